@@ -30,7 +30,8 @@ if uploaded:
 
     # Carregar dados
     try:
-        df = pd.read_csv(filename)
+        # O rodapé com as estatísticas do dispositivo vem em linhas '#'
+        df = pd.read_csv(filename, comment='#')
 
         # --- DEBUG: Imprimir os nomes das colunas exatamente como foram lidos ---
         print(f"\nColunas detectadas no arquivo: {list(df.columns)}")
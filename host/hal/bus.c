@@ -0,0 +1,285 @@
+/* bus.c (host build): I2C, SPI and DMA routed to the simulated devices
+ *
+ * Each transfer charges the caller's clock with its time on the wire at the
+ * configured baud rate. SPI DMA transfers run to completion inside
+ * dma_start_channel_mask() and then raise the DMA IRQ in the same thread.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+
+#define MAX_DEVICES 16
+
+i2c_inst_t i2c0_inst = {0, 100000}, i2c1_inst = {1, 100000};
+spi_inst_t spi0_inst = {0, 1000000, {0}}, spi1_inst = {1, 1000000, {0}};
+dma_hw_t dma_hw_inst;
+
+/* ---- I2C ----------------------------------------------------------------- */
+
+typedef struct {
+    i2c_inst_t *i2c;
+    sim_i2c_device_t dev;
+} i2c_slot_t;
+
+static i2c_slot_t i2c_devs[MAX_DEVICES];
+static size_t i2c_dev_count;
+
+void sim_i2c_attach(i2c_inst_t *i2c, const sim_i2c_device_t *dev) {
+    if (i2c_dev_count < MAX_DEVICES)
+        i2c_devs[i2c_dev_count++] = (i2c_slot_t){i2c, *dev};
+}
+
+static const sim_i2c_device_t *i2c_find(i2c_inst_t *i2c, uint8_t addr) {
+    for (size_t i = 0; i < i2c_dev_count; i++)
+        if (i2c_devs[i].i2c == i2c && i2c_devs[i].dev.addr == addr)
+            return &i2c_devs[i].dev;
+    return NULL;
+}
+
+// START + address + len bytes, 9 clocks each
+static void i2c_charge(i2c_inst_t *i2c, size_t len) {
+    sim_time_charge_ns((len + 1) * 9 * 1000000000ull / i2c->baudrate);
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)nostop;
+    i2c_charge(i2c, len);
+    const sim_i2c_device_t *dev = i2c_find(i2c, addr);
+    if (!dev || !dev->write(dev->ctx, src, len))
+        return PICO_ERROR_GENERIC;
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)nostop;
+    i2c_charge(i2c, len);
+    const sim_i2c_device_t *dev = i2c_find(i2c, addr);
+    if (!dev || !dev->read(dev->ctx, dst, len))
+        return PICO_ERROR_GENERIC;
+    return (int)len;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                         bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len,
+                        bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_read_blocking(i2c, addr, dst, len, nostop);
+}
+
+/* ---- SPI ----------------------------------------------------------------- */
+
+typedef struct {
+    spi_inst_t *spi;
+    sim_spi_device_t dev;
+} spi_slot_t;
+
+static spi_slot_t spi_devs[MAX_DEVICES];
+static size_t spi_dev_count;
+
+void sim_spi_attach(spi_inst_t *spi, const sim_spi_device_t *dev) {
+    if (spi_dev_count < MAX_DEVICES)
+        spi_devs[spi_dev_count++] = (spi_slot_t){spi, *dev};
+}
+
+void sim_spi_cs_changed(uint gpio, bool level) {
+    if (!level)
+        return;
+    for (size_t i = 0; i < spi_dev_count; i++)
+        if (spi_devs[i].dev.cs_gpio == gpio && spi_devs[i].dev.deselect)
+            spi_devs[i].dev.deselect(spi_devs[i].dev.ctx);
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    return spi_set_baudrate(spi, baudrate);
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate) {
+    // clk_peri / (even prescale * postdiv), as the PL022 would round it
+    const uint clk_peri = 125000000;
+    uint prescale = 2;
+    while (prescale < 254 && clk_peri / prescale > baudrate * 256ull)
+        prescale += 2;
+    uint postdiv = 1;
+    while (postdiv < 256 && clk_peri / (prescale * postdiv) > baudrate)
+        postdiv++;
+    spi->baudrate = clk_peri / (prescale * postdiv);
+    return spi->baudrate;
+}
+
+// MISO floats high (pulled up) unless a selected device drives it
+static void spi_exchange(spi_inst_t *spi, const uint8_t *tx, bool tx_incr, uint8_t *rx,
+                         bool rx_incr, size_t len) {
+    sim_time_charge_ns(len * 8 * 1000000000ull / spi->baudrate);
+    const sim_spi_device_t *sel = NULL;
+    for (size_t i = 0; i < spi_dev_count; i++)
+        if (spi_devs[i].spi == spi && !gpio_get(spi_devs[i].dev.cs_gpio))
+            sel = &spi_devs[i].dev;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t in = sel ? sel->exchange(sel->ctx, *tx) : 0xFF;
+        *rx = in;
+        if (tx_incr) tx++;
+        if (rx_incr) rx++;
+    }
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len) {
+    spi_exchange(spi, src, true, dst, true, len);
+    return (int)len;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    uint8_t discard;
+    spi_exchange(spi, src, true, &discard, false, len);
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len) {
+    spi_exchange(spi, &repeated_tx_data, false, dst, true, len);
+    return (int)len;
+}
+
+/* ---- DMA ----------------------------------------------------------------- */
+
+typedef struct {
+    bool claimed;
+    dma_channel_config cfg;
+    volatile void *write_addr;
+    const volatile void *read_addr;
+    uint count;
+    bool irq0, irq1;
+} dma_chan_t;
+
+static dma_chan_t chans[NUM_DMA_CHANNELS];
+static pthread_mutex_t dma_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define MAX_IRQ_HANDLERS 4
+static irq_handler_t irq_handlers[2][MAX_IRQ_HANDLERS];
+static bool irq_enabled[2];
+
+int dma_claim_unused_channel(bool required) {
+    pthread_mutex_lock(&dma_mutex);
+    for (int i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!chans[i].claimed) {
+            chans[i].claimed = true;
+            pthread_mutex_unlock(&dma_mutex);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&dma_mutex);
+    if (required) {
+        fprintf(stderr, "[sim] No DMA channels available\n");
+        abort();
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    chans[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    return (dma_channel_config){true, false, DMA_SIZE_32, 0x3f};
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    chans[channel].cfg = *config;
+    chans[channel].write_addr = write_addr;
+    chans[channel].read_addr = read_addr;
+    chans[channel].count = transfer_count;
+    if (trigger)
+        dma_start_channel_mask(1u << channel);
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    chans[channel].irq0 = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    chans[channel].irq1 = enabled;
+}
+
+static spi_inst_t *spi_of_dr(const volatile void *addr) {
+    if (addr == &spi0_inst.hw.dr) return spi0;
+    if (addr == &spi1_inst.hw.dr) return spi1;
+    return NULL;
+}
+
+static void raise_irq(uint line, io_rw_32 *ints, uint channel) {
+    if (!irq_enabled[line])
+        return;
+    __atomic_or_fetch(ints, 1u << channel, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < MAX_IRQ_HANDLERS && irq_handlers[line][i]; i++)
+        irq_handlers[line][i]();
+    // INTS is write-1-to-clear on the chip; a plain store can't model that,
+    // so the bit is dropped once the handlers have run
+    __atomic_and_fetch(ints, ~(1u << channel), __ATOMIC_SEQ_CST);
+}
+
+// Only SPI TX/RX channel pairs are modelled: the TX channel writes to an
+// SPI data register and the RX channel reads from the same one
+void dma_start_channel_mask(uint32_t chan_mask) {
+    for (uint rx = 0; rx < NUM_DMA_CHANNELS; rx++) {
+        if (!(chan_mask & (1u << rx)))
+            continue;
+        spi_inst_t *spi = spi_of_dr(chans[rx].read_addr);
+        if (!spi)
+            continue;
+        for (uint tx = 0; tx < NUM_DMA_CHANNELS; tx++) {
+            if (!(chan_mask & (1u << tx)) || spi_of_dr(chans[tx].write_addr) != spi)
+                continue;
+            spi_exchange(spi, (const uint8_t *)chans[tx].read_addr, chans[tx].cfg.read_increment,
+                         (uint8_t *)chans[rx].write_addr, chans[rx].cfg.write_increment,
+                         chans[rx].count);
+            if (chans[tx].irq0) raise_irq(0, &dma_hw->ints0, tx);
+            if (chans[tx].irq1) raise_irq(1, &dma_hw->ints1, tx);
+            if (chans[rx].irq0) raise_irq(0, &dma_hw->ints0, rx);
+            if (chans[rx].irq1) raise_irq(1, &dma_hw->ints1, rx);
+            break;
+        }
+    }
+}
+
+/* ---- IRQ ----------------------------------------------------------------- */
+
+static int irq_line(uint num) {
+    return num == DMA_IRQ_0 ? 0 : num == DMA_IRQ_1 ? 1 : -1;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    int line = irq_line(num);
+    if (line < 0) return;
+    memset(irq_handlers[line], 0, sizeof irq_handlers[line]);
+    irq_handlers[line][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    int line = irq_line(num);
+    if (line < 0) return;
+    for (int i = 0; i < MAX_IRQ_HANDLERS; i++) {
+        if (irq_handlers[line][i] == handler) return;
+        if (!irq_handlers[line][i]) {
+            irq_handlers[line][i] = handler;
+            return;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    int line = irq_line(num);
+    if (line >= 0)
+        irq_enabled[line] = enabled;
+}
@@ -0,0 +1,123 @@
+/* gpio.c (host build): pin state, pulls, externally driven inputs, IRQs */
+
+#include "sim.h"
+
+typedef struct {
+    enum gpio_function fn;
+    bool out;         // Direction
+    bool out_value;   // Level driven by the firmware
+    bool pull_up, pull_down;
+    bool driven;      // Level forced from outside (sim_gpio_drive)
+    bool ext_value;
+    uint32_t irq_mask;
+} gpio_state_t;
+
+static gpio_state_t pins[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t irq_callback;
+static pthread_mutex_t gpio_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool level_of(const gpio_state_t *p) {
+    if (p->out)
+        return p->out_value;
+    if (p->driven)
+        return p->ext_value;
+    return p->pull_up;
+}
+
+void gpio_init(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pthread_mutex_lock(&gpio_mutex);
+    pins[gpio].fn = GPIO_FUNC_SIO;
+    pins[gpio].out = false;
+    pins[gpio].out_value = false;
+    pthread_mutex_unlock(&gpio_mutex);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pins[gpio].fn = fn;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pthread_mutex_lock(&gpio_mutex);
+    bool before = level_of(&pins[gpio]);
+    pins[gpio].out = out;
+    bool after = level_of(&pins[gpio]);
+    pthread_mutex_unlock(&gpio_mutex);
+    if (before != after)
+        sim_spi_cs_changed(gpio, after);
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pthread_mutex_lock(&gpio_mutex);
+    bool before = level_of(&pins[gpio]);
+    pins[gpio].out_value = value;
+    bool after = level_of(&pins[gpio]);
+    pthread_mutex_unlock(&gpio_mutex);
+    if (before != after)
+        sim_spi_cs_changed(gpio, after);
+}
+
+bool gpio_get(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) return false;
+    sim_poll();
+    pthread_mutex_lock(&gpio_mutex);
+    bool level = level_of(&pins[gpio]);
+    pthread_mutex_unlock(&gpio_mutex);
+    return level;
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pthread_mutex_lock(&gpio_mutex);
+    pins[gpio].pull_up = up;
+    pins[gpio].pull_down = down;
+    pthread_mutex_unlock(&gpio_mutex);
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pthread_mutex_lock(&gpio_mutex);
+    if (enabled)
+        pins[gpio].irq_mask |= event_mask;
+    else
+        pins[gpio].irq_mask &= ~event_mask;
+    pthread_mutex_unlock(&gpio_mutex);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    if (enabled)
+        irq_callback = callback;
+}
+
+static void set_external(uint gpio, bool driven, bool value) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    pthread_mutex_lock(&gpio_mutex);
+    gpio_state_t *p = &pins[gpio];
+    bool before = level_of(p);
+    p->driven = driven;
+    p->ext_value = value;
+    bool after = level_of(p);
+    uint32_t events = 0;
+    if (before && !after)
+        events = GPIO_IRQ_EDGE_FALL | GPIO_IRQ_LEVEL_LOW;
+    else if (!before && after)
+        events = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_LEVEL_HIGH;
+    events &= p->irq_mask;
+    gpio_irq_callback_t cb = irq_callback;
+    pthread_mutex_unlock(&gpio_mutex);
+    if (events && cb)
+        cb(gpio, events);
+}
+
+void sim_gpio_drive(uint gpio, bool level) {
+    set_external(gpio, true, level);
+}
+
+void sim_gpio_release(uint gpio) {
+    set_external(gpio, false, false);
+}
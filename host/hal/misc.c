@@ -0,0 +1,101 @@
+/* misc.c (host build): RTC, PWM, boot ROM, board ID */
+
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+
+scb_hw_t scb_hw_inst;
+
+/* ---- RTC ------------------------------------------------------------------
+ * Starts at the host's local time; rtc_set_datetime() moves it. The date
+ * advances with the simulated clock of whoever reads it.
+ */
+
+static pthread_mutex_t rtc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool rtc_started;
+static time_t rtc_base;        // Calendar time at rtc_base_us
+static uint64_t rtc_base_us;
+
+void rtc_init(void) {
+    pthread_mutex_lock(&rtc_mutex);
+    if (!rtc_started) {
+        // FatFs_SPI's rtc.c overrides time(), so ask the kernel directly
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        struct tm tm;
+        localtime_r(&ts.tv_sec, &tm);
+        rtc_base = timegm(&tm);
+        rtc_base_us = time_us_64();
+        rtc_started = true;
+    }
+    pthread_mutex_unlock(&rtc_mutex);
+}
+
+bool rtc_set_datetime(const datetime_t *t) {
+    struct tm tm = {
+        .tm_sec = t->sec, .tm_min = t->min, .tm_hour = t->hour,
+        .tm_mday = t->day, .tm_mon = t->month - 1, .tm_year = t->year - 1900,
+    };
+    pthread_mutex_lock(&rtc_mutex);
+    rtc_base = timegm(&tm);
+    rtc_base_us = time_us_64();
+    rtc_started = true;
+    pthread_mutex_unlock(&rtc_mutex);
+    return true;
+}
+
+bool rtc_get_datetime(datetime_t *t) {
+    pthread_mutex_lock(&rtc_mutex);
+    bool ok = rtc_started;
+    time_t now = rtc_base + (time_t)((time_us_64() - rtc_base_us) / 1000000);
+    pthread_mutex_unlock(&rtc_mutex);
+    if (!ok)
+        return false;
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    t->year = tm.tm_year + 1900;
+    t->month = tm.tm_mon + 1;
+    t->day = tm.tm_mday;
+    t->dotw = tm.tm_wday;
+    t->hour = tm.tm_hour;
+    t->min = tm.tm_min;
+    t->sec = tm.tm_sec;
+    return true;
+}
+
+bool rtc_running(void) {
+    return rtc_started;
+}
+
+/* ---- PWM: the buzzer is silent on the host --------------------------------- */
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    (void)slice_num; (void)divider;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    (void)slice_num; (void)wrap;
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    (void)slice_num; (void)chan; (void)level;
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    (void)slice_num; (void)enabled;
+}
+
+/* ---- Boot ROM, IDs --------------------------------------------------------- */
+
+void reset_usb_boot(uint32_t gpio_activity_pin_mask, uint32_t disable_interface_mask) {
+    (void)gpio_activity_pin_mask; (void)disable_interface_mask;
+    fflush(stdout);
+    fprintf(stderr, "[sim] reset_usb_boot: exiting\n");
+    exit(0);
+}
+
+void pico_get_unique_board_id_string(char *id_out, uint len) {
+    strncpy(id_out, "E66038B7136F2E2A", len);
+    if (len) id_out[len - 1] = '\0';
+}
@@ -0,0 +1,115 @@
+/* stdio.c (host build): the console is the process's stdin/stdout
+ *
+ * A terminal on stdin is switched to raw mode so single keys reach the
+ * firmware as they would over USB CDC. From a pipe or file, '\n' becomes
+ * '\r' (the firmware's Enter) and end of input exits the simulator, so
+ * scripted sessions terminate on their own.
+ */
+
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+uint32_t sim_linger_ms;
+
+static struct termios saved_tio;
+static bool tty_raw;
+static bool input_ended;
+static uint64_t input_end_ns;
+
+static void restore_tty(void) {
+    if (tty_raw)
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_tio);
+}
+
+static void usb_out_chars(const char *buf, int len) {
+    fwrite(buf, 1, len, stdout);
+}
+
+static void usb_out_flush(void) {
+    fflush(stdout);
+}
+
+stdio_driver_t stdio_usb = {usb_out_chars, usb_out_flush, NULL};
+
+bool stdio_init_all(void) {
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved_tio) == 0) {
+        struct termios tio = saved_tio;
+        tio.c_lflag &= ~(ICANON | ECHO);
+        tio.c_iflag &= ~ICRNL;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+        tty_raw = true;
+        atexit(restore_tty);
+    }
+    return true;
+}
+
+void stdio_flush(void) {
+    fflush(stdout);
+}
+
+bool stdio_usb_connected(void) {
+    return true;
+}
+
+int putchar_raw(int c) {
+    return putchar(c);
+}
+
+// Only the USB console exists, so there is no translation and no other
+// driver to filter out
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation) {
+    (void)cr_translation;
+    fwrite(s, 1, len, stdout);
+    if (newline) putchar('\n');
+    return len;
+}
+
+void stdio_filter_driver(stdio_driver_t *driver) {
+    (void)driver;
+}
+
+// Polling with a zero timeout still counts as a little idle time in the
+// accelerated mode, so an idle main loop moves the clock forward quickly
+#define IDLE_POLL_NS 50000
+
+static int no_input(uint32_t timeout_us) {
+    uint64_t ns = timeout_us * 1000ull;
+    if (!sim_realtime && ns < IDLE_POLL_NS)
+        ns = IDLE_POLL_NS;
+    sim_time_charge_ns(ns);
+    sim_poll();
+    if (input_ended && sim_time_ns() - input_end_ns >= sim_linger_ms * 1000000ull) {
+        fflush(stdout);
+        exit(0);
+    }
+    return PICO_ERROR_TIMEOUT;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    fflush(stdout);
+    if (input_ended)
+        return no_input(timeout_us);
+    struct pollfd p = {STDIN_FILENO, POLLIN, 0};
+    // Waiting for input is idle time for the firmware: don't burn real time
+    // on it when the clock is simulated
+    int r = poll(&p, 1, sim_realtime ? (int)(timeout_us / 1000) : 0);
+    if (r <= 0)
+        return no_input(timeout_us);
+    unsigned char c;
+    if (read(STDIN_FILENO, &c, 1) != 1) {
+        // End of scripted input
+        input_ended = true;
+        input_end_ns = sim_time_ns();
+        return no_input(timeout_us);
+    }
+    if (!tty_raw && c == '\n')
+        c = '\r';
+    if (tty_raw && c == 3)  // Ctrl+C
+        exit(0);
+    return c;
+}
@@ -0,0 +1,324 @@
+/* sync.c (host build): mutexes, semaphores, queues, events, cores
+ *
+ * Every hand-off records the simulated time of the releasing thread; the
+ * thread that picks it up syncs its clock forward to that time.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+
+static void abs_deadline(struct timespec *ts, uint64_t timeout_us) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    uint64_t ns = ts->tv_nsec + (timeout_us % 1000000) * 1000;
+    ts->tv_sec += timeout_us / 1000000 + ns / 1000000000;
+    ts->tv_nsec = ns % 1000000000;
+}
+
+/* ---- Mutex --------------------------------------------------------------- */
+
+void mutex_init(mutex_t *mtx) {
+    pthread_mutex_init(&mtx->m, NULL);
+    mtx->release_ns = 0;
+    mtx->initialized = true;
+}
+
+void mutex_enter_blocking(mutex_t *mtx) {
+    pthread_mutex_lock(&mtx->m);
+    sim_time_sync_ns(mtx->release_ns);
+}
+
+bool mutex_try_enter(mutex_t *mtx, uint32_t *owner_out) {
+    (void)owner_out;
+    if (pthread_mutex_trylock(&mtx->m))
+        return false;
+    sim_time_sync_ns(mtx->release_ns);
+    return true;
+}
+
+bool mutex_enter_timeout_ms(mutex_t *mtx, uint32_t timeout_ms) {
+    struct timespec ts;
+    abs_deadline(&ts, timeout_ms * 1000ull);
+    if (pthread_mutex_timedlock(&mtx->m, &ts))
+        return false;
+    sim_time_sync_ns(mtx->release_ns);
+    return true;
+}
+
+void mutex_exit(mutex_t *mtx) {
+    mtx->release_ns = sim_time_ns();
+    pthread_mutex_unlock(&mtx->m);
+}
+
+void recursive_mutex_init(recursive_mutex_t *mtx) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mtx->m, &attr);
+    pthread_mutexattr_destroy(&attr);
+    mtx->release_ns = 0;
+    mtx->initialized = true;
+}
+
+void recursive_mutex_enter_blocking(recursive_mutex_t *mtx) {
+    pthread_mutex_lock(&mtx->m);
+    sim_time_sync_ns(mtx->release_ns);
+}
+
+bool recursive_mutex_enter_timeout_ms(recursive_mutex_t *mtx, uint32_t timeout_ms) {
+    struct timespec ts;
+    abs_deadline(&ts, timeout_ms * 1000ull);
+    if (pthread_mutex_timedlock(&mtx->m, &ts))
+        return false;
+    sim_time_sync_ns(mtx->release_ns);
+    return true;
+}
+
+void recursive_mutex_exit(recursive_mutex_t *mtx) {
+    mtx->release_ns = sim_time_ns();
+    pthread_mutex_unlock(&mtx->m);
+}
+
+/* ---- Semaphore ----------------------------------------------------------- */
+
+void sem_init(semaphore_t *sem, int16_t initial_permits, int16_t max_permits) {
+    pthread_mutex_init(&sem->m, NULL);
+    pthread_cond_init(&sem->c, NULL);
+    sem->permits = initial_permits;
+    sem->max_permits = max_permits;
+    sem->release_ns = 0;
+}
+
+int sem_available(semaphore_t *sem) {
+    pthread_mutex_lock(&sem->m);
+    int n = sem->permits;
+    pthread_mutex_unlock(&sem->m);
+    return n;
+}
+
+bool sem_release(semaphore_t *sem) {
+    bool ok = false;
+    pthread_mutex_lock(&sem->m);
+    if (sem->permits < sem->max_permits) {
+        sem->permits++;
+        sem->release_ns = sim_time_ns();
+        pthread_cond_signal(&sem->c);
+        ok = true;
+    }
+    pthread_mutex_unlock(&sem->m);
+    return ok;
+}
+
+void sem_reset(semaphore_t *sem, int16_t permits) {
+    pthread_mutex_lock(&sem->m);
+    sem->permits = permits;
+    pthread_cond_broadcast(&sem->c);
+    pthread_mutex_unlock(&sem->m);
+}
+
+bool sem_acquire_timeout_us(semaphore_t *sem, uint32_t timeout_us) {
+    struct timespec ts;
+    abs_deadline(&ts, timeout_us);
+    pthread_mutex_lock(&sem->m);
+    while (sem->permits <= 0) {
+        if (pthread_cond_timedwait(&sem->c, &sem->m, &ts) == ETIMEDOUT)
+            break;
+    }
+    bool ok = sem->permits > 0;
+    if (ok) {
+        sem->permits--;
+        sim_time_sync_ns(sem->release_ns);
+    }
+    pthread_mutex_unlock(&sem->m);
+    return ok;
+}
+
+bool sem_acquire_timeout_ms(semaphore_t *sem, uint32_t timeout_ms) {
+    return sem_acquire_timeout_us(sem, timeout_ms * 1000);
+}
+
+void sem_acquire_blocking(semaphore_t *sem) {
+    pthread_mutex_lock(&sem->m);
+    while (sem->permits <= 0)
+        pthread_cond_wait(&sem->c, &sem->m);
+    sem->permits--;
+    sim_time_sync_ns(sem->release_ns);
+    pthread_mutex_unlock(&sem->m);
+}
+
+/* ---- Queue --------------------------------------------------------------- */
+
+void queue_init(queue_t *q, uint element_size, uint element_count) {
+    pthread_mutex_init(&q->m, NULL);
+    pthread_cond_init(&q->c, NULL);
+    q->data = calloc(element_count, element_size);
+    q->element_size = element_size;
+    q->element_count = element_count;
+    q->rptr = q->wptr = q->used = 0;
+    q->add_ns = 0;
+}
+
+void queue_free(queue_t *q) {
+    free(q->data);
+    q->data = NULL;
+}
+
+uint queue_get_level(queue_t *q) {
+    pthread_mutex_lock(&q->m);
+    uint n = q->used;
+    pthread_mutex_unlock(&q->m);
+    return n;
+}
+
+static void queue_put(queue_t *q, const void *data) {
+    memcpy(q->data + q->wptr * q->element_size, data, q->element_size);
+    q->wptr = (q->wptr + 1) % q->element_count;
+    q->used++;
+    q->add_ns = sim_time_ns();
+    pthread_cond_broadcast(&q->c);
+}
+
+static void queue_take(queue_t *q, void *data) {
+    memcpy(data, q->data + q->rptr * q->element_size, q->element_size);
+    q->rptr = (q->rptr + 1) % q->element_count;
+    q->used--;
+    sim_time_sync_ns(q->add_ns);
+    pthread_cond_broadcast(&q->c);
+}
+
+bool queue_try_add(queue_t *q, const void *data) {
+    pthread_mutex_lock(&q->m);
+    bool ok = q->used < q->element_count;
+    if (ok)
+        queue_put(q, data);
+    pthread_mutex_unlock(&q->m);
+    return ok;
+}
+
+bool queue_try_remove(queue_t *q, void *data) {
+    pthread_mutex_lock(&q->m);
+    bool ok = q->used > 0;
+    if (ok)
+        queue_take(q, data);
+    pthread_mutex_unlock(&q->m);
+    return ok;
+}
+
+void queue_add_blocking(queue_t *q, const void *data) {
+    pthread_mutex_lock(&q->m);
+    while (q->used == q->element_count)
+        pthread_cond_wait(&q->c, &q->m);
+    queue_put(q, data);
+    pthread_mutex_unlock(&q->m);
+}
+
+void queue_remove_blocking(queue_t *q, void *data) {
+    pthread_mutex_lock(&q->m);
+    while (!q->used)
+        pthread_cond_wait(&q->c, &q->m);
+    queue_take(q, data);
+    pthread_mutex_unlock(&q->m);
+}
+
+/* ---- Events and interrupts ------------------------------------------------- */
+
+static pthread_mutex_t event_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t event_count, event_ns;
+
+void __sev(void) {
+    pthread_mutex_lock(&event_mutex);
+    event_count++;
+    event_ns = sim_time_ns();
+    pthread_cond_broadcast(&event_cond);
+    pthread_mutex_unlock(&event_mutex);
+}
+
+// Returns on the next __sev() or after 1 ms, like a core woken by any event
+void __wfe(void) {
+    struct timespec ts;
+    abs_deadline(&ts, 1000);
+    sim_poll();
+    pthread_mutex_lock(&event_mutex);
+    uint64_t seen = event_count;
+    while (seen == event_count) {
+        if (pthread_cond_timedwait(&event_cond, &event_mutex, &ts) == ETIMEDOUT)
+            break;
+    }
+    if (seen != event_count)
+        sim_time_sync_ns(event_ns);
+    pthread_mutex_unlock(&event_mutex);
+}
+
+void __wfi(void) {
+    __wfe();
+}
+
+void tight_loop_contents(void) {
+    sim_poll();
+    sim_time_charge_ns(1000);
+}
+
+// There is no interrupt preemption on the host: "IRQs" run in the thread
+// that raises them, so masking has nothing to do
+uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+void critical_section_init(critical_section_t *crit_sec) {
+    pthread_mutex_init(&crit_sec->m, NULL);
+    crit_sec->initialized = true;
+}
+
+void critical_section_enter_blocking(critical_section_t *crit_sec) {
+    pthread_mutex_lock(&crit_sec->m);
+}
+
+void critical_section_exit(critical_section_t *crit_sec) {
+    pthread_mutex_unlock(&crit_sec->m);
+}
+
+/* ---- Cores --------------------------------------------------------------- */
+
+static __thread uint core_num;
+static pthread_t core1_thread;
+static bool core1_running;
+
+typedef struct {
+    void (*entry)(void);
+    int64_t offset_ns;
+} core1_start_t;
+
+static void *core1_main(void *arg) {
+    core1_start_t start = *(core1_start_t *)arg;
+    free(arg);
+    core_num = 1;
+    sim_time_inherit(start.offset_ns);
+    start.entry();
+    return NULL;
+}
+
+uint get_core_num(void) {
+    return core_num;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    if (core1_running)
+        return;
+    core1_start_t *start = malloc(sizeof *start);
+    start->entry = entry;
+    start->offset_ns = sim_time_offset_ns();
+    pthread_create(&core1_thread, NULL, core1_main, start);
+    pthread_detach(core1_thread);
+    core1_running = true;
+}
+
+void multicore_reset_core1(void) {
+    // A detached thread can't be stopped safely; the firmware only launches once
+}
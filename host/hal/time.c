@@ -0,0 +1,77 @@
+/* time.c (host build): per-thread simulated clock, sleeps */
+
+#include <errno.h>
+#include <time.h>
+
+#include "sim.h"
+
+bool sim_realtime;
+
+static uint64_t boot_ns;
+// Time skipped by this thread on top of the real elapsed time
+static __thread int64_t offset_ns;
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+__attribute__((constructor)) static void time_boot(void) {
+    boot_ns = mono_ns();
+}
+
+static void real_sleep_ns(uint64_t ns) {
+    struct timespec ts = {(time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull)};
+    while (nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+uint64_t sim_time_ns(void) {
+    return mono_ns() - boot_ns + offset_ns;
+}
+
+void sim_time_charge_ns(uint64_t ns) {
+    if (sim_realtime)
+        real_sleep_ns(ns);
+    else
+        offset_ns += ns;
+}
+
+void sim_time_sync_ns(uint64_t t_ns) {
+    uint64_t now = sim_time_ns();
+    if (t_ns > now)
+        offset_ns += t_ns - now;
+}
+
+void sim_time_inherit(int64_t offset) {
+    offset_ns = offset;
+}
+
+int64_t sim_time_offset_ns(void) {
+    return offset_ns;
+}
+
+uint64_t time_us_64(void) {
+    return sim_time_ns() / 1000;
+}
+
+void sleep_us(uint64_t us) {
+    sim_poll();
+    sim_time_charge_ns(us * 1000);
+    sim_poll();
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us(ms * 1000ull);
+}
+
+void sleep_until(absolute_time_t t) {
+    uint64_t now = time_us_64();
+    if (t > now)
+        sleep_us(t - now);
+}
+
+void busy_wait_us(uint64_t us) {
+    sleep_us(us);
+}
@@ -0,0 +1,32 @@
+/* usb_msc.c (host build): no USB device on the host
+ *
+ * Replaces lib/usb_msc.c. The SD images are plain files, so the host can
+ * open them directly instead of going through Mass Storage mode.
+ */
+
+#include "usb_msc.h"
+
+#include <stdio.h>
+
+void usb_msc_init(void) {
+}
+
+bool usb_msc_start(sd_card_t *sd) {
+    (void)sd;
+    printf("[sim] USB Mass Storage indisponível: abra a imagem do cartão no host\n");
+    return false;
+}
+
+void usb_msc_stop(void) {
+}
+
+bool usb_msc_active(void) {
+    return false;
+}
+
+int usb_msc_task(void) {
+    return PICO_ERROR_TIMEOUT;
+}
+
+void usb_msc_end(void) {
+}
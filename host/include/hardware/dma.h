@@ -0,0 +1,3 @@
+/* hardware/dma.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* hardware/i2c.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
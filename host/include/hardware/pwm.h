@@ -0,0 +1,3 @@
+/* hardware/pwm.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
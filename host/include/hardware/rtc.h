@@ -0,0 +1,3 @@
+/* hardware/rtc.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
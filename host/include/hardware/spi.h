@@ -0,0 +1,3 @@
+/* hardware/spi.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* hardware/structs/scb.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
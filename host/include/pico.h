@@ -0,0 +1,359 @@
+/* pico.h (host build)
+ *
+ * The subset of the Pico SDK API used by the firmware, implemented on top of
+ * POSIX so main.c, lib/ and FatFs_SPI compile unchanged for Linux. The SDK
+ * header names (pico/stdlib.h, hardware/spi.h, ...) are thin wrappers that
+ * include this file. Peripherals are routed to the simulated devices in
+ * host/sim.
+ */
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---- Platform ---------------------------------------------------------- */
+
+#define PICO_ON_DEVICE 0
+
+typedef unsigned int uint;
+typedef volatile uint32_t io_rw_32;
+typedef volatile uint32_t io_ro_32;
+
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define __in_flash(group)
+#define __unused __attribute__((unused))
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+enum pico_error_codes {
+    PICO_OK = 0,
+    PICO_ERROR_NONE = 0,
+    PICO_ERROR_TIMEOUT = -1,
+    PICO_ERROR_GENERIC = -2,
+    PICO_ERROR_NO_DATA = -3,
+};
+
+// Busy-wait loop body: lets the simulated clock and devices move on
+void tight_loop_contents(void);
+void __wfe(void);
+void __wfi(void);
+void __sev(void);
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+uint get_core_num(void);
+
+/* ---- Time -------------------------------------------------------------- */
+
+// Microseconds since boot. On the host each thread ("core") keeps its own
+// simulated clock: sleeps and modelled bus time advance it without waiting.
+typedef uint64_t absolute_time_t;
+#define nil_time ((absolute_time_t)0)
+#define at_the_end_of_time ((absolute_time_t)INT64_MAX)
+
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + ms * 1000ull; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return delayed_by_us(get_absolute_time(), us); }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return delayed_by_ms(get_absolute_time(), ms); }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+static inline bool time_reached(absolute_time_t t) { return get_absolute_time() >= t; }
+static inline bool is_nil_time(absolute_time_t t) { return !t; }
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us(uint64_t us);
+static inline void busy_wait_us_32(uint32_t us) { busy_wait_us(us); }
+static inline void busy_wait_ms(uint32_t ms) { busy_wait_us(ms * 1000ull); }
+
+/* ---- Sync -------------------------------------------------------------- */
+
+typedef struct {
+    pthread_mutex_t m;
+    bool initialized;
+    uint64_t release_ns;  // Simulated time of the last exit
+} mutex_t;
+
+typedef struct {
+    pthread_mutex_t m;
+    bool initialized;
+    uint64_t release_ns;
+} recursive_mutex_t;
+
+#define auto_init_mutex(name) static mutex_t name = {PTHREAD_MUTEX_INITIALIZER, true, 0}
+
+void mutex_init(mutex_t *mtx);
+static inline bool mutex_is_initialized(mutex_t *mtx) { return mtx->initialized; }
+void mutex_enter_blocking(mutex_t *mtx);
+bool mutex_try_enter(mutex_t *mtx, uint32_t *owner_out);
+bool mutex_enter_timeout_ms(mutex_t *mtx, uint32_t timeout_ms);
+void mutex_exit(mutex_t *mtx);
+
+void recursive_mutex_init(recursive_mutex_t *mtx);
+static inline bool recursive_mutex_is_initialized(recursive_mutex_t *mtx) { return mtx->initialized; }
+void recursive_mutex_enter_blocking(recursive_mutex_t *mtx);
+bool recursive_mutex_enter_timeout_ms(recursive_mutex_t *mtx, uint32_t timeout_ms);
+void recursive_mutex_exit(recursive_mutex_t *mtx);
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t c;
+    int16_t permits;
+    int16_t max_permits;
+    uint64_t release_ns;
+} semaphore_t;
+
+void sem_init(semaphore_t *sem, int16_t initial_permits, int16_t max_permits);
+int sem_available(semaphore_t *sem);
+bool sem_release(semaphore_t *sem);
+void sem_reset(semaphore_t *sem, int16_t permits);
+void sem_acquire_blocking(semaphore_t *sem);
+bool sem_acquire_timeout_ms(semaphore_t *sem, uint32_t timeout_ms);
+bool sem_acquire_timeout_us(semaphore_t *sem, uint32_t timeout_us);
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t c;
+    uint8_t *data;
+    uint element_size;
+    uint element_count;
+    uint rptr, wptr, used;
+    uint64_t add_ns;
+} queue_t;
+
+void queue_init(queue_t *q, uint element_size, uint element_count);
+void queue_free(queue_t *q);
+uint queue_get_level(queue_t *q);
+static inline bool queue_is_empty(queue_t *q) { return !queue_get_level(q); }
+bool queue_try_add(queue_t *q, const void *data);
+bool queue_try_remove(queue_t *q, void *data);
+void queue_add_blocking(queue_t *q, const void *data);
+void queue_remove_blocking(queue_t *q, void *data);
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+// No spin lock to claim: a plain pthread mutex between the two core threads
+typedef struct {
+    pthread_mutex_t m;
+    bool initialized;
+} critical_section_t;
+
+void critical_section_init(critical_section_t *crit_sec);
+static inline bool critical_section_is_initialized(critical_section_t *crit_sec) {
+    return crit_sec->initialized;
+}
+void critical_section_enter_blocking(critical_section_t *crit_sec);
+void critical_section_exit(critical_section_t *crit_sec);
+
+/* ---- Multicore ----------------------------------------------------------- */
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+
+/* ---- GPIO ---------------------------------------------------------------- */
+
+#define NUM_BANK0_GPIOS 30
+enum gpio_function {
+    GPIO_FUNC_XIP = 0, GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8, GPIO_FUNC_USB = 9, GPIO_FUNC_NULL = 0x1f,
+};
+enum gpio_dir { GPIO_IN = 0, GPIO_OUT = 1 };
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u, GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u, GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+enum gpio_drive_strength {
+    GPIO_DRIVE_STRENGTH_2MA = 0, GPIO_DRIVE_STRENGTH_4MA = 1,
+    GPIO_DRIVE_STRENGTH_8MA = 2, GPIO_DRIVE_STRENGTH_12MA = 3,
+};
+enum gpio_slew_rate { GPIO_SLEW_RATE_SLOW = 0, GPIO_SLEW_RATE_FAST = 1 };
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_pulls(uint gpio, bool up, bool down);
+static inline void gpio_pull_up(uint gpio) { gpio_set_pulls(gpio, true, false); }
+static inline void gpio_pull_down(uint gpio) { gpio_set_pulls(gpio, false, true); }
+static inline void gpio_disable_pulls(uint gpio) { gpio_set_pulls(gpio, false, false); }
+static inline void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) { (void)gpio; (void)drive; }
+static inline void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew) { (void)gpio; (void)slew; }
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback);
+
+/* ---- IRQ ----------------------------------------------------------------- */
+
+typedef void (*irq_handler_t)(void);
+enum { DMA_IRQ_0 = 11, DMA_IRQ_1 = 12 };
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(uint num, bool enabled);
+
+/* ---- I2C ----------------------------------------------------------------- */
+
+typedef struct i2c_inst {
+    uint index;
+    uint baudrate;
+} i2c_inst_t;
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+static inline uint i2c_hw_index(i2c_inst_t *i2c) { return i2c->index; }
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                         bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len,
+                        bool nostop, uint timeout_us);
+
+/* ---- SPI ----------------------------------------------------------------- */
+
+typedef struct {
+    io_rw_32 dr;
+} spi_hw_t;
+typedef struct spi_inst {
+    uint index;
+    uint baudrate;
+    spi_hw_t hw;
+} spi_inst_t;
+extern spi_inst_t spi0_inst, spi1_inst;
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+
+typedef enum { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 } spi_cpha_t;
+typedef enum { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 } spi_cpol_t;
+typedef enum { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 } spi_order_t;
+
+static inline uint spi_get_index(const spi_inst_t *spi) { return spi->index; }
+static inline spi_hw_t *spi_get_hw(spi_inst_t *spi) { return &spi->hw; }
+uint spi_init(spi_inst_t *spi, uint baudrate);
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+static inline uint spi_get_baudrate(const spi_inst_t *spi) { return spi->baudrate; }
+static inline void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol,
+                                  spi_cpha_t cpha, spi_order_t order) {
+    (void)spi; (void)data_bits; (void)cpol; (void)cpha; (void)order;
+}
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+
+/* ---- DMA ----------------------------------------------------------------- */
+
+#define NUM_DMA_CHANNELS 12
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+enum { DREQ_SPI0_TX = 16, DREQ_SPI0_RX = 17, DREQ_SPI1_TX = 18, DREQ_SPI1_RX = 19 };
+
+typedef struct {
+    bool read_increment;
+    bool write_increment;
+    enum dma_channel_transfer_size size;
+    uint dreq;
+} dma_channel_config;
+
+typedef struct {
+    io_rw_32 ints0;
+    io_rw_32 ints1;
+} dma_hw_t;
+extern dma_hw_t dma_hw_inst;
+#define dma_hw (&dma_hw_inst)
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { c->read_increment = incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->size = size; }
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_start_channel_mask(uint32_t chan_mask);
+static inline void dma_channel_start(uint channel) { dma_start_channel_mask(1u << channel); }
+// Transfers complete inside dma_start_channel_mask(): channels are never busy
+static inline bool dma_channel_is_busy(uint channel) { (void)channel; return false; }
+static inline void dma_channel_wait_for_finish_blocking(uint channel) { (void)channel; }
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+static inline bool dma_channel_get_irq0_status(uint channel) { return dma_hw->ints0 & (1u << channel); }
+static inline bool dma_channel_get_irq1_status(uint channel) { return dma_hw->ints1 & (1u << channel); }
+
+/* ---- PWM ----------------------------------------------------------------- */
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1u) & 7u; }
+static inline uint pwm_gpio_to_channel(uint gpio) { return gpio & 1u; }
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+void pwm_set_enabled(uint slice_num, bool enabled);
+
+/* ---- RTC ----------------------------------------------------------------- */
+
+typedef struct {
+    int16_t year;
+    int8_t month;
+    int8_t day;
+    int8_t dotw;
+    int8_t hour;
+    int8_t min;
+    int8_t sec;
+} datetime_t;
+
+void rtc_init(void);
+bool rtc_set_datetime(const datetime_t *t);
+bool rtc_get_datetime(datetime_t *t);
+bool rtc_running(void);
+
+/* ---- stdio, boot, IDs -------------------------------------------------- */
+
+typedef struct stdio_driver {
+    void (*out_chars)(const char *buf, int len);
+    void (*out_flush)(void);
+    int (*in_chars)(char *buf, int len);
+} stdio_driver_t;
+extern stdio_driver_t stdio_usb;
+
+bool stdio_init_all(void);
+void stdio_flush(void);
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
+void stdio_filter_driver(stdio_driver_t *driver);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+bool stdio_usb_connected(void);
+
+void reset_usb_boot(uint32_t gpio_activity_pin_mask, uint32_t disable_interface_mask);
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+void pico_get_unique_board_id_string(char *id_out, uint len);
+
+typedef struct {
+    io_rw_32 aircr;
+} scb_hw_t;
+extern scb_hw_t scb_hw_inst;
+#define scb_hw (&scb_hw_inst)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,3 @@
+/* pico/multicore.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/sem.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/stdio.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/stdio_usb.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/stdlib.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/time.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
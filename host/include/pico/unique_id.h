@@ -0,0 +1,3 @@
+/* pico/unique_id.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/util/datetime.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,3 @@
+/* pico/util/queue.h (host build): see pico.h */
+#pragma once
+#include "pico.h"
@@ -0,0 +1,10 @@
+/* tusb.h (host build)
+ *
+ * There is no USB device on the host: the console is the process's
+ * stdin/stdout and the CDC FIFO never fills.
+ */
+#pragma once
+#include "pico.h"
+
+static inline bool tud_cdc_connected(void) { return true; }
+static inline uint32_t tud_cdc_write_available(void) { return 64 * 1024; }
@@ -0,0 +1,219 @@
+/* main.c (host build): command-line options, simulated board, firmware
+ *
+ * Wires the device models where hw_config.c and main.c expect them
+ * (MPU6050 on i2c0 0x68 with INT on GPIO 4, SSD1306 on i2c1 0x3C, SD cards on
+ * spi0/CS 17 and spi1/CS 9) and then runs the unmodified firmware main().
+ * --imu adds more MPU6050s, directly on either bus or behind a TCA9548A at
+ * 0x70, with their INT unwired as lib/imu_array.c expects.
+ *
+ * With --backend image or ram the cards skip the SPI protocol: FatFs_SPI's
+ * ram_disk.c serves the sectors straight from memory, with the latency
+ * model chosen by --latency.
+ */
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "disk_image.h"
+#include "hw_config.h"
+#include "i2c_mux_model.h"
+#include "mpu6050_model.h"
+#include "ram_disk.h"
+#include "sd_card_model.h"
+#include "ssd1306_model.h"
+
+int firmware_main(void);
+
+static ram_disk_t ram_disks[2];
+
+#define MAX_EXTRA_IMUS 8
+
+typedef struct {
+    int bus;
+    int channel;  // -1: directly on the bus
+    uint8_t addr;
+    double ppm;
+} extra_imu_t;
+
+// BUS[.CH]:ADDR[:PPM], e.g. 1:0x68, 0.3:0x68:-40
+static bool parse_imu(const char *s, extra_imu_t *imu) {
+    char *end;
+    imu->bus = (int)strtol(s, &end, 10);
+    imu->channel = -1;
+    if (*end == '.')
+        imu->channel = (int)strtol(end + 1, &end, 10);
+    if (*end != ':' || imu->bus < 0 || imu->bus > 1 || imu->channel > 7)
+        return false;
+    imu->addr = (uint8_t)strtoul(end + 1, &end, 0);
+    imu->ppm = *end == ':' ? strtod(end + 1, &end) : 0;
+    return *end == '\0';
+}
+
+static void print_disk_stats(void) {
+    for (int i = 0; i < 2; i++) {
+        const ram_disk_t *d = &ram_disks[i];
+        if (!d->mem)
+            continue;
+        fprintf(stderr,
+                "[sim] disk %d: %llu reads, %llu writes, %llu busy periods, %.1f ms of "
+                "injected latency\n",
+                i, (unsigned long long)d->reads, (unsigned long long)d->writes,
+                (unsigned long long)d->busy_events, d->delay_us_total / 1000.0);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --sd0 PATH        SD card image on spi0 (default sd0.img)\n"
+            "  --sd1 PATH|none   SD card image on spi1 (default sd1.img)\n"
+            "  --sd-size MB      size of newly created images (default 128)\n"
+            "  --read-us US      card read access time (default 100)\n"
+            "  --write-busy-us US card busy time per written block (default 250)\n"
+            "  --backend B       spi: SD protocol over simulated SPI (default)\n"
+            "                    image: RAM disk on the image files, no SPI\n"
+            "                    ram: RAM disk in memory, discarded at exit\n"
+            "  --latency P       RAM disk latency: none, fast, typical, slow\n"
+            "                    (default none)\n"
+            "  --seed N          RAM disk busy-period random seed\n"
+            "  --mpu-int GPIO    MPU6050 INT pin, -1 = not wired (default 4)\n"
+            "  --oled PATH       write the display to PATH (PBM) on every update\n"
+            "  --realtime        sleeps and bus transfers take real time\n"
+            "  --fast            simulated time skips idle waits\n"
+            "  --linger S        after piped input ends, run S more seconds (default 0)\n"
+            "  --eject S[:D]     pull SD card 0 at S seconds for D seconds (default 1; spi)\n"
+            "  --imu BUS[.CH]:ADDR[:PPM]\n"
+            "                    extra MPU6050 on i2c BUS (behind a TCA9548A on channel\n"
+            "                    CH), sample clock off by PPM; repeatable\n"
+            "Default: --realtime on a terminal, --fast when stdin is a pipe or file.\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *sd0 = "sd0.img", *sd1 = "sd1.img", *oled = NULL;
+    uint64_t sd_size = 128ull << 20;
+    sd_card_timing_t timing = {.read_access_us = 100, .write_busy_us = 250};
+    int realtime = -1;
+    const char *backend = "spi";
+    const ram_disk_latency_t *latency = ram_disk_find_latency("none");
+    uint32_t seed = 1;
+    int mpu_int = 4;
+    double eject_at = -1, eject_len = 1;
+    extra_imu_t imus[MAX_EXTRA_IMUS];
+    int n_imus = 0;
+
+    enum { OPT_SD0 = 256, OPT_SD1, OPT_SIZE, OPT_READ, OPT_WRITE, OPT_OLED, OPT_RT, OPT_FAST,
+           OPT_LINGER, OPT_BACKEND, OPT_LATENCY, OPT_SEED, OPT_MPU_INT, OPT_EJECT, OPT_IMU };
+    static const struct option opts[] = {
+        {"sd0", required_argument, 0, OPT_SD0},
+        {"sd1", required_argument, 0, OPT_SD1},
+        {"sd-size", required_argument, 0, OPT_SIZE},
+        {"read-us", required_argument, 0, OPT_READ},
+        {"write-busy-us", required_argument, 0, OPT_WRITE},
+        {"oled", required_argument, 0, OPT_OLED},
+        {"realtime", no_argument, 0, OPT_RT},
+        {"fast", no_argument, 0, OPT_FAST},
+        {"linger", required_argument, 0, OPT_LINGER},
+        {"backend", required_argument, 0, OPT_BACKEND},
+        {"latency", required_argument, 0, OPT_LATENCY},
+        {"seed", required_argument, 0, OPT_SEED},
+        {"mpu-int", required_argument, 0, OPT_MPU_INT},
+        {"eject", required_argument, 0, OPT_EJECT},
+        {"imu", required_argument, 0, OPT_IMU},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case OPT_SD0: sd0 = optarg; break;
+            case OPT_SD1: sd1 = strcmp(optarg, "none") ? optarg : NULL; break;
+            case OPT_SIZE: sd_size = strtoull(optarg, NULL, 0) << 20; break;
+            case OPT_READ: timing.read_access_us = strtoul(optarg, NULL, 0); break;
+            case OPT_WRITE: timing.write_busy_us = strtoul(optarg, NULL, 0); break;
+            case OPT_OLED: oled = optarg; break;
+            case OPT_RT: realtime = 1; break;
+            case OPT_FAST: realtime = 0; break;
+            case OPT_LINGER: sim_linger_ms = (uint32_t)(strtod(optarg, NULL) * 1000); break;
+            case OPT_BACKEND: backend = optarg; break;
+            case OPT_LATENCY:
+                latency = ram_disk_find_latency(optarg);
+                if (!latency) {
+                    fprintf(stderr, "unknown latency preset: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case OPT_SEED: seed = strtoul(optarg, NULL, 0); break;
+            case OPT_MPU_INT: mpu_int = atoi(optarg); break;
+            case OPT_EJECT: {
+                char *end;
+                eject_at = strtod(optarg, &end);
+                if (*end == ':')
+                    eject_len = strtod(end + 1, NULL);
+                break;
+            }
+            case OPT_IMU:
+                if (n_imus == MAX_EXTRA_IMUS || !parse_imu(optarg, &imus[n_imus])) {
+                    fprintf(stderr, "bad or too many --imu: %s\n", optarg);
+                    return 2;
+                }
+                n_imus++;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    sim_realtime = realtime < 0 ? isatty(STDIN_FILENO) : realtime;
+
+    mpu6050_model_create(i2c0, 0x68, mpu_int);
+    ssd1306_model_create(i2c1, 0x3C, oled);
+    i2c_mux_model_t *muxes[2] = {NULL, NULL};
+    for (int i = 0; i < n_imus; i++) {
+        i2c_inst_t *i2c = imus[i].bus ? i2c1 : i2c0;
+        mpu6050_model_t *m = mpu6050_model_create(imus[i].channel < 0 ? i2c : NULL, imus[i].addr, -1);
+        mpu6050_model_set_clock_ppm(m, imus[i].ppm);
+        if (imus[i].channel >= 0) {
+            if (!muxes[imus[i].bus])
+                muxes[imus[i].bus] = i2c_mux_model_create(i2c, 0x70);
+            sim_i2c_device_t dev = mpu6050_model_device(m);
+            i2c_mux_model_attach(muxes[imus[i].bus], (uint)imus[i].channel, &dev);
+        }
+    }
+
+    bool spi = !strcmp(backend, "spi"), ram = !strcmp(backend, "ram");
+    if (!spi && !ram && strcmp(backend, "image")) {
+        fprintf(stderr, "unknown backend: %s\n", backend);
+        return 2;
+    }
+    if (!spi && eject_at >= 0)
+        fprintf(stderr, "[sim] --eject needs the spi backend; ignored\n");
+    const char *paths[2] = {sd0, sd1};
+    static spi_inst_t *const buses[2] = {spi0, spi1};
+    static const uint cs_gpios[2] = {17, 9};
+    for (int i = 0; i < 2; i++) {
+        if (!paths[i])
+            continue;
+        uint64_t sectors;
+        uint8_t *mem = disk_image_map(ram ? NULL : paths[i], sd_size, &sectors);
+        if (!mem)
+            return 1;
+        if (spi) {
+            sd_card_model_t *card = sd_card_model_create(buses[i], cs_gpios[i], mem, sectors);
+            sd_card_model_set_timing(card, &timing);
+            if (i == 0 && eject_at >= 0)
+                sd_card_model_set_outage(card, (uint64_t)(eject_at * 1e9), (uint64_t)(eject_len * 1e9));
+        } else {
+            ram_disks[i] = (ram_disk_t){.mem = mem, .sectors = sectors, .latency = *latency,
+                                        .seed = seed + i};
+            ram_disk_attach(sd_get_by_num(i), &ram_disks[i]);
+        }
+    }
+    atexit(print_disk_stats);
+    fprintf(stderr, "[sim] %s clock, %s backend, SD0=%s SD1=%s%s%s\n",
+            sim_realtime ? "real-time" : "fast", backend, ram ? "(RAM)" : sd0,
+            !sd1 ? "(none)" : ram ? "(RAM)" : sd1, oled ? " OLED=" : "", oled ? oled : "");
+    return firmware_main();
+}
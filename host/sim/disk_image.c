@@ -0,0 +1,43 @@
+/* disk_image.c: raw disk images mapped into memory (see disk_image.h) */
+
+#include "disk_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint8_t *disk_image_map(const char *path, uint64_t size_bytes, uint64_t *sectors_out) {
+    int fd = -1;
+    uint64_t size = size_bytes;
+    if (path) {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            perror(path);
+            if (fd >= 0) close(fd);
+            return NULL;
+        }
+        if (st.st_size == 0 && ftruncate(fd, (off_t)size_bytes) != 0) {
+            perror(path);
+            close(fd);
+            return NULL;
+        }
+        if (st.st_size) size = (uint64_t)st.st_size;
+    }
+    uint64_t sectors = size / 512 / 1024 * 1024;
+    if (!sectors) {
+        fprintf(stderr, "%s: image smaller than 512 KiB\n", path ? path : "RAM disk");
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    void *mem = mmap(NULL, sectors * 512, PROT_READ | PROT_WRITE,
+                     path ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS, fd, 0);
+    if (fd >= 0) close(fd);  // The mapping keeps the file open
+    if (mem == MAP_FAILED) {
+        perror(path ? path : "mmap");
+        return NULL;
+    }
+    *sectors_out = sectors;
+    return mem;
+}
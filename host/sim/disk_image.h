@@ -0,0 +1,16 @@
+/* disk_image.h: raw disk images mapped into memory
+ *
+ * Backing store for the simulated SD cards (sd_card_model.c) and for the
+ * FatFs_SPI RAM disk (ram_disk.c). Writes go straight to the file through
+ * the shared mapping, so the image can be inspected or loop-mounted on the
+ * host afterwards.
+ */
+#pragma once
+
+#include "sim.h"
+
+// Maps path, creating it sparse with size_bytes if it doesn't exist (an
+// existing image keeps its size). path NULL: anonymous memory, lost at exit.
+// The sector count is rounded down to a multiple of 1024 (512 KiB), the
+// SDHC capacity unit. Returns NULL on error.
+uint8_t *disk_image_map(const char *path, uint64_t size_bytes, uint64_t *sectors_out);
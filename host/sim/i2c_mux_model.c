@@ -0,0 +1,78 @@
+/* i2c_mux_model.c: simulated TCA9548A (see i2c_mux_model.h) */
+
+#include "i2c_mux_model.h"
+
+#define MAX_CHILDREN 16
+
+typedef struct {
+    i2c_mux_model_t *mux;
+    uint8_t addr;
+} stand_in_t;
+
+typedef struct {
+    uint channel;
+    sim_i2c_device_t dev;
+} child_t;
+
+struct i2c_mux_model {
+    i2c_inst_t *i2c;
+    uint8_t control;
+    child_t children[MAX_CHILDREN];
+    size_t n_children;
+    stand_in_t stand_ins[MAX_CHILDREN];
+    size_t n_stand_ins;
+};
+
+static bool control_write(void *ctx, const uint8_t *src, size_t len) {
+    i2c_mux_model_t *m = ctx;
+    if (len)
+        m->control = src[len - 1];
+    return true;
+}
+
+static bool control_read(void *ctx, uint8_t *dst, size_t len) {
+    i2c_mux_model_t *m = ctx;
+    for (size_t i = 0; i < len; i++)
+        dst[i] = m->control;
+    return true;
+}
+
+// First device at addr on an enabled channel
+static const sim_i2c_device_t *route(const stand_in_t *s) {
+    const i2c_mux_model_t *m = s->mux;
+    for (size_t i = 0; i < m->n_children; i++) {
+        const child_t *c = &m->children[i];
+        if (c->dev.addr == s->addr && (m->control >> c->channel & 1))
+            return &c->dev;
+    }
+    return NULL;
+}
+
+static bool stand_in_write(void *ctx, const uint8_t *src, size_t len) {
+    const sim_i2c_device_t *dev = route(ctx);
+    return dev && dev->write(dev->ctx, src, len);
+}
+
+static bool stand_in_read(void *ctx, uint8_t *dst, size_t len) {
+    const sim_i2c_device_t *dev = route(ctx);
+    return dev && dev->read(dev->ctx, dst, len);
+}
+
+i2c_mux_model_t *i2c_mux_model_create(i2c_inst_t *i2c, uint8_t addr) {
+    i2c_mux_model_t *m = calloc(1, sizeof *m);
+    m->i2c = i2c;
+    sim_i2c_attach(i2c, &(sim_i2c_device_t){addr, control_write, control_read, m});
+    return m;
+}
+
+void i2c_mux_model_attach(i2c_mux_model_t *m, uint channel, const sim_i2c_device_t *dev) {
+    if (m->n_children == MAX_CHILDREN || channel > 7)
+        return;
+    m->children[m->n_children++] = (child_t){channel, *dev};
+    for (size_t i = 0; i < m->n_stand_ins; i++)
+        if (m->stand_ins[i].addr == dev->addr)
+            return;
+    stand_in_t *s = &m->stand_ins[m->n_stand_ins++];
+    *s = (stand_in_t){m, dev->addr};
+    sim_i2c_attach(m->i2c, &(sim_i2c_device_t){dev->addr, stand_in_write, stand_in_read, s});
+}
@@ -0,0 +1,17 @@
+/* i2c_mux_model.h: simulated TCA9548A 8-channel I2C switch
+ *
+ * The control register (one byte, one bit per channel) is written and read
+ * at the switch's own address. Devices behind it are reached through a
+ * stand-in attached to the parent bus for each downstream address, which
+ * forwards to the device on an enabled channel or NACKs. A device wired
+ * directly to the parent bus at the same address shadows the channels (on
+ * real hardware the two would collide).
+ */
+#pragma once
+
+#include "sim.h"
+
+typedef struct i2c_mux_model i2c_mux_model_t;
+
+i2c_mux_model_t *i2c_mux_model_create(i2c_inst_t *i2c, uint8_t addr);
+void i2c_mux_model_attach(i2c_mux_model_t *mux, uint channel, const sim_i2c_device_t *dev);
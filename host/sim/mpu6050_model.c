@@ -0,0 +1,265 @@
+/* mpu6050_model.c: simulated MPU6050 (see mpu6050_model.h) */
+
+#include "mpu6050_model.h"
+
+#include <math.h>
+#include <string.h>
+
+#define REG_SMPLRT_DIV 0x19
+#define REG_CONFIG 0x1A
+#define REG_GYRO_CONFIG 0x1B
+#define REG_ACCEL_CONFIG 0x1C
+#define REG_FIFO_EN 0x23
+#define REG_INT_PIN_CFG 0x37
+#define REG_INT_ENABLE 0x38
+#define REG_INT_STATUS 0x3A
+#define REG_ACCEL_XOUT_H 0x3B
+#define REG_USER_CTRL 0x6A
+#define REG_PWR_MGMT_1 0x6B
+#define REG_FIFO_COUNTH 0x72
+#define REG_FIFO_COUNTL 0x73
+#define REG_FIFO_R_W 0x74
+#define REG_WHO_AM_I 0x75
+
+#define FIFO_SIZE 1024
+#define INT_DATA_RDY 0x01
+#define INT_FIFO_OFLOW 0x10
+
+struct mpu6050_model {
+    pthread_mutex_t mutex;
+    uint8_t regs[128];
+    uint8_t ptr;
+    uint8_t addr;
+    int int_gpio;
+    bool int_asserted;
+    double clock_scale;  // Actual/nominal sample period
+    uint64_t next_sample_ns;
+    uint64_t samples;
+    uint32_t rng;
+    uint8_t fifo[FIFO_SIZE];
+    uint fifo_r, fifo_used;
+};
+
+static void reset_regs(mpu6050_model_t *m) {
+    memset(m->regs, 0, sizeof m->regs);
+    m->regs[REG_PWR_MGMT_1] = 0x40;  // SLEEP
+    m->regs[REG_WHO_AM_I] = 0x68;
+    m->fifo_r = m->fifo_used = 0;
+}
+
+// Approximately normal noise from a sum of uniforms
+static float noise(mpu6050_model_t *m, float sigma) {
+    float s = 0;
+    for (int i = 0; i < 4; i++) {
+        m->rng ^= m->rng << 13;
+        m->rng ^= m->rng >> 17;
+        m->rng ^= m->rng << 5;
+        s += (m->rng & 0xFFFF) / 65535.0f - 0.5f;
+    }
+    return s * sigma * 1.732f;
+}
+
+static int16_t clamp16(float v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)lrintf(v);
+}
+
+static uint64_t sample_period_ns(const mpu6050_model_t *m) {
+    uint dlpf = m->regs[REG_CONFIG] & 7;
+    uint64_t gyro_rate = (dlpf == 0 || dlpf == 7) ? 8000 : 1000;
+    return (uint64_t)(1e9 * (1 + m->regs[REG_SMPLRT_DIV]) / gyro_rate * m->clock_scale);
+}
+
+static void fifo_push(mpu6050_model_t *m, const uint8_t *src, uint len) {
+    for (uint i = 0; i < len; i++) {
+        if (m->fifo_used == FIFO_SIZE) {
+            // Oldest byte is overwritten
+            m->fifo_r = (m->fifo_r + 1) % FIFO_SIZE;
+            m->fifo_used--;
+            m->regs[REG_INT_STATUS] |= INT_FIFO_OFLOW;
+        }
+        m->fifo[(m->fifo_r + m->fifo_used) % FIFO_SIZE] = src[i];
+        m->fifo_used++;
+    }
+}
+
+static void put_be16(uint8_t *p, int16_t v) {
+    p[0] = (uint8_t)((uint16_t)v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void generate_sample(mpu6050_model_t *m, uint64_t t_ns) {
+    const float two_pi = 6.2831853f;
+    float t = t_ns / 1e9f;
+    float accel_lsb = 16384.0f / (1 << ((m->regs[REG_ACCEL_CONFIG] >> 3) & 3));
+    float gyro_lsb = 131.0f / (1 << ((m->regs[REG_GYRO_CONFIG] >> 3) & 3));
+
+    float accel[3] = {0.05f * sinf(two_pi * 5 * t) + noise(m, 0.004f), noise(m, 0.004f),
+                      1.0f + noise(m, 0.004f)};
+    float gyro[3] = {0.5f + noise(m, 0.05f), -0.3f + noise(m, 0.05f),
+                     10.0f * sinf(two_pi * t) + noise(m, 0.05f)};
+    float temp_c = 25.0f + noise(m, 0.05f);
+
+    uint8_t *d = &m->regs[REG_ACCEL_XOUT_H];
+    for (int i = 0; i < 3; i++) {
+        put_be16(d + 2 * i, clamp16(accel[i] * accel_lsb));
+        put_be16(d + 8 + 2 * i, clamp16(gyro[i] * gyro_lsb));
+    }
+    put_be16(d + 6, clamp16((temp_c - 36.53f) * 340.0f));
+    m->samples++;
+
+    if (m->regs[REG_USER_CTRL] & 0x40) {
+        uint8_t en = m->regs[REG_FIFO_EN];
+        if (en & 0x08) fifo_push(m, d, 6);        // ACCEL
+        if (en & 0x80) fifo_push(m, d + 6, 2);    // TEMP
+        if (en & 0x40) fifo_push(m, d + 8, 2);    // XG
+        if (en & 0x20) fifo_push(m, d + 10, 2);   // YG
+        if (en & 0x10) fifo_push(m, d + 12, 2);   // ZG
+    }
+    m->regs[REG_INT_STATUS] |= INT_DATA_RDY;
+}
+
+static void drive_int(mpu6050_model_t *m, bool active) {
+    bool active_low = m->regs[REG_INT_PIN_CFG] & 0x80;
+    sim_gpio_drive(m->int_gpio, active != active_low);
+}
+
+// Catch up with the sample clock. Returns true if INT should pulse or assert.
+static bool update(mpu6050_model_t *m) {
+    uint64_t now = sim_time_ns();
+    if (m->regs[REG_PWR_MGMT_1] & 0x40) {
+        m->next_sample_ns = now;
+        return false;
+    }
+    if (now < m->next_sample_ns)
+        return false;
+    uint64_t period = sample_period_ns(m);
+    uint64_t due = (now - m->next_sample_ns) / period + 1;
+    // Only the last FIFO_SIZE bytes worth of samples can matter
+    uint64_t skip = due > FIFO_SIZE ? due - FIFO_SIZE : 0;
+    m->samples += skip;
+    for (uint64_t i = skip; i < due; i++)
+        generate_sample(m, m->next_sample_ns + i * period);
+    m->next_sample_ns += due * period;
+    return (m->regs[REG_INT_STATUS] & m->regs[REG_INT_ENABLE]) != 0;
+}
+
+static void poll_int(void *ctx) {
+    mpu6050_model_t *m = ctx;
+    pthread_mutex_lock(&m->mutex);
+    bool fire = update(m);
+    bool latch = m->regs[REG_INT_PIN_CFG] & 0x20;
+    bool pulse = fire && !latch;
+    bool assert_now = fire && latch && !m->int_asserted;
+    if (assert_now) m->int_asserted = true;
+    pthread_mutex_unlock(&m->mutex);
+    // Outside the model lock: the firmware's IRQ callback may read the chip
+    if (pulse) {
+        drive_int(m, true);
+        drive_int(m, false);
+    } else if (assert_now) {
+        drive_int(m, true);
+    }
+}
+
+static void clear_int(mpu6050_model_t *m, bool *deassert) {
+    m->regs[REG_INT_STATUS] = 0;
+    if (m->int_asserted) {
+        m->int_asserted = false;
+        *deassert = true;
+    }
+}
+
+static bool mpu_write(void *ctx, const uint8_t *src, size_t len) {
+    mpu6050_model_t *m = ctx;
+    if (!len) return true;
+    pthread_mutex_lock(&m->mutex);
+    update(m);
+    m->ptr = src[0] & 0x7F;
+    for (size_t i = 1; i < len; i++) {
+        uint8_t reg = m->ptr, v = src[i];
+        if (reg == REG_PWR_MGMT_1 && (v & 0x80)) {
+            reset_regs(m);
+        } else if (reg == REG_USER_CTRL) {
+            if (v & 0x04) m->fifo_r = m->fifo_used = 0;  // FIFO_RESET
+            m->regs[reg] = v & ~0x07;
+        } else if (reg == REG_FIFO_R_W) {
+            fifo_push(m, &v, 1);
+        } else if (reg != REG_WHO_AM_I && reg != REG_INT_STATUS &&
+                   (reg < REG_ACCEL_XOUT_H || reg > REG_ACCEL_XOUT_H + 13)) {
+            m->regs[reg] = v;
+        }
+        if (reg == REG_PWR_MGMT_1 && !(m->regs[reg] & 0x40))
+            m->next_sample_ns = sim_time_ns() + sample_period_ns(m);
+        if (reg != REG_FIFO_R_W) m->ptr = (m->ptr + 1) & 0x7F;
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return true;
+}
+
+static bool mpu_read(void *ctx, uint8_t *dst, size_t len) {
+    mpu6050_model_t *m = ctx;
+    bool deassert = false;
+    pthread_mutex_lock(&m->mutex);
+    update(m);
+    for (size_t i = 0; i < len; i++) {
+        uint8_t reg = m->ptr;
+        if (reg == REG_FIFO_R_W) {
+            if (m->fifo_used) {
+                dst[i] = m->fifo[m->fifo_r];
+                m->fifo_r = (m->fifo_r + 1) % FIFO_SIZE;
+                m->fifo_used--;
+            } else {
+                dst[i] = 0xFF;
+            }
+            continue;  // The pointer stays on FIFO_R_W
+        }
+        if (reg == REG_FIFO_COUNTH)
+            dst[i] = (uint8_t)(m->fifo_used >> 8);
+        else if (reg == REG_FIFO_COUNTL)
+            dst[i] = (uint8_t)m->fifo_used;
+        else
+            dst[i] = m->regs[reg];
+        if (reg == REG_INT_STATUS || (m->regs[REG_INT_PIN_CFG] & 0x10))
+            clear_int(m, &deassert);
+        m->ptr = (m->ptr + 1) & 0x7F;
+    }
+    pthread_mutex_unlock(&m->mutex);
+    if (deassert)
+        drive_int(m, false);
+    return true;
+}
+
+mpu6050_model_t *mpu6050_model_create(i2c_inst_t *i2c, uint8_t addr, int int_gpio) {
+    mpu6050_model_t *m = calloc(1, sizeof *m);
+    pthread_mutex_init(&m->mutex, NULL);
+    reset_regs(m);
+    m->addr = addr;
+    m->int_gpio = int_gpio;
+    m->clock_scale = 1.0;
+    // Same noise run to run, different for every part
+    static uint32_t created;
+    m->rng = 0x12345678u ^ addr ^ (created++ << 8);
+    if (i2c)
+        sim_i2c_attach(i2c, &(sim_i2c_device_t){addr, mpu_write, mpu_read, m});
+    if (int_gpio >= 0) {
+        drive_int(m, false);
+        sim_add_poll(poll_int, m);
+    }
+    return m;
+}
+
+uint64_t mpu6050_model_samples(const mpu6050_model_t *m) {
+    return m->samples;
+}
+
+void mpu6050_model_set_clock_ppm(mpu6050_model_t *m, double ppm) {
+    pthread_mutex_lock(&m->mutex);
+    m->clock_scale = 1.0 + ppm * 1e-6;
+    pthread_mutex_unlock(&m->mutex);
+}
+
+sim_i2c_device_t mpu6050_model_device(mpu6050_model_t *m) {
+    return (sim_i2c_device_t){m->addr, mpu_write, mpu_read, m};
+}
@@ -0,0 +1,23 @@
+/* mpu6050_model.h: simulated MPU6050 on an I2C bus
+ *
+ * Register-level model: WHO_AM_I, power management, full-scale ranges,
+ * sample-rate divider, DLPF rate, data registers, FIFO (1024 bytes, with
+ * overflow) and the INT pin (DATA_RDY / FIFO_OFLOW, active level, latch and
+ * read-clear). Samples follow a fixed motion: gravity on Z, a 5 Hz 0.05 g
+ * vibration on X and a 1 Hz 10 deg/s swing about Z, plus noise.
+ *
+ * The sample clock can run off by a few ppm, as two real parts do against
+ * each other. With i2c NULL the model is not attached to a bus; hand
+ * mpu6050_model_device() to whatever it sits behind (an I2C switch).
+ */
+#pragma once
+
+#include "sim.h"
+
+typedef struct mpu6050_model mpu6050_model_t;
+
+// int_gpio < 0: INT not wired
+mpu6050_model_t *mpu6050_model_create(i2c_inst_t *i2c, uint8_t addr, int int_gpio);
+uint64_t mpu6050_model_samples(const mpu6050_model_t *m);
+void mpu6050_model_set_clock_ppm(mpu6050_model_t *m, double ppm);
+sim_i2c_device_t mpu6050_model_device(mpu6050_model_t *m);
@@ -0,0 +1,326 @@
+/* sd_card_model.c: simulated SDHC card (see sd_card_model.h) */
+
+#include "sd_card_model.h"
+
+#include <string.h>
+
+#include "crc.h"
+
+#define BLOCK 512
+#define R1_IDLE 0x01
+#define R1_ILLEGAL 0x04
+#define R1_COM_CRC 0x08
+#define R1_ADDRESS 0x20
+
+typedef enum {
+    ST_CMD,         // Waiting for / collecting a command
+    ST_READ,        // Streaming blocks (CMD17/18)
+    ST_WRITE_TOKEN, // CMD24/25: waiting for a start token
+    ST_WRITE_DATA,  // Receiving block + CRC
+} state_t;
+
+struct sd_card_model {
+    pthread_mutex_t mutex;
+    uint8_t *mem;
+    uint64_t sectors;
+    sd_card_timing_t timing;
+
+    state_t state;
+    bool idle, app_cmd, crc_on;
+    int acmd41_count;
+    uint8_t cmd[6];
+    int cmd_len;
+    uint32_t sector;
+    bool multi;
+    uint64_t busy_until_ns;   // MISO held low while programming
+    uint64_t ready_at_ns;     // Read access time before the start token
+    uint64_t out_from_ns, out_until_ns;  // Outage window
+    bool pulled;
+
+    uint8_t out[BLOCK + 8];   // Bytes queued for MISO
+    int out_len, out_pos;
+    uint8_t in[BLOCK + 2];    // Block being written
+    int in_len;
+};
+
+static void queue_out(sd_card_model_t *c, const uint8_t *src, int len) {
+    if (c->out_pos == c->out_len)
+        c->out_pos = c->out_len = 0;
+    memcpy(c->out + c->out_len, src, len);
+    c->out_len += len;
+}
+
+static void queue_data_block(sd_card_model_t *c, const uint8_t *data, int len) {
+    uint16_t crc = crc16((const char *)data, len);
+    uint8_t tok = 0xFE, crc_be[2] = {crc >> 8, crc & 0xFF};
+    queue_out(c, &tok, 1);
+    queue_out(c, data, len);
+    queue_out(c, crc_be, 2);
+}
+
+static void build_csd(const sd_card_model_t *c, uint8_t csd[16]) {
+    uint32_t c_size = (uint32_t)(c->sectors / 1024 - 1);
+    const uint8_t v2[16] = {0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59, 0x00, (c_size >> 16) & 0x3F,
+                            (c_size >> 8) & 0xFF, c_size & 0xFF, 0x7F, 0x80, 0x0A, 0x40, 0x00, 0};
+    memcpy(csd, v2, 16);
+    csd[15] = (uint8_t)((crc7((const char *)csd, 15) << 1) | 1);
+}
+
+static void build_cid(uint8_t cid[16]) {
+    const uint8_t id[16] = {0x03, 'S', 'D', 'S', 'I', 'M', 'S', 'D', 0x10,
+                            0x12, 0x34, 0x56, 0x78, 0x01, 0x9A, 0};
+    memcpy(cid, id, 16);
+    cid[15] = (uint8_t)((crc7((const char *)cid, 15) << 1) | 1);
+}
+
+static void respond(sd_card_model_t *c, uint8_t r1) {
+    uint8_t ncr_r1[2] = {0xFF, (uint8_t)(r1 | (c->idle ? R1_IDLE : 0))};
+    queue_out(c, ncr_r1, 2);
+}
+
+static void execute(sd_card_model_t *c) {
+    uint8_t index = c->cmd[0] & 0x3F;
+    uint32_t arg = (uint32_t)c->cmd[1] << 24 | c->cmd[2] << 16 | c->cmd[3] << 8 | c->cmd[4];
+    bool app = c->app_cmd;
+    c->app_cmd = false;
+
+    // CMD0 and CMD8 always carry a valid CRC; the rest only while CRC is on
+    if ((c->crc_on || index == 0 || index == 8) &&
+        (uint8_t)((crc7((const char *)c->cmd, 5) << 1) | 1) != c->cmd[5]) {
+        respond(c, R1_COM_CRC);
+        return;
+    }
+    if (index == 12) {
+        // Stuff byte, then R1 (no Ncr gap: the stuff byte is the gap)
+        c->out_pos = c->out_len = 0;
+        c->state = ST_CMD;
+        uint8_t r[2] = {0xFF, 0x00};
+        queue_out(c, r, 2);
+        return;
+    }
+    c->out_pos = c->out_len = 0;
+    c->state = ST_CMD;
+
+    if (app) {
+        switch (index) {
+            case 41:
+                // Stays idle for a couple of polls, like a real card
+                if (++c->acmd41_count >= 3) c->idle = false;
+                respond(c, 0);
+                return;
+            case 23:
+                respond(c, 0);
+                return;
+        }
+    }
+    switch (index) {
+        case 0:
+            c->idle = true;
+            c->crc_on = false;
+            c->acmd41_count = 0;
+            respond(c, 0);
+            break;
+        case 8: {
+            respond(c, 0);
+            uint8_t r7[4] = {0x00, 0x00, (arg >> 8) & 0x0F, arg & 0xFF};
+            queue_out(c, r7, 4);
+            break;
+        }
+        case 9:
+        case 10: {
+            uint8_t reg[16];
+            if (index == 9) build_csd(c, reg);
+            else build_cid(reg);
+            respond(c, 0);
+            uint8_t gap = 0xFF;
+            queue_out(c, &gap, 1);
+            queue_data_block(c, reg, 16);
+            break;
+        }
+        case 13: {
+            respond(c, 0);
+            uint8_t r2 = 0x00;
+            queue_out(c, &r2, 1);
+            break;
+        }
+        case 16:
+            respond(c, arg == BLOCK ? 0 : 0x40);
+            break;
+        case 17:
+        case 18:
+        case 24:
+        case 25:
+            if (c->idle) {
+                respond(c, R1_ILLEGAL);
+                break;
+            }
+            if (arg >= c->sectors) {
+                respond(c, R1_ADDRESS);
+                break;
+            }
+            respond(c, 0);
+            c->sector = arg;
+            c->multi = index == 18 || index == 25;
+            if (index == 17 || index == 18) {
+                c->state = ST_READ;
+                c->ready_at_ns = sim_time_ns() + c->timing.read_access_us * 1000ull;
+            } else {
+                c->state = ST_WRITE_TOKEN;
+            }
+            break;
+        case 55:
+            c->app_cmd = true;
+            respond(c, 0);
+            break;
+        case 58: {
+            respond(c, 0);
+            // Power-up done and CCS (high capacity) only once initialised
+            uint8_t ocr[4] = {c->idle ? 0x00 : 0xC0, 0xFF, 0x80, 0x00};
+            queue_out(c, ocr, 4);
+            break;
+        }
+        case 59:
+            c->crc_on = arg & 1;
+            respond(c, 0);
+            break;
+        default:
+            respond(c, R1_ILLEGAL);
+            break;
+    }
+}
+
+static uint8_t next_miso(sd_card_model_t *c) {
+    if (c->out_pos < c->out_len)
+        return c->out[c->out_pos++];
+    uint64_t now = sim_time_ns();
+    if (c->state == ST_READ) {
+        if (now < c->ready_at_ns)
+            return 0xFF;
+        if (c->sector >= c->sectors) {
+            c->state = ST_CMD;  // Out of range: stop streaming
+            return 0xFF;
+        }
+        queue_data_block(c, c->mem + (uint64_t)c->sector++ * BLOCK, BLOCK);
+        if (!c->multi)
+            c->state = ST_CMD;
+        return c->out[c->out_pos++];
+    }
+    if (now < c->busy_until_ns)
+        return 0x00;
+    return 0xFF;
+}
+
+static void take_mosi(sd_card_model_t *c, uint8_t b) {
+    switch (c->state) {
+        case ST_WRITE_TOKEN:
+            if (sim_time_ns() < c->busy_until_ns)
+                return;  // Tokens are ignored while busy
+            if (b == 0xFE || (c->multi && b == 0xFC)) {
+                c->state = ST_WRITE_DATA;
+                c->in_len = 0;
+            } else if (c->multi && b == 0xFD) {
+                c->state = ST_CMD;
+                c->busy_until_ns = sim_time_ns() + c->timing.write_busy_us * 1000ull / 4;
+            }
+            return;
+        case ST_WRITE_DATA: {
+            c->in[c->in_len++] = b;
+            if (c->in_len < BLOCK + 2)
+                return;
+            uint16_t crc = (uint16_t)(c->in[BLOCK] << 8 | c->in[BLOCK + 1]);
+            uint8_t resp;
+            if (c->crc_on && crc16((const char *)c->in, BLOCK) != crc) {
+                resp = 0x0B;  // CRC error: block discarded
+            } else {
+                resp = 0x05;
+                memcpy(c->mem + (uint64_t)c->sector++ * BLOCK, c->in, BLOCK);
+            }
+            queue_out(c, &resp, 1);
+            c->busy_until_ns = sim_time_ns() + c->timing.write_busy_us * 1000ull;
+            c->state = (c->multi && resp == 0x05 && c->sector < c->sectors) ? ST_WRITE_TOKEN
+                                                                             : ST_CMD;
+            return;
+        }
+        case ST_CMD:
+        case ST_READ:
+            // Commands are recognised on MOSI even while a read streams out
+            if (c->cmd_len == 0 && (b & 0xC0) != 0x40)
+                return;
+            c->cmd[c->cmd_len++] = b;
+            if (c->cmd_len == 6) {
+                c->cmd_len = 0;
+                execute(c);
+            }
+            return;
+    }
+}
+
+// Out of the socket: nothing drives MISO. Reinserted: back to power-on.
+static bool card_absent(sd_card_model_t *c) {
+    uint64_t now = sim_time_ns();
+    if (now >= c->out_from_ns && now < c->out_until_ns) {
+        c->pulled = true;
+        return true;
+    }
+    if (c->pulled) {
+        c->pulled = false;
+        c->state = ST_CMD;
+        c->idle = true;
+        c->app_cmd = c->crc_on = false;
+        c->acmd41_count = c->cmd_len = c->in_len = 0;
+        c->out_len = c->out_pos = 0;
+        c->busy_until_ns = c->ready_at_ns = 0;
+    }
+    return false;
+}
+
+static uint8_t card_exchange(void *ctx, uint8_t mosi) {
+    sd_card_model_t *c = ctx;
+    pthread_mutex_lock(&c->mutex);
+    if (card_absent(c)) {
+        pthread_mutex_unlock(&c->mutex);
+        return 0xFF;
+    }
+    uint8_t miso = next_miso(c);
+    take_mosi(c, mosi);
+    pthread_mutex_unlock(&c->mutex);
+    return miso;
+}
+
+static void card_deselect(void *ctx) {
+    sd_card_model_t *c = ctx;
+    pthread_mutex_lock(&c->mutex);
+    // A partial command is dropped; data transfers survive CS toggling
+    c->cmd_len = 0;
+    pthread_mutex_unlock(&c->mutex);
+}
+
+sd_card_model_t *sd_card_model_create(spi_inst_t *spi, uint cs_gpio, uint8_t *mem,
+                                      uint64_t sectors) {
+    sd_card_model_t *c = calloc(1, sizeof *c);
+    pthread_mutex_init(&c->mutex, NULL);
+    c->mem = mem;
+    // The CSD counts capacity in 512 KiB units
+    c->sectors = sectors / 1024 * 1024;
+    c->timing = (sd_card_timing_t){.read_access_us = 100, .write_busy_us = 250};
+    c->idle = true;
+    sim_spi_attach(spi, &(sim_spi_device_t){cs_gpio, card_exchange, card_deselect, c});
+    return c;
+}
+
+void sd_card_model_set_timing(sd_card_model_t *card, const sd_card_timing_t *timing) {
+    pthread_mutex_lock(&card->mutex);
+    card->timing = *timing;
+    pthread_mutex_unlock(&card->mutex);
+}
+
+uint64_t sd_card_model_sectors(const sd_card_model_t *card) {
+    return card->sectors;
+}
+
+void sd_card_model_set_outage(sd_card_model_t *card, uint64_t at_ns, uint64_t len_ns) {
+    pthread_mutex_lock(&card->mutex);
+    card->out_from_ns = at_ns;
+    card->out_until_ns = at_ns + len_ns;
+    pthread_mutex_unlock(&card->mutex);
+}
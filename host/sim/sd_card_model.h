@@ -0,0 +1,34 @@
+/* sd_card_model.h: simulated SDHC card in SPI mode, backed by an image file
+ *
+ * Byte-level model of the SPI-mode protocol as FatFs_SPI's sd_card.c drives
+ * it: CMD0/8/55/ACMD41/58 initialisation, CMD59 CRC on/off (command CRC7 and
+ * data CRC16 are checked while it is on), CSD/CID reads, single and multiple
+ * block reads (CMD17/18 + CMD12) and writes (CMD24/25 with the 0xFE/0xFC/0xFD
+ * tokens and data response), CMD13 and ACMD23. After each written block the
+ * card holds MISO low for the programming time; reads wait for the access
+ * time before the start token.
+ *
+ * Storage is memory holding sectors * 512 bytes, normally a disk image
+ * mapped with disk_image_map().
+ *
+ * An outage window pulls the card out of the socket: MISO floats high, so
+ * commands get no response, and on the way back the card starts over from
+ * power-on (idle, CRC off) with its contents intact.
+ */
+#pragma once
+
+#include "sim.h"
+
+typedef struct sd_card_model sd_card_model_t;
+
+typedef struct {
+    uint32_t read_access_us;  // CMD17/18: command to first start token
+    uint32_t write_busy_us;   // Busy after each block is programmed
+} sd_card_timing_t;
+
+sd_card_model_t *sd_card_model_create(spi_inst_t *spi, uint cs_gpio, uint8_t *mem,
+                                      uint64_t sectors);
+void sd_card_model_set_timing(sd_card_model_t *card, const sd_card_timing_t *timing);
+uint64_t sd_card_model_sectors(const sd_card_model_t *card);
+// Card absent from at_ns to at_ns + len_ns of simulated time
+void sd_card_model_set_outage(sd_card_model_t *card, uint64_t at_ns, uint64_t len_ns);
@@ -0,0 +1,28 @@
+/* sim.c: poll hooks for time-driven device models */
+
+#include "sim.h"
+
+#define MAX_POLLS 8
+
+static struct {
+    void (*fn)(void *ctx);
+    void *ctx;
+} polls[MAX_POLLS];
+static int poll_count;
+
+void sim_add_poll(void (*fn)(void *ctx), void *ctx) {
+    if (poll_count < MAX_POLLS) {
+        polls[poll_count].fn = fn;
+        polls[poll_count].ctx = ctx;
+        poll_count++;
+    }
+}
+
+// Only core 0 polls: the firmware enables the GPIO IRQs there, and an
+// edge raised from core 1 would run the callback on core 1's clock
+void sim_poll(void) {
+    if (get_core_num() != 0)
+        return;
+    for (int i = 0; i < poll_count; i++)
+        polls[i].fn(polls[i].ctx);
+}
@@ -0,0 +1,77 @@
+/* sim.h
+ *
+ * Glue between the host HAL (host/hal) and the simulated devices
+ * (host/sim): bus attachment points, externally driven GPIO inputs and the
+ * simulated clock.
+ */
+#pragma once
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---- Clock ---------------------------------------------------------------
+ * Each thread ("core") runs its own clock: real elapsed time plus whatever
+ * was skipped by sleeps and charged for modelled bus traffic. Hand-offs
+ * between threads (mutexes, semaphores, queues, __sev/__wfe) carry the
+ * sender's time so the receiver never observes time going backwards.
+ * With sim_realtime set, sleeps and charges really wait instead.
+ */
+extern bool sim_realtime;
+// Once scripted (non-tty) input is exhausted, keep running this long in
+// simulated time before exiting, so captures started by the script finish
+extern uint32_t sim_linger_ms;
+
+uint64_t sim_time_ns(void);
+void sim_time_charge_ns(uint64_t ns);   // The caller was busy for ns
+void sim_time_sync_ns(uint64_t t_ns);   // Advance the caller's clock to t_ns
+void sim_time_inherit(int64_t offset_ns);  // New thread starts at its parent's offset
+int64_t sim_time_offset_ns(void);
+
+/* ---- Polled device models ------------------------------------------------
+ * Models whose state changes with time alone (sensor sample clock, INT
+ * line) register a poll hook; the HAL calls sim_poll() whenever firmware
+ * waits or looks at a GPIO.
+ */
+void sim_add_poll(void (*fn)(void *ctx), void *ctx);
+void sim_poll(void);
+
+/* ---- GPIO ---------------------------------------------------------------- */
+
+// Drive an input pin from outside (button, sensor INT). Edges fire the
+// firmware's GPIO IRQ callback in the calling thread.
+void sim_gpio_drive(uint gpio, bool level);
+void sim_gpio_release(uint gpio);  // Back to the pull-up/down level
+
+/* ---- I2C ----------------------------------------------------------------- */
+
+typedef struct {
+    uint8_t addr;
+    // One transaction: bytes between START (or repeated START) and STOP.
+    // Returning false NACKs the transfer.
+    bool (*write)(void *ctx, const uint8_t *src, size_t len);
+    bool (*read)(void *ctx, uint8_t *dst, size_t len);
+    void *ctx;
+} sim_i2c_device_t;
+
+void sim_i2c_attach(i2c_inst_t *i2c, const sim_i2c_device_t *dev);
+
+/* ---- SPI ----------------------------------------------------------------- */
+
+typedef struct {
+    uint cs_gpio;  // Active low
+    // Full-duplex byte exchange while selected
+    uint8_t (*exchange)(void *ctx, uint8_t mosi);
+    void (*deselect)(void *ctx);
+    void *ctx;
+} sim_spi_device_t;
+
+void sim_spi_attach(spi_inst_t *spi, const sim_spi_device_t *dev);
+// Called by the GPIO layer when a chip select pin goes high
+void sim_spi_cs_changed(uint gpio, bool level);
+
+#ifdef __cplusplus
+}
+#endif
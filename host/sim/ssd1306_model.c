@@ -0,0 +1,151 @@
+/* ssd1306_model.c: simulated SSD1306 (see ssd1306_model.h) */
+
+#include "ssd1306_model.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define COLS 128
+#define PAGES 8
+
+struct ssd1306_model {
+    pthread_mutex_t mutex;
+    uint8_t ram[PAGES][COLS];
+    uint8_t mem_mode;  // 0 horizontal, 1 vertical, 2 page
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    bool display_on;
+    uint8_t cmd[3];    // Command being assembled with its arguments
+    int cmd_len, cmd_need;
+    char *pbm_path;
+};
+
+static int args_of(uint8_t op) {
+    switch (op) {
+        case 0x21:
+        case 0x22:
+            return 2;
+        case 0x20:
+        case 0x81:
+        case 0x8D:
+        case 0xA8:
+        case 0xD3:
+        case 0xD5:
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void run_command(ssd1306_model_t *d) {
+    switch (d->cmd[0]) {
+        case 0x20:
+            d->mem_mode = d->cmd[1] & 3;
+            break;
+        case 0x21:
+            d->col_start = d->col = d->cmd[1] & 0x7F;
+            d->col_end = d->cmd[2] & 0x7F;
+            break;
+        case 0x22:
+            d->page_start = d->page = d->cmd[1] & 7;
+            d->page_end = d->cmd[2] & 7;
+            break;
+        case 0xAE:
+        case 0xAF:
+            d->display_on = d->cmd[0] & 1;
+            break;
+    }
+}
+
+static void command_byte(ssd1306_model_t *d, uint8_t b) {
+    if (d->cmd_len == 0)
+        d->cmd_need = 1 + args_of(b);
+    d->cmd[d->cmd_len++] = b;
+    if (d->cmd_len == d->cmd_need) {
+        run_command(d);
+        d->cmd_len = 0;
+    }
+}
+
+static void data_byte(ssd1306_model_t *d, uint8_t b) {
+    d->ram[d->page][d->col] = b;
+    if (d->mem_mode == 1) {  // Vertical: page first, then column
+        if (d->page++ >= d->page_end) {
+            d->page = d->page_start;
+            if (d->col++ >= d->col_end) d->col = d->col_start;
+        }
+    } else {                 // Horizontal (page mode wraps within the page)
+        if (d->col++ >= d->col_end) {
+            d->col = d->col_start;
+            if (d->mem_mode == 0 && d->page++ >= d->page_end) d->page = d->page_start;
+        }
+    }
+}
+
+static void write_pbm(ssd1306_model_t *d) {
+    char tmp[4096];
+    snprintf(tmp, sizeof tmp, "%s.tmp", d->pbm_path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f)
+        return;
+    fprintf(f, "P4\n%d %d\n", COLS, PAGES * 8);
+    for (int y = 0; y < PAGES * 8; y++) {
+        uint8_t row[COLS / 8] = {0};
+        for (int x = 0; x < COLS; x++)
+            if (d->display_on && (d->ram[y / 8][x] >> (y % 8) & 1))
+                row[x / 8] |= 0x80 >> (x % 8);
+        fwrite(row, 1, sizeof row, f);
+    }
+    fclose(f);
+    rename(tmp, d->pbm_path);  // Viewers never see a half-written frame
+}
+
+static bool oled_write(void *ctx, const uint8_t *src, size_t len) {
+    ssd1306_model_t *d = ctx;
+    pthread_mutex_lock(&d->mutex);
+    bool data = false;
+    // Co bit set: one byte follows, then another control byte
+    for (size_t i = 0; i < len;) {
+        uint8_t control = src[i++];
+        bool co = control & 0x80, dc = control & 0x40;
+        size_t n = co ? (i < len ? 1 : 0) : len - i;
+        for (size_t k = 0; k < n; k++, i++) {
+            if (dc) data_byte(d, src[i]);
+            else command_byte(d, src[i]);
+        }
+        data |= dc && n;
+    }
+    if (data && d->pbm_path)
+        write_pbm(d);
+    pthread_mutex_unlock(&d->mutex);
+    return true;
+}
+
+static bool oled_read(void *ctx, uint8_t *dst, size_t len) {
+    (void)ctx;
+    memset(dst, 0x00, len);  // Status byte: display on, not busy
+    return true;
+}
+
+ssd1306_model_t *ssd1306_model_create(i2c_inst_t *i2c, uint8_t addr, const char *pbm_path) {
+    ssd1306_model_t *d = calloc(1, sizeof *d);
+    pthread_mutex_init(&d->mutex, NULL);
+    d->col_end = COLS - 1;
+    d->page_end = PAGES - 1;
+    d->mem_mode = 2;
+    d->pbm_path = pbm_path ? strdup(pbm_path) : NULL;
+    sim_i2c_attach(i2c, &(sim_i2c_device_t){addr, oled_write, oled_read, d});
+    return d;
+}
+
+bool ssd1306_model_pixel(ssd1306_model_t *d, uint x, uint y) {
+    if (x >= COLS || y >= PAGES * 8)
+        return false;
+    pthread_mutex_lock(&d->mutex);
+    bool on = d->ram[y / 8][x] >> (y % 8) & 1;
+    pthread_mutex_unlock(&d->mutex);
+    return on;
+}
@@ -0,0 +1,17 @@
+/* ssd1306_model.h: simulated SSD1306 128x64 OLED on an I2C bus
+ *
+ * Parses the control byte (0x80/0x00 commands, 0x40 data), the addressing
+ * commands (memory mode, column and page ranges) and display on/off, and
+ * keeps the GDDRAM. If a PBM path is given, the frame is written there
+ * after every data transfer, so an image viewer that reloads on change
+ * shows the display live.
+ */
+#pragma once
+
+#include "sim.h"
+
+typedef struct ssd1306_model ssd1306_model_t;
+
+ssd1306_model_t *ssd1306_model_create(i2c_inst_t *i2c, uint8_t addr, const char *pbm_path);
+// Pixel as the firmware addresses it (x 0..127, y 0..63)
+bool ssd1306_model_pixel(ssd1306_model_t *d, uint x, uint y);
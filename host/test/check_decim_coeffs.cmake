@@ -0,0 +1,17 @@
+# Fails when lib/decim_coeffs.h is not what tools/gen_decim writes today.
+#
+#   cmake -DGEN_DECIM=<gen_decim> -DCOEFFS=<lib/decim_coeffs.h> -DSTAMP=<file> -P check_decim_coeffs.cmake
+#
+# Line endings are ignored (the checked-in file has CRLF).
+execute_process(COMMAND ${GEN_DECIM} OUTPUT_VARIABLE generated RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "gen_decim failed: ${result}")
+endif()
+file(READ ${COEFFS} checked_in)
+string(REPLACE "\r\n" "\n" checked_in "${checked_in}")
+string(REPLACE "\r\n" "\n" generated "${generated}")
+if(NOT checked_in STREQUAL generated)
+    message(FATAL_ERROR "${COEFFS} is stale; regenerate it with tools/gen_decim "
+            "(gen_decim > lib/decim_coeffs.h)")
+endif()
+file(TOUCH ${STAMP})
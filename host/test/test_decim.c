@@ -0,0 +1,184 @@
+/* test_decim.c (host build): lib/decim.c against a double-precision model
+ *
+ * For every supported ratio the integer stage is fed a mix of tones and
+ * noise on all six axes. Its output is compared with the same CIC + FIR
+ * evaluated in double (the CIC as N cascaded moving sums, the FIR with the
+ * coefficients of decim_coeffs.h scaled back to real numbers, no
+ * intermediate rounding). The only rounding left in lib/decim.c is the final
+ * shift, so the two must agree within REF_TOL_Q8 output counts.
+ *
+ * The filter itself is checked on single tones: DC and passband tones come
+ * out with the input amplitude within PASS_TOL_DB, tones that reach the FIR's
+ * stop band (and would alias into the output band) at least STOP_MIN_DB down.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decim.h"
+
+#define REF_TOL_Q8 0.51     // Final rounding (0.5) plus double noise
+#define PASS_TOL_DB 0.5
+#define STOP_MIN_DB 40.0
+#define N_IN 20000          // 20 s at DECIM_INPUT_HZ
+
+static const double q8 = 1 << DECIM_OUT_FRAC_BITS;
+static int failures;
+
+static void check(bool ok, const char *what, uint ratio, double got, double bound) {
+    if (!ok) {
+        printf("FAIL R=%u %s: %.4f (bound %.4f)\n", ratio, what, got, bound);
+        failures++;
+    }
+}
+
+// Deterministic noise, uniform in [-1, 1)
+static double noise(void) {
+    static uint32_t s = 12345;
+    s = s * 1664525u + 1013904223u;
+    return (double)(int32_t)s / 2147483648.0;
+}
+
+static int16_t to_counts(double v) {
+    long c = lround(v);
+    return (int16_t)(c > 32767 ? 32767 : c < -32768 ? -32768 : c);
+}
+
+// Runs the integer stage over in[n][DECIM_AXES]; returns the outputs
+static size_t run_decim(uint ratio, const int16_t (*in)[DECIM_AXES], size_t n,
+                        int32_t (*out)[DECIM_AXES]) {
+    decim_t d;
+    if (!decim_init(&d, ratio)) {
+        printf("FAIL R=%u not supported\n", ratio);
+        failures++;
+        return 0;
+    }
+    // Uneven blocks, as the capture hands them over
+    size_t produced = 0;
+    for (size_t i = 0, len = 1; i < n; i += len, len = len % 37 + 1) {
+        if (len > n - i) len = n - i;
+        produced += decim_process(&d, in + i, len, out + produced);
+    }
+    return produced;
+}
+
+// Reference for one axis: y[q], in Q8 counts, for the q-th output kept by
+// decim_process
+static void reference(const decim_config_t *c, const double *x, size_t n, double *y, size_t n_out,
+                      uint32_t warmup) {
+    // CIC: N moving sums of length Rc at the input rate, then keep every Rc-th
+    double *s = malloc(n * sizeof *s);
+    memcpy(s, x, n * sizeof *s);
+    for (int st = 0; st < DECIM_CIC_STAGES; st++) {
+        double acc = 0;
+        double *prev = malloc(n * sizeof *prev);
+        memcpy(prev, s, n * sizeof *prev);
+        for (size_t i = 0; i < n; i++) {
+            acc += prev[i];
+            if (i >= c->cic_ratio) acc -= prev[i - c->cic_ratio];
+            s[i] = acc;
+        }
+        free(prev);
+    }
+    size_t n_cic = n / c->cic_ratio;
+    double *cic = malloc(n_cic * sizeof *cic);
+    for (size_t m = 0; m < n_cic; m++) cic[m] = s[(m + 1) * c->cic_ratio - 1];
+
+    // FIR on every fir_ratio-th CIC output, newest sample first
+    const double scale = 1.0 / (double)(1LL << DECIM_ACC_SHIFT);
+    size_t q = 0;
+    for (size_t m = c->fir_ratio - 1; m < n_cic && q < n_out + warmup; m += c->fir_ratio, q++) {
+        if (q < warmup) continue;
+        double acc = 0;
+        for (int k = 0; k < c->taps && k <= (int)m; k++) acc += c->coef[k] * scale * cic[m - k];
+        y[q - warmup] = acc;
+    }
+    free(cic);
+    free(s);
+}
+
+static void test_reference(uint ratio) {
+    static int16_t in[N_IN][DECIM_AXES];
+    static int32_t out[N_IN][DECIM_AXES];
+    static double x[N_IN], y[N_IN];
+    // Axis a: a tone per axis plus noise, near full scale on the last axis
+    for (size_t i = 0; i < N_IN; i++)
+        for (int a = 0; a < DECIM_AXES; a++) {
+            double f = 3.0 + 11.0 * a;  // Hz; the upper axes land in the stopband
+            double amp = 1000.0 * (a + 1) + (a == DECIM_AXES - 1 ? 20000.0 : 0);
+            in[i][a] = to_counts(amp * sin(2 * M_PI * f * i / DECIM_INPUT_HZ) + 200 * a +
+                                 3000.0 * noise());
+        }
+    size_t n_out = run_decim(ratio, (const int16_t (*)[DECIM_AXES])in, N_IN, out);
+    check(n_out >= N_IN / ratio - DECIM_MAX_TAPS && n_out <= N_IN / ratio, "output count", ratio,
+          n_out, N_IN / ratio);
+
+    decim_t d;
+    decim_init(&d, ratio);
+    double max_err = 0;
+    for (int a = 0; a < DECIM_AXES; a++) {
+        for (size_t i = 0; i < N_IN; i++) x[i] = in[i][a];
+        reference(d.cfg, x, N_IN, y, n_out, d.warmup);
+        for (size_t q = 0; q < n_out; q++) max_err = fmax(max_err, fabs(out[q][a] - y[q]));
+    }
+    check(max_err <= REF_TOL_Q8, "max error vs double (Q8 counts)", ratio, max_err, REF_TOL_Q8);
+    printf("R=%-2u %zu outputs, max error vs double %.3f Q8 counts\n", ratio, n_out, max_err);
+}
+
+// Output/input amplitude of a tone at f_hz, in dB, from the settled outputs
+static double tone_gain_db(uint ratio, double f_hz) {
+    static int16_t in[N_IN][DECIM_AXES];
+    static int32_t out[N_IN][DECIM_AXES];
+    const double amp = 8000.0;
+    for (size_t i = 0; i < N_IN; i++)
+        for (int a = 0; a < DECIM_AXES; a++)
+            in[i][a] = to_counts(amp * cos(2 * M_PI * f_hz * i / DECIM_INPUT_HZ));
+    size_t n_out = run_decim(ratio, (const int16_t (*)[DECIM_AXES])in, N_IN, out);
+    // RMS over the outputs, skipping the first second
+    size_t skip = DECIM_INPUT_HZ / ratio;
+    double sum = 0;
+    for (size_t q = skip; q < n_out; q++) sum += (double)out[q][0] * out[q][0];
+    double rms = sqrt(sum / (n_out - skip)) / q8;
+    double rms_in = f_hz == 0 ? amp : amp / sqrt(2);
+    return 20 * log10(fmax(rms, 1e-9) / rms_in);
+}
+
+static void test_response(uint ratio) {
+    decim_t d;
+    decim_init(&d, ratio);
+    const decim_config_t *c = d.cfg;
+    // Band edges of tools/gen_decim, in Hz: pass/stop are in cycles/sample
+    // at the FIR input, which runs at DECIM_INPUT_HZ / Rc
+    const double fir_hz = (double)DECIM_INPUT_HZ / c->cic_ratio;
+    const double pass_hz = (ratio == 5 ? 0.30 : 0.20) * fir_hz;
+    const double stop_hz = (ratio == 5 ? 0.45 : 0.30) * fir_hz;
+    double worst_pass = 0, worst_stop = -1000;
+    for (double f = 0; f <= pass_hz; f += pass_hz / 8) {
+        double g = tone_gain_db(ratio, f);
+        if (fabs(g) > fabs(worst_pass)) worst_pass = g;
+    }
+    // Up to past the CIC's first null; the CIC nulls take care of the rest.
+    // Tones that the CIC folds into the FIR's transition band are skipped,
+    // the design leaves that band free.
+    for (double f = stop_hz; f < 1.5 * fir_hz; f += fir_hz / 40) {
+        double alias = fabs(f - fir_hz * round(f / fir_hz));
+        if (alias < stop_hz) continue;
+        double g = tone_gain_db(ratio, f);
+        if (g > worst_stop) worst_stop = g;
+    }
+    check(fabs(worst_pass) <= PASS_TOL_DB, "passband gain (dB)", ratio, worst_pass, PASS_TOL_DB);
+    check(worst_stop <= -STOP_MIN_DB, "stopband gain (dB)", ratio, worst_stop, -STOP_MIN_DB);
+    printf("R=%-2u passband %+.3f dB (0..%.0f Hz), stopband %.1f dB (from %.0f Hz)\n", ratio,
+           worst_pass, pass_hz, worst_stop, stop_hz);
+}
+
+int main(void) {
+    for (size_t i = 0; i < count_of(decim_configs); i++) {
+        test_reference(decim_configs[i].ratio);
+        test_response(decim_configs[i].ratio);
+    }
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/* test_fft.c (host build): lib/fft.c and lib/vib_spectrum.c against double
+ *
+ * fft_forward is fed tones and noise in Q15 and compared, bin by bin, with a
+ * direct DFT in double of the same input: the SNR of the fixed-point result
+ * must stay above FFT_MIN_SNR_DB and the strongest bins must be the same.
+ *
+ * The spectral summary goes through the capture path (vib_spectrum_add on
+ * core0, vib_compute on core1) with known tones plus noise, in counts. The
+ * time RMS and the band RMS are compared with the same Hann-windowed
+ * spectrum computed in double, within SUMMARY_TOL (plus BAND_FLOOR of the
+ * block RMS for bands down near the fixed-point noise floor). Each tone must
+ * come out as a peak within PEAK_HZ_TOL_BINS of its frequency and
+ * PEAK_AMP_TOL of its amplitude.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vib_spectrum.h"
+
+#define FFT_MIN_SNR_DB 50.0    // Block floating point in 16 bits, up to 1024 points
+#define SUMMARY_TOL 0.01        // Relative, RMS in time and per band
+#define BAND_FLOOR 2e-4         // Of the block RMS (-74 dB), for the quiet bands
+#define PEAK_HZ_TOL_BINS 0.1
+#define PEAK_AMP_TOL 0.03       // Relative
+
+static int failures;
+
+static void check(bool ok, const char *what, uint n, double got, double bound) {
+    if (!ok) {
+        printf("FAIL n=%u %s: %.4f (bound %.4f)\n", n, what, got, bound);
+        failures++;
+    }
+}
+
+// Deterministic noise, uniform in [-1, 1)
+static double noise(void) {
+    static uint32_t s = 12345;
+    s = s * 1664525u + 1013904223u;
+    return (double)(int32_t)s / 2147483648.0;
+}
+
+static void dft(const double *re_in, const double *im_in, double *re, double *im, uint n) {
+    for (uint k = 0; k < n; k++) {
+        double sr = 0, si = 0;
+        for (uint i = 0; i < n; i++) {
+            double a = -2 * M_PI * (double)((uint64_t)k * i % n) / n;
+            sr += re_in[i] * cos(a) - im_in[i] * sin(a);
+            si += re_in[i] * sin(a) + im_in[i] * cos(a);
+        }
+        re[k] = sr;
+        im[k] = si;
+    }
+}
+
+static uint argmax(const double *p, uint n) {
+    uint best = 0;
+    for (uint k = 1; k < n; k++)
+        if (p[k] > p[best]) best = k;
+    return best;
+}
+
+// A signal: tones at f (in bins) with amplitudes a, plus noise, real or complex
+typedef struct {
+    const char *name;
+    double f[2], a[2];
+    double noise;
+    bool complex_in;
+} fft_case_t;
+
+static void test_fft(uint n, const fft_case_t *c) {
+    fft_cpx_t *x = malloc(n * sizeof *x);
+    double *in_re = malloc(n * sizeof(double)), *in_im = malloc(n * sizeof(double));
+    double *re = malloc(n * sizeof(double)), *im = malloc(n * sizeof(double));
+    double *p_ref = malloc(n * sizeof(double)), *p_fix = malloc(n * sizeof(double));
+    for (uint i = 0; i < n; i++) {
+        double vr = 0, vi = 0;
+        for (int t = 0; t < 2; t++) {
+            vr += c->a[t] * cos(2 * M_PI * c->f[t] * i / n);
+            vi += c->complex_in ? c->a[t] * sin(2 * M_PI * c->f[t] * i / n) : 0;
+        }
+        vr += c->noise * noise();
+        vi += c->complex_in ? c->noise * noise() : 0;
+        x[i].re = (int16_t)lround(vr);
+        x[i].im = (int16_t)lround(vi);
+        in_re[i] = x[i].re;
+        in_im[i] = x[i].im;
+    }
+    dft(in_re, in_im, re, im, n);
+    int exp = fft_forward(x, n);
+
+    double sig = 0, err = 0;
+    for (uint k = 0; k < n; k++) {
+        double fr = ldexp(x[k].re, exp), fi = ldexp(x[k].im, exp);
+        sig += re[k] * re[k] + im[k] * im[k];
+        err += (fr - re[k]) * (fr - re[k]) + (fi - im[k]) * (fi - im[k]);
+        p_ref[k] = re[k] * re[k] + im[k] * im[k];
+        p_fix[k] = fr * fr + fi * fi;
+    }
+    double snr = err > 0 ? 10 * log10(sig / err) : 999.0;
+    // A real input has the same power at k and n - k
+    const uint bins = c->complex_in ? n : n / 2 + 1;
+    uint k_ref = argmax(p_ref, bins), k_fix = argmax(p_fix, bins);
+    check(snr >= FFT_MIN_SNR_DB, c->name, n, snr, FFT_MIN_SNR_DB);
+    check(k_ref == k_fix, "strongest bin", n, k_fix, k_ref);
+    printf("fft n=%-4u %-12s exp %2d, SNR vs double %.1f dB, peak bin %u\n", n, c->name, exp, snr,
+           k_fix);
+    free(x); free(in_re); free(in_im); free(re); free(im); free(p_ref); free(p_fix);
+}
+
+// Summary of one block through vib_spectrum; tones in Hz and counts
+static void test_summary(uint n, float rate_hz, const double *f_hz, const double *amp, int tones,
+                         double noise_amp) {
+    static vib_spectrum_t v;
+    const float sens = 16384.0f;  // Contagens por g (±2 g)
+    if (!vib_spectrum_init(&v, n, rate_hz, sens)) {
+        printf("FAIL n=%u not supported\n", n);
+        failures++;
+        return;
+    }
+    int16_t *x = malloc(n * sizeof *x);
+    for (uint i = 0; i < n; i++) {
+        double s = 300;  // Offset, removed by the summary
+        for (int t = 0; t < tones; t++) s += amp[t] * sin(2 * M_PI * f_hz[t] * i / rate_hz + t);
+        x[i] = (int16_t)lround(s + noise_amp * noise());
+        vib_spectrum_add(&v, x[i], i);
+    }
+    vib_summary_t s;
+    bool got = vib_spectrum_finish(&v, &s);
+    check(got, "summary delivered", n, got, 1);
+    if (!got) {
+        free(x);
+        return;
+    }
+
+    // Reference: same mean removal and Hann window, in double
+    double mean = 0, ss = 0, w2 = 0;
+    for (uint i = 0; i < n; i++) mean += x[i];
+    mean = trunc(mean / n);  // vib_compute divides in integers
+    double *re_in = malloc(n * sizeof(double)), *im_in = calloc(n, sizeof(double));
+    double *re = malloc(n * sizeof(double)), *im = malloc(n * sizeof(double));
+    for (uint i = 0; i < n; i++) {
+        double w = 0.5 * (1 - cos(2 * M_PI * i / n));
+        ss += (x[i] - mean) * (x[i] - mean);
+        w2 += w * w;
+        re_in[i] = (x[i] - mean) * w;
+    }
+    dft(re_in, im_in, re, im, n);
+    const double rms = sqrt(ss / n) / sens;
+    check(fabs(s.rms - rms) <= SUMMARY_TOL * rms, "time RMS", n, s.rms, rms);
+
+    const uint half = n / 2;
+    double worst_band = 0;
+    for (int b = 0; b < VIB_BANDS; b++) {
+        uint k0 = b * half / VIB_BANDS, k1 = b == VIB_BANDS - 1 ? half + 1 : (b + 1) * half / VIB_BANDS;
+        double acc = 0;
+        for (uint k = k0 ? k0 : 1; k < k1; k++) acc += re[k] * re[k] + im[k] * im[k];
+        double band = sqrt(2 * acc / (n * w2)) / sens;
+        // Relative to what the band may miss: SUMMARY_TOL of itself plus the
+        // fixed-point noise floor
+        double e = fabs(s.band_rms[b] - band) / (SUMMARY_TOL * band + BAND_FLOOR * rms);
+        if (e > worst_band) worst_band = e;
+    }
+    check(worst_band <= 1, "band RMS (error / allowed)", n, worst_band, 1);
+
+    // Each tone among the peaks, at its frequency and amplitude
+    const double bin_hz = rate_hz / n;
+    double worst_hz = 0, worst_amp = 0;
+    for (int t = 0; t < tones; t++) {
+        int j = 0;
+        while (j < VIB_PEAKS && fabs(s.peak_hz[j] - f_hz[t]) > bin_hz) j++;
+        check(j < VIB_PEAKS, "tone among the peaks (Hz)", n, f_hz[t], 0);
+        if (j == VIB_PEAKS) continue;
+        worst_hz = fmax(worst_hz, fabs(s.peak_hz[j] - f_hz[t]) / bin_hz);
+        worst_amp = fmax(worst_amp, fabs(s.peak_amp[j] * sens - amp[t]) / amp[t]);
+    }
+    check(worst_hz <= PEAK_HZ_TOL_BINS, "peak frequency error (bins)", n, worst_hz,
+          PEAK_HZ_TOL_BINS);
+    check(worst_amp <= PEAK_AMP_TOL, "peak amplitude error", n, worst_amp, PEAK_AMP_TOL);
+    printf("vib n=%-4u RMS %.5f g (double %.5f), band error %.2f of allowed, peaks within %.3f bins "
+           "and %.2f%%\n",
+           n, s.rms, rms, worst_band, worst_hz, 100 * worst_amp);
+    free(x); free(re_in); free(im_in); free(re); free(im);
+}
+
+int main(void) {
+    fft_init();
+    core1_worker_init();
+
+    const fft_case_t cases[] = {
+        {"on-bin full", {5, 0}, {16000, 0}, 0, false},
+        {"two tones", {37.3, 151.6}, {9000, 1200}, 128, false},
+        {"complex", {-20.5, 3.2}, {7000, 3000}, 200, true},
+        {"noise", {0, 0}, {0, 0}, 12000, true},
+    };
+    for (uint n = FFT_MIN_POINTS; n <= FFT_MAX_POINTS; n <<= 1)
+        for (size_t c = 0; c < count_of(cases); c++) test_fft(n, &cases[c]);
+
+    // Off-bin tones with noise at 1 kHz, as "fft" captures them
+    const double f1[] = {31.7, 112.35, 240.0}, a1[] = {4000, 1500, 600};
+    for (uint n = VIB_MIN_POINTS; n <= FFT_MAX_POINTS; n <<= 1)
+        test_summary(n, 1000.0f, f1, a1, 3, 40);
+    // Small vibration: a few counts, scaled up by vib_compute
+    const double f2[] = {87.1}, a2[] = {12};
+    test_summary(1024, 1000.0f, f2, a2, 1, 1);
+
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -9,6 +9,9 @@
 #include "ff.h" /* Obtains integer types */
 //
 #include "diskio.h" /* Declarations of disk functions */
+//
+#include "trace.h"
+#include "cpu_load.h"
 
 /* 
 This example assumes the following hardware configuration:
@@ -23,6 +26,15 @@ This example assumes the following hardware configuration:
 | GND   |       |       | 18,23 |           | GND       | Ground                 |
 | 3v3   |       |       | 36    |           | 3v3       | 3.3 volt power         |
 
+A second card on SPI1 is used by the stripe/mirror logging modes (sd_array.c):
+
+|       | SPI1  | GPIO  | Pin   | SPI       | MicroSD   | Description            |
+| ----- | ----  | ----- | ---   | --------  | --------- | ---------------------- |
+| MISO  | RX    | 8     | 11    | DO        | DO        | Master In, Slave Out   |
+| MOSI  | TX    | 27    | 32    | DI        | DI        | Master Out, Slave In   |
+| SCK   | SCK   | 26    | 31    | SCLK      | CLK       | SPI clock              |
+| CS1   |       | 9     | 12    | SS or CS  | CS        | Slave (or Chip) Select |
+
 */
 
 // Hardware Configuration of SPI "objects"
@@ -38,6 +50,13 @@ static spi_t spis[] = {  // One for each SPI.
         // .baud_rate = 1000 * 1000
         .baud_rate = 1000 * 1000
         // .baud_rate = 25 * 1000 * 1000 // Actual frequency: 20833333.
+    },
+    {
+        .hw_inst = spi1,  // Separate SPI so both cards can transfer in parallel
+        .miso_gpio = 8,
+        .mosi_gpio = 27,
+        .sck_gpio = 26,
+        .baud_rate = 1000 * 1000
     }};
 
 // Hardware Configuration of the SD Card "objects"
@@ -50,6 +69,14 @@ static sd_card_t sd_cards[] = {  // One for each SD card
         .card_detect_gpio = 22,  // Card detect
         .card_detected_true = -1  // What the GPIO read returns when a card is
                                  // present.
+    },
+    {
+        .pcName = "1:",
+        .spi = &spis[1],
+        .ss_gpio = 9,
+        .use_card_detect = false,
+        .card_detect_gpio = 22,
+        .card_detected_true = -1
     }};
 
 /* ********************************************************************** */
@@ -72,4 +99,31 @@ spi_t *spi_get_by_num(size_t num) {
     }
 }
 
+// Profiling hooks of the driver (hw_config.h), into lib/trace and lib/cpu_load
+void __not_in_flash_func(sd_hook_spi_irq)(bool enter) {
+    if (enter)
+        CPU_ISR_ENTER();
+    else
+        CPU_ISR_EXIT();
+}
+void __not_in_flash_func(sd_hook_spi_irq_dma)(bool begin, uint rx_dma) {
+    if (begin)
+        TRACE_BEGIN(TRACE_ISR_DMA, rx_dma);
+    else
+        TRACE_END(TRACE_ISR_DMA, rx_dma);
+}
+void sd_hook_spi_dma(bool begin, size_t length) {
+    if (begin)
+        TRACE_BEGIN(TRACE_DMA, length);
+    else
+        TRACE_END(TRACE_DMA, length);
+}
+void sd_hook_disk_io(bool write, bool begin, UINT count) {
+    uint8_t id = write ? TRACE_DISK_WRITE : TRACE_DISK_READ;
+    if (begin)
+        TRACE_BEGIN(id, count);
+    else
+        TRACE_END(id, count);
+}
+
 /* [] END OF FILE */
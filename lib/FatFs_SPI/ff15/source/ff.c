@@ -1422,6 +1422,35 @@ static FRESULT fill_last_frag (
 
 
 #if !FF_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Keep an incremental free space scan exact              */
+/*-----------------------------------------------------------------------*/
+/* Clusters below fs->scan_clst have been counted by f_getfree_step; when
+/  they change state the partial count follows. Clusters at or above it are
+/  counted in their current state when the scan gets there. */
+
+static void scan_update (
+	FATFS* fs,		/* Filesystem object */
+	DWORD clst,		/* First cluster of the block */
+	DWORD n,		/* Number of contiguous clusters */
+	int alloc		/* 1:allocated, 0:freed */
+)
+{
+	DWORD e;
+
+
+	if (fs->scan_clst <= clst) return;	/* Not counted yet or no scan in progress */
+	e = (fs->scan_clst - clst < n) ? fs->scan_clst - clst : n;
+	if (alloc) {
+		fs->scan_free -= e;
+	} else {
+		fs->scan_free += e;
+	}
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* FAT handling - Remove a cluster chain                                 */
 /*-----------------------------------------------------------------------*/
@@ -1464,6 +1493,7 @@ static FRESULT remove_chain (	/* FR_OK(0):succeeded, !=0:error */
 			fs->free_clst++;
 			fs->fsi_flag |= 1;
 		}
+		scan_update(fs, clst, 1, 0);
 #if FF_FS_EXFAT || FF_USE_TRIM
 		if (ecl + 1 == nxt) {	/* Is next cluster contiguous? */
 			ecl = nxt;
@@ -1607,6 +1637,7 @@ static DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:D
 		fs->last_clst = ncl;
 		if (fs->free_clst <= fs->n_fatent - 2) fs->free_clst--;
 		fs->fsi_flag |= 1;
+		scan_update(fs, ncl, 1, 1);
 	} else {
 		ncl = (res == FR_DISK_ERR) ? 0xFFFFFFFF : 1;	/* Failed. Generate error status */
 	}
@@ -3504,6 +3535,7 @@ static FRESULT mount_volume (	/* FR_OK(0): successful, !=0: an error occurred */
 
 #if !FF_FS_READONLY
 		fs->last_clst = fs->free_clst = 0xFFFFFFFF;		/* Initialize cluster allocation information */
+		fs->scan_clst = 0;								/* No free space scan in progress */
 #endif
 		fmt = FS_EXFAT;			/* FAT sub-type */
 	} else
@@ -3563,6 +3595,7 @@ static FRESULT mount_volume (	/* FR_OK(0): successful, !=0: an error occurred */
 #if !FF_FS_READONLY
 		/* Get FSInfo if available */
 		fs->last_clst = fs->free_clst = 0xFFFFFFFF;		/* Initialize cluster allocation information */
+		fs->scan_clst = 0;								/* No free space scan in progress */
 		fs->fsi_flag = 0x80;
 #if (FF_FS_NOFSINFO & 3) != 3
 		if (fmt == FS_FAT32				/* Allow to update FSInfo only if BPB_FSInfo32 == 1 */
@@ -4895,8 +4928,104 @@ FRESULT f_getfree (
 				*nclst = nfree;			/* Return the free clusters */
 				fs->free_clst = nfree;	/* Now free_clst is valid */
 				fs->fsi_flag |= 1;		/* FAT32: FSInfo is to be updated */
+				fs->scan_clst = 0;		/* Any incremental scan is done too */
+			}
+		}
+	}
+
+	LEAVE_FF(fs, res);
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Get Number of Free Clusters a Few Sectors at a Time                   */
+/*-----------------------------------------------------------------------*/
+/* Same count as f_getfree, but reads at most nsect sectors of the FAT (or
+/  of the exFAT allocation bitmap) per call, so the volume is never held for
+/  a whole FAT scan. The scan position is kept in the filesystem object and
+/  allocations made between calls are accounted for. *nclst is 0xFFFFFFFF
+/  until the count is complete; nsect = 0 only queries. */
+
+FRESULT f_getfree_step (
+	const TCHAR* path,	/* Logical drive number */
+	UINT nsect,			/* Maximum number of sectors to read in this call */
+	DWORD* nclst,		/* Pointer to a variable to return number of free clusters */
+	FATFS** fatfs		/* Pointer to return pointer to corresponding filesystem object */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD nfree = 0, clst, stat, n;
+	UINT i;
+	FFOBJID obj;
+
+
+	/* Get logical drive */
+	res = mount_volume(&path, &fs, 0);
+	if (res == FR_OK) {
+		*fatfs = fs;
+		if (fs->free_clst > fs->n_fatent - 2 && nsect) {	/* Not known yet: count some more */
+			if (fs->scan_clst < 2) {	/* Start a new scan */
+				fs->scan_clst = 2;
+				fs->scan_free = 0;
+			}
+			clst = fs->scan_clst;
+			if (fs->fs_type == FS_FAT12) {	/* FAT12: small enough to scan at once */
+				obj.fs = fs;
+				for ( ; clst < fs->n_fatent; clst++) {
+					stat = get_fat(&obj, clst);
+					if (stat == 0xFFFFFFFF) {
+						res = FR_DISK_ERR; break;
+					}
+					if (stat == 1) {
+						res = FR_INT_ERR; break;
+					}
+					if (stat == 0) nfree++;
+				}
+			} else {
+#if FF_FS_EXFAT
+				if (fs->fs_type == FS_EXFAT) {	/* exFAT: one bit per cluster in the bitmap */
+					for ( ; nsect && clst < fs->n_fatent; nsect--) {
+						n = clst - 2;	/* Bit of the cluster */
+						res = move_window(fs, fs->bitbase + n / 8 / SS(fs));
+						if (res != FR_OK) break;
+						do {
+							if (!(fs->win[n / 8 % SS(fs)] & (1 << (n % 8)))) nfree++;
+							n++; clst++;
+						} while (n % (SS(fs) * 8) && clst < fs->n_fatent);
+					}
+				} else
+#endif
+				{	/* FAT16/32: WORD/DWORD FAT entries */
+					n = SS(fs) / (fs->fs_type == FS_FAT16 ? 2 : 4);	/* Entries per sector */
+					for ( ; nsect && clst < fs->n_fatent; nsect--) {
+						res = move_window(fs, fs->fatbase + clst / n);
+						if (res != FR_OK) break;
+						do {
+							i = clst % n;
+							if (fs->fs_type == FS_FAT16) {
+								if (ld_word(fs->win + i * 2) == 0) nfree++;
+							} else {
+								if ((ld_dword(fs->win + i * 4) & 0x0FFFFFFF) == 0) nfree++;
+							}
+							clst++;
+						} while (clst % n && clst < fs->n_fatent);
+					}
+				}
+			}
+			if (res == FR_OK) {
+				fs->scan_free += nfree;
+				fs->scan_clst = clst;
+				if (clst >= fs->n_fatent) {		/* Scan complete */
+					fs->free_clst = fs->scan_free;	/* Now free_clst is valid */
+					fs->fsi_flag |= 1;		/* FAT32: FSInfo is to be updated */
+					fs->scan_clst = 0;
+				}
 			}
 		}
+		*nclst = (fs->free_clst <= fs->n_fatent - 2) ? fs->free_clst : 0xFFFFFFFF;
 	}
 
 	LEAVE_FF(fs, res);
@@ -5643,6 +5772,7 @@ FRESULT f_expand (
 				fs->free_clst -= tcl;
 				fs->fsi_flag |= 1;
 			}
+			scan_update(fs, scl, tcl, 1);
 		}
 	}
 
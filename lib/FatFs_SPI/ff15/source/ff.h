@@ -151,6 +151,8 @@ typedef struct {
 #if !FF_FS_READONLY
 	DWORD	last_clst;		/* Last allocated cluster */
 	DWORD	free_clst;		/* Number of free clusters */
+	DWORD	scan_clst;		/* f_getfree_step: next cluster to count (0:no scan in progress) */
+	DWORD	scan_free;		/* f_getfree_step: free clusters below scan_clst */
 #endif
 #if FF_FS_RPATH
 	DWORD	cdir;			/* Current directory start cluster (0:root) */
@@ -323,6 +325,7 @@ FRESULT f_chdir (const TCHAR* path);								/* Change current directory */
 FRESULT f_chdrive (const TCHAR* path);								/* Change current drive */
 FRESULT f_getcwd (TCHAR* buff, UINT len);							/* Get current directory */
 FRESULT f_getfree (const TCHAR* path, DWORD* nclst, FATFS** fatfs);	/* Get number of free clusters on the drive */
+FRESULT f_getfree_step (const TCHAR* path, UINT nsect, DWORD* nclst, FATFS** fatfs);	/* Same, reading at most nsect sectors per call */
 FRESULT f_getlabel (const TCHAR* path, TCHAR* label, DWORD* vsn);	/* Get volume label */
 FRESULT f_setlabel (const TCHAR* label);							/* Set volume label */
 FRESULT f_forward (FIL* fp, UINT(*func)(const BYTE*,UINT), UINT btf, UINT* bf);	/* Forward data to the stream */
@@ -374,12 +377,35 @@ DWORD ff_wtoupper (DWORD uni);			/* Unicode upper-case conversion */
 #if FF_USE_LFN == 3		/* Dynamic memory allocation */
 void* ff_memalloc (UINT msize);		/* Allocate memory block */
 void ff_memfree (void* mblock);		/* Free memory block */
+void ff_memusage (UINT* in_use, UINT* peak, DWORD* allocs);	/* Bytes in use/peak, allocations */
 #endif
+typedef struct {
+	BYTE	blocks, blocks_used, blocks_peak;	/* ff_memalloc pool (0 unless FF_USE_LFN == 3) */
+	DWORD	heap_allocs;	/* ff_memalloc requests served by the heap */
+	DWORD	fails;			/* Requests refused (pool empty) */
+	BYTE	fils, fil_used, fil_peak;			/* File object pool */
+	BYTE	dirs, dir_used, dir_peak;			/* Directory object pool */
+} FF_POOLSTATS;
+FIL* ff_fil_alloc (void);			/* Take a file object from the pool */
+void ff_fil_free (FIL* fp);			/* Return a file object to the pool */
+DIR* ff_dir_alloc (void);			/* Take a directory object from the pool */
+void ff_dir_free (DIR* dp);			/* Return a directory object to the pool */
+void ff_poolstats (FF_POOLSTATS* st);	/* Pool usage and high-water marks */
 #if FF_FS_REENTRANT	/* Sync functions */
 int ff_mutex_create (int vol);		/* Create a sync object */
 void ff_mutex_delete (int vol);		/* Delete a sync object */
 int ff_mutex_take (int vol);		/* Lock sync object */
 void ff_mutex_give (int vol);		/* Unlock sync object */
+typedef struct {
+	DWORD	takes;			/* Grants */
+	DWORD	contended;		/* Grants that had to wait for the other holder */
+	DWORD	timeouts;		/* Requests that gave up after FF_FS_TIMEOUT */
+	DWORD	wait_max_us;
+	QWORD	wait_sum_us;
+	DWORD	hold_max_us;	/* Longest time a holder kept the lock */
+	QWORD	hold_sum_us;
+} FF_MUTEXSTATS;
+void ff_mutex_stats (int vol, FF_MUTEXSTATS* st, int reset);	/* Lock statistics */
 #endif
 
 
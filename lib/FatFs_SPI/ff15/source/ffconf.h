@@ -38,7 +38,7 @@
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_EXPAND	0
+#define FF_USE_EXPAND	1
 /* This option switches f_expand function. (0:Disable or 1:Enable) */
 
 
@@ -133,6 +133,18 @@
 /  ff_memfree() exemplified in ffsystem.c, need to be added to the project. */
 
 
+#define FF_MEMPOOL_BLOCKS	4
+#define FF_MEMPOOL_HEAP		1
+#define FF_FILPOOL_SIZE		2
+#define FF_DIRPOOL_SIZE		2
+/* Static pools in ffsystem.c (up to 32 objects each). With FF_USE_LFN == 3
+/  ff_memalloc() takes one of FF_MEMPOOL_BLOCKS blocks sized for an LFN working
+/  buffer; larger requests (f_mkfs, f_fdisk) use the heap when FF_MEMPOOL_HEAP
+/  is 1 and fail when it is 0. In any LFN mode ff_fil_alloc()/ff_dir_alloc()
+/  hand out the FF_FILPOOL_SIZE file and FF_DIRPOOL_SIZE directory objects.
+/  Size them from the high-water marks of ff_poolstats(). */
+
+
 #define FF_LFN_UNICODE	2
 /* This option switches the character encoding on the API when LFN is enabled.
 /
@@ -275,7 +287,7 @@
 /      lock control is independent of re-entrancy. */
 
 
-#define FF_FS_REENTRANT	0
+#define FF_FS_REENTRANT	1
 #define FF_FS_TIMEOUT	1000
 /* The option FF_FS_REENTRANT switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
@@ -289,6 +301,8 @@
 /      function, must be added to the project. Samples are available in ffsystem.c.
 /
 /  The FF_FS_TIMEOUT defines timeout period in unit of O/S time tick.
+/  With the pico_sync mutexes of ffsystem.c (OS_TYPE 5) the unit is milliseconds;
+/  the logger on core1 and the console on core0 can then share a volume.
 */
 
 
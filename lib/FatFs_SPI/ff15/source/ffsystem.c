@@ -3,6 +3,22 @@
 /*------------------------------------------------------------------------*/
 
 #include "ff.h"
+#include <string.h>
+
+
+/* Usage of the memory block pool (FF_USE_LFN == 3 only) and of the file and
+/  directory object pools (any LFN mode) */
+static FF_POOLSTATS pool_stats = { FF_USE_LFN == 3 ? FF_MEMPOOL_BLOCKS : 0, 0, 0, 0, 0, FF_FILPOOL_SIZE, 0, 0, FF_DIRPOOL_SIZE, 0, 0 };
+
+#if FF_FS_REENTRANT	/* The volume mutexes do not cover allocations on different volumes */
+#include "pico/mutex.h"
+auto_init_mutex(pool_mutex);
+#define POOL_LOCK()		mutex_enter_blocking(&pool_mutex)
+#define POOL_UNLOCK()	mutex_exit(&pool_mutex)
+#else
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+#endif
 
 
 #if FF_USE_LFN == 3	/* Use dynamic memory allocation */
@@ -13,12 +29,55 @@
 
 #include <stdlib.h>		/* with POSIX API */
 
+/* Each block is preceded by its size so the usage can be reported */
+typedef union { UINT size; QWORD align; } memhdr_t;
+
+/* Blocks of the static pool fit one LFN working buffer (see INIT_NAMBUF in
+/  ff.c), so path-resolving calls never touch the heap. Bigger requests
+/  (f_mkfs, f_fdisk, dir_clear) go to malloc, or fail when FF_MEMPOOL_HEAP
+/  is 0; dir_clear() then falls back to the window buffer. */
+#define MEMPOOL_BLOCK_SIZE	((FF_MAX_LFN + 1) * 2 + (FF_FS_EXFAT ? (FF_MAX_LFN + 44U) / 15 * 32 : 0))
+#define MEMPOOL_SLOT	((sizeof (memhdr_t) + MEMPOOL_BLOCK_SIZE + sizeof (QWORD) - 1) / sizeof (QWORD))
+
+static QWORD mem_pool[FF_MEMPOOL_BLOCKS][MEMPOOL_SLOT];
+static DWORD mem_pool_map;			/* Bit n set: block n in use */
+static UINT mem_in_use, mem_peak;
+static DWORD mem_allocs;
+
 
 void* ff_memalloc (	/* Returns pointer to the allocated memory block (null if not enough core) */
 	UINT msize		/* Number of bytes to allocate */
 )
 {
-	return malloc((size_t)msize);	/* Allocate a new memory block */
+	memhdr_t* h = 0;
+	UINT i;
+
+	POOL_LOCK();
+	if (msize <= MEMPOOL_BLOCK_SIZE) {	/* Take a free block of the pool */
+		for (i = 0; i < FF_MEMPOOL_BLOCKS && (mem_pool_map & (1UL << i)); i++) ;
+		if (i < FF_MEMPOOL_BLOCKS) {
+			mem_pool_map |= 1UL << i;
+			h = (memhdr_t*)mem_pool[i];
+			if (++pool_stats.blocks_used > pool_stats.blocks_peak) pool_stats.blocks_peak = pool_stats.blocks_used;
+		}
+	}
+#if FF_MEMPOOL_HEAP
+	if (!h) {
+		h = malloc(sizeof (memhdr_t) + (size_t)msize);	/* Allocate a new memory block */
+		if (h) pool_stats.heap_allocs++;
+	}
+#endif
+	if (!h) {
+		pool_stats.fails++;
+		POOL_UNLOCK();
+		return 0;
+	}
+	h->size = msize;
+	mem_in_use += msize;
+	if (mem_in_use > mem_peak) mem_peak = mem_in_use;
+	mem_allocs++;
+	POOL_UNLOCK();
+	return h + 1;
 }
 
 
@@ -26,12 +85,114 @@ void ff_memfree (
 	void* mblock	/* Pointer to the memory block to free (no effect if null) */
 )
 {
-	free(mblock);	/* Free the memory block */
+	if (mblock) {
+		memhdr_t* h = (memhdr_t*)mblock - 1;
+		QWORD* q = (QWORD*)h;
+
+		POOL_LOCK();
+		mem_in_use -= h->size;
+		if (q >= mem_pool[0] && q < mem_pool[FF_MEMPOOL_BLOCKS]) {	/* Back to the pool */
+			mem_pool_map &= ~(1UL << ((q - mem_pool[0]) / MEMPOOL_SLOT));
+			pool_stats.blocks_used--;
+		} else {
+			free(h);	/* Free the memory block */
+		}
+		POOL_UNLOCK();
+	}
+}
+
+
+void ff_memusage (
+	UINT* in_use,	/* Bytes allocated now */
+	UINT* peak,		/* Most bytes allocated at once */
+	DWORD* allocs	/* Number of ff_memalloc calls */
+)
+{
+	*in_use = mem_in_use;
+	*peak = mem_peak;
+	*allocs = mem_allocs;
 }
 
 #endif
 
 
+/*------------------------------------------------------------------------*/
+/* Pre-allocated File and Directory Objects (in any LFN mode)             */
+/*------------------------------------------------------------------------*/
+
+static FIL fil_pool[FF_FILPOOL_SIZE];
+static DIR dir_pool[FF_DIRPOOL_SIZE];
+static DWORD fil_pool_map, dir_pool_map;
+
+
+static int pool_take (DWORD* map, UINT n, BYTE* used, BYTE* peak)
+{
+	UINT i;
+
+	POOL_LOCK();
+	for (i = 0; i < n && (*map & (1UL << i)); i++) ;
+	if (i == n) {
+		pool_stats.fails++;
+		POOL_UNLOCK();
+		return -1;
+	}
+	*map |= 1UL << i;
+	if (++*used > *peak) *peak = *used;
+	POOL_UNLOCK();
+	return (int)i;
+}
+
+
+FIL* ff_fil_alloc (void)	/* Returns a cleared file object (null if the pool is empty) */
+{
+	int i = pool_take(&fil_pool_map, FF_FILPOOL_SIZE, &pool_stats.fil_used, &pool_stats.fil_peak);
+
+	if (i < 0) return 0;
+	memset(&fil_pool[i], 0, sizeof (FIL));
+	return &fil_pool[i];
+}
+
+
+void ff_fil_free (FIL* fp)
+{
+	if (fp) {
+		POOL_LOCK();
+		fil_pool_map &= ~(1UL << (fp - fil_pool));
+		pool_stats.fil_used--;
+		POOL_UNLOCK();
+	}
+}
+
+
+DIR* ff_dir_alloc (void)	/* Returns a cleared directory object (null if the pool is empty) */
+{
+	int i = pool_take(&dir_pool_map, FF_DIRPOOL_SIZE, &pool_stats.dir_used, &pool_stats.dir_peak);
+
+	if (i < 0) return 0;
+	memset(&dir_pool[i], 0, sizeof (DIR));
+	return &dir_pool[i];
+}
+
+
+void ff_dir_free (DIR* dp)
+{
+	if (dp) {
+		POOL_LOCK();
+		dir_pool_map &= ~(1UL << (dp - dir_pool));
+		pool_stats.dir_used--;
+		POOL_UNLOCK();
+	}
+}
+
+
+void ff_poolstats (
+	FF_POOLSTATS* st	/* Pool sizes, blocks in use and high-water marks */
+)
+{
+	*st = pool_stats;
+}
+
+
 
 
 #if FF_FS_REENTRANT	/* Mutal exclusion */
@@ -39,7 +200,7 @@ void ff_memfree (
 /* Definitions of Mutex                                                   */
 /*------------------------------------------------------------------------*/
 
-#define OS_TYPE	0	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS */
+#define OS_TYPE	5	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS, 5:Pico SDK */
 
 
 #if   OS_TYPE == 0	/* Win32 */
@@ -64,6 +225,16 @@ static SemaphoreHandle_t Mutex[FF_VOLUMES + 1];	/* Table of mutex handle */
 #include "cmsis_os.h"
 static osMutexId Mutex[FF_VOLUMES + 1];	/* Table of mutex ID */
 
+#elif OS_TYPE == 5	/* Pico SDK: pico_sync mutexes, shared by both cores (FF_FS_TIMEOUT in ms) */
+#include <string.h>
+#include "pico/mutex.h"
+#include "pico/sync.h"
+#include "pico/time.h"
+static mutex_t Mutex[FF_VOLUMES + 1];	/* Table of mutexes */
+static FF_MUTEXSTATS MutexStats[FF_VOLUMES + 1];	/* Contention and hold times */
+static uint32_t MutexTaken[FF_VOLUMES + 1];	/* When the current holder got the mutex (us) */
+static critical_section_t StatsLock;	/* Guards MutexStats: a timeout and a reset happen without the volume mutex */
+
 #endif
 
 
@@ -106,6 +277,11 @@ int ff_mutex_create (	/* Returns 1:Function succeeded or 0:Could not create the
 	Mutex[vol] = osMutexCreate(osMutex(cmsis_os_mutex));
 	return (int)(Mutex[vol] != NULL);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	if (!critical_section_is_initialized(&StatsLock)) critical_section_init(&StatsLock);
+	if (!mutex_is_initialized(&Mutex[vol])) mutex_init(&Mutex[vol]);	/* Kept across remounts */
+	return 1;
+
 #endif
 }
 
@@ -138,6 +314,9 @@ void ff_mutex_delete (	/* Returns 1:Function succeeded or 0:Could not delete due
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexDelete(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* Pico SDK: nothing to free, the mutex is reused on the next f_mount */
+	(void)vol;
+
 #endif
 }
 
@@ -171,6 +350,31 @@ int ff_mutex_take (	/* Returns 1:Succeeded or 0:Timeout */
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	return (int)(osMutexWait(Mutex[vol], FF_FS_TIMEOUT) == osOK);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	uint32_t t0 = time_us_32(), wait = 0;
+	int contended = 0;
+
+	if (!mutex_try_enter(&Mutex[vol], 0)) {	/* Held by the other core */
+		if (!mutex_enter_timeout_ms(&Mutex[vol], FF_FS_TIMEOUT)) {
+			critical_section_enter_blocking(&StatsLock);
+			MutexStats[vol].timeouts++;
+			critical_section_exit(&StatsLock);
+			return 0;
+		}
+		wait = time_us_32() - t0;
+		contended = 1;
+	}
+	MutexTaken[vol] = time_us_32();
+	critical_section_enter_blocking(&StatsLock);
+	MutexStats[vol].takes++;
+	if (contended) {
+		MutexStats[vol].contended++;
+		MutexStats[vol].wait_sum_us += wait;
+		if (wait > MutexStats[vol].wait_max_us) MutexStats[vol].wait_max_us = wait;
+	}
+	critical_section_exit(&StatsLock);
+	return 1;
+
 #endif
 }
 
@@ -201,8 +405,40 @@ void ff_mutex_give (
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexRelease(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	uint32_t hold = time_us_32() - MutexTaken[vol];
+
+	critical_section_enter_blocking(&StatsLock);
+	MutexStats[vol].hold_sum_us += hold;
+	if (hold > MutexStats[vol].hold_max_us) MutexStats[vol].hold_max_us = hold;
+	critical_section_exit(&StatsLock);
+	mutex_exit(&Mutex[vol]);
+
 #endif
 }
 
+
+#if OS_TYPE == 5
+/*------------------------------------------------------------------------*/
+/* Lock Statistics                                                        */
+/*------------------------------------------------------------------------*/
+
+void ff_mutex_stats (
+	int vol,			/* Mutex ID: Volume mutex (0 to FF_VOLUMES - 1) or system mutex (FF_VOLUMES) */
+	FF_MUTEXSTATS* st,	/* Counters since the last reset */
+	int reset			/* Clear the counters after reading them */
+)
+{
+	if (!critical_section_is_initialized(&StatsLock)) {	/* Before the first f_mount: nothing counted yet */
+		memset(st, 0, sizeof *st);
+		return;
+	}
+	critical_section_enter_blocking(&StatsLock);
+	*st = MutexStats[vol];
+	if (reset) memset(&MutexStats[vol], 0, sizeof MutexStats[vol]);
+	critical_section_exit(&StatsLock);
+}
+#endif
+
 #endif	/* FF_FS_REENTRANT */
 
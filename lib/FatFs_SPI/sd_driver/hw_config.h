@@ -26,6 +26,14 @@ extern "C" {
     size_t spi_get_num();
     spi_t *spi_get_by_num(size_t num);
 
+    /* Profiling hooks the driver calls around its I/O. spi.c and glue.c
+       define them as weak no-ops; the application may override them (the
+       two IRQ hooks run in the DMA interrupt and belong in RAM). */
+    void sd_hook_spi_irq(bool enter);                  // DMA IRQ handler entry/exit
+    void sd_hook_spi_irq_dma(bool begin, uint rx_dma); // Block completion, inside the IRQ
+    void sd_hook_spi_dma(bool begin, size_t length);   // Block transfer (length > 1)
+    void sd_hook_disk_io(bool write, bool begin, UINT count);  // disk_read/disk_write
+
 #ifdef __cplusplus
 }
 #endif
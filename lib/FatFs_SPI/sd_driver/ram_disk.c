@@ -0,0 +1,115 @@
+/* ram_disk.c: memory-backed block device for an sd_card_t (see ram_disk.h) */
+
+#include <string.h>
+//
+#include "pico/stdlib.h"
+//
+#include "my_debug.h"
+#include "ram_disk.h"
+//
+#include "ff.h" /* Obtains integer types */
+//
+#include "diskio.h" /* Declarations of disk functions */  // Needed for STA_NOINIT, ...
+
+#define SECTOR_SIZE 512
+
+const ram_disk_latency_preset_t ram_disk_latency_presets[] = {
+    {"none", {0, 0, 0, 0, 0, 0}},
+    {"fast", {20, 15, 40, 200, 2000, 20000}},
+    {"typical", {100, 60, 250, 1000, 10000, 100000}},
+    {"slow", {300, 150, 800, 5000, 50000, 250000}},
+};
+const size_t ram_disk_latency_preset_count = count_of(ram_disk_latency_presets);
+
+const ram_disk_latency_t *ram_disk_find_latency(const char *name) {
+    for (size_t i = 0; i < ram_disk_latency_preset_count; ++i)
+        if (0 == strcmp(name, ram_disk_latency_presets[i].name))
+            return &ram_disk_latency_presets[i].latency;
+    return NULL;
+}
+
+static uint32_t next_random(ram_disk_t *disk) {
+    // xorshift32
+    uint32_t x = disk->seed ? disk->seed : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    disk->seed = x;
+    return x;
+}
+
+static void ram_disk_wait(ram_disk_t *disk, uint64_t us) {
+    if (!us) return;
+    disk->delay_us_total += us;
+    busy_wait_us(us);
+}
+
+static int ram_disk_init(sd_card_t *pSD) {
+    ram_disk_t *disk = pSD->backend;
+    if (!mutex_is_initialized(&pSD->mutex)) mutex_init(&pSD->mutex);
+    pSD->sectors = disk->sectors;
+    pSD->m_Status &= ~(STA_NOINIT | STA_NODISK);
+    return pSD->m_Status;
+}
+
+static int ram_disk_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber,
+                                uint32_t ulSectorCount) {
+    ram_disk_t *disk = pSD->backend;
+    if (ulSectorNumber + ulSectorCount > disk->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    SD_STATS_TIME(t0);
+    mutex_enter_blocking(&pSD->mutex);
+    disk->reads++;
+    memcpy(buffer, disk->mem + ulSectorNumber * SECTOR_SIZE, (size_t)ulSectorCount * SECTOR_SIZE);
+    ram_disk_wait(disk, disk->latency.cmd_us +
+                            (uint64_t)disk->latency.read_us_per_sector * ulSectorCount);
+    SD_STATS_HIST(pSD, read, t0);
+    SD_STATS_ADD(pSD, read_sectors, ulSectorCount);
+    mutex_exit(&pSD->mutex);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static int ram_disk_write_blocks(sd_card_t *pSD, const uint8_t *buffer, uint64_t ulSectorNumber,
+                                 uint32_t blockCnt) {
+    ram_disk_t *disk = pSD->backend;
+    if (ulSectorNumber + blockCnt > disk->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    SD_STATS_TIME(t0);
+    mutex_enter_blocking(&pSD->mutex);
+    disk->writes++;
+    memcpy(disk->mem + ulSectorNumber * SECTOR_SIZE, buffer, (size_t)blockCnt * SECTOR_SIZE);
+    const ram_disk_latency_t *lat = &disk->latency;
+    uint64_t us = lat->cmd_us + (uint64_t)lat->write_us_per_sector * blockCnt;
+    if (lat->busy_ppm) {
+        for (uint32_t i = 0; i < blockCnt; ++i) {
+            if (next_random(disk) % 1000000 < lat->busy_ppm) {
+                uint32_t span = lat->busy_max_us - lat->busy_min_us;
+                us += lat->busy_min_us + (span ? next_random(disk) % (span + 1) : 0);
+                disk->busy_events++;
+            }
+        }
+    }
+    ram_disk_wait(disk, us);
+    SD_STATS_HIST(pSD, write, t0);
+    SD_STATS_ADD(pSD, write_sectors, blockCnt);
+    mutex_exit(&pSD->mutex);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static uint64_t ram_disk_get_num_sectors(sd_card_t *pSD) {
+    return ((ram_disk_t *)pSD->backend)->sectors;
+}
+
+void ram_disk_attach(sd_card_t *pSD, ram_disk_t *disk) {
+    myASSERT(disk->mem && disk->sectors);
+    pSD->backend = disk;
+    pSD->m_Status = STA_NOINIT;
+    pSD->use_card_detect = false;
+    pSD->init = ram_disk_init;
+    pSD->read_blocks = ram_disk_read_blocks;
+    pSD->write_blocks = ram_disk_write_blocks;
+    pSD->get_num_sectors = ram_disk_get_num_sectors;
+    pSD->sd_test_com = NULL;
+}
+
+/* [] END OF FILE */
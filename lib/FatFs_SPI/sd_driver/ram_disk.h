@@ -0,0 +1,62 @@
+/* ram_disk.h: memory-backed block device for an sd_card_t
+ *
+ * Attach it to a card before the first disk_initialize() and FatFs uses the
+ * memory instead of the card on the SPI bus. The memory can be a static
+ * array on the Pico or an mmap'ed disk image on the host build (host/), so
+ * the same FatFs code can be benchmarked and fuzzed off target.
+ *
+ * Optionally the device waits like a real card would: a fixed cost per
+ * command, a cost per sector, and now and then a long busy period after a
+ * write (flash erase/garbage collection), drawn from a uniform range.
+ */
+
+#pragma once
+
+#include <stdint.h>
+//
+#include "sd_card.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t cmd_us;              // Per read or write command
+    uint32_t read_us_per_sector;
+    uint32_t write_us_per_sector; // Programming time
+    uint32_t busy_ppm;            // Chance per written sector of a long busy
+    uint32_t busy_min_us;
+    uint32_t busy_max_us;
+} ram_disk_latency_t;
+
+typedef struct {
+    const char *name;
+    ram_disk_latency_t latency;
+} ram_disk_latency_preset_t;
+
+// "none", "fast", "typical", "slow". Rough figures for microSD cards in SPI
+// mode; "slow" resembles a worn or low-end card with frequent long stalls.
+extern const ram_disk_latency_preset_t ram_disk_latency_presets[];
+extern const size_t ram_disk_latency_preset_count;
+const ram_disk_latency_t *ram_disk_find_latency(const char *name);
+
+typedef struct {
+    uint8_t *mem;
+    uint64_t sectors;  // mem holds sectors * 512 bytes
+    ram_disk_latency_t latency;
+    uint32_t seed;     // Random state for busy periods; any non-zero value
+    // Statistics
+    uint64_t reads, writes;          // Commands
+    uint64_t busy_events;
+    uint64_t delay_us_total;         // Injected waiting time
+} ram_disk_t;
+
+// Replaces the card's block device operations with ones backed by disk->mem.
+// disk must stay valid while the card is in use.
+void ram_disk_attach(sd_card_t *pSD, ram_disk_t *disk);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* [] END OF FILE */
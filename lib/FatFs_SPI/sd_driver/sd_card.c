@@ -184,6 +184,16 @@ specific language governing permissions and limitations under the License.
 static bool crc_on = true;
 #endif
 
+// Keep a CMD18 multi-block read open across calls so that FatFs reading
+// adjacent sectors doesn't pay for CMD18/CMD12 every time.
+#ifndef SD_READ_STREAM_ENABLED
+#define SD_READ_STREAM_ENABLED 1
+#endif
+
+#ifndef SD_READ_STREAM_TIMEOUT_MS
+#define SD_READ_STREAM_TIMEOUT_MS 50 /*!< Idle time before an open read is stopped */
+#endif
+
 #define TRACE_PRINTF(fmt, args...)
 // #define TRACE_PRINTF printf
 
@@ -357,7 +367,10 @@ static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
     } while (resp == 0x00 &&
              0 < absolute_time_diff_us(get_absolute_time(), timeout_time));
 
-    if (resp == 0x00) DBG_PRINTF("%s failed\r\n", __FUNCTION__);
+    if (resp == 0x00) {
+        DBG_PRINTF("%s failed\r\n", __FUNCTION__);
+        SD_STATS_ADD(pSD, timeouts, 1);
+    }
 
     // Return success/failure
     return (resp > 0x00);
@@ -450,13 +463,20 @@ static const char *cmd2str(const cmdSupported cmd) {
 #define SD_COMMAND_RETRIES 3 /*!< Times SPI cmd is retried when there is no response */
 #define SD_COMMAND_TIMEOUT 2000 /*!< Timeout in ms for response */
 
-static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
-                  bool isAcmd, uint32_t *resp) {
+static int sd_stop_read_stream(sd_card_t *pSD);
+
+static int in_sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
+                     bool isAcmd, uint32_t *resp) {
     TRACE_PRINTF("%s(%s(0x%08lx)): ", __FUNCTION__, cmd2str(cmd), arg);
 
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
     uint32_t response;
 
+    // Any other command ends an open multi-block read first
+    if (CMD12_STOP_TRANSMISSION != cmd && pSD->read_stream_open) {
+        sd_stop_read_stream(pSD);
+    }
+
     // No need to wait for card to be ready when sending the stop command
     if (CMD12_STOP_TRANSMISSION != cmd) {
         if (false == sd_wait_ready(pSD, SD_COMMAND_TIMEOUT)) {
@@ -477,6 +497,7 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
         response = sd_cmd_spi(pSD, cmd, arg);
         if (R1_NO_RESPONSE == response) {
             DBG_PRINTF("No response CMD:%d\r\n", cmd);
+            SD_STATS_ADD(pSD, cmd_retries, 1);
             continue;
         }
         break;
@@ -611,6 +632,17 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
     return status;
 }
 
+/* Sends a command, timing it into the card's histogram for that command and
+   counting CRC errors (sd_stats.h). */
+static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
+                  bool isAcmd, uint32_t *resp) {
+    SD_STATS_TIME(t0);
+    int status = in_sd_cmd(pSD, cmd, arg, isAcmd, resp);
+    SD_STATS_HIST(pSD, cmd, t0);
+    if (SD_BLOCK_DEVICE_ERROR_CRC == status) SD_STATS_ADD(pSD, crc_errors, 1);
+    return status;
+}
+
 /* Return non-zero if the SD-card is present. */
 bool sd_card_detect(sd_card_t *pSD) {
     TRACE_PRINTF("> %s\r\n", __FUNCTION__);
@@ -628,6 +660,7 @@ bool sd_card_detect(sd_card_t *pSD) {
         // The socket is now empty
         pSD->m_Status |= (STA_NODISK | STA_NOINIT);
         pSD->card_type = SDCARD_NONE;
+        pSD->read_stream_open = false;
         printf("No SD card detected!\r\n");
         return false;
     }
@@ -771,6 +804,7 @@ static bool sd_wait_token(sd_card_t *pSD, uint8_t token) {
         }
     } while (0 < absolute_time_diff_us(get_absolute_time(), timeout_time));
     DBG_PRINTF("sd_wait_token: timeout\r\n");
+    SD_STATS_ADD(pSD, timeouts, 1);
     return false;
 }
 
@@ -802,6 +836,7 @@ static int sd_read_bytes(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
             DBG_PRINTF("_read_bytes: Invalid CRC received 0x%" PRIx16
                        " result of computation 0x%" PRIx16 "\r\n",
                        crc, (uint16_t)crc_result);
+            SD_STATS_ADD(pSD, crc_errors, 1);
             return SD_BLOCK_DEVICE_ERROR_CRC;
         }
     }
@@ -819,9 +854,11 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
     }
     // read data
     // bool spi_transfer(const uint8_t *tx, uint8_t *rx, size_t length)
+    SD_STATS_TIME(t0);
     if (!sd_spi_transfer(pSD, NULL, buffer, length)) {
         return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
+    SD_STATS_HIST(pSD, dma, t0);
     // Read the CRC16 checksum for the data block
     crc = (sd_spi_write(pSD, SPI_FILL_CHAR) << 8);
     crc |= sd_spi_write(pSD, SPI_FILL_CHAR);
@@ -835,6 +872,7 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
             DBG_PRINTF("%s: Invalid CRC received 0x%" PRIx16
                        " result of computation 0x%" PRIx16 "\r\n",
                        __FUNCTION__, crc, (uint16_t)crc_result);
+            SD_STATS_ADD(pSD, crc_errors, 1);
             return SD_BLOCK_DEVICE_ERROR_CRC;
         }
     }
@@ -843,6 +881,23 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
     return SD_BLOCK_DEVICE_ERROR_NONE;
 }
 
+// Send CMD12(0x00000000) to stop an open multi-block read
+static int sd_stop_read_stream(sd_card_t *pSD) {
+    if (!pSD->read_stream_open) return SD_BLOCK_DEVICE_ERROR_NONE;
+    pSD->read_stream_open = false;
+    return sd_cmd(pSD, CMD12_STOP_TRANSMISSION, 0x0, false, 0);
+}
+
+// The stream keeps the card selected between calls, which is only safe when
+// no other card shares the SPI.
+static bool sd_spi_is_dedicated(sd_card_t *pSD) {
+    for (size_t i = 0; i < sd_get_num(); ++i) {
+        sd_card_t *other = sd_get_by_num(i);
+        if (other != pSD && other->spi == pSD->spi) return false;
+    }
+    return true;
+}
+
 static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
                              uint64_t ulSectorNumber, uint32_t ulSectorCount) {
     uint32_t blockCnt = ulSectorCount;
@@ -862,6 +917,26 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
     } else {
         addr = ulSectorNumber * _block_size;
     }
+#if SD_READ_STREAM_ENABLED
+    // An open stream can only serve the sector right after the last one read
+    if (pSD->read_stream_open &&
+        (ulSectorNumber != pSD->read_stream_next ||
+         absolute_time_diff_us(pSD->read_stream_time, get_absolute_time()) >
+             SD_READ_STREAM_TIMEOUT_MS * 1000)) {
+        status = sd_stop_read_stream(pSD);
+        if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
+            return status;
+        }
+    }
+    // Open-ended: the card keeps sending blocks until CMD12
+    if (!pSD->read_stream_open) {
+        status = sd_cmd(pSD, CMD18_READ_MULTIPLE_BLOCK, addr, false, 0);
+        if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
+            return status;
+        }
+        pSD->read_stream_open = true;
+    }
+#else
     // Write command ro receive data
     if (blockCnt > 1) {
         status = sd_cmd(pSD, CMD18_READ_MULTIPLE_BLOCK, addr, false, 0);
@@ -871,6 +946,7 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
     if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
         return status;
     }
+#endif
     // receive the data : one block at a time
     int rd_status = 0;
     while (blockCnt) {
@@ -881,23 +957,48 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
         buffer += _block_size;
         --blockCnt;
     }
+#if SD_READ_STREAM_ENABLED
+    pSD->read_stream_next = ulSectorNumber + ulSectorCount;
+    pSD->read_stream_time = get_absolute_time();
+    // Stop on error, before the card reads ahead past its last sector, or
+    // if the card has to give up the SPI between calls
+    if (rd_status || pSD->read_stream_next >= pSD->sectors ||
+        !sd_spi_is_dedicated(pSD)) {
+        status = sd_stop_read_stream(pSD);
+    }
+#else
     // Send CMD12(0x00000000) to stop the transmission for multi-block transfer
     if (ulSectorCount > 1) {
         status = sd_cmd(pSD, CMD12_STOP_TRANSMISSION, 0x0, false, 0);
     }
+#endif
     return rd_status ? rd_status : status;
 }
 
 int sd_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber,
                    uint32_t ulSectorCount) {
+    SD_STATS_TIME(t0);
     sd_acquire(pSD);
     TRACE_PRINTF("sd_read_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, ulSectorCount);
     int status = in_sd_read_blocks(pSD, buffer, ulSectorNumber, ulSectorCount);
+    SD_STATS_HIST(pSD, read, t0);
+    SD_STATS_ADD(pSD, read_sectors, ulSectorCount);
     sd_release(pSD);
     return status;
 }
 
+void sd_read_stream_poll(sd_card_t *pSD) {
+    if (!pSD->read_stream_open) return;
+    sd_acquire(pSD);
+    if (pSD->read_stream_open &&
+        absolute_time_diff_us(pSD->read_stream_time, get_absolute_time()) >
+            SD_READ_STREAM_TIMEOUT_MS * 1000) {
+        sd_stop_read_stream(pSD);
+    }
+    sd_release(pSD);
+}
+
 static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
                               uint8_t token, uint32_t length) {
     uint16_t crc = (~0);
@@ -907,8 +1008,10 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
     sd_spi_write(pSD, token);
 
     // write the data
+    SD_STATS_TIME(t_dma);
     bool ret = sd_spi_transfer(pSD, buffer, NULL, length);
     myASSERT(ret);
+    SD_STATS_HIST(pSD, dma, t_dma);
 
 #if SD_CRC_ENABLED
     if (crc_on) {
@@ -925,10 +1028,17 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
     response = sd_spi_write(pSD, SPI_FILL_CHAR);
 
     // Wait for last block to be written
+    SD_STATS_TIME(t_busy);
     if (false == sd_wait_ready(pSD, SD_COMMAND_TIMEOUT)) {
         DBG_PRINTF("%s:%d: Card not ready yet\r\n", __FILE__, __LINE__);
     }
-    return (response & SPI_DATA_RESPONSE_MASK);
+    SD_STATS_HIST(pSD, busy, t_busy);
+    response &= SPI_DATA_RESPONSE_MASK;
+    if (SPI_DATA_CRC_ERROR == response)
+        SD_STATS_ADD(pSD, crc_errors, 1);
+    else if (SPI_DATA_ACCEPTED != response)
+        SD_STATS_ADD(pSD, write_errors, 1);
+    return response;
 }
 
 /** Program blocks to a block device
@@ -1016,10 +1126,13 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
 
 int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
                     uint64_t ulSectorNumber, uint32_t blockCnt) {
+    SD_STATS_TIME(t0);
     sd_acquire(pSD);
     TRACE_PRINTF("sd_write_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, blockCnt);
     int status = in_sd_write_blocks(pSD, buffer, ulSectorNumber, blockCnt);
+    SD_STATS_HIST(pSD, write, t0);
+    SD_STATS_ADD(pSD, write_sectors, blockCnt);
     sd_release(pSD);
     return status;
 }
@@ -1137,6 +1250,7 @@ static void sd_ctor(sd_card_t *pSD) {
     pSD->init = sd_init;
     pSD->write_blocks = sd_write_blocks;
     pSD->read_blocks = sd_read_blocks;
+    pSD->get_num_sectors = sd_sectors;
     pSD->sd_test_com = sd_test_com;
 }
 bool sd_init_driver() {
@@ -1146,6 +1260,8 @@ bool sd_init_driver() {
     if (!initialized) {
         for (size_t i = 0; i < sd_get_num(); ++i) {
             sd_card_t *pSD = sd_get_by_num(i);
+            // Cards with another block device backend attached keep it
+            if (pSD->init) continue;
 
             sd_ctor(pSD);
 
@@ -1201,6 +1317,8 @@ static int sd_init(sd_card_t *pSD) {
     pSD->card_type = SDCARD_NONE;
 
     sd_spi_acquire(pSD);
+    // CMD0 resets the card, so there is no read to stop
+    pSD->read_stream_open = false;
 
     int err = sd_init_medium(pSD);
     if (SD_BLOCK_DEVICE_ERROR_NONE != err) {
@@ -1247,6 +1365,7 @@ static bool sd_test_com(sd_card_t *pSD) {
 
     if (!(pSD->m_Status & STA_NOINIT)) {
         // SD card is currently initialized
+        sd_stop_read_stream(pSD);
 
         // Timeout of 0 means only check once
         if (sd_wait_ready(pSD, 0)) {
@@ -1275,6 +1394,7 @@ static bool sd_test_com(sd_card_t *pSD) {
 
         // Initialize the member variables
         pSD->card_type = SDCARD_NONE;
+        pSD->read_stream_open = false;
 
         sd_spi_go_low_frequency(pSD);
         sd_spi_send_initializing_sequence(pSD);
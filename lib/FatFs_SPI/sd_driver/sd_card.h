@@ -25,6 +25,7 @@ specific language governing permissions and limitations under the License.
 #include "ff.h"
 //
 #include "spi.h"
+#include "sd_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,12 +55,25 @@ struct sd_card_t {
     mutex_t mutex;
     FATFS fatfs;
     bool mounted;
-
+    // Open-ended CMD18 multi-block read kept across calls for sequential reads.
+    // While open, the card stays selected between calls.
+    bool read_stream_open;
+    uint64_t read_stream_next;         // Next sector the open stream will deliver
+    absolute_time_t read_stream_time;  // When the stream last delivered a block
+
+    // Block device operations. sd_init_driver() points these at the SPI
+    // driver unless another backend (e.g. ram_disk.c) was attached first.
     int (*init)(sd_card_t *sd_card_p);
     int (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
                     uint64_t ulSectorNumber, uint32_t blockCnt);
     int (*read_blocks)(sd_card_t *sd_card_p, uint8_t *buffer, uint64_t ulSectorNumber,
                     uint32_t ulSectorCount);
+    uint64_t (*get_num_sectors)(sd_card_t *sd_card_p);
+    void *backend;  // Private state of a non-SPI backend
+
+    // Latency histograms and error counters (see sd_stats.h). Updated with
+    // the card's mutex held.
+    sd_stats_t stats;
 
     // Useful when use_card_detect is false - call periodically to check for presence of SD card
     // Returns true if and only if SD card was sensed on the bus
@@ -93,6 +107,14 @@ uint64_t sd_sectors(sd_card_t *pSD);
 bool sd_init_driver();
 bool sd_card_detect(sd_card_t *sd_card_p);
 
+// Call periodically: closes an open-ended multi-block read once it has been
+// idle for longer than SD_READ_STREAM_TIMEOUT_MS
+void sd_read_stream_poll(sd_card_t *sd_card_p);
+
+// Copies the card's statistics, optionally clearing them afterwards
+void sd_card_get_stats(sd_card_t *sd_card_p, sd_stats_t *stats, bool reset);
+void sd_stats_print(const sd_card_t *sd_card_p, const sd_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
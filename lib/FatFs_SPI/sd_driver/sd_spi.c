@@ -78,11 +78,13 @@ void sd_spi_deselect_pulse(sd_card_t *pSD) {
 }
 void sd_spi_acquire(sd_card_t *pSD) {
     sd_spi_lock(pSD);
-    sd_spi_select(pSD);
+    // Still selected if the last call left a read stream open
+    if (!pSD->read_stream_open) sd_spi_select(pSD);
 }
 
 void sd_spi_release(sd_card_t *pSD) {
-    sd_spi_deselect(pSD);
+    // The card must stay selected for the whole multi-block read
+    if (!pSD->read_stream_open) sd_spi_deselect(pSD);
     sd_spi_unlock(pSD);
 }
 
@@ -0,0 +1,82 @@
+/* sd_stats.c: SD driver latency histograms and error counters (see sd_stats.h) */
+
+#include <stdio.h>
+#include <string.h>
+//
+#include "pico/stdlib.h"
+//
+#include "sd_card.h"
+#include "sd_stats.h"
+
+void sd_hist_add(sd_hist_t *hist, uint32_t us) {
+    uint32_t b = us ? 31 - __builtin_clz(us) : 0;
+    if (b >= SD_STATS_BUCKETS) b = SD_STATS_BUCKETS - 1;
+    hist->buckets[b]++;
+    hist->count++;
+    hist->sum_us += us;
+    if (us > hist->max_us) hist->max_us = us;
+}
+
+void sd_card_get_stats(sd_card_t *pSD, sd_stats_t *stats, bool reset) {
+    // The mutex only exists once the card has been initialized
+    bool locked = mutex_is_initialized(&pSD->mutex);
+    if (locked) mutex_enter_blocking(&pSD->mutex);
+    *stats = pSD->stats;
+    if (reset) {
+        memset(&pSD->stats, 0, sizeof pSD->stats);
+        pSD->stats.since_us = time_us_64();
+        if (pSD->spi) pSD->spi->dma_timeouts = 0;
+    }
+    if (locked) mutex_exit(&pSD->mutex);
+}
+
+static void print_hist_row(const char *name, const sd_hist_t *h) {
+    printf("  %-6s %8lu %8lu %8lu\n", name, (unsigned long)h->count,
+           h->count ? (unsigned long)(h->sum_us / h->count) : 0UL,
+           (unsigned long)h->max_us);
+}
+
+static void print_hist_buckets(const char *name, const sd_hist_t *h) {
+    if (!h->count) return;
+    uint32_t peak = 0;
+    for (int i = 0; i < SD_STATS_BUCKETS; ++i)
+        if (h->buckets[i] > peak) peak = h->buckets[i];
+    printf("  %s (us):\n", name);
+    for (int i = 0; i < SD_STATS_BUCKETS; ++i) {
+        if (!h->buckets[i]) continue;
+        char range[24];
+        if (SD_STATS_BUCKETS - 1 == i)
+            snprintf(range, sizeof range, ">= %lu", 1UL << i);
+        else
+            snprintf(range, sizeof range, "%lu..%lu", i ? 1UL << i : 0UL,
+                     (2UL << i) - 1);
+        int bar = (int)((h->buckets[i] * 32ULL + peak - 1) / peak);
+        printf("    %16s %8lu %.*s\n", range, (unsigned long)h->buckets[i], bar,
+               "################################");
+    }
+}
+
+void sd_stats_print(const sd_card_t *pSD, const sd_stats_t *s) {
+    uint64_t secs = (time_us_64() - s->since_us) / 1000000;
+    printf("%s last %llu s: %lu sectors read, %lu written\n", pSD->pcName,
+           (unsigned long long)secs, (unsigned long)s->read_sectors,
+           (unsigned long)s->write_sectors);
+    printf("  retries %lu, CRC errors %lu, write errors %lu, timeouts %lu",
+           (unsigned long)s->cmd_retries, (unsigned long)s->crc_errors,
+           (unsigned long)s->write_errors, (unsigned long)s->timeouts);
+    if (pSD->spi)
+        printf(", DMA timeouts %lu", (unsigned long)pSD->spi->dma_timeouts);
+    printf("\n  %-6s %8s %8s %8s\n", "", "count", "avg us", "max us");
+    print_hist_row("cmd", &s->cmd);
+    print_hist_row("dma", &s->dma);
+    print_hist_row("busy", &s->busy);
+    print_hist_row("read", &s->read);
+    print_hist_row("write", &s->write);
+    print_hist_buckets("cmd", &s->cmd);
+    print_hist_buckets("dma", &s->dma);
+    print_hist_buckets("busy", &s->busy);
+    print_hist_buckets("read", &s->read);
+    print_hist_buckets("write", &s->write);
+}
+
+/* [] END OF FILE */
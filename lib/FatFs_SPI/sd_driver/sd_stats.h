@@ -0,0 +1,64 @@
+/* sd_stats.h: per-card latency histograms and error counters for the SD driver
+ *
+ * Each histogram has log2 buckets in microseconds: bucket i counts times in
+ * [2^i, 2^(i+1)) us (bucket 0 also holds 0 us), and the last bucket
+ * everything from 2^(SD_STATS_BUCKETS-1) us up. Recording is a couple of
+ * timer reads and a count-leading-zeros, so it is left on by default;
+ * build with SD_STATS_ENABLED=0 to compile it out.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SD_STATS_ENABLED
+#define SD_STATS_ENABLED 1
+#endif
+
+#define SD_STATS_BUCKETS 21  // Up to ~1 s
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[SD_STATS_BUCKETS];
+} sd_hist_t;
+
+typedef struct {
+    sd_hist_t cmd;    // sd_cmd(): wait for ready, command, R1
+    sd_hist_t dma;    // DMA transfer of one data block
+    sd_hist_t busy;   // Card busy (programming) after each written block
+    sd_hist_t read;   // Whole read_blocks() call
+    sd_hist_t write;  // Whole write_blocks() call
+    uint32_t read_sectors;
+    uint32_t write_sectors;
+    uint32_t cmd_retries;   // Commands sent again after no response
+    uint32_t crc_errors;    // R1 CRC error, bad data CRC or CRC data response
+    uint32_t write_errors;  // Other rejected data blocks
+    uint32_t timeouts;      // Card not ready or no start token in time
+    uint64_t since_us;      // When the counters were last reset
+} sd_stats_t;
+
+void sd_hist_add(sd_hist_t *hist, uint32_t us);
+
+#if SD_STATS_ENABLED
+#  define SD_STATS_TIME(t0) uint32_t t0 = time_us_32()
+#  define SD_STATS_HIST(pSD, field, t0) \
+    sd_hist_add(&(pSD)->stats.field, time_us_32() - (t0))
+#  define SD_STATS_ADD(pSD, field, n) ((pSD)->stats.field += (n))
+#else
+#  define SD_STATS_TIME(t0)
+#  define SD_STATS_HIST(pSD, field, t0)
+#  define SD_STATS_ADD(pSD, field, n)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/* [] END OF FILE */
@@ -26,21 +26,39 @@ specific language governing permissions and limitations under the License.
 
 static bool irqChannel1 = false;
 static bool irqShared = true;
+// Whether the transfer in flight on each SPI is a data block (for tracing)
+static volatile bool block_transfer[2];
+
+// Default profiling hooks (hw_config.h): none
+__attribute__((weak)) void __not_in_flash_func(sd_hook_spi_irq)(bool enter) { (void)enter; }
+__attribute__((weak)) void __not_in_flash_func(sd_hook_spi_irq_dma)(bool begin, uint rx_dma) {
+    (void)begin;
+    (void)rx_dma;
+}
+__attribute__((weak)) void sd_hook_spi_dma(bool begin, size_t length) {
+    (void)begin;
+    (void)length;
+}
 
 static void in_spi_irq_handler(const uint DMA_IRQ_num, io_rw_32 *dma_hw_ints_p) {
+    sd_hook_spi_irq(true);
     for (size_t i = 0; i < spi_get_num(); ++i) {
         spi_t *spi_p = spi_get_by_num(i);
         if (DMA_IRQ_num == spi_p->DMA_IRQ_num)  {
             // Is the SPI's channel requesting interrupt?
             if (*dma_hw_ints_p & (1 << spi_p->rx_dma)) {
+                bool trace = block_transfer[spi_get_index(spi_p->hw_inst)];
+                if (trace) sd_hook_spi_irq_dma(true, spi_p->rx_dma);
                 *dma_hw_ints_p = 1 << spi_p->rx_dma;  // Clear it.
                 assert(!dma_channel_is_busy(spi_p->rx_dma));
                 assert(!sem_available(&spi_p->sem));
                 bool ok = sem_release(&spi_p->sem);
                 assert(ok);
+                if (trace) sd_hook_spi_irq_dma(false, spi_p->rx_dma);
             }
         }
     }
+    sd_hook_spi_irq(false);
 }
 static void __not_in_flash_func(spi_irq_handler_0)() {
     in_spi_irq_handler(DMA_IRQ_0, &dma_hw->ints0);
@@ -107,6 +125,10 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     }
     sem_reset(&spi_p->sem, 0);
 
+    // Single bytes (commands, polling) would flood the trace: blocks only
+    block_transfer[spi_get_index(spi_p->hw_inst)] = length > 1;
+    if (length > 1) sd_hook_spi_dma(true, length);
+
     // start them exactly simultaneously to avoid races (in extreme cases
     // the FIFO could overflow)
     dma_start_channel_mask((1u << spi_p->tx_dma) | (1u << spi_p->rx_dma));
@@ -115,9 +137,11 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     uint32_t timeOut = 1000; /* Timeout 1 sec */
     bool rc = sem_acquire_timeout_ms(
         &spi_p->sem, timeOut);  // Wait for notification from ISR
+    if (length > 1) sd_hook_spi_dma(false, length);
     if (!rc) {
         // If the timeout is reached the function will return false
         DBG_PRINTF("Notification wait timed out in %s\n", __FUNCTION__);
+        spi_p->dma_timeouts++;
         return false;
     }
     // Shouldn't be necessary:
@@ -51,6 +51,7 @@ typedef struct {
     dma_channel_config rx_dma_cfg;
     irq_handler_t dma_isr; // Ignored: no longer used
     bool initialized;  
+    uint32_t dma_timeouts;  // Transfers whose DMA completion never came
     semaphore_t sem;
     mutex_t mutex;    
 } spi_t;
@@ -94,7 +94,7 @@ FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     //  const TCHAR* path, /* [IN] File name */
     //  BYTE mode          /* [IN] Mode flags */
     //);
-    FIL *fp = malloc(sizeof(FIL));
+    FIL *fp = ff_fil_alloc();
     if (!fp) {
         errno = ENOMEM;
         return NULL;
@@ -103,7 +103,7 @@ FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     errno = fresult2errno(fr);
     if (FR_OK != fr) {
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-        free(fp);
+        ff_fil_free(fp);
         fp = 0;
     }
     return fp;
@@ -117,7 +117,7 @@ int ff_fclose(FF_FILE *pxStream) {
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    free(pxStream);
+    ff_fil_free(pxStream);
     if (FR_OK == fr)
         return 0;
     else
@@ -389,7 +389,7 @@ int ff_findnext(FF_FindData_t *pxFindData) {
 }
 FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
     TRACE_PRINTF("%s\n", __func__);
-    FIL *fp = malloc(sizeof(FIL));
+    FIL *fp = ff_fil_alloc();
     if (!fp) {
         errno = ENOMEM;
         return NULL;
@@ -398,7 +398,10 @@ FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
     if (FR_OK != fr)
         printf("%s: f_open error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    if (FR_OK != fr) return NULL;
+    if (FR_OK != fr) {
+        ff_fil_free(fp);
+        return NULL;
+    }
     while (f_tell(fp) < (FSIZE_t)lTruncateSize) {
         UINT bw = 0;
         char c = 0;
@@ -406,22 +409,32 @@ FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
         if (FR_OK != fr)
             TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
         errno = fresult2errno(fr);
-        if (1 != bw) return NULL;
+        if (1 != bw) {
+            if (FR_OK == fr) {
+                fr = FR_DENIED;  // Volume full
+                errno = fresult2errno(fr);
+            }
+            break;
+        }
+    }
+    if (FR_OK == fr) {
+        fr = f_lseek(fp, lTruncateSize);
+        errno = fresult2errno(fr);
+        if (FR_OK != fr)
+            printf("%s: f_lseek error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+    }
+    if (FR_OK == fr) {
+        fr = f_truncate(fp);
+        if (FR_OK != fr)
+            printf("%s: f_truncate error: %s (%d)\n", __func__, FRESULT_str(fr),
+                   fr);
+        errno = fresult2errno(fr);
     }
-    fr = f_lseek(fp, lTruncateSize);
-    errno = fresult2errno(fr);
-    if (FR_OK != fr)
-        printf("%s: f_lseek error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    if (FR_OK != fr) return NULL;
-    fr = f_truncate(fp);
-    if (FR_OK != fr)
-        printf("%s: f_truncate error: %s (%d)\n", __func__, FRESULT_str(fr),
-               fr);
-    errno = fresult2errno(fr);
     if (FR_OK == fr)
         return fp;
-    else
-        return NULL;
+    f_close(fp);
+    ff_fil_free(fp);
+    return NULL;
 }
 int ff_seteof(FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
@@ -32,6 +32,13 @@ specific language governing permissions and limitations under the License.
 #define TRACE_PRINTF(fmt, args...)
 //#define TRACE_PRINTF printf  // task_printf
 
+// Default profiling hook (hw_config.h): none
+__attribute__((weak)) void sd_hook_disk_io(bool write, bool begin, UINT count) {
+    (void)write;
+    (void)begin;
+    (void)count;
+}
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -98,7 +105,9 @@ DRESULT disk_read(BYTE pdrv,  /* Physical drive nmuber to identify the drive */
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+    sd_hook_disk_io(false, true, count);
     int rc = p_sd->read_blocks(p_sd, buff, sector, count);
+    sd_hook_disk_io(false, false, count);
     return sdrc2dresult(rc);
 }
 
@@ -116,7 +125,9 @@ DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+    sd_hook_disk_io(true, true, count);
     int rc = p_sd->write_blocks(p_sd, buff, sector, count);
+    sd_hook_disk_io(true, false, count);
     return sdrc2dresult(rc);
 }
 
@@ -142,7 +153,7 @@ DRESULT disk_ioctl(BYTE pdrv, /* Physical drive nmuber (0..) */
                                   // volume/partition to be created. It is
                                   // required when FF_USE_MKFS == 1.
             static LBA_t n;
-            n = sd_sectors(p_sd);
+            n = p_sd->get_num_sectors(p_sd);
             *(LBA_t *)buff = n;
             if (!n) return RES_ERROR;
             return RES_OK;
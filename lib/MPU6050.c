@@ -57,11 +57,33 @@ void mpu6050_wake_up(mpu6050_t *mpu) {
 }
 
 void mpu6050_read_raw(mpu6050_t *mpu, int16_t *accel, int16_t *gyro) {
-    uint8_t buffer[14];
+    uint8_t buffer[MPU6050_BURST_LEN];
     
     // Lê todos os registros de dados de uma vez
-    mpu6050_read_registers(mpu, MPU6050_REG_ACCEL_XOUT_H, buffer, 14);
-    
+    mpu6050_read_burst(mpu, buffer);
+    mpu6050_decode_burst(buffer, accel, gyro);
+}
+
+void mpu6050_read_burst(mpu6050_t *mpu, uint8_t *dst) {
+    mpu6050_read_registers(mpu, MPU6050_REG_ACCEL_XOUT_H, dst, MPU6050_BURST_LEN);
+}
+
+bool mpu6050_read_status_burst(mpu6050_t *mpu, uint8_t *dst) {
+    uint8_t reg = MPU6050_REG_INT_STATUS;
+    if (i2c_write_blocking(mpu->i2c, mpu->addr, &reg, 1, true) != 1)
+        return false;
+    return i2c_read_blocking(mpu->i2c, mpu->addr, dst, 1 + MPU6050_BURST_LEN, false) == 1 + MPU6050_BURST_LEN;
+}
+
+bool mpu6050_probe(i2c_inst_t *i2c, uint8_t addr) {
+    uint8_t reg = MPU6050_REG_WHO_AM_I, who = 0;
+    // O WHO_AM_I não muda com o pino AD0: 0x68 também no endereço 0x69
+    if (i2c_write_timeout_us(i2c, addr, &reg, 1, true, 1000) != 1)
+        return false;
+    return i2c_read_timeout_us(i2c, addr, &who, 1, false, 1000) == 1 && MPU6050_ADDR == who;
+}
+
+void mpu6050_decode_burst(const uint8_t *buffer, int16_t *accel, int16_t *gyro) {
     // Converte os dados para inteiros de 16 bits
     accel[0] = (int16_t)((buffer[0] << 8) | buffer[1]);  // Accel X
     accel[1] = (int16_t)((buffer[2] << 8) | buffer[3]);  // Accel Y
@@ -107,4 +129,27 @@ void mpu6050_calibrate(mpu6050_t *mpu, int16_t *accel_bias, int16_t *gyro_bias,
     
     // O eixo Z do acelerômetro deve ter aproximadamente 1g (ajuste para escala 2G)
     accel_bias[2] -= (int16_t)(1.0f * mpu->accel_sensitivity);
+}
+
+// Faz o próprio sensor marcar o ritmo: com o DLPF ligado a base é 1 kHz,
+// dividida por (1 + SMPLRT_DIV), e cada amostra nova gera um pulso de 50 us
+// no pino INT (ativo em nível alto). O período pedido é um múltiplo de 1 ms
+// (1 a 256 ms), programado direto no divisor; retorna o período real em us.
+uint32_t mpu6050_enable_data_ready(mpu6050_t *mpu, uint32_t period_us) {
+    uint32_t div = period_us / 1000;
+    if (div < 1) div = 1;
+    if (div > 256) div = 256;
+    mpu6050_write_register(mpu, MPU6050_REG_CONFIG, 0x01);        // DLPF 184 Hz
+    mpu6050_write_register(mpu, MPU6050_REG_SMPLRT_DIV, div - 1);
+    mpu6050_write_register(mpu, MPU6050_REG_INT_PIN_CFG, 0x10);   // Pulso, limpa na leitura
+    mpu6050_write_register(mpu, MPU6050_REG_INT_ENABLE, 0x01);    // DATA_RDY
+    return div * 1000;
+}
+
+// Volta à taxa padrão (8 kHz, sem DLPF) usada quando os registros são lidos
+// sob demanda, como no "stream"
+void mpu6050_disable_data_ready(mpu6050_t *mpu) {
+    mpu6050_write_register(mpu, MPU6050_REG_INT_ENABLE, 0x00);
+    mpu6050_write_register(mpu, MPU6050_REG_CONFIG, 0x00);
+    mpu6050_write_register(mpu, MPU6050_REG_SMPLRT_DIV, 0x00);
 }
\ No newline at end of file
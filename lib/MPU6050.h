@@ -5,13 +5,20 @@
 #include "hardware/i2c.h"
 
 #define MPU6050_ADDR 0x68
+#define MPU6050_BURST_LEN 14  // ACCEL_XOUT_H..GYRO_ZOUT_L: acel, temperatura, giro (big-endian)
 
 // Registros do MPU6050
 #define MPU6050_REG_PWR_MGMT_1   0x6B
+#define MPU6050_REG_SMPLRT_DIV   0x19
+#define MPU6050_REG_CONFIG       0x1A
+#define MPU6050_REG_INT_PIN_CFG  0x37
+#define MPU6050_REG_INT_ENABLE   0x38
+#define MPU6050_REG_INT_STATUS   0x3A
 #define MPU6050_REG_ACCEL_CONFIG 0x1C
 #define MPU6050_REG_GYRO_CONFIG  0x1B
 #define MPU6050_REG_ACCEL_XOUT_H 0x3B
 #define MPU6050_REG_GYRO_XOUT_H  0x43
+#define MPU6050_REG_WHO_AM_I     0x75
 
 // Escalas do acelerômetro
 enum mpu6050_accel_scale {
@@ -45,7 +52,17 @@ void mpu6050_init(mpu6050_t *mpu, i2c_inst_t *i2c, uint8_t addr,
 void mpu6050_reset(mpu6050_t *mpu);
 void mpu6050_wake_up(mpu6050_t *mpu);
 void mpu6050_read_raw(mpu6050_t *mpu, int16_t *accel, int16_t *gyro);
+// Leitura dos 14 registros de dados direto em dst, sem conversão
+void mpu6050_read_burst(mpu6050_t *mpu, uint8_t *dst);
+// INT_STATUS seguido dos 14 registros de dados (15 bytes); false se o
+// sensor não respondeu
+bool mpu6050_read_status_burst(mpu6050_t *mpu, uint8_t *dst);
+// true se há um MPU6050 (WHO_AM_I 0x68) no endereço
+bool mpu6050_probe(i2c_inst_t *i2c, uint8_t addr);
+void mpu6050_decode_burst(const uint8_t *burst, int16_t *accel, int16_t *gyro);
 void mpu6050_read_calibrated(mpu6050_t *mpu, float *accel, float *gyro);
 void mpu6050_calibrate(mpu6050_t *mpu, int16_t *accel_bias, int16_t *gyro_bias, uint16_t samples);
+uint32_t mpu6050_enable_data_ready(mpu6050_t *mpu, uint32_t period_us);
+void mpu6050_disable_data_ready(mpu6050_t *mpu);
 
 #endif // MPU6050_H
\ No newline at end of file
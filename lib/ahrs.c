@@ -0,0 +1,123 @@
+#include "ahrs.h"
+#include <math.h>
+#include <string.h>
+
+#define Q30 (1 << 30)
+
+static inline int32_t mul30(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+// Raiz quadrada inteira (bit a bit)
+static uint32_t isqrt32(uint32_t v) {
+    uint32_t r = 0, bit = 1u << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+void ahrs_init(ahrs_t *a, float rate_hz, float gyro_sensitivity, float kp, float ki) {
+    memset(a, 0, sizeof *a);
+    const double dt = 1.0 / rate_hz;
+    a->q[0] = Q30;
+    a->gyro_k = llround(0.5 * dt * (M_PI / 180.0) / gyro_sensitivity * 0x1p46);
+    a->kp = (int32_t)lround(0.5 * kp * dt * 0x1p30);
+    a->ki = (int32_t)lround(0.5 * ki * dt * dt * 0x1p36);
+    // O bias estimado fica limitado a 20 graus/s
+    a->integ_max = llround(0.5 * dt * (20.0 * M_PI / 180.0) * 0x1p66);
+}
+
+// Quaternion que leva a gravidade medida ao eixo Z (guinada zero)
+static void align_to_gravity(ahrs_t *a, const int16_t accel[3]) {
+    double roll = atan2(accel[1], accel[2]);
+    double pitch = atan2(-accel[0], sqrt((double)accel[1] * accel[1] + (double)accel[2] * accel[2]));
+    double cr = cos(roll / 2), sr = sin(roll / 2), cp = cos(pitch / 2), sp = sin(pitch / 2);
+    a->q[0] = (int32_t)lround(cr * cp * 0x1p30);
+    a->q[1] = (int32_t)lround(sr * cp * 0x1p30);
+    a->q[2] = (int32_t)lround(cr * sp * 0x1p30);
+    a->q[3] = (int32_t)lround(-sr * sp * 0x1p30);
+}
+
+void ahrs_update(ahrs_t *a, const int16_t accel[3], const int16_t gyro[3]) {
+    int32_t *q = a->q;
+    const uint32_t n2 = (uint32_t)(accel[0] * accel[0]) + (uint32_t)(accel[1] * accel[1]) +
+                        (uint32_t)(accel[2] * accel[2]);
+    if (!a->started && n2) {
+        align_to_gravity(a, accel);
+        a->started = true;
+    }
+
+    // Meio ângulo girado nesta amostra, Q30
+    int32_t th[3];
+    for (int i = 0; i < 3; i++) th[i] = (int32_t)((gyro[i] * a->gyro_k) >> 16);
+
+    if (n2) {
+        // Gravidade medida, unitária em Q30
+        const int64_t inv = (1LL << 46) / isqrt32(n2);
+        int32_t u[3];
+        for (int i = 0; i < 3; i++) u[i] = (int32_t)((accel[i] * inv) >> 16);
+        // Gravidade prevista pelo quaternion (terceira linha da rotação)
+        int32_t v[3] = {
+            (int32_t)(((int64_t)q[1] * q[3] - (int64_t)q[0] * q[2]) >> 29),
+            (int32_t)(((int64_t)q[0] * q[1] + (int64_t)q[2] * q[3]) >> 29),
+            (int32_t)(((int64_t)q[0] * q[0] - (int64_t)q[1] * q[1] - (int64_t)q[2] * q[2] +
+                       (int64_t)q[3] * q[3]) >> 30),
+        };
+        // Erro = medida x prevista
+        int32_t e[3] = {
+            (int32_t)(((int64_t)u[1] * v[2] - (int64_t)u[2] * v[1]) >> 30),
+            (int32_t)(((int64_t)u[2] * v[0] - (int64_t)u[0] * v[2]) >> 30),
+            (int32_t)(((int64_t)u[0] * v[1] - (int64_t)u[1] * v[0]) >> 30),
+        };
+        for (int i = 0; i < 3; i++) {
+            if (a->ki) {
+                int64_t s = a->integ[i] + (int64_t)e[i] * a->ki;
+                if (s > a->integ_max) s = a->integ_max;
+                if (s < -a->integ_max) s = -a->integ_max;
+                a->integ[i] = s;
+            }
+            th[i] += mul30(e[i], a->kp) + (int32_t)(a->integ[i] >> 36);
+        }
+    }
+
+    // q += q (x) (0, th)
+    const int32_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] -= (int32_t)(((int64_t)q1 * th[0] + (int64_t)q2 * th[1] + (int64_t)q3 * th[2]) >> 30);
+    q[1] += (int32_t)(((int64_t)q0 * th[0] + (int64_t)q2 * th[2] - (int64_t)q3 * th[1]) >> 30);
+    q[2] += (int32_t)(((int64_t)q0 * th[1] - (int64_t)q1 * th[2] + (int64_t)q3 * th[0]) >> 30);
+    q[3] += (int32_t)(((int64_t)q0 * th[2] + (int64_t)q1 * th[1] - (int64_t)q2 * th[0]) >> 30);
+
+    // Volta à norma 1
+    int64_t norm2 = 0;
+    for (int i = 0; i < 4; i++) norm2 += (int64_t)q[i] * q[i];
+    const int32_t s = (int32_t)((3 * (int64_t)Q30 - (norm2 >> 30)) >> 1);
+    for (int i = 0; i < 4; i++) q[i] = mul30(q[i], s);
+}
+
+void ahrs_update_block(ahrs_t *a, const int16_t in[][6], size_t n) {
+    for (size_t i = 0; i < n; i++) ahrs_update(a, &in[i][0], &in[i][3]);
+}
+
+void ahrs_quaternion(const ahrs_t *a, float q[4]) {
+    for (int i = 0; i < 4; i++) q[i] = ldexpf((float)a->q[i], -30);
+}
+
+void ahrs_euler(const ahrs_t *a, float euler[3]) {
+    float q[4];
+    ahrs_quaternion(a, q);
+    const float rad2deg = 180.0f / (float)M_PI;
+    float sp = 2 * (q[0] * q[2] - q[3] * q[1]);
+    if (sp > 1) sp = 1;
+    if (sp < -1) sp = -1;
+    euler[0] = atan2f(2 * (q[0] * q[1] + q[2] * q[3]), 1 - 2 * (q[1] * q[1] + q[2] * q[2])) * rad2deg;
+    euler[1] = asinf(sp) * rad2deg;
+    euler[2] = atan2f(2 * (q[0] * q[3] + q[1] * q[2]), 1 - 2 * (q[2] * q[2] + q[3] * q[3])) * rad2deg;
+}
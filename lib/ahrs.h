@@ -0,0 +1,49 @@
+#ifndef AHRS_H
+#define AHRS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Estimador de orientação (filtro de Mahony, 6 eixos) em inteiros, para
+// rodar na taxa de aquisição sem FPU. O giroscópio integra o quaternion e o
+// acelerômetro corrige a inclinação: o erro entre a gravidade medida e a
+// prevista pelo quaternion entra como termo proporcional (kp) e integral
+// (ki, que estima o bias do giroscópio). Sem magnetômetro a guinada deriva.
+//
+// Formatos: quaternion em Q30; o giroscópio vira direto o meio ângulo
+// girado por amostra (0,5 w dt, Q30), com dt fixo pela taxa de amostragem.
+// A normalização do quaternion é um passo de Newton (q *= (3 - |q|^2) / 2),
+// que basta porque ele sai de norma 1 a cada amostra.
+//
+// Custo por amostra, contado no código: ~45 multiplicações 32x32->64, uma
+// raiz inteira de 32 bits e uma divisão 64/32, o que estima 1500 a 2000
+// ciclos no Cortex-M0+ (12 a 16 us a 125 MHz, 1,2 a 1,6% de um core a
+// 1 kHz). O "ahrs bench" mede o valor real com o SysTick.
+//
+// O ahrs_update só usa inteiros. O ahrs_init, o alinhamento à gravidade na
+// primeira amostra e as saídas (ahrs_quaternion, ahrs_euler) usam float e
+// double da libm, fora do caminho por amostra. Não depende do SDK, para ser
+// compilado também pelo tools/imu_ahrs.
+
+typedef struct {
+    int32_t q[4];        // w, x, y, z em Q30
+    int64_t integ[3];    // Termo integral, meio ângulo por amostra em Q66
+    int64_t integ_max;
+    int64_t gyro_k;      // Contagem do giroscópio -> meio ângulo, Q46
+    int32_t kp;          // 0,5 kp dt em Q30
+    int32_t ki;          // 0,5 ki dt^2 em Q36
+    bool started;        // A primeira amostra alinha o quaternion à gravidade
+} ahrs_t;
+
+// Protótipos das funções
+void ahrs_init(ahrs_t *a, float rate_hz, float gyro_sensitivity, float kp, float ki);
+// Contagens brutas do sensor (acel X/Y/Z, giro X/Y/Z)
+void ahrs_update(ahrs_t *a, const int16_t accel[3], const int16_t gyro[3]);
+// Várias amostras seguidas, no layout [acel X/Y/Z, giro X/Y/Z]
+void ahrs_update_block(ahrs_t *a, const int16_t in[][6], size_t n);
+void ahrs_quaternion(const ahrs_t *a, float q[4]);
+// Rolagem, arfagem e guinada (ZYX) em graus
+void ahrs_euler(const ahrs_t *a, float euler[3]);
+
+#endif // AHRS_H
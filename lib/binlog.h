@@ -0,0 +1,118 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Log binário das leituras cruas do sensor (arquivos .imb, "logfmt bin").
+// O arquivo é uma sequência de páginas de BINLOG_PAGE_SIZE bytes (um
+// segmento do sd_array): um cabeçalho e BINLOG_RECORDS_PER_PAGE registros
+// de BINLOG_RECORD_SIZE bytes. Cada registro tem os 32 bits baixos do
+// carimbo de tempo (little-endian) e os 14 bytes lidos do MPU6050 como
+// vieram do I2C (big-endian: acel X/Y/Z, temperatura, giro X/Y/Z). A
+// leitura I2C cai direto no registro, dentro da página que depois vai
+// inteira para o disk_write.
+//
+// O carimbo completo da primeira amostra está no cabeçalho; os seguintes
+// voltam a 64 bits por ele. Páginas com assinatura errada (sobra da
+// pré-alocação depois de uma queda de energia) encerram o arquivo. Só usa
+// stdint para compilar também no tools/imu_bin.
+//
+// Com vários sensores (lib/imu_array.h) o cabeçalho diz quantos canais há
+// (n_channels > 1) e é seguido de uma tabela binlog_channel_t por canal. O
+// registro leva o carimbo do tick comum e, para cada canal, o INT_STATUS e
+// os 14 bytes do sensor: 4 + 15 * n_channels bytes. Com n_channels 0 ou 1 a
+// página é a de um sensor só, como acima.
+
+#define BINLOG_PAGE_SIZE 4096
+#define BINLOG_MAGIC "IMB1"
+#define BINLOG_BURST_LEN 14
+#define BINLOG_RECORD_SIZE (4 + BINLOG_BURST_LEN)
+#define BINLOG_MAX_CHANNELS 8
+#define BINLOG_CHANNEL_LEN (1 + BINLOG_BURST_LEN)  // INT_STATUS + leitura
+#define BINLOG_STATUS_DATA_RDY 0x01  // Amostra nova desde a leitura anterior
+#define BINLOG_STATUS_ERROR 0x80     // Sensor não respondeu; dados inválidos
+#define BINLOG_NO_MUX 0xFF
+
+typedef struct {
+    char magic[4];           // BINLOG_MAGIC
+    uint32_t seq;            // Número da página, desde 0
+    uint64_t t0_us;          // Carimbo completo do primeiro registro
+    uint16_t n_records;
+    uint16_t record_size;    // BINLOG_RECORD_SIZE
+    float accel_lsb;         // Contagens por g
+    float gyro_lsb;          // Contagens por grau/s
+    uint8_t n_channels;      // 0 ou 1: um sensor, registro sem INT_STATUS
+    uint8_t reserved[3];
+} binlog_page_header_t;
+
+// Um sensor das páginas com vários canais
+typedef struct {
+    uint8_t bus;             // 0: i2c0, 1: i2c1
+    uint8_t addr;
+    uint8_t mux_channel;     // Canal do TCA9548A, ou BINLOG_NO_MUX
+    uint8_t reserved;
+    int16_t accel_bias[3];   // Calibração em contagens, a subtrair
+    int16_t gyro_bias[3];
+    uint16_t read_offset_us; // Atraso médio da leitura depois do tick
+    uint16_t reserved2;
+} binlog_channel_t;
+
+#define BINLOG_RECORDS_PER_PAGE ((BINLOG_PAGE_SIZE - sizeof(binlog_page_header_t)) / BINLOG_RECORD_SIZE)
+
+static inline unsigned binlog_record_size(unsigned n_channels) {
+    return n_channels > 1 ? 4 + n_channels * BINLOG_CHANNEL_LEN : BINLOG_RECORD_SIZE;
+}
+
+// Onde começam os registros: depois do cabeçalho e da tabela de canais
+static inline size_t binlog_records_offset(unsigned n_channels) {
+    return sizeof(binlog_page_header_t) + (n_channels > 1 ? n_channels * sizeof(binlog_channel_t) : 0);
+}
+
+static inline unsigned binlog_records_per_page(unsigned n_channels) {
+    return (unsigned)((BINLOG_PAGE_SIZE - binlog_records_offset(n_channels)) / binlog_record_size(n_channels));
+}
+
+// Começa uma página nova em "page", com a tabela de canais zerada
+static inline void binlog_page_begin(uint8_t *page, uint32_t seq, uint64_t t0_us, float accel_lsb,
+                                     float gyro_lsb, unsigned n_channels) {
+    binlog_page_header_t h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, BINLOG_MAGIC, 4);
+    h.seq = seq;
+    h.t0_us = t0_us;
+    h.record_size = (uint16_t)binlog_record_size(n_channels);
+    h.accel_lsb = accel_lsb;
+    h.gyro_lsb = gyro_lsb;
+    h.n_channels = n_channels > 1 ? (uint8_t)n_channels : 0;
+    memcpy(page, &h, sizeof h);
+    memset(page + sizeof h, 0, binlog_records_offset(n_channels) - sizeof h);
+}
+
+// Preenche a tabela de canais (páginas com n_channels > 1)
+static inline void binlog_page_channels(uint8_t *page, const binlog_channel_t *ch, unsigned n_channels) {
+    memcpy(page + sizeof(binlog_page_header_t), ch, n_channels * sizeof *ch);
+}
+
+// Registro n da página: grava o carimbo e devolve onde vão os bytes dos
+// sensores (14, ou 15 por canal)
+static inline uint8_t *binlog_record(uint8_t *page, unsigned n_channels, unsigned n, uint64_t t_us) {
+    uint8_t *rec = page + binlog_records_offset(n_channels) + n * binlog_record_size(n_channels);
+    uint32_t t = (uint32_t)t_us;
+    rec[0] = (uint8_t)t;
+    rec[1] = (uint8_t)(t >> 8);
+    rec[2] = (uint8_t)(t >> 16);
+    rec[3] = (uint8_t)(t >> 24);
+    return rec + 4;
+}
+
+// Fecha a página com n registros e zera o resto
+static inline void binlog_page_end(uint8_t *page, unsigned n_channels, unsigned n) {
+    uint16_t n16 = (uint16_t)n;
+    memcpy(page + offsetof(binlog_page_header_t, n_records), &n16, sizeof n16);
+    size_t used = binlog_records_offset(n_channels) + n * binlog_record_size(n_channels);
+    memset(page + used, 0, BINLOG_PAGE_SIZE - used);
+}
+
+#endif // BINLOG_H
@@ -0,0 +1,103 @@
+#include "bulk_xfer.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "f_util.h"
+#include "cdc_out.h"
+
+// Tabela do CRC-32 (IEEE 802.3, polinômio refletido 0xEDB88320), montada
+// na primeira chamada para não ocupar flash
+static uint32_t crc_table[256];
+
+uint32_t bulk_crc32(uint32_t crc, const void *data, size_t len) {
+    if (!crc_table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+    }
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--)
+        crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_le(uint8_t *p, uint64_t v, int n) {
+    for (int i = 0; i < n; i++, v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+// Quadro montado inteiro, para sair numa chamada só (cdc_out.h). Os dados
+// ficam alinhados em 4 bytes logo depois do cabeçalho.
+static uint8_t frame[BULK_XFER_HDR_SIZE + BULK_XFER_CHUNK + 4] __attribute__((aligned(4)));
+#define FRAME_DATA (frame + BULK_XFER_HDR_SIZE)
+
+// Envia o quadro com os len bytes já em FRAME_DATA, esperando o PC
+static void send_frame(bulk_frame_type_t type, uint64_t offset, uint32_t len) {
+    memset(frame, 0, BULK_XFER_HDR_SIZE);
+    put_le(frame, BULK_XFER_MAGIC, 4);
+    frame[4] = (uint8_t)type;
+    put_le(frame + 8, offset, 8);
+    put_le(frame + 16, len, 4);
+    put_le(FRAME_DATA + len, bulk_crc32(0, frame, BULK_XFER_HDR_SIZE + len), 4);
+    cdc_out_frame(frame, BULK_XFER_HDR_SIZE + len + 4, false);
+}
+
+static void send_error(uint64_t offset, const char *msg) {
+    size_t n = strlen(msg);
+    if (n > BULK_XFER_CHUNK) n = BULK_XFER_CHUNK;
+    memcpy(FRAME_DATA, msg, n);
+    send_frame(BULK_FRAME_ERROR, offset, (uint32_t)n);
+}
+
+// Envia len bytes do arquivo a partir de offset (len = 0: até o fim).
+// O primeiro quadro vai só até o próximo limite de BULK_XFER_CHUNK; daí em
+// diante cada f_read cobre setores inteiros e o FatFs lê direto no quadro,
+// sem passar pela janela de setor do FIL.
+FRESULT bulk_xfer_send_file(const char *path, uint64_t offset, uint64_t len) {
+    FIL fil;
+
+    cdc_out_begin();
+    FRESULT fr = f_open(&fil, path, FA_READ);
+    if (FR_OK != fr) {
+        send_error(offset, FRESULT_str(fr));
+        cdc_out_end();
+        return fr;
+    }
+    uint64_t size = f_size(&fil);
+    if (offset > size) offset = size;
+    if (!len || len > size - offset) len = size - offset;
+    fr = f_lseek(&fil, offset);
+    if (FR_OK != fr) {
+        send_error(offset, FRESULT_str(fr));
+        f_close(&fil);
+        cdc_out_end();
+        return fr;
+    }
+
+    put_le(FRAME_DATA, size, 8);
+    put_le(FRAME_DATA + 8, len, 8);
+    send_frame(BULK_FRAME_INFO, offset, 16);
+
+    uint64_t end = offset + len;
+    while (offset < end) {
+        UINT n = BULK_XFER_CHUNK - (UINT)(offset % BULK_XFER_CHUNK);
+        if (n > end - offset) n = (UINT)(end - offset);
+        UINT br;
+        fr = f_read(&fil, FRAME_DATA, n, &br);
+        if (FR_OK != fr || br != n) {
+            if (FR_OK == fr) fr = FR_INT_ERR;  // Arquivo encolheu durante o envio
+            send_error(offset, FRESULT_str(fr));
+            break;
+        }
+        send_frame(BULK_FRAME_DATA, offset, n);
+        offset += n;
+    }
+    if (FR_OK == fr)
+        send_frame(BULK_FRAME_END, offset, 0);
+    f_close(&fil);
+    cdc_out_end();
+    return fr;
+}
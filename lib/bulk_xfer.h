@@ -0,0 +1,28 @@
+#ifndef BULK_XFER_H
+#define BULK_XFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Protocolo de download binário pela CDC (comando "get"). Cada quadro é:
+//   magic u32 | tipo u8 | reservado u8[3] | offset u64 | tamanho u32 |
+//   dados[tamanho] | crc32 u32 (do cabeçalho + dados)
+// Todos os campos em little-endian. O leitor no PC (tools/imu_get.cpp)
+// precisa seguir exatamente este formato.
+#define BULK_XFER_MAGIC 0x42554D49u  // "IMUB"
+#define BULK_XFER_HDR_SIZE 20
+#define BULK_XFER_CHUNK 4096         // Múltiplo do setor; alinhado no arquivo
+
+typedef enum {
+    BULK_FRAME_INFO = 1,   // dados: tamanho do arquivo u64 + bytes a enviar u64
+    BULK_FRAME_DATA = 2,   // dados: trecho do arquivo a partir de offset
+    BULK_FRAME_END = 3,    // sem dados; offset = fim do trecho enviado
+    BULK_FRAME_ERROR = 4   // dados: mensagem de erro (texto)
+} bulk_frame_type_t;
+
+// Protótipos das funções
+uint32_t bulk_crc32(uint32_t crc, const void *data, size_t len);
+FRESULT bulk_xfer_send_file(const char *path, uint64_t offset, uint64_t len);
+
+#endif // BULK_XFER_H
@@ -44,4 +44,48 @@ void play_alarm_rain() {
     set_buzzer_tone(BUZZER_B, G4);
     sleep_ms(300);
     stop_buzzer(BUZZER_B);
-}
\ No newline at end of file
+}
+
+static struct {
+    const buzzer_note_t *notes;
+    uint count, next;
+    uint gpio;
+    uint64_t until_us;  // Fim da nota atual
+} seq;
+
+static void seq_start_note(void) {
+    const buzzer_note_t *n = &seq.notes[seq.next++];
+    if (n->freq)
+        set_buzzer_tone(seq.gpio, n->freq);
+    else
+        stop_buzzer(seq.gpio);
+    seq.until_us = time_us_64() + n->ms * 1000u;
+}
+
+void buzzer_play(uint gpio, const buzzer_note_t *notes, uint count) {
+    if (seq.notes && seq.gpio != gpio)
+        stop_buzzer(seq.gpio);
+    seq.notes = count ? notes : NULL;
+    seq.count = count;
+    seq.next = 0;
+    seq.gpio = gpio;
+    if (seq.notes)
+        seq_start_note();
+    else
+        stop_buzzer(gpio);
+}
+
+void buzzer_poll(void) {
+    if (!seq.notes || time_us_64() < seq.until_us)
+        return;
+    if (seq.next < seq.count) {
+        seq_start_note();
+    } else {
+        stop_buzzer(seq.gpio);
+        seq.notes = NULL;
+    }
+}
+
+bool buzzer_busy(void) {
+    return seq.notes != NULL;
+}
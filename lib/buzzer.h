@@ -18,11 +18,23 @@
 #define E5 660   // Mi5
 #define G5 784   // Sol5
 
+// Sequência de notas tocada sem bloquear (buzzer_play + buzzer_poll)
+typedef struct {
+    uint16_t freq;  // Hz; 0 = pausa
+    uint16_t ms;
+} buzzer_note_t;
+
 // Protótipos
 void init_buzzer_pwm(uint gpio);
 void set_buzzer_tone(uint gpio, uint freq);
 void stop_buzzer(uint gpio);
 void play_alarm_critic(void);  // Alarme para condições críticas
 void play_alarm_rain(void);    // Alarme para chuva
+// Começa a tocar as notas (o vetor precisa continuar válido) e volta na hora;
+// buzzer_poll, chamado no laço principal e na captura, avança a sequência.
+// Uma sequência nova substitui a que estiver tocando.
+void buzzer_play(uint gpio, const buzzer_note_t *notes, uint count);
+void buzzer_poll(void);
+bool buzzer_busy(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include "cdc_out.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+
+void cdc_out_begin(void) {
+    stdio_flush();
+    stdio_filter_driver(&stdio_usb);
+}
+
+void cdc_out_end(void) {
+    stdio_flush();
+    stdio_filter_driver(NULL);
+}
+
+// O teste de espaço fica fora da trava: se um printf ocupar a FIFO entre o
+// teste e o envio, o quadro espera como o printf esperaria
+bool cdc_out_frame(const void *frame, size_t len, bool drop) {
+    if (drop && tud_cdc_write_available() < len)
+        return false;
+    stdio_put_string(frame, (int)len, false, false);
+    return true;
+}
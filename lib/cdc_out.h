@@ -0,0 +1,22 @@
+#ifndef CDC_OUT_H
+#define CDC_OUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Saída binária pela CDC, comum aos protocolos com quadros ("get" em
+// bulk_xfer.c e "stream" em imu_stream.c). Cada quadro sai numa única
+// chamada ao stdio, sem a troca de '\n' por "\r\n" e com a mesma trava do
+// printf: texto de outra parte do firmware nunca cai no meio de um quadro.
+
+// Protótipos das funções
+// Entre o begin e o end o stdio só escreve na USB: a UART não acompanharia
+// a taxa e não deve receber binário
+void cdc_out_begin(void);
+void cdc_out_end(void);
+// Envia o quadro inteiro. Com drop, se a FIFO da CDC não tiver espaço para
+// ele todo, o quadro é descartado (retorna false) em vez de esperar o PC;
+// sem drop, espera como o printf (quadros maiores que a FIFO também).
+bool cdc_out_frame(const void *frame, size_t len, bool drop);
+
+#endif // CDC_OUT_H
@@ -0,0 +1,175 @@
+#include "config.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum { KEY_U32, KEY_BOOL, KEY_NAME } key_type_t;
+
+typedef struct {
+    const char *name;
+    key_type_t type;
+    size_t offset;
+    uint32_t min, max;
+    const uint32_t *choices;  // Valores aceitos (terminados em 0), ou NULL
+} config_key_t;
+
+static const uint32_t accel_ranges[] = {2, 4, 8, 16, 0};
+static const uint32_t gyro_ranges[] = {250, 500, 1000, 2000, 0};
+
+static const config_key_t keys[] = {
+    {"amostras", KEY_U32, offsetof(config_t, samples), 1, 1000000, NULL},
+    {"intervalo_ms", KEY_U32, offsetof(config_t, interval_ms), 1, 250, NULL},
+    {"arquivo", KEY_NAME, offsetof(config_t, filename_base), 1, CONFIG_NAME_LEN - 1, NULL},
+    {"acel_g", KEY_U32, offsetof(config_t, accel_range_g), 0, 0, accel_ranges},
+    {"giro_dps", KEY_U32, offsetof(config_t, gyro_range_dps), 0, 0, gyro_ranges},
+    {"spi_hz", KEY_U32, offsetof(config_t, spi_hz), 400000, 31250000, NULL},
+    {"alarme", KEY_BOOL, offsetof(config_t, alarm), 0, 1, NULL},
+    {"alarme_ms", KEY_U32, offsetof(config_t, alarm_ms), 50, 5000, NULL},
+};
+
+void config_defaults(config_t *c) {
+    memset(c, 0, sizeof *c);
+    c->samples = 1000;
+    c->interval_ms = 100;
+    strcpy(c->filename_base, "medicoes_imu");
+    c->accel_range_g = 2;
+    c->gyro_range_dps = 250;
+    c->spi_hz = 1000 * 1000;  // O mesmo do hw_config.c
+    c->alarm = false;
+    c->alarm_ms = 500;
+}
+
+static const config_key_t *find_key(const char *name) {
+    for (size_t i = 0; i < count_of(keys); i++)
+        if (0 == strcmp(keys[i].name, name))
+            return &keys[i];
+    return NULL;
+}
+
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s))
+        s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+    return s;
+}
+
+int config_set(config_t *c, const char *key, const char *value) {
+    const config_key_t *k = find_key(key);
+    if (!k)
+        return CONFIG_ERR_KEY;
+    void *field = (char *)c + k->offset;
+    switch (k->type) {
+        case KEY_U32: {
+            char *end;
+            unsigned long v = strtoul(value, &end, 0);
+            if (end == value || *end || v > UINT32_MAX)
+                return CONFIG_ERR_VALUE;
+            if (k->choices) {
+                const uint32_t *p = k->choices;
+                while (*p && *p != v)
+                    p++;
+                if (!*p)
+                    return CONFIG_ERR_VALUE;
+            } else if (v < k->min || v > k->max) {
+                return CONFIG_ERR_VALUE;
+            }
+            *(uint32_t *)field = (uint32_t)v;
+            break;
+        }
+        case KEY_BOOL:
+            if (0 == strcmp(value, "on") || 0 == strcmp(value, "1"))
+                *(bool *)field = true;
+            else if (0 == strcmp(value, "off") || 0 == strcmp(value, "0"))
+                *(bool *)field = false;
+            else
+                return CONFIG_ERR_VALUE;
+            break;
+        case KEY_NAME: {
+            // Só o que não precisa de nome longo nem escape: letras, dígitos, _ e -
+            size_t len = strlen(value);
+            if (len < k->min || len > k->max)
+                return CONFIG_ERR_VALUE;
+            for (const char *p = value; *p; p++)
+                if (!isalnum((unsigned char)*p) && *p != '_' && *p != '-')
+                    return CONFIG_ERR_VALUE;
+            strcpy((char *)field, value);
+            break;
+        }
+    }
+    return CONFIG_OK;
+}
+
+int config_get(const config_t *c, const char *key, char *buf, size_t size) {
+    const config_key_t *k = find_key(key);
+    if (!k)
+        return -1;
+    const void *field = (const char *)c + k->offset;
+    switch (k->type) {
+        case KEY_U32:
+            return snprintf(buf, size, "%lu", (unsigned long)*(const uint32_t *)field);
+        case KEY_BOOL:
+            return snprintf(buf, size, "%s", *(const bool *)field ? "on" : "off");
+        case KEY_NAME:
+            return snprintf(buf, size, "%s", (const char *)field);
+    }
+    return -1;
+}
+
+int config_load(config_t *c, const char *path) {
+    FIL fil;
+    if (FR_OK != f_open(&fil, path, FA_READ))
+        return -1;
+    char line[96];
+    int line_no = 0, n = 0;
+    while (f_gets(line, sizeof line, &fil)) {
+        line_no++;
+        line[strcspn(line, "#;")] = '\0';
+        char *s = trim(line);
+        if (!*s || *s == '[')
+            continue;
+        char *eq = strchr(s, '=');
+        if (!eq) {
+            printf("%s:%d: falta o '='\n", path, line_no);
+            continue;
+        }
+        *eq = '\0';
+        char *key = trim(s), *value = trim(eq + 1);
+        int rc = config_set(c, key, value);
+        if (CONFIG_ERR_KEY == rc)
+            printf("%s:%d: chave desconhecida \"%s\"\n", path, line_no, key);
+        else if (CONFIG_ERR_VALUE == rc)
+            printf("%s:%d: valor inválido para %s: \"%s\"\n", path, line_no, key, value);
+        else
+            n++;
+    }
+    f_close(&fil);
+    return n;
+}
+
+FRESULT config_save(const config_t *c, const char *path) {
+    FIL fil;
+    FRESULT fr = f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE);
+    if (FR_OK != fr)
+        return fr;
+    char value[24];
+    if (f_puts("# Configuração do datalogger (comando config)\n", &fil) < 0)
+        fr = FR_DISK_ERR;
+    for (size_t i = 0; FR_OK == fr && i < count_of(keys); i++) {
+        config_get(c, keys[i].name, value, sizeof value);
+        if (f_printf(&fil, "%s = %s\n", keys[i].name, value) < 0)
+            fr = FR_DISK_ERR;
+    }
+    FRESULT fr_close = f_close(&fil);
+    return FR_OK == fr ? fr_close : fr;
+}
+
+void config_print(const config_t *c) {
+    char value[24];
+    for (size_t i = 0; i < count_of(keys); i++) {
+        config_get(c, keys[i].name, value, sizeof value);
+        printf("  %-13s = %s\n", keys[i].name, value);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "ff.h"
+
+// Configuração do datalogger num arquivo INI do cartão (CONFIG_FILE), lido
+// ao montar: uma "chave = valor" por linha, '#' ou ';' comentam e seções
+// [...] são ignoradas. Chaves desconhecidas ou valores fora da faixa são
+// avisados e ficam com o valor anterior. O arquivo é lido uma vez para a
+// struct; a captura, o sensor, o SPI dos cartões e o alarme usam a struct.
+//
+//   amostras = 1000      Amostras por captura (sem decimação)
+//   intervalo_ms = 100   Período de amostragem (1 a 250 ms)
+//   arquivo = medicoes_imu
+//   acel_g = 2           Escala do acelerômetro: 2, 4, 8 ou 16
+//   giro_dps = 250       Escala do giroscópio: 250, 500, 1000 ou 2000
+//   spi_hz = 1000000     Clock SPI dos cartões depois da inicialização
+//   alarme = off         Detecção de eventos ligada ao montar
+//   alarme_ms = 500      Duração de cada bipe do alarme de erro
+
+#define CONFIG_FILE "config.ini"
+#define CONFIG_NAME_LEN 13  // Base do nome do arquivo de log, com o '\0'
+
+typedef struct {
+    uint32_t samples;
+    uint32_t interval_ms;
+    char filename_base[CONFIG_NAME_LEN];
+    uint32_t accel_range_g;
+    uint32_t gyro_range_dps;
+    uint32_t spi_hz;
+    bool alarm;
+    uint32_t alarm_ms;
+} config_t;
+
+#define CONFIG_OK 0
+#define CONFIG_ERR_KEY (-1)
+#define CONFIG_ERR_VALUE (-2)
+
+// Protótipos das funções
+void config_defaults(config_t *c);
+// Lê o arquivo por cima da configuração atual; retorna quantas chaves leu
+// ou -1 se não abriu o arquivo
+int config_load(config_t *c, const char *path);
+FRESULT config_save(const config_t *c, const char *path);
+// Altera uma chave a partir do texto; retorna CONFIG_OK ou CONFIG_ERR_*
+int config_set(config_t *c, const char *key, const char *value);
+// Valor de uma chave como texto, como snprintf (-1 se a chave não existe)
+int config_get(const config_t *c, const char *key, char *buf, size_t size);
+void config_print(const config_t *c);
+
+#endif // CONFIG_H
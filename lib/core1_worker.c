@@ -0,0 +1,60 @@
+#include "core1_worker.h"
+#include "pico/multicore.h"
+#include "pico/util/queue.h"
+#include "hardware/sync.h"
+#include "trace.h"
+#include "cpu_load.h"
+
+// Fila de ponteiros de trabalho do core0 para o core1. A FIFO de hardware
+// entre os cores só carrega 32 bits, o que não cabe um ponteiro no build host.
+static queue_t job_queue;
+static volatile uint64_t busy_us;  // Tempo total executando trabalhos
+
+// Laço do core1: executa os trabalhos na ordem em que chegam pela fila
+static void core1_main(void) {
+    cpu_load_init_core();
+    while (true) {
+        core1_job_t *job;
+        CPU_IDLE_BEGIN();
+        queue_remove_blocking(&job_queue, &job);
+        CPU_IDLE_END();
+        uint64_t t0 = time_us_64();
+        TRACE_BEGIN(TRACE_CORE1_JOB, 0);
+        CPU_TASK_BEGIN(CPU_TASK_CORE1_JOB);
+        job->fn(job->arg);
+        CPU_TASK_END(CPU_TASK_CORE1_JOB);
+        TRACE_END(TRACE_CORE1_JOB, 0);
+        busy_us += time_us_64() - t0;
+        __dmb();
+        job->done = true;
+        __sev();  // Acorda o core0 se estiver esperando em __wfe()
+    }
+}
+
+void core1_worker_init(void) {
+    static bool launched = false;
+    if (!launched) {
+        queue_init(&job_queue, sizeof(core1_job_t *), 4);
+        multicore_launch_core1(core1_main);
+        launched = true;
+    }
+}
+
+void core1_worker_post(core1_job_t *job) {
+    job->done = false;
+    __dmb();
+    queue_add_blocking(&job_queue, &job);
+}
+
+uint64_t core1_worker_busy_us(void) {
+    return busy_us;
+}
+
+void core1_worker_wait(core1_job_t *job) {
+    CPU_IDLE_BEGIN();
+    while (!job->done) {
+        __wfe();
+    }
+    CPU_IDLE_END();
+    __dmb();
+}
@@ -0,0 +1,21 @@
+#ifndef CORE1_WORKER_H
+#define CORE1_WORKER_H
+
+#include "pico/stdlib.h"
+
+// Trabalho a ser executado no core1. O core0 preenche fn/arg, posta e depois
+// espera por done; o core1 executa um trabalho por vez, na ordem de chegada.
+typedef struct {
+    void (*fn)(void *arg);
+    void *arg;
+    volatile bool done;
+} core1_job_t;
+
+// Protótipos das funções
+void core1_worker_init(void);
+void core1_worker_post(core1_job_t *job);
+void core1_worker_wait(core1_job_t *job);
+// Tempo acumulado do core1 executando trabalhos (o resto ele passa dormindo)
+uint64_t core1_worker_busy_us(void);
+
+#endif // CORE1_WORKER_H
@@ -0,0 +1,327 @@
+#include "cpu_load.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "ff.h"
+
+// Padrão pintado nas pilhas; a marca d'água é a primeira palavra alterada
+#define STACK_PAINT 0xC0DEFACEu
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+#endif
+
+#if PICO_ON_DEVICE
+// Limites definidos pelo linker script do SDK (memmap_default.ld)
+extern uint32_t __StackBottom, __StackTop, __StackOneBottom, __StackOneTop;
+extern char __end__, __StackLimit;
+#define STACK_PAINT_MARGIN 16     // Palavras poupadas abaixo do quadro atual
+#else
+// No build host as pilhas são das threads: mede só o que cresce abaixo do
+// ponto onde cpu_load_init_core foi chamada, numa janela de 16 KiB
+#define HOST_STACK_WINDOW (16 * 1024)
+#define STACK_PAINT_MARGIN 256    // Zona vermelha do x86-64 e folga
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define NO_ASAN
+#endif
+
+typedef struct {
+    volatile uint32_t seq;       // Ímpar enquanto o próprio core atualiza
+    bool started;
+    uint8_t stack[CPU_TASK_DEPTH];
+    uint64_t began[CPU_TASK_DEPTH];
+    int depth;
+    int overflow;                // Aninhamentos além de CPU_TASK_DEPTH
+    uint64_t seg_start;          // Início do trecho cobrado da tarefa do topo
+    uint64_t seg_isr;            // isr_us no início do trecho
+    int isr_nest;
+    uint64_t isr_start;
+    uint32_t gen;                // Janela a que os máximos se referem
+    cpu_core_stats_t s;          // Acumulado desde o boot (exceto os máximos)
+    uint32_t *stack_lo, *stack_hi;
+} core_state_t;
+
+static core_state_t cores[2];
+static volatile uint32_t window_gen;
+
+// Estado do leitor (core0)
+static cpu_core_stats_t last[2];
+static uint64_t last_sample_us;
+
+static const char *const task_names[CPU_TASK_COUNT] = {
+    [CPU_TASK_OTHER] = "outros",
+    [CPU_TASK_IDLE] = "ocioso",
+    [CPU_TASK_CONSOLE] = "console",
+    [CPU_TASK_CAPTURE] = "captura",
+    [CPU_TASK_IMU] = "imu",
+    [CPU_TASK_DISPLAY] = "display",
+    [CPU_TASK_STREAM] = "stream",
+    [CPU_TASK_USB] = "usb",
+    [CPU_TASK_CORE1_JOB] = "core1_job",
+};
+
+// O outro core lê o estado sem travas: a contagem ímpar em seq indica
+// atualização em andamento e ele tenta de novo
+static inline void update_begin(core_state_t *c) {
+    c->seq++;
+    __dmb();
+    if (c->gen != window_gen) {
+        c->gen = window_gen;
+        c->s.isr_max_us = 0;
+        for (int i = 0; i < CPU_TASK_COUNT; i++) c->s.task[i].max_us = 0;
+    }
+}
+
+static inline void update_end(core_state_t *c) {
+    __dmb();
+    c->seq++;
+}
+
+// Cobra da tarefa do topo o tempo desde o início do trecho, sem as ISRs
+static void charge(core_state_t *c, uint64_t now) {
+    uint64_t spent = now - c->seg_start;
+    uint64_t isr = c->s.isr_us - c->seg_isr;
+    c->s.task[c->stack[c->depth - 1]].run_us += spent > isr ? spent - isr : 0;
+    c->seg_start = now;
+    c->seg_isr = c->s.isr_us;
+}
+
+static void __attribute__((noinline)) NO_ASAN paint_stack(core_state_t *c, uint core) {
+    uint32_t *frame = (uint32_t *)__builtin_frame_address(0);
+#if PICO_ON_DEVICE
+    c->stack_lo = core ? &__StackOneBottom : &__StackBottom;
+    c->stack_hi = core ? &__StackOneTop : &__StackTop;
+#else
+    (void)core;
+    c->stack_hi = frame;
+    c->stack_lo = frame - HOST_STACK_WINDOW / sizeof(uint32_t);
+#endif
+    // Uma interrupção no meio usaria a pilha abaixo do quadro atual
+    uint32_t irq = save_and_disable_interrupts();
+    for (volatile uint32_t *p = c->stack_lo; p < frame - STACK_PAINT_MARGIN; p++)
+        *p = STACK_PAINT;
+    restore_interrupts(irq);
+}
+
+static uint32_t NO_ASAN stack_used(const core_state_t *c) {
+    if (!c->stack_lo) return 0;
+    const volatile uint32_t *p = c->stack_lo;
+    while (p < c->stack_hi && STACK_PAINT == *p) p++;
+    return (uint32_t)((uintptr_t)c->stack_hi - (uintptr_t)p);
+}
+
+void cpu_load_init_core(void) {
+    uint core = get_core_num();
+    core_state_t *c = &cores[core];
+    paint_stack(c, core);
+    c->stack[0] = CPU_TASK_OTHER;
+    c->depth = 1;
+    c->seg_start = time_us_64();
+    c->gen = window_gen;
+    __dmb();
+    c->started = true;
+}
+
+void __not_in_flash_func(cpu_task_begin)(cpu_task_t t) {
+    core_state_t *c = &cores[get_core_num()];
+    if (!c->started) return;
+    uint32_t irq = save_and_disable_interrupts();
+    update_begin(c);
+    if (CPU_TASK_DEPTH == c->depth) {
+        c->overflow++;
+    } else {
+        uint64_t now = time_us_64();
+        charge(c, now);
+        c->stack[c->depth] = (uint8_t)t;
+        c->began[c->depth++] = now;
+        c->s.task[t].calls++;
+    }
+    update_end(c);
+    restore_interrupts(irq);
+}
+
+void __not_in_flash_func(cpu_task_end)(cpu_task_t t) {
+    core_state_t *c = &cores[get_core_num()];
+    if (!c->started) return;
+    uint32_t irq = save_and_disable_interrupts();
+    update_begin(c);
+    if (c->overflow) {
+        c->overflow--;
+    } else if (c->depth > 1 && c->stack[c->depth - 1] == t) {
+        uint64_t now = time_us_64();
+        charge(c, now);
+        uint32_t d = (uint32_t)(now - c->began[--c->depth]);
+        if (d > c->s.task[t].max_us) c->s.task[t].max_us = d;
+    }
+    update_end(c);
+    restore_interrupts(irq);
+}
+
+void __not_in_flash_func(cpu_isr_enter)(void) {
+    core_state_t *c = &cores[get_core_num()];
+    if (!c->started) return;
+    uint32_t irq = save_and_disable_interrupts();
+    if (0 == c->isr_nest++) c->isr_start = time_us_64();
+    restore_interrupts(irq);
+}
+
+void __not_in_flash_func(cpu_isr_exit)(void) {
+    core_state_t *c = &cores[get_core_num()];
+    if (!c->started) return;
+    uint32_t irq = save_and_disable_interrupts();
+    if (c->isr_nest && 0 == --c->isr_nest) {
+        update_begin(c);
+        uint32_t d = (uint32_t)(time_us_64() - c->isr_start);
+        c->s.isr_us += d;
+        c->s.isr_count++;
+        if (d > c->s.isr_max_us) c->s.isr_max_us = d;
+        update_end(c);
+    }
+    restore_interrupts(irq);
+}
+
+// Cópia consistente do estado de um core, mesmo que ele esteja rodando
+static void read_core(const core_state_t *c, core_state_t *copy) {
+    uint32_t seq;
+    do {
+        while ((seq = c->seq) & 1) tight_loop_contents();
+        __dmb();
+        memcpy(copy, (const void *)c, sizeof *copy);
+        __dmb();
+    } while (c->seq != seq);
+}
+
+void cpu_load_sample(cpu_load_report_t *out) {
+    memset(out, 0, sizeof *out);
+    uint64_t now = time_us_64();
+    out->window_us = now - last_sample_us;
+    for (int i = 0; i < 2; i++) {
+        core_state_t c;
+        read_core(&cores[i], &c);
+        if (!c.started) continue;
+
+        // Inclui o trecho em andamento na tarefa do topo
+        cpu_core_stats_t cur = c.s;
+        if (now > c.seg_start) {
+            uint64_t spent = now - c.seg_start, isr = c.s.isr_us - c.seg_isr;
+            cur.task[c.stack[c.depth - 1]].run_us += spent > isr ? spent - isr : 0;
+        }
+        // Core que não se mexeu na janela ainda guarda os máximos da anterior
+        bool stale = c.gen != window_gen;
+
+        cpu_core_stats_t *o = &out->core[i];
+        o->isr_us = cur.isr_us - last[i].isr_us;
+        o->isr_count = cur.isr_count - last[i].isr_count;
+        o->isr_max_us = stale ? 0 : cur.isr_max_us;
+        for (int t = 0; t < CPU_TASK_COUNT; t++) {
+            o->task[t].run_us = cur.task[t].run_us - last[i].task[t].run_us;
+            o->task[t].calls = cur.task[t].calls - last[i].task[t].calls;
+            o->task[t].max_us = stale ? 0 : cur.task[t].max_us;
+        }
+        o->stack_size = (uint32_t)((uintptr_t)c.stack_hi - (uintptr_t)c.stack_lo);
+        o->stack_used = stack_used(&cores[i]);
+        last[i] = cur;
+    }
+    last_sample_us = now;
+    window_gen++;
+
+#if PICO_ON_DEVICE
+    struct mallinfo mi = mallinfo();
+    out->heap_size = (uint32_t)(&__StackLimit - &__end__);
+#else
+    struct mallinfo2 mi = mallinfo2();
+#endif
+    out->heap_used = (uint32_t)mi.uordblks;
+    out->heap_arena = (uint32_t)mi.arena;
+#if FF_USE_LFN == 3
+    UINT in_use, peak;
+    DWORD allocs;
+    ff_memusage(&in_use, &peak, &allocs);
+    out->ff_in_use = in_use;
+    out->ff_peak = peak;
+    out->ff_allocs = allocs;
+#endif
+    ff_poolstats(&out->ff_pool);
+}
+
+static double pct(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+void cpu_load_print(const cpu_load_report_t *r) {
+    printf("Carga de CPU nos últimos %.1f s:\n", r->window_us / 1e6);
+    printf("  core  ocupado  ISR (n, máx us)          pilha usada\n");
+    for (int i = 0; i < 2; i++) {
+        const cpu_core_stats_t *c = &r->core[i];
+        if (!c->stack_size) {
+            printf("  %4d  parado\n", i);
+            continue;
+        }
+        // Soma em vez de janela - ocioso: o core1 pode ter partido no meio dela
+        uint64_t busy = c->isr_us;
+        for (int t = 0; t < CPU_TASK_COUNT; t++)
+            if (CPU_TASK_IDLE != t) busy += c->task[t].run_us;
+        char isr[32];
+        snprintf(isr, sizeof isr, "%.1f%% (%lu, %lu)", pct(c->isr_us, r->window_us),
+                 (unsigned long)c->isr_count, (unsigned long)c->isr_max_us);
+        printf("  %4d  %6.1f%%  %-23s  %lu/%lu B (%.0f%%)%s\n", i, pct(busy, r->window_us), isr,
+               (unsigned long)c->stack_used, (unsigned long)c->stack_size,
+               pct(c->stack_used, c->stack_size),
+               c->stack_used >= c->stack_size ? " ESTOUROU?" : "");
+    }
+    printf("  tarefa      core  tempo(ms)    CPU%%  chamadas   máx(us)\n");
+    for (int i = 0; i < 2; i++) {
+        const cpu_core_stats_t *c = &r->core[i];
+        if (!c->stack_size) continue;
+        for (int t = 0; t < CPU_TASK_COUNT; t++) {
+            const cpu_task_stats_t *k = &c->task[t];
+            if (!k->run_us && !k->calls) continue;
+            printf("  %-10s  %4d  %9.1f  %6.1f  %8lu  %8lu\n", task_names[t], i,
+                   k->run_us / 1000.0, pct(k->run_us, r->window_us), (unsigned long)k->calls,
+                   (unsigned long)k->max_us);
+        }
+    }
+    if (r->heap_size)
+        printf("Heap: %lu B em uso, %lu B já obtidos de %lu B", (unsigned long)r->heap_used,
+               (unsigned long)r->heap_arena, (unsigned long)r->heap_size);
+    else
+        printf("Heap: %lu B em uso, %lu B já obtidos", (unsigned long)r->heap_used,
+               (unsigned long)r->heap_arena);
+    printf("; FatFs: %lu B em uso (pico %lu B, %lu alocações)\n", (unsigned long)r->ff_in_use,
+           (unsigned long)r->ff_peak, (unsigned long)r->ff_allocs);
+    const FF_POOLSTATS *p = &r->ff_pool;
+    printf("Pools do FatFs (em uso/máximo/total): buffers %u/%u/%u, FIL %u/%u/%u, DIR %u/%u/%u; "
+           "%lu do heap, %lu recusados\n",
+           p->blocks_used, p->blocks_peak, p->blocks, p->fil_used, p->fil_peak, p->fils, p->dir_used,
+           p->dir_peak, p->dirs, (unsigned long)p->heap_allocs, (unsigned long)p->fails);
+}
+
+bool cpu_cycles_available(void) {
+    return PICO_ON_DEVICE;
+}
+
+#if PICO_ON_DEVICE
+// SysTick no clock do processador, contando para baixo a partir de 2^24 - 1
+void cpu_cycles_start(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // ENABLE | CLKSOURCE
+}
+
+uint32_t cpu_cycles_elapsed(void) {
+    return (0x00FFFFFF - systick_hw->cvr) & 0x00FFFFFF;
+}
+#else
+void cpu_cycles_start(void) {
+}
+
+uint32_t cpu_cycles_elapsed(void) {
+    return 0;
+}
+#endif
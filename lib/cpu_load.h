@@ -0,0 +1,96 @@
+#ifndef CPU_LOAD_H
+#define CPU_LOAD_H
+
+#include "pico/stdlib.h"
+#include "ff.h"
+
+// Carga de CPU por núcleo, no estilo do "top": cada core tem uma pilha de
+// tarefas e o tempo entre duas marcações é cobrado da tarefa do topo (tempo
+// próprio, sem as aninhadas). Esperas (sleep, WFE, fila do core1) são a
+// tarefa CPU_TASK_IDLE; o que não está em tarefa nenhuma cai em "outros".
+// Interrupções são medidas à parte e descontadas da tarefa interrompida.
+//
+// Também mede a marca d'água das pilhas dos dois cores (pintadas com um
+// padrão em cpu_load_init_core) e o uso do heap e dos pools do FatFs
+// (buffers de nome longo do ff_memalloc e objetos FIL/DIR, em ffsystem.c).
+
+#ifndef CPU_LOAD_ENABLED
+#define CPU_LOAD_ENABLED 1
+#endif
+
+// Profundidade máxima de tarefas aninhadas por núcleo
+#define CPU_TASK_DEPTH 8
+
+typedef enum {
+    CPU_TASK_OTHER,    // Fora de qualquer tarefa (resto do laço principal)
+    CPU_TASK_IDLE,     // Dormindo ou esperando
+    CPU_TASK_CONSOLE,  // Comandos do terminal e atalhos do menu
+    CPU_TASK_CAPTURE,  // Captura do IMU para o cartão
+    CPU_TASK_IMU,      // Leitura periódica do IMU no laço principal
+    CPU_TASK_DISPLAY,  // Envio do framebuffer ao SSD1306
+    CPU_TASK_STREAM,   // Transmissão ao vivo pela USB
+    CPU_TASK_USB,      // Modo USB Mass Storage
+    CPU_TASK_CORE1_JOB,// Trabalho executado pelo core1
+    CPU_TASK_COUNT
+} cpu_task_t;
+
+typedef struct {
+    uint64_t run_us;   // Tempo próprio, sem tarefas aninhadas nem ISRs
+    uint32_t calls;
+    uint32_t max_us;   // Chamada mais longa da janela (com as aninhadas)
+} cpu_task_stats_t;
+
+typedef struct {
+    uint64_t isr_us;
+    uint32_t isr_count;
+    uint32_t isr_max_us;
+    cpu_task_stats_t task[CPU_TASK_COUNT];
+    uint32_t stack_size;  // Bytes da pilha medidos (0 = core não iniciado)
+    uint32_t stack_used;  // Marca d'água desde o boot
+} cpu_core_stats_t;
+
+typedef struct {
+    uint64_t window_us;   // Duração da janela (desde o cpu_load_sample anterior)
+    cpu_core_stats_t core[2];
+    uint32_t heap_size;   // 0 = desconhecido (build host)
+    uint32_t heap_used;   // Em uso agora (malloc)
+    uint32_t heap_arena;  // Maior extensão já obtida pelo malloc
+    uint32_t ff_in_use;   // Bytes do FatFs (ff_memalloc) em uso agora
+    uint32_t ff_peak;
+    uint32_t ff_allocs;
+    FF_POOLSTATS ff_pool; // Blocos e objetos dos pools: em uso e marca d'água
+} cpu_load_report_t;
+
+#if CPU_LOAD_ENABLED
+#define CPU_TASK_BEGIN(t) cpu_task_begin(t)
+#define CPU_TASK_END(t) cpu_task_end(t)
+#define CPU_IDLE_BEGIN() cpu_task_begin(CPU_TASK_IDLE)
+#define CPU_IDLE_END() cpu_task_end(CPU_TASK_IDLE)
+#define CPU_ISR_ENTER() cpu_isr_enter()
+#define CPU_ISR_EXIT() cpu_isr_exit()
+#else
+#define CPU_TASK_BEGIN(t) ((void)0)
+#define CPU_TASK_END(t) ((void)0)
+#define CPU_IDLE_BEGIN() ((void)0)
+#define CPU_IDLE_END() ((void)0)
+#define CPU_ISR_ENTER() ((void)0)
+#define CPU_ISR_EXIT() ((void)0)
+#endif
+
+// Protótipos das funções
+void cpu_load_init_core(void);  // Chamar no início de cada core
+void cpu_task_begin(cpu_task_t t);
+void cpu_task_end(cpu_task_t t);
+void cpu_isr_enter(void);
+void cpu_isr_exit(void);
+// Preenche *out com a janela desde a chamada anterior e começa outra (core0)
+void cpu_load_sample(cpu_load_report_t *out);
+void cpu_load_print(const cpu_load_report_t *r);
+// Contador de ciclos para benchmarks curtos (SysTick, 24 bits: até ~130 ms a
+// 125 MHz). cpu_cycles_start zera; cpu_cycles_elapsed conta desde então.
+// No build host não há contador e cpu_cycles_available retorna false.
+bool cpu_cycles_available(void);
+void cpu_cycles_start(void);
+uint32_t cpu_cycles_elapsed(void);
+
+#endif // CPU_LOAD_H
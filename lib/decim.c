@@ -0,0 +1,78 @@
+#include "decim.h"
+#include <string.h>
+
+static const decim_config_t *find_config(uint ratio) {
+    for (size_t i = 0; i < count_of(decim_configs); i++)
+        if (decim_configs[i].ratio == ratio) return &decim_configs[i];
+    return NULL;
+}
+
+bool decim_ratio_supported(uint ratio) {
+    return find_config(ratio) != NULL;
+}
+
+bool decim_init(decim_t *d, uint ratio) {
+    memset(d, 0, sizeof *d);
+    d->cfg = find_config(ratio);
+    if (!d->cfg) return false;
+    // O CIC assenta em N saídas dele e o FIR precisa da linha cheia
+    uint32_t cic_out = DECIM_CIC_STAGES + d->cfg->taps;
+    d->warmup = (cic_out + d->cfg->fir_ratio - 1) / d->cfg->fir_ratio;
+    return true;
+}
+
+// Uma saída do FIR a partir da linha de atraso de um eixo
+static int32_t fir_output(const decim_t *d, const int32_t *h) {
+    const decim_config_t *c = d->cfg;
+    int64_t acc = 0;
+    int idx = d->pos;  // Amostra mais nova
+    for (int k = 0; k < c->taps; k++) {
+        acc += (int64_t)c->coef[k] * h[idx];
+        if (0 == idx) idx = c->taps;
+        idx--;
+    }
+    return (int32_t)((acc + (1LL << (DECIM_ACC_SHIFT - 1))) >> DECIM_ACC_SHIFT);
+}
+
+size_t decim_process(decim_t *d, const int16_t in[][DECIM_AXES], size_t n,
+                     int32_t out[][DECIM_AXES]) {
+    const decim_config_t *c = d->cfg;
+    size_t produced = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (int a = 0; a < DECIM_AXES; a++) {
+            uint32_t v = (uint32_t)(int32_t)in[i][a];
+            for (int s = 0; s < DECIM_CIC_STAGES; s++) v = d->integ[a][s] += v;
+        }
+        if (++d->cic_phase < c->cic_ratio) continue;
+        d->cic_phase = 0;
+
+        // Pentes na taxa do CIC; o overflow dos integradores se cancela aqui
+        if (++d->pos == c->taps) d->pos = 0;
+        for (int a = 0; a < DECIM_AXES; a++) {
+            uint32_t v = d->integ[a][DECIM_CIC_STAGES - 1];
+            for (int s = 0; s < DECIM_CIC_STAGES; s++) {
+                uint32_t prev = d->comb[a][s];
+                d->comb[a][s] = v;
+                v -= prev;
+            }
+            d->hist[a][d->pos] = (int32_t)v;
+        }
+        if (++d->fir_phase < c->fir_ratio) continue;
+        d->fir_phase = 0;
+
+        if (d->warmup) {
+            d->warmup--;
+            continue;
+        }
+        for (int a = 0; a < DECIM_AXES; a++) out[produced][a] = fir_output(d, d->hist[a]);
+        produced++;
+    }
+    return produced;
+}
+
+uint32_t decim_delay_us(const decim_t *d, uint32_t period_us) {
+    const decim_config_t *c = d->cfg;
+    // Em meias amostras de entrada: CIC N(Rc-1)/2, FIR (taps-1)/2 saídas do CIC
+    uint32_t half = DECIM_CIC_STAGES * (c->cic_ratio - 1) + (c->taps - 1) * c->cic_ratio;
+    return half * period_us / 2;
+}
@@ -0,0 +1,42 @@
+#ifndef DECIM_H
+#define DECIM_H
+
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "decim_coeffs.h"
+
+// Estágio de decimação entre a leitura do IMU e a gravação: amostra o
+// sensor a DECIM_INPUT_HZ (bom para o anti-aliasing) e grava a 1/R disso.
+// Cada razão é um CIC de DECIM_CIC_STAGES estágios (só somas, aritmética
+// modular de 32 bits) seguido de um FIR de fase linear que compensa a queda
+// do CIC e decima de novo; o FIR só calcula as saídas que ficam, o
+// equivalente à forma polifásica. Tudo em inteiros: a entrada são as
+// contagens brutas e a saída, contagens em Q8 (DECIM_OUT_FRAC_BITS).
+//
+// Os coeficientes de cada razão vêm de decim_coeffs.h, gerado pelo
+// tools/gen_decim.
+
+#define DECIM_INPUT_HZ 1000
+#define DECIM_AXES 6           // Acel X/Y/Z, giro X/Y/Z
+#define DECIM_MAX_RATIO 20
+
+typedef struct {
+    const decim_config_t *cfg;
+    uint32_t integ[DECIM_AXES][DECIM_CIC_STAGES];  // Integradores (taxa de entrada)
+    uint32_t comb[DECIM_AXES][DECIM_CIC_STAGES];   // Valor anterior de cada pente
+    int32_t hist[DECIM_AXES][DECIM_MAX_TAPS];      // Saídas do CIC (anel)
+    uint8_t cic_phase, fir_phase, pos;
+    uint32_t warmup;  // Saídas descartadas até os filtros encherem
+} decim_t;
+
+// Protótipos das funções
+bool decim_ratio_supported(uint ratio);
+bool decim_init(decim_t *d, uint ratio);
+// Processa n amostras; grava em out no máximo n / ratio + 1 saídas e
+// retorna quantas gravou
+size_t decim_process(decim_t *d, const int16_t in[][DECIM_AXES], size_t n,
+                     int32_t out[][DECIM_AXES]);
+// Atraso de grupo do estágio, em us, para a entrada amostrada a period_us
+uint32_t decim_delay_us(const decim_t *d, uint32_t period_us);
+
+#endif // DECIM_H
@@ -0,0 +1,56 @@
+// Gerado por tools/gen_decim.cpp; não edite à mão.
+#ifndef DECIM_COEFFS_H
+#define DECIM_COEFFS_H
+
+#include <stdint.h>
+
+#define DECIM_CIC_STAGES 4
+#define DECIM_OUT_FRAC_BITS 8
+#define DECIM_ACC_SHIFT 24
+#define DECIM_MAX_TAPS 31
+
+// R = 5: CIC /5, FIR /1 com 15 taps (passa até 0.30, corta de 0.45
+// ciclos/amostra na entrada do FIR)
+static const int32_t decim_fir_5[15] = {
+    -117501, 307572, -338992, -106858, 1097839, -2026243,
+    1066478, 7107355, 1066478, -2026243, 1097839, -106858,
+    -338992, 307572, -117501,
+};
+
+// R = 10: CIC /5, FIR /2 com 31 taps (passa até 0.20, corta de 0.30
+// ciclos/amostra na entrada do FIR)
+static const int32_t decim_fir_10[31] = {
+    -6695, 8593, 30484, -15708, -74336, 23433,
+    150317, -28284, -276667, 22427, 493890, 18883,
+    -933054, -240712, 2333074, 3860659, 2333074, -240712,
+    -933054, 18883, 493890, 22427, -276667, -28284,
+    150317, 23433, -74336, -15708, 30484, 8593,
+    -6695,
+};
+
+// R = 20: CIC /10, FIR /2 com 31 taps (passa até 0.20, corta de 0.30
+// ciclos/amostra na entrada do FIR)
+static const int32_t decim_fir_20[31] = {
+    -424, 542, 1928, -990, -4702, 1472,
+    9507, -1765, -17493, 1362, 31214, 1339,
+    -58888, -15686, 146171, 242322, 146171, -15686,
+    -58888, 1339, 31214, 1362, -17493, -1765,
+    9507, 1472, -4702, -990, 1928, 542,
+    -424,
+};
+
+typedef struct {
+    uint8_t ratio;      // Decimação total
+    uint8_t cic_ratio;  // Decimação do CIC
+    uint8_t fir_ratio;  // Decimação do FIR (polifásico)
+    uint8_t taps;
+    const int32_t *coef;
+} decim_config_t;
+
+static const decim_config_t decim_configs[] = {
+    {5, 5, 1, 15, decim_fir_5},
+    {10, 5, 2, 31, decim_fir_10},
+    {20, 10, 2, 31, decim_fir_20},
+};
+
+#endif // DECIM_COEFFS_H
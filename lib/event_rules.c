@@ -0,0 +1,274 @@
+#include "event_rules.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "f_util.h"
+
+enum { RULE_IDLE, RULE_PENDING, RULE_ACTIVE };
+
+static const char *const signal_names[EVENT_SIG_COUNT] = {"amag", "gmag", "ax", "ay",
+                                                          "az",   "gx",   "gy", "gz"};
+
+// Sons das regras, tocados pelo sequenciador do buzzer
+static const buzzer_note_t sound_bip[] = {{C5, 80}};
+static const buzzer_note_t sound_fall[] = {{G5, 100}, {E5, 100}, {C5, 100}, {G4, 100}, {C4, 200}};
+static const buzzer_note_t sound_impact[] = {{A4, 60}, {0, 40}, {A4, 60}, {0, 40}, {A4, 60}};
+static const buzzer_note_t sound_still[] = {{C4, 300}, {0, 150}, {C4, 300}};
+
+static const struct {
+    const char *name;
+    const buzzer_note_t *notes;
+    uint count;
+} event_sounds[] = {
+    {"nenhum", NULL, 0},
+    {"bip", sound_bip, count_of(sound_bip)},
+    {"queda", sound_fall, count_of(sound_fall)},
+    {"impacto", sound_impact, count_of(sound_impact)},
+    {"parado", sound_still, count_of(sound_still)},
+};
+
+static bool is_magnitude(uint8_t signal) {
+    return signal == EVENT_SIG_AMAG || signal == EVENT_SIG_GMAG;
+}
+
+static bool is_accel(uint8_t signal) {
+    return signal == EVENT_SIG_AMAG || (signal >= EVENT_SIG_AX && signal <= EVENT_SIG_AZ);
+}
+
+// Limiar na unidade do sinal -> contagens (contagens² nos módulos)
+static uint32_t to_counts(const event_rules_t *e, uint8_t signal, float v) {
+    float c = (v > 0 ? v : 0) * (is_accel(signal) ? e->accel_sensitivity : e->gyro_sensitivity);
+    if (is_magnitude(signal))
+        c *= c;
+    return c >= 4294967295.0f ? UINT32_MAX : (uint32_t)(c + 0.5f);
+}
+
+static float from_counts(const event_rules_t *e, uint8_t signal, uint32_t c) {
+    float v = is_magnitude(signal) ? sqrtf((float)c) : (float)c;
+    return v / (is_accel(signal) ? e->accel_sensitivity : e->gyro_sensitivity);
+}
+
+static void rule_prepare(event_rules_t *e, event_rule_t *r) {
+    float off = r->below ? r->threshold + r->hysteresis : r->threshold - r->hysteresis;
+    r->on = to_counts(e, r->signal, r->threshold);
+    r->off = to_counts(e, r->signal, off);
+    r->state = RULE_IDLE;
+}
+
+static bool add_rule(event_rules_t *e, const char *name, uint8_t signal, bool below, float threshold,
+                     float hysteresis, uint32_t min_ms, uint8_t sound) {
+    if (e->n_rules >= EVENT_MAX_RULES)
+        return false;
+    event_rule_t *r = &e->rule[e->n_rules++];
+    memset(r, 0, sizeof *r);
+    snprintf(r->name, sizeof r->name, "%s", name);
+    r->signal = signal;
+    r->below = below;
+    r->threshold = threshold;
+    r->hysteresis = hysteresis;
+    r->min_us = min_ms * 1000u;
+    r->sound = sound;
+    rule_prepare(e, r);
+    return true;
+}
+
+void event_rules_init(event_rules_t *e, float accel_sensitivity, float gyro_sensitivity) {
+    memset(e, 0, sizeof *e);
+    e->accel_sensitivity = accel_sensitivity;
+    e->gyro_sensitivity = gyro_sensitivity;
+    // Queda livre: |a| perto de zero por 60 ms (~2 cm de queda)
+    add_rule(e, "queda", EVENT_SIG_AMAG, true, 0.35f, 0.15f, 60, 2);
+    // Impacto: pico de |a| acima de 1,8 g, sem duração mínima (na escala de
+    // ±2 g da captura um eixo satura em 2 g)
+    add_rule(e, "impacto", EVENT_SIG_AMAG, false, 1.8f, 0.6f, 0, 3);
+    // Repouso: quase sem rotação por 10 s
+    add_rule(e, "parado", EVENT_SIG_GMAG, true, 1.5f, 1.5f, 10000, 4);
+}
+
+static int find_name(const char *const *names, size_t count, const char *s) {
+    for (size_t i = 0; i < count; i++)
+        if (0 == strcmp(names[i], s))
+            return (int)i;
+    return -1;
+}
+
+int event_rules_load(event_rules_t *e, const char *path) {
+    FIL fil;
+    FRESULT fr = f_open(&fil, path, FA_READ);
+    if (FR_OK != fr)
+        return -1;
+    e->n_rules = 0;
+    char line[96];
+    int line_no = 0;
+    while (f_gets(line, sizeof line, &fil)) {
+        line_no++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        char name[EVENT_NAME_LEN], sig[8], op[2], snd[12];
+        float threshold, hysteresis;
+        unsigned long min_ms;
+        int n = sscanf(line, "%11s %7s %1s %f %f %lu %11s", name, sig, op, &threshold, &hysteresis,
+                       &min_ms, snd);
+        if (n <= 0)
+            continue;  // Linha vazia ou só comentário
+        int signal = find_name(signal_names, EVENT_SIG_COUNT, sig);
+        int sound = -1;
+        for (size_t i = 0; n == 7 && i < count_of(event_sounds); i++)
+            if (0 == strcmp(event_sounds[i].name, snd))
+                sound = (int)i;
+        if (n != 7 || signal < 0 || (op[0] != '<' && op[0] != '>') || threshold < 0 ||
+            hysteresis < 0 || sound < 0) {
+            printf("%s:%d: regra inválida, ignorada\n", path, line_no);
+            continue;
+        }
+        if (!add_rule(e, name, (uint8_t)signal, op[0] == '<', threshold, hysteresis, (uint32_t)min_ms,
+                      (uint8_t)sound)) {
+            printf("%s:%d: mais de %d regras, o resto foi ignorado\n", path, line_no, EVENT_MAX_RULES);
+            break;
+        }
+    }
+    f_close(&fil);
+    return (int)e->n_rules;
+}
+
+void event_rules_set_sensitivity(event_rules_t *e, float accel_sensitivity, float gyro_sensitivity) {
+    e->accel_sensitivity = accel_sensitivity;
+    e->gyro_sensitivity = gyro_sensitivity;
+    for (uint i = 0; i < e->n_rules; i++)
+        rule_prepare(e, &e->rule[i]);
+}
+
+void event_rules_reset(event_rules_t *e) {
+    for (uint i = 0; i < e->n_rules; i++)
+        e->rule[i].state = RULE_IDLE;
+}
+
+static void log_event(event_rules_t *e, uint i, uint64_t t_us) {
+    event_rule_t *r = &e->rule[i];
+    event_record_t *rec = &e->log[e->head];
+    rec->t_us = r->since_us;
+    rec->dur_ms = (uint32_t)((t_us - r->since_us) / 1000);
+    rec->rule = (uint8_t)i;
+    rec->peak = from_counts(e, r->signal, r->peak);
+    e->head = (e->head + 1) % EVENT_LOG_SIZE;
+    if (e->unsaved == EVENT_LOG_SIZE)
+        e->dropped++;
+    else
+        e->unsaved++;
+    e->total++;
+}
+
+int event_rules_eval(event_rules_t *e, const int16_t accel[3], const int16_t gyro[3], uint64_t t_us) {
+    uint32_t v[EVENT_SIG_COUNT];
+    v[EVENT_SIG_AMAG] = 0;
+    v[EVENT_SIG_GMAG] = 0;
+    for (int i = 0; i < 3; i++) {
+        // Quadrados somados em 32 bits sem sinal: 3 * 32768² ainda cabe
+        v[EVENT_SIG_AMAG] += (uint32_t)(accel[i] * accel[i]);
+        v[EVENT_SIG_GMAG] += (uint32_t)(gyro[i] * gyro[i]);
+        v[EVENT_SIG_AX + i] = (uint32_t)(accel[i] < 0 ? -accel[i] : accel[i]);
+        v[EVENT_SIG_GX + i] = (uint32_t)(gyro[i] < 0 ? -gyro[i] : gyro[i]);
+    }
+
+    int fired = -1;
+    for (uint i = 0; i < e->n_rules; i++) {
+        event_rule_t *r = &e->rule[i];
+        uint32_t x = v[r->signal];
+        bool on = r->below ? x < r->on : x > r->on;
+        switch (r->state) {
+            case RULE_IDLE:
+                if (!on)
+                    break;
+                r->state = RULE_PENDING;
+                r->since_us = t_us;
+                r->peak = x;
+                // Sem duração mínima o evento começa já
+                __attribute__((fallthrough));
+            case RULE_PENDING:
+                if (!on) {
+                    r->state = RULE_IDLE;
+                    break;
+                }
+                if (r->below ? x < r->peak : x > r->peak)
+                    r->peak = x;
+                if (t_us - r->since_us >= r->min_us) {
+                    r->state = RULE_ACTIVE;
+                    if (fired < 0)
+                        fired = (int)i;
+                }
+                break;
+            case RULE_ACTIVE:
+                if (r->below ? x < r->peak : x > r->peak)
+                    r->peak = x;
+                if (r->below ? x > r->off : x < r->off) {
+                    log_event(e, i, t_us);
+                    r->state = RULE_IDLE;
+                }
+                break;
+        }
+    }
+    return fired;
+}
+
+uint event_rules_sound(const event_rules_t *e, int rule, const buzzer_note_t **notes) {
+    if (rule < 0 || (uint)rule >= e->n_rules) {
+        *notes = NULL;
+        return 0;
+    }
+    *notes = event_sounds[e->rule[rule].sound].notes;
+    return event_sounds[e->rule[rule].sound].count;
+}
+
+int event_rules_format(const event_rules_t *e, const event_record_t *r, const char *prefix,
+                       char *buf, size_t size) {
+    return snprintf(buf, size, "%s%lu.%06lu, %lu, %s, %.3f\n", prefix,
+                    (unsigned long)(r->t_us / 1000000), (unsigned long)(r->t_us % 1000000),
+                    (unsigned long)r->dur_ms, e->rule[r->rule].name, r->peak);
+}
+
+FRESULT event_rules_save(event_rules_t *e, const char *path) {
+    if (!e->unsaved)
+        return FR_OK;
+    FIL fil;
+    FRESULT fr = f_open(&fil, path, FA_OPEN_APPEND | FA_WRITE);
+    if (FR_OK != fr)
+        return fr;
+    if (0 == f_size(&fil) && f_puts("Início (s), Duração (ms), Regra, Pico\n", &fil) < 0)
+        fr = FR_DISK_ERR;
+    char line[80];
+    while (FR_OK == fr && e->unsaved) {
+        const event_record_t *r = &e->log[(e->head + EVENT_LOG_SIZE - e->unsaved) % EVENT_LOG_SIZE];
+        int len = event_rules_format(e, r, "", line, sizeof line);
+        UINT bw;
+        if (len > 0 && (size_t)len < sizeof line)
+            fr = f_write(&fil, line, (UINT)len, &bw);
+        if (FR_OK == fr)
+            e->unsaved--;
+    }
+    FRESULT fr_close = f_close(&fil);
+    return FR_OK == fr ? fr_close : fr;
+}
+
+void event_rules_print(const event_rules_t *e) {
+    printf("%u regras:\n", e->n_rules);
+    for (uint i = 0; i < e->n_rules; i++) {
+        const event_rule_t *r = &e->rule[i];
+        printf("  %-10s %-4s %c %.3f (sai em %.3f) por %lu ms, som %s%s\n", r->name,
+               signal_names[r->signal], r->below ? '<' : '>', r->threshold,
+               r->below ? r->threshold + r->hysteresis : r->threshold - r->hysteresis,
+               (unsigned long)(r->min_us / 1000), event_sounds[r->sound].name,
+               r->state == RULE_ACTIVE ? " [ativo]" : "");
+    }
+    uint n = e->total < EVENT_LOG_SIZE ? e->total : EVENT_LOG_SIZE;
+    printf("%lu eventos desde o boot (%u ainda não gravados em %s, %lu perdidos)\n",
+           (unsigned long)e->total, e->unsaved, EVENT_LOG_FILE, (unsigned long)e->dropped);
+    if (n)
+        printf("Início (s), Duração (ms), Regra, Pico\n");
+    char line[80];
+    for (uint k = n; k > 0; k--) {
+        const event_record_t *r = &e->log[(e->head + EVENT_LOG_SIZE - k) % EVENT_LOG_SIZE];
+        if (event_rules_format(e, r, "", line, sizeof line) > 0)
+            printf("%s", line);
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef EVENT_RULES_H
+#define EVENT_RULES_H
+
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "ff.h"
+#include "buzzer.h"
+
+// Detecção de eventos no sinal do sensor (queda livre, impacto, repouso...)
+// por regras avaliadas a cada amostra. Cada regra compara um sinal (módulo
+// da aceleração, módulo da rotação ou um eixo em valor absoluto) com um
+// limiar, acima ou abaixo dele; o evento começa quando a condição dura pelo
+// menos a duração mínima e só termina quando o sinal volta além do limiar
+// mais a histerese. No começo o buzzer toca o som da regra; no fim o evento
+// (início, duração, pico) vai para um registro circular na RAM, gravado
+// depois em EVENT_LOG_FILE.
+//
+// Os limiares são convertidos para contagens uma vez (contagens² nos
+// módulos, sem raiz quadrada por amostra), então cada amostra custa seis
+// multiplicações e algumas comparações por regra: O(1), com no máximo
+// EVENT_MAX_RULES regras.
+//
+// As regras vêm de EVENT_RULES_FILE, uma por linha ('#' comenta):
+//
+//   # nome    sinal  op  limiar  histerese  duração_ms  som
+//   queda     amag   <   0.35    0.15       60          queda
+//
+// sinal: amag, gmag (g e graus/s) ou ax, ay, az, gx, gy, gz; op: < ou >;
+// som: nenhum, bip, queda, impacto ou parado.
+
+#define EVENT_MAX_RULES 8
+#define EVENT_LOG_SIZE 32
+#define EVENT_NAME_LEN 12
+#define EVENT_RULES_FILE "regras.txt"
+#define EVENT_LOG_FILE "eventos.csv"
+
+typedef enum {
+    EVENT_SIG_AMAG,  // |a| em g
+    EVENT_SIG_GMAG,  // |w| em graus/s
+    EVENT_SIG_AX, EVENT_SIG_AY, EVENT_SIG_AZ,
+    EVENT_SIG_GX, EVENT_SIG_GY, EVENT_SIG_GZ,
+    EVENT_SIG_COUNT
+} event_signal_t;
+
+typedef struct {
+    char name[EVENT_NAME_LEN];
+    uint8_t signal;         // event_signal_t
+    bool below;             // Condição "<"
+    uint8_t sound;          // Índice em event_sounds
+    float threshold, hysteresis;  // Na unidade do sinal
+    uint32_t min_us;
+    // Em contagens (contagens² nos módulos), calculados por event_rules_init
+    uint32_t on, off;
+    // Estado
+    uint8_t state;
+    uint64_t since_us;      // Início da condição
+    uint32_t peak;          // Extremo do sinal desde o início, em contagens
+} event_rule_t;
+
+typedef struct {
+    uint64_t t_us;          // Início
+    uint32_t dur_ms;
+    uint8_t rule;
+    float peak;             // Na unidade do sinal
+} event_record_t;
+
+typedef struct {
+    event_rule_t rule[EVENT_MAX_RULES];
+    uint n_rules;
+    float accel_sensitivity, gyro_sensitivity;
+    event_record_t log[EVENT_LOG_SIZE];
+    uint head;              // Próxima posição do registro
+    uint unsaved;           // Registros ainda não gravados no cartão
+    uint32_t total;         // Eventos desde o boot
+    uint32_t dropped;       // Sobrescritos antes de ir para o cartão
+} event_rules_t;
+
+// Protótipos das funções
+// Regras padrão (queda, impacto e repouso) para as sensibilidades dadas
+void event_rules_init(event_rules_t *e, float accel_sensitivity, float gyro_sensitivity);
+// Troca as regras pelas do arquivo; retorna quantas carregou (as linhas com
+// erro são avisadas e puladas) ou -1 se não abriu o arquivo
+int event_rules_load(event_rules_t *e, const char *path);
+// Converte os limiares para outra escala do sensor, mantendo as regras
+void event_rules_set_sensitivity(event_rules_t *e, float accel_sensitivity, float gyro_sensitivity);
+// Volta as regras ao estado inicial (sem evento em andamento)
+void event_rules_reset(event_rules_t *e);
+// Avalia uma amostra (contagens brutas); retorna a regra que disparou um
+// evento nesta amostra, ou -1
+int event_rules_eval(event_rules_t *e, const int16_t accel[3], const int16_t gyro[3], uint64_t t_us);
+// Som da regra para o buzzer_play; retorna o número de notas (0 = nenhum)
+uint event_rules_sound(const event_rules_t *e, int rule, const buzzer_note_t **notes);
+// Linha "início, duração, regra, pico" de um registro, como snprintf
+int event_rules_format(const event_rules_t *e, const event_record_t *r, const char *prefix,
+                       char *buf, size_t size);
+// Acrescenta os registros não gravados ao arquivo (cabeçalho se for novo)
+FRESULT event_rules_save(event_rules_t *e, const char *path);
+void event_rules_print(const event_rules_t *e);
+
+#endif // EVENT_RULES_H
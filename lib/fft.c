@@ -0,0 +1,99 @@
+#include "fft.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define QUARTER (FFT_MAX_POINTS / 4)
+
+// sin(2 pi i / FFT_MAX_POINTS) em Q15, i = 0..QUARTER
+static int16_t sin_q15[QUARTER + 1];
+
+void fft_init(void) {
+    for (int i = 0; i <= QUARTER; i++) {
+        long v = lroundf(32768.0f * sinf(2.0f * (float)M_PI * i / FFT_MAX_POINTS));
+        sin_q15[i] = v > 32767 ? 32767 : (int16_t)v;
+    }
+}
+
+// sin e cos de 2 pi i / FFT_MAX_POINTS pela simetria do quarto de onda
+static inline int16_t sin_lookup(uint i) {
+    i &= FFT_MAX_POINTS - 1;
+    if (i <= QUARTER) return sin_q15[i];
+    if (i <= 2 * QUARTER) return sin_q15[2 * QUARTER - i];
+    if (i <= 3 * QUARTER) return (int16_t)-sin_q15[i - 2 * QUARTER];
+    return (int16_t)-sin_q15[FFT_MAX_POINTS - i];
+}
+
+static inline int16_t cos_lookup(uint i) {
+    return sin_lookup(i + QUARTER);
+}
+
+bool fft_size_supported(uint n) {
+    return n >= FFT_MIN_POINTS && n <= FFT_MAX_POINTS && 0 == (n & (n - 1));
+}
+
+int16_t fft_hann(uint i, uint n) {
+    // (1 - cos) / 2 em Q15, sem passar de 32767
+    int32_t w = (32768 - cos_lookup(i * (FFT_MAX_POINTS / n))) >> 1;
+    return w > 32767 ? 32767 : (int16_t)w;
+}
+
+static void bit_reverse(fft_cpx_t *x, uint n) {
+    for (uint i = 1, j = 0; i < n; i++) {
+        uint bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j) {
+            fft_cpx_t t = x[i];
+            x[i] = x[j];
+            x[j] = t;
+        }
+    }
+}
+
+// A borboleta cresce no máximo 1 + sqrt(2) vezes por componente; abaixo
+// deste limite a saída ainda cabe em 16 bits
+#define STAGE_LIMIT 13572
+
+// Deslocamento que deixa o bloco abaixo de STAGE_LIMIT
+static int stage_shift(const fft_cpx_t *x, uint n) {
+    int32_t m = 0;
+    for (uint i = 0; i < n; i++) {
+        int32_t a = abs(x[i].re), b = abs(x[i].im);
+        if (a > m) m = a;
+        if (b > m) m = b;
+    }
+    int s = 0;
+    while (((m + (s ? 1 << (s - 1) : 0)) >> s) > STAGE_LIMIT) s++;
+    return s;
+}
+
+static inline int16_t shr_round(int16_t v, int s) {
+    return s ? (int16_t)((v + (1 << (s - 1))) >> s) : v;
+}
+
+int fft_forward(fft_cpx_t *x, uint n) {
+    bit_reverse(x, n);
+    int exp = 0;
+    for (uint half = 1; half < n; half <<= 1) {
+        int s = stage_shift(x, n);
+        exp += s;
+        const uint step = FFT_MAX_POINTS / (2 * half);
+        for (uint k = 0; k < half; k++) {
+            // W = exp(-j 2 pi k / (2 half))
+            const int32_t wr = cos_lookup(k * step);
+            const int32_t wi = -sin_lookup(k * step);
+            for (uint i = k; i < n; i += 2 * half) {
+                fft_cpx_t *a = &x[i], *b = &x[i + half];
+                int32_t ar = shr_round(a->re, s), ai = shr_round(a->im, s);
+                int32_t br = shr_round(b->re, s), bi = shr_round(b->im, s);
+                int32_t tr = (br * wr - bi * wi + (1 << 14)) >> 15;
+                int32_t ti = (br * wi + bi * wr + (1 << 14)) >> 15;
+                a->re = (int16_t)(ar + tr);
+                a->im = (int16_t)(ai + ti);
+                b->re = (int16_t)(ar - tr);
+                b->im = (int16_t)(ai - ti);
+            }
+        }
+    }
+    return exp;
+}
@@ -0,0 +1,31 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include "pico/stdlib.h"
+
+// FFT complexa radix-2 em ponto fixo (Q15) para o Cortex-M0+, que não tem
+// FPU: decimação no tempo, in-place, com ponto flutuante em bloco. Antes de
+// cada estágio o bloco inteiro é deslocado para a direita o necessário para
+// a borboleta não estourar, e o expoente comum é devolvido ao chamador: o
+// resultado verdadeiro é x[k] * 2^exp.
+//
+// Senos, twiddles e a janela de Hann vêm de uma tabela de um quarto de onda
+// de FFT_MAX_POINTS pontos, preenchida pelo fft_init. Os dois cores usam a
+// tabela: o main chama o fft_init uma vez, antes de o core1 começar.
+
+#define FFT_MIN_POINTS 8
+#define FFT_MAX_POINTS 1024  // Potência de 2
+
+typedef struct {
+    int16_t re, im;
+} fft_cpx_t;
+
+// Protótipos das funções
+void fft_init(void);
+bool fft_size_supported(uint n);
+// Transforma x[0..n-1] no lugar e retorna o expoente do bloco
+int fft_forward(fft_cpx_t *x, uint n);
+// Janela de Hann em Q15, w[i] = (1 - cos(2 pi i / n)) / 2
+int16_t fft_hann(uint i, uint n);
+
+#endif // FFT_H
@@ -0,0 +1,274 @@
+#include "imu_array.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static i2c_inst_t *imu_array_port(uint bus) {
+    return bus ? i2c1 : i2c0;
+}
+
+// Liga só o canal pedido do TCA9548A (IMU_NO_MUX desliga todos)
+static bool imu_array_mux_select(imu_array_t *a, uint bus, uint8_t channel) {
+    if (!a->mux[bus] || a->mux_sel[bus] == channel) return true;
+    uint8_t mask = IMU_NO_MUX == channel ? 0 : (uint8_t)(1u << channel);
+    if (i2c_write_timeout_us(imu_array_port(bus), IMU_MUX_ADDR, &mask, 1, false, 1000) != 1) {
+        a->mux_sel[bus] = IMU_NO_MUX;  // Estado desconhecido: escreve de novo na próxima
+        return false;
+    }
+    a->mux_sel[bus] = channel;
+    return true;
+}
+
+// Os sensores diretos não precisam desligar o mux: o scan só aceita atrás
+// dele endereços que ninguém usa direto no mesmo barramento
+static bool imu_array_select(imu_array_t *a, const imu_dev_t *d) {
+    return IMU_NO_MUX == d->mux_channel || imu_array_mux_select(a, d->bus, d->mux_channel);
+}
+
+static void imu_array_reset_stats(imu_dev_t *d) {
+    d->reads = d->stale = d->errors = 0;
+    d->read_us_min = UINT32_MAX;
+    d->read_us_max = 0;
+    d->read_us_sum = d->offset_us_sum = 0;
+}
+
+static void imu_array_add(imu_array_t *a, const imu_dev_t *old, uint old_n, uint bus, uint8_t addr,
+                          uint8_t channel, const mpu6050_t *ref) {
+    if (a->n == IMU_ARRAY_MAX) return;
+    imu_dev_t *d = &a->dev[a->n++];
+    memset(d, 0, sizeof *d);
+    i2c_inst_t *i2c = imu_array_port(bus);
+    // O sensor 0 já está inicializado pelo main
+    if (i2c == ref->i2c && addr == ref->addr)
+        d->mpu = *ref;
+    else
+        mpu6050_init(&d->mpu, i2c, addr, ref->accel_scale, ref->gyro_scale);
+    d->bus = (uint8_t)bus;
+    d->mux_channel = channel;
+    imu_array_reset_stats(d);
+    a->n_bus[bus]++;
+    // Sensor que já estava lá fica com a calibração
+    for (uint i = 0; i < old_n; i++) {
+        if (old[i].calibrated && old[i].bus == bus && old[i].mpu.addr == addr && old[i].mux_channel == channel &&
+            old[i].mpu.accel_scale == d->mpu.accel_scale && old[i].mpu.gyro_scale == d->mpu.gyro_scale) {
+            memcpy(d->accel_bias, old[i].accel_bias, sizeof d->accel_bias);
+            memcpy(d->gyro_bias, old[i].gyro_bias, sizeof d->gyro_bias);
+            d->calibrated = true;
+        }
+    }
+}
+
+int imu_array_scan(imu_array_t *a, const mpu6050_t *ref) {
+    static imu_dev_t old[IMU_ARRAY_MAX];
+    uint old_n = a->n;
+    memcpy(old, a->dev, sizeof old);
+    a->n = 0;
+    for (uint bus = 0; bus < IMU_ARRAY_BUSES; bus++) {
+        i2c_inst_t *i2c = imu_array_port(bus);
+        a->n_bus[bus] = 0;
+        // Com todos os canais desligados só respondem os sensores diretos
+        uint8_t off = 0;
+        a->mux[bus] = i2c_write_timeout_us(i2c, IMU_MUX_ADDR, &off, 1, false, 1000) == 1;
+        a->mux_sel[bus] = IMU_NO_MUX;
+        bool direct[2] = {false, false};
+        for (uint k = 0; k < 2; k++) {
+            if (mpu6050_probe(i2c, MPU6050_ADDR + k)) {
+                direct[k] = true;
+                imu_array_add(a, old, old_n, bus, MPU6050_ADDR + k, IMU_NO_MUX, ref);
+            }
+        }
+        if (!a->mux[bus]) continue;
+        for (uint8_t ch = 0; ch < IMU_MUX_CHANNELS; ch++) {
+            if (!imu_array_mux_select(a, bus, ch)) break;
+            for (uint k = 0; k < 2; k++) {
+                if (!direct[k] && mpu6050_probe(i2c, MPU6050_ADDR + k))
+                    imu_array_add(a, old, old_n, bus, MPU6050_ADDR + k, ch, ref);
+            }
+        }
+        imu_array_mux_select(a, bus, IMU_NO_MUX);
+    }
+    // Sem o sensor do INT não há tick comum
+    if (a->n && (a->dev[0].mpu.i2c != ref->i2c || a->dev[0].mpu.addr != ref->addr))
+        a->n = 0;
+    return a->n;
+}
+
+void imu_array_calibrate(imu_array_t *a, uint16_t samples) {
+    for (uint i = 0; i < a->n; i++) {
+        imu_dev_t *d = &a->dev[i];
+        if (!imu_array_select(a, d)) continue;
+        mpu6050_calibrate(&d->mpu, d->accel_bias, d->gyro_bias, samples);
+        d->calibrated = true;
+    }
+}
+
+static int16_t imu_array_rescale(int16_t v, float k) {
+    return (int16_t)lrintf(v * k);
+}
+
+void imu_array_start(imu_array_t *a, const mpu6050_t *ref) {
+    for (uint i = 0; i < a->n; i++) {
+        imu_dev_t *d = &a->dev[i];
+        bool selected = imu_array_select(a, d);
+        if (d->mpu.accel_scale != ref->accel_scale || d->mpu.gyro_scale != ref->gyro_scale) {
+            // O bias medido vale na escala nova, em outras contagens
+            float ka = ref->accel_sensitivity / d->mpu.accel_sensitivity;
+            float kg = ref->gyro_sensitivity / d->mpu.gyro_sensitivity;
+            for (int j = 0; j < 3; j++) {
+                d->accel_bias[j] = imu_array_rescale(d->accel_bias[j], ka);
+                d->gyro_bias[j] = imu_array_rescale(d->gyro_bias[j], kg);
+            }
+            if (0 == i)
+                d->mpu = *ref;
+            else if (selected)
+                mpu6050_init(&d->mpu, d->mpu.i2c, d->mpu.addr, ref->accel_scale, ref->gyro_scale);
+        }
+        imu_array_reset_stats(d);
+        if (i && selected)
+            mpu6050_enable_data_ready(&d->mpu, 1000000 / IMU_ARRAY_RATE_HZ);
+    }
+    a->ticked = true;
+    if (a->n_bus[1])
+        core1_worker_init();
+}
+
+void imu_array_stop(imu_array_t *a) {
+    for (uint i = 1; i < a->n; i++) {
+        if (imu_array_select(a, &a->dev[i]))
+            mpu6050_disable_data_ready(&a->dev[i].mpu);
+    }
+}
+
+static void imu_array_read_dev(imu_array_t *a, uint i) {
+    imu_dev_t *d = &a->dev[i];
+    uint8_t *dst = a->dst + i * IMU_CHANNEL_LEN;
+    uint32_t t0 = time_us_32();
+    bool ok = imu_array_select(a, d) && mpu6050_read_status_burst(&d->mpu, dst);
+    uint32_t us = time_us_32() - t0;
+    d->reads++;
+    if (!ok) {
+        d->errors++;
+        memset(dst, 0, IMU_CHANNEL_LEN);
+        dst[0] = BINLOG_STATUS_ERROR;
+        return;
+    }
+    dst[0] &= (uint8_t)~BINLOG_STATUS_ERROR;  // Bit reservado no sensor
+    if (!(dst[0] & BINLOG_STATUS_DATA_RDY)) d->stale++;
+    if (us < d->read_us_min) d->read_us_min = us;
+    if (us > d->read_us_max) d->read_us_max = us;
+    d->read_us_sum += us;
+    d->offset_us_sum += t0 - a->tick_us;
+}
+
+static void imu_array_read_bus(imu_array_t *a, uint bus) {
+    for (uint i = 0; i < a->n; i++) {
+        if (a->dev[i].bus == bus) imu_array_read_dev(a, i);
+    }
+}
+
+static void imu_array_bus1_job(void *arg) {
+    imu_array_read_bus(arg, 1);
+}
+
+void imu_array_read(imu_array_t *a, uint8_t *dst, uint64_t tick_us) {
+    a->dst = dst;
+    a->tick_us = (uint32_t)tick_us;
+    if (a->n_bus[1]) {
+        a->job.fn = imu_array_bus1_job;
+        a->job.arg = a;
+        core1_worker_post(&a->job);
+    }
+    imu_array_read_bus(a, 0);
+    if (a->n_bus[1])
+        core1_worker_wait(&a->job);
+}
+
+void imu_array_measure(imu_array_t *a, uint n) {
+    uint8_t rec[IMU_ARRAY_MAX * IMU_CHANNEL_LEN];
+    if (a->n_bus[1])
+        core1_worker_init();
+    for (uint i = 0; i < a->n; i++)
+        imu_array_reset_stats(&a->dev[i]);
+    // Sem o ritmo da captura, DATA_RDY não diz nada
+    a->ticked = false;
+    for (uint k = 0; k < n; k++)
+        imu_array_read(a, rec, time_us_64());
+}
+
+uint32_t imu_array_read_us(const imu_dev_t *d) {
+    uint32_t ok = d->reads - d->errors;
+    return ok ? (uint32_t)(d->read_us_sum / ok) : 0;
+}
+
+static uint32_t imu_array_hz(uint32_t us) {
+    if (!us) return 0;
+    uint32_t hz = 1000000 / us;
+    return hz > IMU_ARRAY_RATE_HZ ? IMU_ARRAY_RATE_HZ : hz;
+}
+
+// Limite pelo barramento mais ocupado; o resto do laço da captura (cartão,
+// estatísticas) tira mais um pouco do core0
+uint32_t imu_array_rate_hz(const imu_array_t *a) {
+    uint32_t bus_us[IMU_ARRAY_BUSES] = {0};
+    for (uint i = 0; i < a->n; i++)
+        bus_us[a->dev[i].bus] += imu_array_read_us(&a->dev[i]);
+    return imu_array_hz(bus_us[0] > bus_us[1] ? bus_us[0] : bus_us[1]);
+}
+
+void imu_array_describe(const imu_array_t *a, binlog_channel_t *ch) {
+    for (uint i = 0; i < a->n; i++) {
+        const imu_dev_t *d = &a->dev[i];
+        memset(&ch[i], 0, sizeof ch[i]);
+        ch[i].bus = d->bus;
+        ch[i].addr = d->mpu.addr;
+        ch[i].mux_channel = d->mux_channel;
+        memcpy(ch[i].accel_bias, d->accel_bias, sizeof ch[i].accel_bias);
+        memcpy(ch[i].gyro_bias, d->gyro_bias, sizeof ch[i].gyro_bias);
+        uint32_t ok = d->reads - d->errors;
+        uint64_t offset = ok ? d->offset_us_sum / ok : 0;
+        ch[i].read_offset_us = offset > UINT16_MAX ? UINT16_MAX : (uint16_t)offset;
+    }
+}
+
+void imu_array_print(const imu_array_t *a) {
+    if (!a->n) {
+        printf("Nenhum sensor (o 0 é o do i2c0 em 0x68)\n");
+        return;
+    }
+    printf("%u sensor%s (i2c0: %u, i2c1: %u)", a->n, a->n > 1 ? "es" : "", a->n_bus[0], a->n_bus[1]);
+    for (uint bus = 0; bus < IMU_ARRAY_BUSES; bus++) {
+        if (a->mux[bus]) printf(", TCA9548A no i2c%u", bus);
+    }
+    printf("\n");
+    uint32_t bus_us[IMU_ARRAY_BUSES] = {0};
+    for (uint i = 0; i < a->n; i++) {
+        const imu_dev_t *d = &a->dev[i];
+        char where[12] = "direto";
+        if (IMU_NO_MUX != d->mux_channel)
+            snprintf(where, sizeof where, "canal %u", d->mux_channel);
+        printf("S%u: i2c%u 0x%02x %-7s ", i, d->bus, d->mpu.addr, where);
+        if (d->calibrated)
+            printf("bias acel %d %d %d, giro %d %d %d\n", d->accel_bias[0], d->accel_bias[1], d->accel_bias[2],
+                   d->gyro_bias[0], d->gyro_bias[1], d->gyro_bias[2]);
+        else
+            printf("sem calibração\n");
+        uint32_t us = imu_array_read_us(d);
+        bus_us[d->bus] += us;
+        if (d->reads == d->errors) {
+            if (d->reads) printf("    %lu leituras, todas com erro\n", (unsigned long)d->reads);
+            continue;
+        }
+        uint32_t ok = d->reads - d->errors;
+        printf("    leitura %lu us (mín %lu, máx %lu): até %lu Hz sozinho; atraso médio %lu us",
+               (unsigned long)us, (unsigned long)d->read_us_min, (unsigned long)d->read_us_max,
+               (unsigned long)imu_array_hz(us), (unsigned long)(d->offset_us_sum / ok));
+        if (i && a->ticked)
+            printf(", %lu de %lu sem amostra nova", (unsigned long)d->stale, (unsigned long)ok);
+        if (d->errors)
+            printf(", %lu erros", (unsigned long)d->errors);
+        printf("\n");
+    }
+    if (bus_us[0] || bus_us[1])
+        printf("Limite do I2C: até %lu Hz juntos (i2c0: %lu us, i2c1: %lu us por tick), sem contar a gravação\n",
+               (unsigned long)imu_array_rate_hz(a), (unsigned long)bus_us[0], (unsigned long)bus_us[1]);
+}
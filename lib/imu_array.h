@@ -0,0 +1,89 @@
+#ifndef IMU_ARRAY_H
+#define IMU_ARRAY_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "MPU6050.h"
+#include "binlog.h"
+#include "core1_worker.h"
+
+// Vários MPU6050 lidos juntos na captura. Cada barramento (i2c0 e i2c1, o
+// do display) aceita dois sensores direto, com o AD0 em 0 ou 1 (0x68 e
+// 0x69), e outros atrás de um TCA9548A em 0x70, um endereço livre por
+// canal. O sensor 0 é o do i2c0 em 0x68, com o INT ligado: o data-ready
+// dele é o tick comum da captura (lib/sample_clock.h).
+//
+// Os outros sensores ficam a 1 kHz, a taxa máxima com o DLPF, e a cada tick
+// o valor mais novo de cada um é lido: a amostra de qualquer canal é de no
+// máximo 1 ms antes da leitura, que acontece read_offset_us depois do tick.
+// A leitura começa no INT_STATUS (15 bytes a partir de 0x3A); DATA_RDY
+// apagado quer dizer que o sensor não tinha amostra nova desde o tick
+// anterior (relógios dos sensores com desvio).
+//
+// No mesmo barramento as leituras vão em sequência; os dois barramentos
+// andam juntos, o i2c1 num trabalho do core1 enquanto o core0 lê o i2c0.
+// O display também usa o i2c1: com sensores lá a tela fica parada durante
+// a captura.
+
+#define IMU_ARRAY_MAX BINLOG_MAX_CHANNELS
+#define IMU_ARRAY_BUSES 2
+#define IMU_MUX_ADDR 0x70           // TCA9548A com A0..A2 em GND
+#define IMU_MUX_CHANNELS 8
+#define IMU_NO_MUX BINLOG_NO_MUX
+#define IMU_ARRAY_RATE_HZ 1000      // Taxa interna dos sensores além do 0
+#define IMU_CHANNEL_LEN BINLOG_CHANNEL_LEN
+
+typedef struct {
+    mpu6050_t mpu;
+    uint8_t bus;
+    uint8_t mux_channel;         // IMU_NO_MUX: direto no barramento
+    int16_t accel_bias[3];       // Contagens, parado com o Z para cima
+    int16_t gyro_bias[3];
+    bool calibrated;
+    // Desde o imu_array_start ou o imu_array_measure
+    uint32_t reads;
+    uint32_t stale;              // Sem amostra nova (DATA_RDY apagado)
+    uint32_t errors;             // Sem resposta no I2C
+    uint32_t read_us_min;
+    uint32_t read_us_max;
+    uint64_t read_us_sum;
+    uint64_t offset_us_sum;      // Do tick ao início da leitura
+} imu_dev_t;
+
+typedef struct {
+    uint8_t n;
+    imu_dev_t dev[IMU_ARRAY_MAX];
+    bool mux[IMU_ARRAY_BUSES];         // TCA9548A presente
+    uint8_t mux_sel[IMU_ARRAY_BUSES];  // Canal selecionado, ou IMU_NO_MUX
+    uint8_t n_bus[IMU_ARRAY_BUSES];
+    bool ticked;                 // Estatísticas de uma captura, não do measure
+    core1_job_t job;             // Leitura do i2c1 (done começa em true)
+    uint8_t *dst;                // Registro do tick em andamento
+    uint32_t tick_us;
+} imu_array_t;
+
+// Protótipos das funções
+// Procura os sensores nos dois barramentos, com as escalas de "ref", que é
+// o sensor 0 já inicializado. Retorna quantos achou (0 sem o sensor 0).
+int imu_array_scan(imu_array_t *a, const mpu6050_t *ref);
+// Mede o bias de cada sensor, parados e com o Z para cima
+void imu_array_calibrate(imu_array_t *a, uint16_t samples);
+// Antes da captura: escalas iguais às de "ref", sensores além do 0 a
+// IMU_ARRAY_RATE_HZ e estatísticas zeradas. O sensor 0 fica com o
+// sample_clock_start.
+void imu_array_start(imu_array_t *a, const mpu6050_t *ref);
+void imu_array_stop(imu_array_t *a);
+// Lê todos os canais do tick em dst, IMU_CHANNEL_LEN bytes por sensor
+void imu_array_read(imu_array_t *a, uint8_t *dst, uint64_t tick_us);
+// Só mede os tempos de leitura, n leituras seguidas
+void imu_array_measure(imu_array_t *a, uint n);
+// Tabela de canais do .imb
+void imu_array_describe(const imu_array_t *a, binlog_channel_t *ch);
+// Tempo médio de leitura do sensor e taxa máxima, dele e do conjunto. A
+// taxa só conta o I2C: na captura o core0 ainda grava as páginas do .imb
+// entre as leituras, e a taxa que se sustenta fica abaixo desta.
+uint32_t imu_array_read_us(const imu_dev_t *d);
+uint32_t imu_array_rate_hz(const imu_array_t *a);
+void imu_array_print(const imu_array_t *a);
+
+#endif // IMU_ARRAY_H
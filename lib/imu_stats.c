@@ -0,0 +1,94 @@
+#include "imu_stats.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Mesmos nomes das colunas do CSV
+const char *const imu_stats_axis_names[IMU_STATS_AXES] = {
+    "Aceleração X", "Aceleração Y", "Aceleração Z",
+    "Giroscópio X", "Giroscópio Y", "Giroscópio Z",
+};
+
+void imu_stats_init(imu_stats_t *s, float accel_sensitivity, float gyro_sensitivity) {
+    memset(s, 0, sizeof *s);
+    for (int i = 0; i < 3; i++) {
+        s->sensitivity[i] = accel_sensitivity;
+        s->sensitivity[3 + i] = gyro_sensitivity;
+    }
+}
+
+// Divisão com arredondamento para o mais próximo (simétrica em torno de zero)
+static inline int64_t div_round(int64_t a, uint32_t n) {
+    return a >= 0 ? (a + n / 2) / n : -((-a + n / 2) / n);
+}
+
+static void welford_add(welford_q_t *w, int16_t x) {
+    int64_t xq = (int64_t)x << 16;
+    if (0 == w->n++) {
+        w->mean_q16 = xq;
+        w->min = w->max = x;
+        return;
+    }
+    if (x < w->min) w->min = x;
+    if (x > w->max) w->max = x;
+    // M2 += (x - média antiga) * (x - média nova); os desvios descem para Q8
+    // para o produto (Q16) caber em 64 bits
+    int64_t delta = xq - w->mean_q16;
+    w->mean_q16 += div_round(delta, w->n);
+    int64_t prod = (delta >> 8) * ((xq - w->mean_q16) >> 8);
+    if (prod > 0) w->m2_q8 += (uint64_t)prod >> 8;
+}
+
+void imu_stats_add(imu_stats_t *s, const int16_t accel[3], const int16_t gyro[3]) {
+    for (int i = 0; i < 3; i++) {
+        welford_add(&s->axis[i], accel[i]);
+        welford_add(&s->axis[3 + i], gyro[i]);
+    }
+}
+
+uint32_t imu_stats_count(const imu_stats_t *s) {
+    return s->axis[0].n;
+}
+
+void imu_stats_summary(const imu_stats_t *s, int axis, imu_axis_summary_t *out) {
+    const welford_q_t *w = &s->axis[axis];
+    memset(out, 0, sizeof *out);
+    if (!w->n) return;
+    double k = s->sensitivity[axis];
+    double mean = w->mean_q16 / 65536.0;
+    double m2 = w->m2_q8 / 256.0;
+    out->mean = (float)(mean / k);
+    out->std = w->n > 1 ? (float)(sqrt(m2 / (w->n - 1)) / k) : 0.0f;
+    out->min = (float)(w->min / k);
+    out->max = (float)(w->max / k);
+    out->rms = (float)(sqrt(mean * mean + m2 / w->n) / k);
+}
+
+int imu_stats_format_footer(const imu_stats_t *s, char *buf, size_t size) {
+    int len = snprintf(buf, size, "# Estatísticas (Welford no dispositivo): %lu amostras\n"
+                                  "# Eixo, Média, Desvio, Mínimo, Máximo, RMS\n",
+                       (unsigned long)imu_stats_count(s));
+    for (int i = 0; i < IMU_STATS_AXES && len >= 0 && (size_t)len < size; i++) {
+        imu_axis_summary_t a;
+        imu_stats_summary(s, i, &a);
+        int n = snprintf(buf + len, size - len, "# %s, %f, %f, %f, %f, %f\n",
+                         imu_stats_axis_names[i], a.mean, a.std, a.min, a.max, a.rms);
+        if (n < 0) return n;
+        len += n;
+    }
+    return len;
+}
+
+void imu_stats_print(const imu_stats_t *s) {
+    static const char *const labels[IMU_STATS_AXES] = {
+        "acel X [g]", "acel Y [g]", "acel Z [g]", "giro X [dps]", "giro Y [dps]", "giro Z [dps]",
+    };
+    printf("Estatísticas de %lu amostras:\n", (unsigned long)imu_stats_count(s));
+    printf("  %-12s %10s %10s %10s %10s %10s\n", "eixo", "media", "desvio", "min", "max", "rms");
+    for (int i = 0; i < IMU_STATS_AXES; i++) {
+        imu_axis_summary_t a;
+        imu_stats_summary(s, i, &a);
+        printf("  %-12s %10.4f %10.4f %10.4f %10.4f %10.4f\n", labels[i], a.mean,
+               a.std, a.min, a.max, a.rms);
+    }
+}
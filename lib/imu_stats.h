@@ -0,0 +1,46 @@
+#ifndef IMU_STATS_H
+#define IMU_STATS_H
+
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+// Estatísticas por eixo acumuladas amostra a amostra durante a captura
+// (algoritmo de Welford em ponto fixo, O(1) por amostra): média, desvio
+// padrão, mínimo, máximo e RMS, sem precisar baixar o CSV inteiro.
+//
+// Os acumuladores trabalham nas contagens brutas do sensor: a média fica em
+// Q16 e a soma dos quadrados dos desvios (M2) em Q8, ambas em 64 bits. Com o
+// pior caso (variância de fundo de escala, 2^30 contagens²) o M2 aguenta
+// 2^25 amostras; sinais reais ficam muito longe disso. A conversão para g e
+// graus/s só acontece ao gerar o resumo.
+
+#define IMU_STATS_AXES 6  // Acel X/Y/Z, giro X/Y/Z
+
+typedef struct {
+    uint32_t n;
+    int64_t mean_q16;  // Média, contagens em Q16
+    uint64_t m2_q8;    // Soma dos quadrados dos desvios, contagens² em Q8
+    int16_t min, max;
+} welford_q_t;
+
+typedef struct {
+    welford_q_t axis[IMU_STATS_AXES];
+    float sensitivity[IMU_STATS_AXES];  // Contagens por g ou por grau/s
+} imu_stats_t;
+
+typedef struct {
+    float mean, std, min, max, rms;  // Em g ou graus/s; std amostral (n-1)
+} imu_axis_summary_t;
+
+extern const char *const imu_stats_axis_names[IMU_STATS_AXES];
+
+// Protótipos das funções
+void imu_stats_init(imu_stats_t *s, float accel_sensitivity, float gyro_sensitivity);
+void imu_stats_add(imu_stats_t *s, const int16_t accel[3], const int16_t gyro[3]);
+uint32_t imu_stats_count(const imu_stats_t *s);
+void imu_stats_summary(const imu_stats_t *s, int axis, imu_axis_summary_t *out);
+// Rodapé do CSV em linhas de comentário ('#'); retorna o tamanho como snprintf
+int imu_stats_format_footer(const imu_stats_t *s, char *buf, size_t size);
+void imu_stats_print(const imu_stats_t *s);
+
+#endif // IMU_STATS_H
@@ -0,0 +1,110 @@
+#include "imu_stream.h"
+#include <stdio.h>
+#include "cdc_out.h"
+#include "cpu_load.h"
+
+// Codifica len bytes em COBS (sem o 0x00 final). dst precisa de len + len/254 + 1 bytes.
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst) {
+    size_t code_ix = 0, out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (src[i]) {
+            dst[out++] = src[i];
+            code++;
+        }
+        if (!src[i] || code == 0xFF) {
+            dst[code_ix] = code;
+            code_ix = out++;
+            code = 1;
+        }
+    }
+    dst[code_ix] = code;
+    return out;
+}
+
+static void put_le(uint8_t *p, uint32_t v, int n) {
+    for (int i = 0; i < n; i++, v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+// Envia um quadro inteiro ou nada: se a FIFO da CDC não tiver espaço, o
+// quadro é descartado em vez de travar a aquisição esperando o PC
+static bool send_frame(const uint8_t *frame, size_t len) {
+    uint8_t enc[64];
+    size_t n = cobs_encode(frame, len, enc);
+    enc[n++] = 0;
+    return cdc_out_frame(enc, n, true);
+}
+
+// Lê o MPU6050 a rate_hz e envia cada amostra bruta até chegar '\r' pelo
+// console. A cada segundo vai um quadro com os contadores de perdas; o
+// número de sequência avança também nos períodos perdidos, para o PC
+// enxergar as lacunas.
+void imu_stream_run(mpu6050_t *mpu, uint32_t rate_hz, imu_stream_stats_t *total) {
+    const uint32_t period_us = 1000000 / rate_hz;
+    uint8_t frame[21];
+    imu_stream_stats_t sec = {0};
+    uint32_t seq = 0;
+
+    cdc_out_begin();
+    // O 0x00 inicial fecha o que restou de texto (eco do comando) no receptor
+    frame[0] = IMU_FRAME_INFO;
+    put_le(frame + 1, rate_hz, 2);
+    put_le(frame + 3, (uint32_t)mpu->accel_sensitivity, 2);
+    put_le(frame + 5, (uint32_t)(mpu->gyro_sensitivity * 10), 2);
+    cdc_out_frame("", 1, false);
+    send_frame(frame, 7);
+
+    absolute_time_t next = get_absolute_time();
+    absolute_time_t next_stats = delayed_by_ms(next, 1000);
+    while ('\r' != getchar_timeout_us(0)) {
+        CPU_IDLE_BEGIN();
+        while (absolute_time_diff_us(get_absolute_time(), next) > 0)
+            tight_loop_contents();
+        CPU_IDLE_END();
+
+        int16_t accel[3], gyro[3];
+        uint32_t t_us = time_us_32();
+        mpu6050_read_raw(mpu, accel, gyro);
+
+        frame[0] = IMU_FRAME_SAMPLE;
+        put_le(frame + 1, seq, 4);
+        put_le(frame + 5, t_us, 4);
+        for (int i = 0; i < 3; i++) {
+            put_le(frame + 9 + 2 * i, (uint16_t)accel[i], 2);
+            put_le(frame + 15 + 2 * i, (uint16_t)gyro[i], 2);
+        }
+        if (send_frame(frame, sizeof frame))
+            sec.sent++;
+        else
+            sec.dropped++;
+        seq++;
+
+        next = delayed_by_us(next, period_us);
+        int64_t behind = absolute_time_diff_us(next, get_absolute_time());
+        if (behind > 0) {
+            uint32_t missed = (uint32_t)(behind / period_us) + 1;
+            sec.late += missed;
+            seq += missed;
+            next = delayed_by_us(next, (uint64_t)missed * period_us);
+        }
+
+        if (time_reached(next_stats)) {
+            frame[0] = IMU_FRAME_STATS;
+            put_le(frame + 1, seq, 4);
+            put_le(frame + 5, sec.sent, 4);
+            put_le(frame + 9, sec.dropped, 4);
+            put_le(frame + 13, sec.late, 4);
+            send_frame(frame, 17);
+            total->sent += sec.sent;
+            total->dropped += sec.dropped;
+            total->late += sec.late;
+            sec = (imu_stream_stats_t){0};
+            next_stats = delayed_by_ms(next_stats, 1000);
+        }
+    }
+    total->sent += sec.sent;
+    total->dropped += sec.dropped;
+    total->late += sec.late;
+    cdc_out_end();
+}
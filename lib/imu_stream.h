@@ -0,0 +1,30 @@
+#ifndef IMU_STREAM_H
+#define IMU_STREAM_H
+
+#include "pico/stdlib.h"
+#include "MPU6050.h"
+
+// Transmissão ao vivo das amostras pela CDC (comando "stream"). Cada quadro
+// é codificado em COBS e termina com 0x00; o primeiro byte decodificado é o
+// tipo. Campos em little-endian. O receptor no PC (tools/imu_stream.cpp)
+// precisa seguir exatamente este formato.
+#define IMU_STREAM_DEFAULT_HZ 1000
+#define IMU_STREAM_MAX_HZ 2000
+
+typedef enum {
+    IMU_FRAME_INFO = 1,    // taxa_hz u16, LSB/g u16, LSB/(°/s) x10 u16
+    IMU_FRAME_SAMPLE = 2,  // seq u32, t_us u32, acel i16[3], giro i16[3]
+    IMU_FRAME_STATS = 3    // seq u32, enviadas u32, perdidas u32, atrasadas u32 (último segundo)
+} imu_frame_type_t;
+
+typedef struct {
+    uint32_t sent;     // Quadros entregues à CDC
+    uint32_t dropped;  // Sem espaço na CDC (PC não está lendo rápido o bastante)
+    uint32_t late;     // Períodos perdidos porque a leitura atrasou
+} imu_stream_stats_t;
+
+// Protótipos das funções
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst);
+void imu_stream_run(mpu6050_t *mpu, uint32_t rate_hz, imu_stream_stats_t *total);
+
+#endif // IMU_STREAM_H
@@ -0,0 +1,211 @@
+#include "imz.h"
+#include <string.h>
+
+#define HEADER_SIZE sizeof(imz_block_header_t)
+#define PAYLOAD_MAX (IMZ_BLOCK_SIZE - HEADER_SIZE)
+#define ESCAPE_Q 16       // Quociente que sinaliza o escape para 32 bits
+#define CTX_RESET 64      // Janela da média adaptativa
+#define CTX_INIT_SUM 16   // k inicial 4
+// Pior caso de uma amostra: escape (16 + 32 bits) em todos os canais
+#define SAMPLE_MAX_BYTES ((IMZ_CHANNELS * (ESCAPE_Q + 32) + 7) / 8)
+
+_Static_assert(sizeof(imz_block_header_t) == 72, "cabeçalho do bloco .imz mudou");
+
+// CRC-32 (o mesmo do bulk_xfer) com tabela de 16 entradas, meio byte por vez
+static uint32_t crc32(const uint8_t *p, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = ~0u;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0xF];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+    }
+    return ~crc;
+}
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static inline int ctx_k(const imz_ctx_t *c) {
+    int k = 0;
+    while ((c->n << k) < c->sum && k < 24) k++;
+    return k;
+}
+
+static inline void ctx_update(imz_ctx_t *c, uint32_t u) {
+    c->sum += u < (1u << 24) ? u : (1u << 24);
+    if (++c->n == CTX_RESET) {
+        c->sum >>= 1;
+        c->n >>= 1;
+    }
+}
+
+static void ctx_reset(imz_ctx_t *ctx) {
+    for (int i = 0; i < IMZ_CHANNELS; i++) {
+        ctx[i].sum = CTX_INIT_SUM;
+        ctx[i].n = 1;
+    }
+}
+
+// ---- Codificador ----
+
+// Escreve os n bits menos significativos de v (n <= 24)
+static inline void put_bits(imz_encoder_t *e, uint32_t v, int n) {
+    e->bits = (e->bits << n) | (v & ((1u << n) - 1));
+    e->nbits += n;
+    while (e->nbits >= 8) {
+        e->nbits -= 8;
+        e->block[HEADER_SIZE + e->pos++] = (uint8_t)(e->bits >> e->nbits);
+    }
+}
+
+static void put_rice(imz_encoder_t *e, imz_ctx_t *c, uint32_t u) {
+    int k = ctx_k(c);
+    uint32_t q = u >> k;
+    if (q < ESCAPE_Q) {
+        put_bits(e, ((1u << q) - 1) << 1, (int)q + 1);  // q uns e um zero
+        if (k) put_bits(e, u, k);
+    } else {
+        put_bits(e, (1u << ESCAPE_Q) - 1, ESCAPE_Q);
+        put_bits(e, u >> 16, 16);
+        put_bits(e, u, 16);
+    }
+    ctx_update(c, u);
+}
+
+static void start_block(imz_encoder_t *e, const int32_t v[IMZ_AXES], uint64_t t_us) {
+    imz_block_header_t *h = (imz_block_header_t *)e->block;
+    memset(h, 0, HEADER_SIZE);
+    memcpy(h->magic, IMZ_MAGIC, 4);
+    h->version = IMZ_VERSION;
+    h->header_size = HEADER_SIZE;
+    h->seq = e->seq;
+    h->first_index = e->index;
+    h->t0_us = t_us;
+    h->period_us = e->period_us;
+    h->accel_lsb = e->accel_lsb;
+    h->gyro_lsb = e->gyro_lsb;
+    h->frac_bits = e->frac_bits;
+    memcpy(h->first, v, sizeof h->first);
+    e->pos = 0;
+    e->bits = 0;
+    e->nbits = 0;
+    e->n = 1;
+    ctx_reset(e->ctx);
+}
+
+static const uint8_t *finish_block(imz_encoder_t *e) {
+    if (e->nbits) put_bits(e, 0, 8 - e->nbits);
+    imz_block_header_t *h = (imz_block_header_t *)e->block;
+    h->n_samples = e->n;
+    h->payload_bytes = (uint16_t)e->pos;
+    h->crc = crc32(e->block + HEADER_SIZE, e->pos);
+    memset(e->block + HEADER_SIZE + e->pos, 0, PAYLOAD_MAX - e->pos);
+    e->n = 0;
+    e->seq++;
+    return e->block;
+}
+
+void imz_encoder_init(imz_encoder_t *e, uint32_t period_us, float accel_lsb, float gyro_lsb,
+                      uint8_t frac_bits) {
+    memset(e, 0, sizeof *e);
+    e->period_us = period_us;
+    e->accel_lsb = accel_lsb;
+    e->gyro_lsb = gyro_lsb;
+    e->frac_bits = frac_bits;
+}
+
+const uint8_t *imz_encoder_add(imz_encoder_t *e, const int32_t v[IMZ_AXES], uint64_t t_us) {
+    if (!e->n) {
+        start_block(e, v, t_us);
+    } else {
+        for (int i = 0; i < IMZ_AXES; i++) put_rice(e, &e->ctx[i], zigzag(v[i] - e->prev[i]));
+        int32_t dt = (int32_t)(t_us - e->prev_t - e->period_us);
+        put_rice(e, &e->ctx[IMZ_AXES], zigzag(dt));
+        e->n++;
+    }
+    memcpy(e->prev, v, sizeof e->prev);
+    e->prev_t = t_us;
+    e->index++;
+    // Fecha o bloco se a próxima amostra, no pior caso, não couber
+    if (e->pos + SAMPLE_MAX_BYTES + 1 > PAYLOAD_MAX || e->n == UINT16_MAX)
+        return finish_block(e);
+    return NULL;
+}
+
+const uint8_t *imz_encoder_flush(imz_encoder_t *e) {
+    return e->n ? finish_block(e) : NULL;
+}
+
+// ---- Decodificador ----
+
+typedef struct {
+    const uint8_t *p, *end;
+    uint32_t bits;
+    int nbits;
+    bool overrun;
+} bit_reader_t;
+
+static inline uint32_t get_bits(bit_reader_t *r, int n) {
+    while (r->nbits < n) {
+        uint8_t b = 0;
+        if (r->p < r->end)
+            b = *r->p++;
+        else
+            r->overrun = true;
+        r->bits = (r->bits << 8) | b;
+        r->nbits += 8;
+    }
+    r->nbits -= n;
+    return (r->bits >> r->nbits) & ((1u << n) - 1);
+}
+
+static uint32_t get_rice(bit_reader_t *r, imz_ctx_t *c) {
+    int k = ctx_k(c);
+    uint32_t q = 0;
+    while (q < ESCAPE_Q && get_bits(r, 1)) q++;
+    uint32_t u;
+    if (q < ESCAPE_Q) {
+        u = (q << k) | (k ? get_bits(r, k) : 0);
+    } else {
+        u = get_bits(r, 16) << 16;
+        u |= get_bits(r, 16);
+    }
+    ctx_update(c, u);
+    return u;
+}
+
+int imz_decode_block(const uint8_t *block, size_t len, imz_block_header_t *hdr,
+                     imz_sample_t *out, size_t max_out) {
+    if (len < HEADER_SIZE) return IMZ_ERR_FORMAT;
+    imz_block_header_t h;
+    memcpy(&h, block, HEADER_SIZE);
+    if (memcmp(h.magic, IMZ_MAGIC, 4) || h.header_size != HEADER_SIZE) return IMZ_ERR_MAGIC;
+    if (h.payload_bytes > len - HEADER_SIZE || h.n_samples == 0 || h.n_samples > max_out)
+        return IMZ_ERR_FORMAT;
+    if (crc32(block + HEADER_SIZE, h.payload_bytes) != h.crc) return IMZ_ERR_CRC;
+    if (hdr) *hdr = h;
+
+    imz_ctx_t ctx[IMZ_CHANNELS];
+    ctx_reset(ctx);
+    bit_reader_t r = {block + HEADER_SIZE, block + HEADER_SIZE + h.payload_bytes, 0, 0, false};
+    memcpy(out[0].v, h.first, sizeof out[0].v);
+    out[0].t_us = h.t0_us;
+    for (int s = 1; s < h.n_samples; s++) {
+        for (int i = 0; i < IMZ_AXES; i++)
+            out[s].v[i] = out[s - 1].v[i] + unzigzag(get_rice(&r, &ctx[i]));
+        int32_t dt = unzigzag(get_rice(&r, &ctx[IMZ_AXES]));
+        out[s].t_us = out[s - 1].t_us + h.period_us + (int64_t)dt;
+        if (r.overrun) return IMZ_ERR_FORMAT;
+    }
+    return h.n_samples;
+}
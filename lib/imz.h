@@ -0,0 +1,92 @@
+#ifndef IMZ_H
+#define IMZ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Compressão sem perdas do log do IMU (arquivos .imz). O arquivo é uma
+// sequência de blocos de IMZ_BLOCK_SIZE bytes, cada um decodificável
+// sozinho: um cabeçalho com a primeira amostra inteira e, depois, as
+// demais como resíduos.
+//
+// Cada canal (6 eixos e o tempo) é previsto pelo valor anterior (o tempo,
+// pelo anterior mais o período nominal). O resíduo passa por zigzag e vai
+// em código de Rice, com o parâmetro k adaptado por canal pela média dos
+// resíduos recentes (como no LOCO-I): o decodificador refaz a mesma conta,
+// então nada disso é gravado. Resíduos grandes demais escapam para 32 bits
+// crus. Tudo recomeça a cada bloco, e um CRC-32 protege a carga.
+//
+// O codificador trabalha amostra a amostra dentro do bloco de 4 KiB (um
+// segmento do sd_array, oito setores): ~100 a 150 ciclos por canal no
+// Cortex-M0+. O decodificador é o mesmo código, compilado também pelo
+// tools/imu_imz; por isso só usa stdint. O formato é little-endian.
+
+#define IMZ_BLOCK_SIZE 4096
+#define IMZ_AXES 6
+#define IMZ_CHANNELS (IMZ_AXES + 1)  // Eixos e tempo
+#define IMZ_MAGIC "IMZ1"
+#define IMZ_VERSION 1
+// Limite de amostras por bloco (cada canal ocupa pelo menos 1 bit)
+#define IMZ_MAX_SAMPLES ((IMZ_BLOCK_SIZE * 8) / IMZ_CHANNELS + 1)
+
+#define IMZ_ERR_MAGIC (-1)
+#define IMZ_ERR_CRC (-2)
+#define IMZ_ERR_FORMAT (-3)
+
+typedef struct {
+    char magic[4];           // IMZ_MAGIC
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t seq;            // Número do bloco no arquivo, desde 0
+    uint32_t first_index;    // Número da primeira amostra, desde 0
+    uint64_t t0_us;          // Carimbo da primeira amostra
+    uint32_t period_us;      // Período nominal (predição do tempo)
+    uint16_t n_samples;      // Contando a primeira
+    uint16_t payload_bytes;  // Resíduos depois do cabeçalho
+    float accel_lsb;         // Contagens por g
+    float gyro_lsb;          // Contagens por grau/s
+    uint8_t frac_bits;       // Bits fracionários dos valores (8 com decimação)
+    uint8_t reserved[3];
+    uint32_t crc;            // CRC-32 da carga
+    int32_t first[IMZ_AXES]; // Primeira amostra
+} imz_block_header_t;
+
+typedef struct {
+    uint32_t sum;  // Soma dos resíduos recentes (zigzag)
+    uint32_t n;
+} imz_ctx_t;
+
+typedef struct {
+    uint8_t block[IMZ_BLOCK_SIZE];
+    uint32_t pos;            // Bytes de carga já escritos
+    uint32_t bits;           // Acumulador de bits (MSB primeiro)
+    int nbits;
+    int32_t prev[IMZ_AXES];
+    uint64_t prev_t;
+    imz_ctx_t ctx[IMZ_CHANNELS];
+    uint16_t n;              // Amostras no bloco atual
+    uint32_t seq, index;
+    uint32_t period_us;
+    float accel_lsb, gyro_lsb;
+    uint8_t frac_bits;
+} imz_encoder_t;
+
+typedef struct {
+    int32_t v[IMZ_AXES];
+    uint64_t t_us;
+} imz_sample_t;
+
+// Protótipos das funções
+void imz_encoder_init(imz_encoder_t *e, uint32_t period_us, float accel_lsb, float gyro_lsb,
+                      uint8_t frac_bits);
+// Acrescenta uma amostra; se isso fechou um bloco, retorna os
+// IMZ_BLOCK_SIZE bytes dele (válidos até a próxima chamada), senão NULL
+const uint8_t *imz_encoder_add(imz_encoder_t *e, const int32_t v[IMZ_AXES], uint64_t t_us);
+// Fecha o bloco incompleto no fim da gravação (NULL se estiver vazio)
+const uint8_t *imz_encoder_flush(imz_encoder_t *e);
+// Decodifica um bloco; retorna o número de amostras ou IMZ_ERR_*
+int imz_decode_block(const uint8_t *block, size_t len, imz_block_header_t *hdr,
+                     imz_sample_t *out, size_t max_out);
+
+#endif // IMZ_H
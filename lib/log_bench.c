@@ -0,0 +1,271 @@
+#include "log_bench.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/spi.h"
+#include "f_util.h"
+#include "hw_config.h"
+#include "core1_worker.h"
+#include "trace.h"
+#include "cpu_load.h"
+
+// Revisão do código gravada nos relatórios (definida pelo CMake)
+#ifndef BUILD_GIT_REV
+#define BUILD_GIT_REV "unknown"
+#endif
+
+static uint8_t bench_buf[LOG_BENCH_MAX_BUF];
+
+static const char *format_str(log_bench_format_t f) {
+    return LOG_BENCH_BIN == f ? "bin" : "csv";
+}
+
+static const char *sync_str(log_bench_sync_t s) {
+    switch (s) {
+        case LOG_BENCH_SYNC_1S: return "1s";
+        case LOG_BENCH_SYNC_EACH: return "each";
+        default: return "close";
+    }
+}
+
+// Uma escrita (ou sync) cronometrada: é o tempo que o core0 fica sem amostrar
+static FRESULT timed_write(const log_bench_params_t *p, log_bench_result_t *r,
+                           const uint8_t *data, UINT len, bool sync) {
+    uint64_t t0 = time_us_64();
+    FRESULT fr = FR_OK;
+    if (len) fr = sd_array_write(p->array, data, len);
+    if (FR_OK == fr && (sync || LOG_BENCH_SYNC_EACH == p->sync))
+        fr = sd_array_sync(p->array);
+    uint32_t dt = (uint32_t)(time_us_64() - t0);
+    r->writes++;
+    r->write_sum_us += dt;
+    if (dt > r->write_max_us) r->write_max_us = dt;
+    r->bytes += len;
+    return fr;
+}
+
+static UINT make_record(mpu6050_t *mpu, log_bench_format_t format, uint32_t n, uint8_t *dst) {
+    uint32_t t_us = time_us_32();
+    if (LOG_BENCH_BIN == format) {
+        int16_t a[3], g[3];
+        TRACE_BEGIN(TRACE_IMU_READ, 0);
+        mpu6050_read_raw(mpu, a, g);
+        TRACE_END(TRACE_IMU_READ, 0);
+        memcpy(dst, &t_us, 4);
+        memcpy(dst + 4, a, sizeof a);
+        memcpy(dst + 10, g, sizeof g);
+        return 16;
+    }
+    float a[3], g[3];
+    TRACE_BEGIN(TRACE_IMU_READ, 0);
+    mpu6050_read_calibrated(mpu, a, g);
+    TRACE_END(TRACE_IMU_READ, 0);
+    return (UINT)snprintf((char *)dst, 100, "%lu,%f,%f,%f,%f,%f,%f,%f\n", (unsigned long)n,
+                          a[0], a[1], a[2], g[0], g[1], g[2], t_us / 1e6f);
+}
+
+// Ajusta o clock SPI dos cartões usados; devolve o clock real do cartão 0
+static uint32_t set_spi_clock(uint n_cards, uint32_t hz, uint32_t saved[]) {
+    uint32_t actual = 0;
+    for (uint i = 0; i < n_cards; i++) {
+        spi_t *spi = sd_get_by_num(i)->spi;
+        saved[i] = spi->baud_rate;
+        if (hz) spi->baud_rate = hz;
+        uint32_t got = spi_set_baudrate(spi->hw_inst, spi->baud_rate);
+        if (0 == i) actual = got;
+    }
+    return actual;
+}
+
+static void restore_spi_clock(uint n_cards, const uint32_t saved[]) {
+    for (uint i = 0; i < n_cards; i++) {
+        spi_t *spi = sd_get_by_num(i)->spi;
+        spi->baud_rate = saved[i];
+        spi_set_baudrate(spi->hw_inst, saved[i]);
+    }
+}
+
+// Roda o logger com os parâmetros dados por p->duration_ms. As amostras têm
+// horário fixo (t0 + k * período); quando uma escrita segura o core0 além
+// do horário, os períodos que passaram contam como perdidos.
+FRESULT log_bench_run(mpu6050_t *mpu, const log_bench_params_t *p, log_bench_result_t *r) {
+    memset(r, 0, sizeof *r);
+    const uint n_cards = (SD_ARRAY_SINGLE == p->mode) ? 1 : 2;
+    uint32_t saved_hz[SD_ARRAY_MAX_CARDS];
+    if (n_cards > sd_get_num()) return r->result = FR_INVALID_DRIVE;
+    r->spi_hz = set_spi_clock(n_cards, p->spi_hz, saved_hz);
+
+    FRESULT fr = sd_array_open(p->array, p->mode, LOG_BENCH_FILE);
+    if (FR_OK != fr) {
+        restore_spi_clock(n_cards, saved_hz);
+        return r->result = fr;
+    }
+    // Só os f_sync da política medida (p->sync), sem os do log da captura
+    p->array->hold = false;
+
+    const uint32_t period_us = 1000000 / p->rate_hz;
+    const uint32_t buf_size = p->buf_bytes > LOG_BENCH_MAX_BUF ? LOG_BENCH_MAX_BUF : p->buf_bytes;
+    const uint64_t t_start = time_us_64();
+    const uint64_t t_end = t_start + p->duration_ms * 1000ull;
+    const uint64_t core1_start = core1_worker_busy_us();
+    uint64_t next = t_start, last_sync = t_start;
+    UINT len = 0;
+    uint8_t rec[100];
+
+    while (next < t_end && FR_OK == fr) {
+        uint64_t now = time_us_64();
+        if (now < next) {
+            CPU_IDLE_BEGIN();
+            sleep_until(from_us_since_boot(next));
+            CPU_IDLE_END();
+            uint64_t woke = time_us_64();
+            r->core0_idle_us += woke - now;
+            now = woke;
+        }
+        uint32_t missed = (uint32_t)((now - next) / period_us);
+        if (missed) {
+            r->dropped += missed;
+            next += (uint64_t)missed * period_us;
+            if (next >= t_end) break;
+        }
+        next += period_us;
+
+        UINT n = make_record(mpu, p->format, r->samples + 1, rec);
+        r->samples++;
+        if (!buf_size) {
+            fr = timed_write(p, r, rec, n, false);
+        } else {
+            if (len + n > buf_size) {
+                fr = timed_write(p, r, bench_buf, len, false);
+                len = 0;
+            }
+            memcpy(bench_buf + len, rec, n);
+            len += n;
+        }
+        if (FR_OK == fr && LOG_BENCH_SYNC_1S == p->sync && now - last_sync >= 1000000) {
+            fr = timed_write(p, r, NULL, 0, true);
+            last_sync = now;
+        }
+    }
+    if (FR_OK == fr && len) fr = timed_write(p, r, bench_buf, len, false);
+
+    // O fechamento (sync final) também segura o logger: entra na latência
+    uint64_t t0 = time_us_64();
+    FRESULT fr_close = sd_array_close(p->array);
+    uint32_t dt = (uint32_t)(time_us_64() - t0);
+    if (dt > r->write_max_us) r->write_max_us = dt;
+    if (FR_OK == fr) fr = fr_close;
+
+    r->elapsed_us = (uint32_t)(time_us_64() - t_start);
+    r->core1_busy_us = core1_worker_busy_us() - core1_start;
+    r->result = fr;
+
+    for (uint i = 0; i < n_cards; i++) {
+        char path[40];
+        snprintf(path, sizeof path, "%s%s", sd_get_by_num(i)->pcName, LOG_BENCH_FILE);
+        f_unlink(path);
+    }
+    restore_spi_clock(n_cards, saved_hz);
+    return fr;
+}
+
+static void print_header(bool json) {
+    printf("--- bench begin ---\n");
+    if (json)
+        printf("{\"rev\": \"%s\", \"build\": \"%s %s\", \"runs\": [\n", BUILD_GIT_REV, __DATE__,
+               __TIME__);
+    else
+        printf("rev,mode,rate_hz,format,buf_bytes,sync,spi_hz,duration_ms,samples,dropped,"
+               "samples_per_s,bytes,kib_per_s,write_avg_us,write_max_us,core0_cpu_pct,"
+               "core1_cpu_pct,wfi_ms,result\n");
+}
+
+static void print_run(bool json, bool first, const log_bench_params_t *p,
+                      const log_bench_result_t *r) {
+    double s = r->elapsed_us / 1e6;
+    double sps = s > 0 ? r->samples / s : 0;
+    double kib_s = s > 0 ? r->bytes / 1024.0 / s : 0;
+    uint32_t avg = r->writes ? (uint32_t)(r->write_sum_us / r->writes) : 0;
+    double cpu0 = r->elapsed_us ? 100.0 * (r->elapsed_us - r->core0_idle_us) / r->elapsed_us : 0;
+    double cpu1 = r->elapsed_us ? 100.0 * r->core1_busy_us / r->elapsed_us : 0;
+    // Energia (aproximação): tempo somado dos dois cores dormindo
+    double wfi_ms = (r->core0_idle_us + (r->elapsed_us - r->core1_busy_us)) / 1000.0;
+    const char *mode = sd_array_mode_str(p->mode);
+    if (json) {
+        printf("%s  {\"mode\": \"%s\", \"rate_hz\": %lu, \"format\": \"%s\", \"buf_bytes\": %lu, "
+               "\"sync\": \"%s\", \"spi_hz\": %lu, \"duration_ms\": %lu, \"samples\": %lu, "
+               "\"dropped\": %lu, \"samples_per_s\": %.1f, \"bytes\": %llu, \"kib_per_s\": %.2f, "
+               "\"write_avg_us\": %lu, \"write_max_us\": %lu, \"core0_cpu_pct\": %.1f, "
+               "\"core1_cpu_pct\": %.1f, \"wfi_ms\": %.1f, \"result\": \"%s\"}",
+               first ? "" : ",\n", mode, (unsigned long)p->rate_hz, format_str(p->format),
+               (unsigned long)p->buf_bytes, sync_str(p->sync), (unsigned long)r->spi_hz,
+               (unsigned long)(r->elapsed_us / 1000), (unsigned long)r->samples,
+               (unsigned long)r->dropped, sps, (unsigned long long)r->bytes, kib_s,
+               (unsigned long)avg, (unsigned long)r->write_max_us, cpu0, cpu1, wfi_ms,
+               FRESULT_str(r->result));
+    } else {
+        printf("%s,%s,%lu,%s,%lu,%s,%lu,%lu,%lu,%lu,%.1f,%llu,%.2f,%lu,%lu,%.1f,%.1f,%.1f,%s\n",
+               BUILD_GIT_REV, mode, (unsigned long)p->rate_hz, format_str(p->format),
+               (unsigned long)p->buf_bytes, sync_str(p->sync), (unsigned long)r->spi_hz,
+               (unsigned long)(r->elapsed_us / 1000), (unsigned long)r->samples,
+               (unsigned long)r->dropped, sps, (unsigned long long)r->bytes, kib_s,
+               (unsigned long)avg, (unsigned long)r->write_max_us, cpu0, cpu1, wfi_ms,
+               FRESULT_str(r->result));
+    }
+    stdio_flush();
+}
+
+// Percorre todas as combinações e imprime o relatório entre as linhas
+// "--- bench begin ---" e "--- bench end ---". Enter no console interrompe
+// depois da rodada atual. Devolve o número de rodadas feitas.
+int log_bench_sweep(mpu6050_t *mpu, const log_bench_sweep_t *sweep) {
+    static const uint32_t rates_quick[] = {100, 1000};
+    static const uint32_t rates_full[] = {100, 500, 1000, 2000};
+    static const uint32_t bufs_quick[] = {512, 4096};
+    static const uint32_t bufs_full[] = {0, 512, 4096};
+    static const log_bench_sync_t syncs_quick[] = {LOG_BENCH_SYNC_CLOSE, LOG_BENCH_SYNC_1S};
+    static const log_bench_sync_t syncs_full[] = {LOG_BENCH_SYNC_CLOSE, LOG_BENCH_SYNC_1S,
+                                                  LOG_BENCH_SYNC_EACH};
+    static const uint32_t spis_quick[] = {0};
+    static const uint32_t spis_full[] = {1000000, 12500000, 25000000};
+
+    const bool full = sweep->full;
+    const uint32_t *rates = full ? rates_full : rates_quick;
+    const uint32_t *bufs = full ? bufs_full : bufs_quick;
+    const log_bench_sync_t *syncs = full ? syncs_full : syncs_quick;
+    const uint32_t *spis = full ? spis_full : spis_quick;
+    const int n_rates = full ? count_of(rates_full) : count_of(rates_quick);
+    const int n_bufs = full ? count_of(bufs_full) : count_of(bufs_quick);
+    const int n_syncs = full ? count_of(syncs_full) : count_of(syncs_quick);
+    const int n_spis = full ? count_of(spis_full) : count_of(spis_quick);
+    const int total = n_spis * n_rates * 2 * n_bufs * n_syncs;
+
+    print_header(sweep->json);
+    int run = 0;
+    bool stop = false;
+    for (int si = 0; si < n_spis && !stop; si++)
+        for (int ri = 0; ri < n_rates && !stop; ri++)
+            for (int fi = 0; fi < 2 && !stop; fi++)
+                for (int bi = 0; bi < n_bufs && !stop; bi++)
+                    for (int yi = 0; yi < n_syncs && !stop; yi++) {
+                        log_bench_params_t p = {
+                            .rate_hz = rates[ri],
+                            .format = fi ? LOG_BENCH_BIN : LOG_BENCH_CSV,
+                            .buf_bytes = bufs[bi],
+                            .sync = syncs[yi],
+                            .spi_hz = spis[si],
+                            .duration_ms = sweep->duration_ms,
+                            .mode = sweep->mode,
+                            .array = sweep->array,
+                        };
+                        if (sweep->progress) sweep->progress(run, total);
+                        log_bench_result_t r;
+                        log_bench_run(mpu, &p, &r);
+                        print_run(sweep->json, 0 == run, &p, &r);
+                        run++;
+                        if ('\r' == getchar_timeout_us(0)) stop = true;
+                    }
+    if (sweep->json) printf("\n]}\n");
+    printf("--- bench end ---\n");
+    stdio_flush();
+    return run;
+}
@@ -0,0 +1,67 @@
+#ifndef LOG_BENCH_H
+#define LOG_BENCH_H
+
+#include "pico/stdlib.h"
+#include "ff.h"
+#include "MPU6050.h"
+#include "sd_array.h"
+
+// Maior buffer de registros testado
+#define LOG_BENCH_MAX_BUF 4096
+
+// Arquivo temporário gravado em cada rodada (apagado no fim)
+#define LOG_BENCH_FILE "bench.dat"
+
+typedef enum {
+    LOG_BENCH_CSV = 0,  // Linha de texto como a da captura ('f')
+    LOG_BENCH_BIN       // 16 bytes: t_us u32 + accel i16[3] + gyro i16[3]
+} log_bench_format_t;
+
+typedef enum {
+    LOG_BENCH_SYNC_CLOSE = 0,  // Só no f_close do fim
+    LOG_BENCH_SYNC_1S,         // f_sync a cada segundo
+    LOG_BENCH_SYNC_EACH        // f_sync após cada escrita do buffer
+} log_bench_sync_t;
+
+// Uma combinação de parâmetros
+typedef struct {
+    uint32_t rate_hz;
+    log_bench_format_t format;
+    uint32_t buf_bytes;        // 0: cada amostra vai direto para o f_write
+    log_bench_sync_t sync;
+    uint32_t spi_hz;           // 0: mantém o clock do hw_config.c
+    uint32_t duration_ms;
+    sd_array_mode_t mode;
+    sd_array_t *array;         // Emprestado: o da captura, que não roda junto
+} log_bench_params_t;
+
+typedef struct {
+    uint32_t spi_hz;           // Clock real obtido do divisor do SPI
+    uint32_t samples;          // Amostras gravadas
+    uint32_t dropped;          // Períodos perdidos com o core0 preso em escrita
+    uint64_t bytes;
+    uint32_t elapsed_us;
+    uint32_t writes;           // Chamadas de escrita/sync cronometradas
+    uint32_t write_max_us;
+    uint64_t write_sum_us;
+    uint64_t core0_idle_us;    // Dormindo em sleep_until (WFE)
+    uint64_t core1_busy_us;
+    FRESULT result;
+} log_bench_result_t;
+
+// Varredura: "quick" (16 rodadas) ou "full" (216 rodadas)
+typedef struct {
+    bool full;
+    bool json;                 // Relatório em JSON em vez de CSV
+    uint32_t duration_ms;      // Por rodada
+    sd_array_mode_t mode;
+    sd_array_t *array;
+    // Chamado antes de cada rodada (ex: atualizar o display); pode ser NULL
+    void (*progress)(int run, int total);
+} log_bench_sweep_t;
+
+// Protótipos das funções
+FRESULT log_bench_run(mpu6050_t *mpu, const log_bench_params_t *p, log_bench_result_t *r);
+int log_bench_sweep(mpu6050_t *mpu, const log_bench_sweep_t *sweep);
+
+#endif // LOG_BENCH_H
@@ -0,0 +1,159 @@
+#include "sample_clock.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "cpu_load.h"
+
+static mpu6050_t *clock_mpu;
+static uint clock_gpio;
+static volatile bool clock_running;
+
+// Carimbos gravados pela interrupção e consumidos pelo laço
+static volatile uint64_t ring[SAMPLE_CLOCK_RING];
+static volatile uint32_t ring_head, ring_tail;
+static volatile uint32_t ring_overflow;
+
+static sample_clock_stats_t stats;
+static uint64_t last_stamp;     // Último carimbo usado nas estatísticas
+static uint64_t next_timer_us;  // Próxima amostra sem o INT
+
+// Chamada do tratador de GPIO na borda de subida do INT
+void __not_in_flash_func(sample_clock_irq)(void) {
+    uint64_t now = time_us_64();
+    if (!clock_running) return;
+    if (ring_head - ring_tail == SAMPLE_CLOCK_RING) {
+        ring_overflow++;
+        return;
+    }
+    ring[ring_head % SAMPLE_CLOCK_RING] = now;
+    ring_head++;
+}
+
+// Configura o sensor para gerar o data-ready no período pedido (múltiplo de
+// 1 ms) e liga a interrupção. Retorna o período real em us.
+uint32_t sample_clock_start(mpu6050_t *mpu, uint int_gpio, uint32_t period_us) {
+    clock_mpu = mpu;
+    clock_gpio = int_gpio;
+    memset(&stats, 0, sizeof stats);
+    stats.min_us = UINT32_MAX;
+    stats.from_int = true;
+    ring_head = ring_tail = ring_overflow = 0;
+    last_stamp = 0;
+
+    gpio_init(int_gpio);
+    gpio_set_dir(int_gpio, GPIO_IN);
+    gpio_pull_down(int_gpio);  // Sem o sensor ligado, o pino fica em 0
+    stats.period_us = mpu6050_enable_data_ready(mpu, period_us);
+    next_timer_us = time_us_64() + stats.period_us;
+    clock_running = true;
+    gpio_set_irq_enabled(int_gpio, GPIO_IRQ_EDGE_RISE, true);
+    return stats.period_us;
+}
+
+void sample_clock_stop(void) {
+    gpio_set_irq_enabled(clock_gpio, GPIO_IRQ_EDGE_RISE, false);
+    clock_running = false;
+    mpu6050_disable_data_ready(clock_mpu);
+}
+
+static void add_interval(uint32_t dt) {
+    int32_t dev = (int32_t)(dt - stats.period_us);
+    uint32_t mag = dev < 0 ? -dev : dev;
+    uint b = mag ? 32 - __builtin_clz(mag) : 0;
+    if (b >= SAMPLE_CLOCK_HIST_BUCKETS) b = SAMPLE_CLOCK_HIST_BUCKETS - 1;
+    stats.hist[b]++;
+    stats.count++;
+    stats.sum_dev_us += dev;
+    stats.sum_dev2_us += (uint64_t)((int64_t)dev * dev);
+    if (dt < stats.min_us) stats.min_us = dt;
+    if (dt > stats.max_us) stats.max_us = dt;
+}
+
+// Espera a próxima amostra e retorna o carimbo dela (us desde o boot).
+// Se o laço atrasou e há vários pulsos pendentes, fica com o mais novo
+// (é o que está nos registros do sensor) e conta os outros como perdidos.
+uint64_t sample_clock_wait(void) {
+    if (stats.from_int) {
+        // Dorme pelo timer até perto do pulso esperado e então espera por ele
+        uint64_t expected = (last_stamp ? last_stamp : time_us_64()) + stats.period_us;
+        uint64_t deadline = expected + 2 * stats.period_us + 10000;
+        CPU_IDLE_BEGIN();
+        if (ring_head == ring_tail && expected > time_us_64() + 500)
+            sleep_until(from_us_since_boot(expected - 500));
+        while (ring_head == ring_tail && time_us_64() < deadline)
+            tight_loop_contents();
+        CPU_IDLE_END();
+
+        if (ring_head != ring_tail) {
+            uint64_t stamp = 0;
+            uint32_t taken = 0;
+            while (ring_head != ring_tail) {
+                stamp = ring[ring_tail % SAMPLE_CLOCK_RING];
+                ring_tail++;
+                if (last_stamp) add_interval((uint32_t)(stamp - last_stamp));
+                last_stamp = stamp;
+                taken++;
+            }
+            stats.lost += taken - 1 + ring_overflow;
+            ring_overflow = 0;
+            uint32_t service = (uint32_t)(time_us_64() - stamp);
+            if (service > stats.service_max_us) stats.service_max_us = service;
+            return stamp;
+        }
+        // Nenhum pulso: INT desligado ou sensor parado
+        printf("[AVISO] Sem data-ready do MPU6050 no GPIO %u; usando o timer.\n", clock_gpio);
+        stats.from_int = false;
+        next_timer_us = time_us_64();
+        last_stamp = 0;
+    }
+
+    uint64_t now = time_us_64();
+    if (now < next_timer_us) {
+        CPU_IDLE_BEGIN();
+        sleep_until(from_us_since_boot(next_timer_us));
+        CPU_IDLE_END();
+    } else if (now - next_timer_us >= stats.period_us) {
+        uint32_t missed = (uint32_t)((now - next_timer_us) / stats.period_us);
+        stats.lost += missed;
+        next_timer_us += (uint64_t)missed * stats.period_us;
+    }
+    uint64_t stamp = time_us_64();
+    if (last_stamp) add_interval((uint32_t)(stamp - last_stamp));
+    last_stamp = stamp;
+    next_timer_us += stats.period_us;
+    return stamp;
+}
+
+const sample_clock_stats_t *sample_clock_stats(void) {
+    return &stats;
+}
+
+void sample_clock_print(const sample_clock_stats_t *st, bool histogram) {
+    if (!st->count) {
+        printf("Relógio de amostragem: sem intervalos medidos\n");
+        return;
+    }
+    double mean_dev = (double)st->sum_dev_us / st->count;
+    double var = (double)st->sum_dev2_us / st->count - mean_dev * mean_dev;
+    printf("Relógio de amostragem (%s): %lu intervalos, período %lu us\n",
+           st->from_int ? "INT do MPU6050" : "timer", (unsigned long)st->count,
+           (unsigned long)st->period_us);
+    printf("  min %lu  max %lu  média %.1f  desvio %.1f us; %lu perdidas, atraso máx da leitura %lu us\n",
+           (unsigned long)st->min_us, (unsigned long)st->max_us, st->period_us + mean_dev,
+           var > 0 ? sqrt(var) : 0.0, (unsigned long)st->lost, (unsigned long)st->service_max_us);
+    if (!histogram) return;
+    printf("  |intervalo - período| (us):\n");
+    for (int i = 0; i < SAMPLE_CLOCK_HIST_BUCKETS; i++) {
+        if (!st->hist[i]) continue;
+        char range[24];
+        if (i <= 1)
+            snprintf(range, sizeof range, "%d", i);
+        else if (SAMPLE_CLOCK_HIST_BUCKETS - 1 == i)
+            snprintf(range, sizeof range, ">= %lu", 1UL << (i - 1));
+        else
+            snprintf(range, sizeof range, "%lu..%lu", 1UL << (i - 1), (1UL << i) - 1);
+        printf("    %14s %8lu\n", range, (unsigned long)st->hist[i]);
+    }
+}
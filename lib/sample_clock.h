@@ -0,0 +1,41 @@
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#include "pico/stdlib.h"
+#include "MPU6050.h"
+
+// Relógio de amostragem da captura: o pulso de data-ready do MPU6050 (pino
+// INT) é carimbado em us na interrupção, e o laço de captura lê a amostra
+// com esse carimbo. Assim o tempo gravado é o da amostra no sensor, não o
+// de quando o laço conseguiu chegar até ela.
+//
+// Os intervalos entre pulsos consecutivos alimentam as estatísticas de
+// jitter (mín/máx/média/desvio e histograma do desvio ao período nominal).
+// Se o INT não estiver ligado, o relógio cai para o timer do RP2040 e os
+// números passam a medir o próprio laço.
+
+#define SAMPLE_CLOCK_RING 16          // Carimbos pendentes (potência de 2)
+#define SAMPLE_CLOCK_HIST_BUCKETS 16  // |desvio|: 0, 1, 2..3, 4..7, ... us
+
+typedef struct {
+    uint32_t period_us;        // Nominal
+    uint32_t count;            // Intervalos medidos
+    uint32_t min_us;
+    uint32_t max_us;
+    int64_t sum_dev_us;        // Soma de (intervalo - período)
+    uint64_t sum_dev2_us;      // Soma de (intervalo - período)^2
+    uint32_t hist[SAMPLE_CLOCK_HIST_BUCKETS];
+    uint32_t lost;             // Amostras puladas porque o laço atrasou
+    uint32_t service_max_us;   // Maior atraso entre o pulso e a leitura
+    bool from_int;             // false: INT ausente, tempos do timer
+} sample_clock_stats_t;
+
+// Protótipos das funções
+uint32_t sample_clock_start(mpu6050_t *mpu, uint int_gpio, uint32_t period_us);
+uint64_t sample_clock_wait(void);
+void sample_clock_stop(void);
+void sample_clock_irq(void);
+const sample_clock_stats_t *sample_clock_stats(void);
+void sample_clock_print(const sample_clock_stats_t *st, bool histogram);
+
+#endif // SAMPLE_CLOCK_H
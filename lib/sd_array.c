@@ -0,0 +1,377 @@
+#include "sd_array.h"
+#include <stdio.h>
+#include <string.h>
+#include "diskio.h"
+#include "hw_config.h"
+#include "trace.h"
+
+const char *sd_array_mode_str(sd_array_mode_t mode) {
+    switch (mode) {
+        case SD_ARRAY_STRIPE: return "stripe";
+        case SD_ARRAY_MIRROR: return "mirror";
+        default: return "single";
+    }
+}
+
+// Segmento inteiro direto nos setores pré-alocados do arquivo
+static FRESULT sd_array_disk_write(sd_array_t *arr, uint card, const uint8_t *buf, UINT len, UINT *bw) {
+    UINT count = len / FF_MIN_SS;
+    *bw = 0;
+    if (arr->next_sector[card] + count > arr->end_sector[card])
+        return FR_OK;  // Fim da pré-alocação: conta como cartão cheio
+    if (RES_OK != disk_write(arr->files[card].obj.fs->pdrv, buf, arr->next_sector[card], count))
+        return FR_DISK_ERR;
+    arr->next_sector[card] += count;
+    *bw = len;
+    return FR_OK;
+}
+
+// f_write cronometrado, acumulando a latência do cartão
+static FRESULT sd_array_timed_write(sd_array_t *arr, uint card, const uint8_t *buf, UINT len) {
+    UINT bw;
+    uint32_t t0 = time_us_32();
+    TRACE_BEGIN(TRACE_F_WRITE, card);
+    FRESULT fr = arr->pages ? sd_array_disk_write(arr, card, buf, len, &bw)
+                            : f_write(&arr->files[card], buf, len, &bw);
+    TRACE_END(TRACE_F_WRITE, card);
+    uint32_t dt = time_us_32() - t0;
+
+    sd_array_stats_t *st = &arr->stats[card];
+    st->bytes += bw;
+    st->writes++;
+    st->lat_sum_us += dt;
+    if (dt < st->lat_min_us) st->lat_min_us = dt;
+    if (dt > st->lat_max_us) st->lat_max_us = dt;
+
+    if (FR_OK == fr && bw != len) fr = FR_DENIED;  // Cartão cheio
+    return fr;
+}
+
+// Executado no core1: grava o segmento "busy" no cartão 1
+static void sd_array_core1_write(void *arg) {
+    sd_array_t *arr = (sd_array_t *)arg;
+    FRESULT fr = sd_array_timed_write(arr, 1, arr->busy, arr->busy_len);
+    if (FR_OK != fr && FR_OK == arr->core1_result) arr->core1_result = fr;
+}
+
+// Espera o core1 liberar o segmento anterior e entrega o atual a ele
+static void sd_array_post_core1(sd_array_t *arr) {
+    core1_worker_wait(&arr->job);
+    uint8_t *tmp = arr->busy;
+    arr->busy = arr->fill;
+    arr->busy_len = arr->fill_len;
+    arr->fill = tmp;
+    TRACE_MARK(TRACE_BUF_SWAP, arr->busy_len);
+    core1_worker_post(&arr->job);
+}
+
+// Erros que a remontagem resolve (cartão fora ou sem resposta) deixam o
+// modo single offline; cartão cheio e os demais encerram o log
+static void sd_array_fault(sd_array_t *arr, FRESULT fr) {
+    if (FR_DISK_ERR == fr || FR_NOT_READY == fr || FR_INVALID_OBJECT == fr) {
+        if (!arr->offline) arr->outages++;
+        arr->offline = true;
+    } else if (FR_OK == arr->result) {
+        arr->result = fr;
+    }
+}
+
+// Arquivo comum no modo single: o que já foi escrito fica garantido no
+// cartão e a cópia em RAM recomeça
+static void sd_array_tail_sync(sd_array_t *arr) {
+    TRACE_BEGIN(TRACE_F_SYNC, 0);
+    FRESULT fr = f_sync(&arr->files[0]);
+    TRACE_END(TRACE_F_SYNC, 0);
+    if (FR_OK != fr) {
+        sd_array_fault(arr, fr);
+        return;
+    }
+    arr->synced_size = f_tell(&arr->files[0]);
+    arr->tail_len = 0;
+}
+
+// f_write direto, com a cópia em RAM ao lado; com o cartão fora só a cópia
+static void sd_array_single_write(sd_array_t *arr, const uint8_t *p, UINT len) {
+    uint8_t *tail = (uint8_t *)arr->buffers;
+    if (!arr->hold) {
+        if (arr->offline) {
+            arr->lost_bytes += len;
+            return;
+        }
+        FRESULT fr = sd_array_timed_write(arr, 0, p, len);
+        if (FR_OK != fr) sd_array_fault(arr, fr);
+        return;
+    }
+    while (len && FR_OK == arr->result) {
+        UINT n = len < SD_ARRAY_SEGMENT_SIZE ? len : SD_ARRAY_SEGMENT_SIZE;
+        if (!arr->offline && arr->tail_len + n > SD_ARRAY_SYNC_BYTES) sd_array_tail_sync(arr);
+        if (arr->tail_len + n > sizeof arr->buffers) {
+            arr->lost_bytes += len;  // RAM cheia com o cartão fora
+            return;
+        }
+        memcpy(tail + arr->tail_len, p, n);
+        arr->tail_len += n;
+        if (arr->tail_len > arr->held_peak) arr->held_peak = arr->tail_len;
+        if (!arr->offline) {
+            FRESULT fr = sd_array_timed_write(arr, 0, p, n);
+            if (FR_OK != fr) sd_array_fault(arr, fr);
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+// Arquivo do cartão 0 que ficou para trás numa queda. Com o volume
+// inacessível o f_close falha antes de soltar a trava do FF_FS_LOCK; o FIL
+// fica inválido e a trava sai na remontagem (f_unmount/f_mount)
+static void sd_array_drop_file(sd_array_t *arr) {
+    if (FR_OK != f_close(&arr->files[0])) arr->files[0].obj.fs = NULL;
+}
+
+// Páginas no modo single: grava as que esperam o cartão, em ordem
+static void sd_array_drain(sd_array_t *arr) {
+    while (!arr->offline && FR_OK == arr->result && arr->ring_pending) {
+        FRESULT fr = sd_array_timed_write(arr, 0, arr->buffers[arr->ring_head], SD_ARRAY_SEGMENT_SIZE);
+        if (FR_OK != fr) {
+            sd_array_fault(arr, fr);
+            return;
+        }
+        arr->ring_head = (arr->ring_head + 1) % SD_ARRAY_SEGMENTS;
+        arr->ring_pending--;
+    }
+}
+
+// A página cheia entra na fila e a próxima é preenchida no buffer seguinte
+static void sd_array_page_push(sd_array_t *arr) {
+    if (SD_ARRAY_SEGMENTS - 1 == arr->ring_pending) {
+        arr->lost_bytes += SD_ARRAY_SEGMENT_SIZE;  // Fila cheia com o cartão fora
+        return;
+    }
+    arr->ring_pending++;
+    if (arr->ring_pending * SD_ARRAY_SEGMENT_SIZE > arr->held_peak)
+        arr->held_peak = arr->ring_pending * SD_ARRAY_SEGMENT_SIZE;
+    arr->fill = arr->buffers[(arr->ring_head + arr->ring_pending) % SD_ARRAY_SEGMENTS];
+    sd_array_drain(arr);
+}
+
+static void sd_array_flush(sd_array_t *arr) {
+    if (!arr->fill_len) return;
+    FRESULT fr = FR_OK;
+    if (SD_ARRAY_SINGLE == arr->mode) {
+        sd_array_page_push(arr);
+    } else if (SD_ARRAY_STRIPE == arr->mode) {
+        if (0 == arr->next_card) {
+            fr = sd_array_timed_write(arr, 0, arr->fill, arr->fill_len);
+        } else {
+            sd_array_post_core1(arr);
+        }
+        arr->next_card ^= 1;
+    } else {
+        // Espelho: o core1 grava a cópia do cartão 1 enquanto o core0 grava a do 0
+        sd_array_post_core1(arr);
+        fr = sd_array_timed_write(arr, 0, arr->busy, arr->busy_len);
+    }
+    if (FR_OK != fr && FR_OK == arr->result) arr->result = fr;
+    arr->fill_len = 0;
+}
+
+FRESULT sd_array_open(sd_array_t *arr, sd_array_mode_t mode, const char *filename) {
+    arr->mode = mode;
+    arr->n_cards = (SD_ARRAY_SINGLE == mode) ? 1 : 2;
+    if (sd_get_num() < arr->n_cards) return FR_INVALID_DRIVE;
+
+    for (uint i = 0; i < arr->n_cards; i++) {
+        if (!sd_get_by_num(i)->mounted) return FR_NOT_READY;
+    }
+    for (uint i = 0; i < arr->n_cards; i++) {
+        char path[40];
+        snprintf(path, sizeof path, "%s%s", sd_get_by_num(i)->pcName, filename);
+        FRESULT fr = f_open(&arr->files[i], path, FA_WRITE | FA_CREATE_ALWAYS);
+        // A entrada do diretório já no cartão, para o arquivo ser achado
+        // depois de uma queda
+        if (FR_OK == fr && SD_ARRAY_SINGLE == mode) fr = f_sync(&arr->files[i]);
+        if (0 == i) strcpy(arr->path, path);
+        if (FR_OK != fr) {
+            while (i--) f_close(&arr->files[i]);
+            return fr;
+        }
+    }
+
+    memset(arr->stats, 0, sizeof arr->stats);
+    for (uint i = 0; i < SD_ARRAY_MAX_CARDS; i++) arr->stats[i].lat_min_us = UINT32_MAX;
+    arr->next_card = 0;
+    arr->fill = arr->buffers[0];
+    arr->busy = arr->buffers[1];
+    arr->fill_len = 0;
+    arr->busy_len = 0;
+    arr->result = FR_OK;
+    arr->core1_result = FR_OK;
+    arr->job.fn = sd_array_core1_write;
+    arr->job.arg = arr;
+    arr->job.done = true;
+    arr->pages = false;
+    arr->tail_len = 0;
+    arr->hold = true;
+    arr->ring_head = arr->ring_pending = 0;
+    arr->offline = false;
+    arr->synced_size = 0;
+    arr->outages = 0;
+    arr->held_peak = 0;
+    arr->lost_bytes = 0;
+    if (arr->n_cards > 1) core1_worker_init();
+    arr->start = get_absolute_time();
+    return FR_OK;
+}
+
+FRESULT sd_array_open_pages(sd_array_t *arr, sd_array_mode_t mode, const char *filename, uint32_t bytes) {
+    FRESULT fr = sd_array_open(arr, mode, filename);
+    if (FR_OK != fr) return fr;
+    uint32_t segments = (bytes + SD_ARRAY_SEGMENT_SIZE - 1) / SD_ARRAY_SEGMENT_SIZE;
+    if (SD_ARRAY_STRIPE == mode) segments = (segments + 1) / 2;
+    if (!segments) segments = 1;
+    for (uint i = 0; i < arr->n_cards && FR_OK == fr; i++) {
+        FIL *fp = &arr->files[i];
+        // Cadeia contígua já gravada na FAT: o primeiro setor do arquivo e
+        // os seguintes são os do disk_write
+        fr = f_expand(fp, (FSIZE_t)segments * SD_ARRAY_SEGMENT_SIZE, 1);
+        // Com o tamanho já no diretório o arquivo sobrevive a uma queda
+        if (FR_OK == fr) fr = f_sync(fp);
+        if (FR_OK != fr) break;
+        FATFS *fs = fp->obj.fs;
+        arr->next_sector[i] = fs->database + (LBA_t)fs->csize * (fp->obj.sclust - 2);
+        arr->end_sector[i] = arr->next_sector[i] + (LBA_t)segments * (SD_ARRAY_SEGMENT_SIZE / FF_MIN_SS);
+    }
+    if (FR_OK != fr) {
+        for (uint i = 0; i < arr->n_cards; i++) f_close(&arr->files[i]);
+        return fr;
+    }
+    arr->first_sector = arr->next_sector[0];
+    arr->pages = true;
+    return FR_OK;
+}
+
+uint8_t *sd_array_page(sd_array_t *arr) {
+    return arr->fill;
+}
+
+FRESULT sd_array_commit(sd_array_t *arr) {
+    arr->fill_len = SD_ARRAY_SEGMENT_SIZE;
+    sd_array_flush(arr);
+    if (FR_OK == arr->result) arr->result = arr->core1_result;
+    return arr->result;
+}
+
+FRESULT sd_array_write(sd_array_t *arr, const void *data, UINT len) {
+    if (SD_ARRAY_SINGLE == arr->mode) {
+        sd_array_single_write(arr, data, len);
+        return arr->result;
+    }
+    const uint8_t *p = data;
+    while (len) {
+        UINT n = SD_ARRAY_SEGMENT_SIZE - arr->fill_len;
+        if (n > len) n = len;
+        memcpy(arr->fill + arr->fill_len, p, n);
+        arr->fill_len += n;
+        p += n;
+        len -= n;
+        if (SD_ARRAY_SEGMENT_SIZE == arr->fill_len) sd_array_flush(arr);
+    }
+    // Erros do core1 aparecem na escrita seguinte
+    if (FR_OK == arr->result) arr->result = arr->core1_result;
+    return arr->result;
+}
+
+// Grava nos cartões o que já foi entregue ao FatFs (f_sync em cada arquivo).
+// O segmento ainda em preenchimento continua no buffer.
+FRESULT sd_array_sync(sd_array_t *arr) {
+    if (SD_ARRAY_SINGLE == arr->mode) {
+        if (!arr->pages && !arr->offline && FR_OK == arr->result) sd_array_tail_sync(arr);
+        return arr->result;
+    }
+    core1_worker_wait(&arr->job);
+    if (FR_OK == arr->result) arr->result = arr->core1_result;
+    for (uint i = 0; i < arr->n_cards; i++) {
+        TRACE_BEGIN(TRACE_F_SYNC, i);
+        FRESULT fr = f_sync(&arr->files[i]);
+        TRACE_END(TRACE_F_SYNC, i);
+        if (FR_OK != fr && FR_OK == arr->result) arr->result = fr;
+    }
+    return arr->result;
+}
+
+FRESULT sd_array_resume(sd_array_t *arr) {
+    if (!arr->offline) return arr->result;
+    FIL *fp = &arr->files[0];
+    FRESULT fr = f_open(fp, arr->path, FA_WRITE | FA_OPEN_EXISTING);
+    if (FR_OK == fr && arr->pages) {
+        // Outro cartão ou outro arquivo no lugar: não grava nos setores às cegas
+        FATFS *fs = fp->obj.fs;
+        if (fs->database + (LBA_t)fs->csize * (fp->obj.sclust - 2) != arr->first_sector) fr = FR_NO_FILE;
+    } else if (FR_OK == fr) {
+        // Volta ao último f_sync; a cópia em RAM tem o resto
+        fr = f_lseek(fp, arr->synced_size);
+        if (FR_OK == fr) fr = f_truncate(fp);
+    }
+    if (FR_OK != fr) {
+        sd_array_drop_file(arr);
+        sd_array_fault(arr, fr);
+        return arr->result;
+    }
+    arr->offline = false;
+    if (arr->pages) {
+        sd_array_drain(arr);
+    } else {
+        arr->stats[0].bytes = (uint32_t)arr->synced_size;
+        fr = arr->tail_len ? sd_array_timed_write(arr, 0, (const uint8_t *)arr->buffers, arr->tail_len) : FR_OK;
+        if (FR_OK != fr) sd_array_fault(arr, fr);
+    }
+    return arr->result;
+}
+
+FRESULT sd_array_close(sd_array_t *arr) {
+    if (SD_ARRAY_SINGLE == arr->mode && arr->offline) {
+        // O cartão não voltou: o arquivo fica como estava no último f_sync
+        // (páginas: na última gravada)
+        arr->lost_bytes += arr->pages ? (uint32_t)arr->ring_pending * SD_ARRAY_SEGMENT_SIZE : arr->tail_len;
+        arr->tail_len = 0;
+        arr->ring_pending = 0;
+        sd_array_drop_file(arr);
+        if (FR_OK == arr->result) arr->result = FR_DISK_ERR;
+        return arr->result;
+    }
+    if (SD_ARRAY_SINGLE != arr->mode) {
+        if (!arr->pages) sd_array_flush(arr);
+        core1_worker_wait(&arr->job);
+        if (FR_OK == arr->result) arr->result = arr->core1_result;
+    }
+    for (uint i = 0; i < arr->n_cards; i++) {
+        FRESULT fr = FR_OK;
+        // Devolve a sobra da pré-alocação; o tamanho fica o que foi gravado
+        if (arr->pages) {
+            fr = f_lseek(&arr->files[i], arr->stats[i].bytes);
+            if (FR_OK == fr) fr = f_truncate(&arr->files[i]);
+            if (FR_OK != fr && FR_OK == arr->result) arr->result = fr;
+        }
+        fr = f_close(&arr->files[i]);
+        if (FR_OK != fr && FR_OK == arr->result) arr->result = fr;
+    }
+    return arr->result;
+}
+
+void sd_array_print_stats(const sd_array_t *arr) {
+    int64_t us = absolute_time_diff_us(arr->start, get_absolute_time());
+    uint64_t total = 0;
+    for (uint i = 0; i < arr->n_cards; i++) total += arr->stats[i].bytes;
+    printf("Modo %s: %llu bytes em %lld ms (%lu B/s)\n", sd_array_mode_str(arr->mode),
+           total, us / 1000, us > 0 ? (uint32_t)(total * 1000000 / us) : 0);
+    for (uint i = 0; i < arr->n_cards; i++) {
+        const sd_array_stats_t *st = &arr->stats[i];
+        if (!st->writes) continue;
+        printf("Cartao %u: %lu escritas, latencia min/media/max = %lu/%lu/%lu us\n",
+               i, st->writes, st->lat_min_us, (uint32_t)(st->lat_sum_us / st->writes),
+               st->lat_max_us);
+    }
+    if (arr->outages)
+        printf("Quedas do cartao: %lu, ate %lu bytes guardados em RAM, %lu bytes perdidos\n",
+               arr->outages, arr->held_peak, arr->lost_bytes);
+}
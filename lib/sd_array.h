@@ -0,0 +1,111 @@
+#ifndef SD_ARRAY_H
+#define SD_ARRAY_H
+
+#include "pico/stdlib.h"
+#include "ff.h"
+#include "core1_worker.h"
+
+#define SD_ARRAY_MAX_CARDS 2
+
+// Tamanho de cada segmento gravado de uma vez (múltiplo de 512 bytes)
+#ifndef SD_ARRAY_SEGMENT_SIZE
+#define SD_ARRAY_SEGMENT_SIZE 4096
+#endif
+
+// Segmentos em RAM. Stripe e espelho usam dois (um enchendo, outro no
+// core1); no modo single todos seguram o log enquanto o cartão está fora
+#ifndef SD_ARRAY_SEGMENTS
+#define SD_ARRAY_SEGMENTS 8
+#endif
+
+// Modo single: f_sync quando a cópia em RAM do que foi escrito passa desse
+// tamanho; o resto dos segmentos fica para uma queda do cartão
+#ifndef SD_ARRAY_SYNC_BYTES
+#define SD_ARRAY_SYNC_BYTES (SD_ARRAY_SEGMENTS / 2 * SD_ARRAY_SEGMENT_SIZE)
+#endif
+
+// Modos de gravação do log
+typedef enum {
+    SD_ARRAY_SINGLE = 0,  // Só o cartão 0, escrita direta
+    SD_ARRAY_STRIPE,      // Segmentos alternados: pares no cartão 0, ímpares no 1
+    SD_ARRAY_MIRROR       // Os mesmos dados nos dois cartões
+} sd_array_mode_t;
+
+// Estatísticas de escrita de um cartão
+typedef struct {
+    uint32_t bytes;
+    uint32_t writes;
+    uint32_t lat_min_us;
+    uint32_t lat_max_us;
+    uint64_t lat_sum_us;
+} sd_array_stats_t;
+
+// Arquivo de log distribuído entre os cartões. O cartão 1 é escrito pelo core1
+// em paralelo com o cartão 0 (cada um no seu SPI/DMA). Abrir e fechar os
+// arquivos só acontece no core0; o core1 apenas chama f_write no volume 1.
+//
+// No modo de páginas (sd_array_open_pages) o arquivo é pré-alocado contíguo
+// e o produtor escreve direto no segmento (sd_array_page); o segmento cheio
+// vai inteiro para o disk_write, do buffer para o DMA do SPI, sem passar
+// pelo f_write nem pelo buffer do arquivo (FIL.buf). No fechamento o
+// arquivo é cortado no tamanho gravado.
+//
+// No modo single um erro de disco não encerra o log: o sd_array fica
+// offline e o log se acumula em RAM (o que passar da capacidade é
+// descartado e contado). Depois que o volume é remontado, sd_array_resume
+// reabre o arquivo e grava o que ficou guardado. Para isso o arquivo comum
+// leva um f_sync a cada SD_ARRAY_SYNC_BYTES; com hold = false (depois do
+// open) não há cópia nem esse f_sync, e o que chega offline é descartado.
+typedef struct {
+    sd_array_mode_t mode;
+    uint8_t n_cards;
+    uint8_t next_card;                 // Striping: cartão do próximo segmento
+    FIL files[SD_ARRAY_MAX_CARDS];
+    uint8_t buffers[SD_ARRAY_SEGMENTS][SD_ARRAY_SEGMENT_SIZE];
+    uint8_t *fill;                     // Segmento sendo preenchido pelo core0
+    UINT fill_len;
+    uint8_t *busy;                     // Segmento sendo gravado pelo core1
+    UINT busy_len;
+    core1_job_t job;
+    volatile FRESULT core1_result;
+    FRESULT result;
+    absolute_time_t start;
+    sd_array_stats_t stats[SD_ARRAY_MAX_CARDS];
+    bool pages;                        // Modo de páginas: disk_write direto
+    LBA_t next_sector[SD_ARRAY_MAX_CARDS];
+    LBA_t end_sector[SD_ARRAY_MAX_CARDS];
+    // Modo single. Arquivo comum: os buffers guardam uma cópia de tudo o que
+    // foi escrito desde o último f_sync (tail_len bytes), para regravar
+    // depois de uma queda. Páginas: ring_pending páginas esperando o cartão
+    // a partir de ring_head, seguidas da que está sendo preenchida.
+    uint32_t tail_len;
+    bool hold;                         // Cópia e f_sync periódico; o log_bench desliga
+    uint8_t ring_head, ring_pending;
+    bool offline;                      // Cartão fora: nada é gravado até sd_array_resume
+    FSIZE_t synced_size;               // Tamanho do arquivo no último f_sync
+    LBA_t first_sector;                // Páginas: início da pré-alocação
+    char path[40];                     // Arquivo no cartão 0, para reabrir
+    uint32_t outages;
+    uint32_t held_peak;                // Maior volume guardado em RAM
+    uint32_t lost_bytes;               // Descartados com a RAM cheia
+} sd_array_t;
+
+// Protótipos das funções
+FRESULT sd_array_open(sd_array_t *arr, sd_array_mode_t mode, const char *filename);
+FRESULT sd_array_write(sd_array_t *arr, const void *data, UINT len);
+// Abre pré-alocando espaço para "bytes" de log no total (dividido entre os
+// cartões conforme o modo); precisa de espaço livre contíguo
+FRESULT sd_array_open_pages(sd_array_t *arr, sd_array_mode_t mode, const char *filename, uint32_t bytes);
+// Segmento a preencher (SD_ARRAY_SEGMENT_SIZE bytes), válido até o commit
+uint8_t *sd_array_page(sd_array_t *arr);
+// Entrega o segmento inteiro aos cartões
+FRESULT sd_array_commit(sd_array_t *arr);
+FRESULT sd_array_sync(sd_array_t *arr);
+// Modo single, depois que o cartão 0 foi remontado: reabre o arquivo e
+// grava o que ficou em RAM
+FRESULT sd_array_resume(sd_array_t *arr);
+FRESULT sd_array_close(sd_array_t *arr);
+void sd_array_print_stats(const sd_array_t *arr);
+const char *sd_array_mode_str(sd_array_mode_t mode);
+
+#endif // SD_ARRAY_H
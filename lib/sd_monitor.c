@@ -0,0 +1,143 @@
+#include "sd_monitor.h"
+#include "diskio.h"
+#include "ff.h"
+#include "hw_config.h"
+
+static sd_monitor_card_t cards[SD_MONITOR_MAX_CARDS];
+
+static sd_monitor_card_t *sd_monitor_find(sd_card_t *sd) {
+    for (size_t i = 0; i < sd_get_num() && i < SD_MONITOR_MAX_CARDS; i++) {
+        if (sd_get_by_num(i) == sd) return &cards[i];
+    }
+    return NULL;
+}
+
+const char *sd_monitor_state_str(sd_monitor_state_t state) {
+    switch (state) {
+        case SD_MON_PRESENT: return "presente";
+        case SD_MON_LOST: return "fora";
+        case SD_MON_SETTLING: return "voltando";
+        default: return "desligado";
+    }
+}
+
+void sd_monitor_init(void) {
+    for (size_t i = 0; i < sd_get_num() && i < SD_MONITOR_MAX_CARDS; i++) {
+        sd_card_t *sd = sd_get_by_num(i);
+        if (sd->use_card_detect)
+            gpio_set_irq_enabled(sd->card_detect_gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+    }
+}
+
+bool sd_monitor_irq(uint gpio) {
+    bool hit = false;
+    for (size_t i = 0; i < sd_get_num() && i < SD_MONITOR_MAX_CARDS; i++) {
+        sd_card_t *sd = sd_get_by_num(i);
+        if (sd->use_card_detect && sd->card_detect_gpio == gpio) {
+            cards[i].cd_event = true;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+void sd_monitor_start(sd_card_t *sd) {
+    sd_monitor_card_t *m = sd_monitor_find(sd);
+    if (!m) return;
+    m->state = SD_MON_PRESENT;
+    m->next_check = make_timeout_time_ms(SD_MONITOR_PERIOD_MS);
+}
+
+void sd_monitor_stop(sd_card_t *sd) {
+    sd_monitor_card_t *m = sd_monitor_find(sd);
+    if (m) m->state = SD_MON_OFF;
+}
+
+static void sd_monitor_lost(sd_monitor_card_t *m, sd_card_t *sd) {
+    m->state = SD_MON_LOST;
+    m->lost_at = get_absolute_time();
+    m->losses++;
+    // Ninguém usa o volume até a remontagem; o cartão que voltar passa
+    // pela inicialização inteira
+    sd->mounted = false;
+    sd->m_Status |= STA_NOINIT;
+}
+
+void sd_monitor_fault(sd_card_t *sd) {
+    sd_monitor_card_t *m = sd_monitor_find(sd);
+    if (!m || SD_MON_PRESENT != m->state) return;
+    sd_monitor_lost(m, sd);
+    m->next_check = get_absolute_time();
+}
+
+// Cartão no soquete (card detect) ou respondendo (CMD13). O disco em RAM
+// não tem nenhum dos dois e está sempre presente.
+static bool sd_monitor_present(sd_card_t *sd) {
+    if (sd->use_card_detect) return sd_card_detect(sd);
+    if (sd->sd_test_com) return sd->sd_test_com(sd);
+    return true;
+}
+
+// Descarta o volume antigo e monta de novo
+static bool sd_monitor_remount(sd_card_t *sd) {
+    f_unmount(sd->pcName);
+    sd->m_Status |= STA_NOINIT;
+    sd->mounted = FR_OK == f_mount(&sd->fatfs, sd->pcName, 1);
+    return sd->mounted;
+}
+
+bool sd_monitor_poll(void) {
+    bool changed = false;
+    for (size_t i = 0; i < sd_get_num() && i < SD_MONITOR_MAX_CARDS; i++) {
+        sd_monitor_card_t *m = &cards[i];
+        sd_card_t *sd = sd_get_by_num(i);
+        if (SD_MON_OFF == m->state || (!m->cd_event && !time_reached(m->next_check)))
+            continue;
+        m->cd_event = false;
+        bool present = sd_monitor_present(sd);
+        uint32_t next_ms = SD_MONITOR_RETRY_MS;
+        switch (m->state) {
+            case SD_MON_PRESENT:
+                if (present) {
+                    next_ms = SD_MONITOR_PERIOD_MS;
+                } else {
+                    sd_monitor_lost(m, sd);
+                    changed = true;
+                }
+                break;
+            case SD_MON_LOST:
+                if (present) {
+                    m->state = SD_MON_SETTLING;
+                    next_ms = SD_MONITOR_SETTLE_MS;
+                    changed = true;
+                }
+                break;
+            case SD_MON_SETTLING:
+                if (present && sd_monitor_remount(sd)) {
+                    uint32_t down_ms = (uint32_t)(absolute_time_diff_us(m->lost_at, get_absolute_time()) / 1000);
+                    if (down_ms > m->down_max_ms) m->down_max_ms = down_ms;
+                    m->remounts++;
+                    m->state = SD_MON_PRESENT;
+                    next_ms = SD_MONITOR_PERIOD_MS;
+                } else {
+                    if (present) m->remount_failures++;
+                    m->state = SD_MON_LOST;
+                }
+                changed = true;
+                break;
+            default:
+                break;
+        }
+        m->next_check = make_timeout_time_ms(next_ms);
+    }
+    return changed;
+}
+
+sd_monitor_state_t sd_monitor_state(sd_card_t *sd) {
+    sd_monitor_card_t *m = sd_monitor_find(sd);
+    return m ? m->state : SD_MON_OFF;
+}
+
+const sd_monitor_card_t *sd_monitor_get(sd_card_t *sd) {
+    return sd_monitor_find(sd);
+}
@@ -0,0 +1,68 @@
+#ifndef SD_MONITOR_H
+#define SD_MONITOR_H
+
+#include "pico/stdlib.h"
+#include "sd_card.h"
+
+// Presença dos cartões montados e remontagem automática. Com o card detect
+// ligado (use_card_detect no hw_config.c) a troca de nível no pino avisa
+// pela IRQ; sem ele o cartão é testado a cada SD_MONITOR_PERIOD_MS com
+// sd_test_com (CMD13). Um erro de escrita (sd_monitor_fault) também conta
+// como queda. O cartão que some fica LOST, sem uso (pSD->mounted falso);
+// quando volta a responder, espera SD_MONITOR_SETTLE_MS com contato firme e
+// é remontado. Os arquivos abertos antes da queda ficam inválidos.
+//
+//   OFF -> PRESENT -> LOST -> SETTLING -> PRESENT
+//                       ^---------'  (sumiu de novo ou a montagem falhou)
+
+#define SD_MONITOR_MAX_CARDS 2
+
+// Teste do cartão presente
+#ifndef SD_MONITOR_PERIOD_MS
+#define SD_MONITOR_PERIOD_MS 500
+#endif
+// Teste do cartão fora
+#ifndef SD_MONITOR_RETRY_MS
+#define SD_MONITOR_RETRY_MS 100
+#endif
+// Cartão de volta respondendo por esse tempo antes de remontar
+#ifndef SD_MONITOR_SETTLE_MS
+#define SD_MONITOR_SETTLE_MS 200
+#endif
+
+typedef enum {
+    SD_MON_OFF = 0,     // Não montado pelo usuário: não é vigiado
+    SD_MON_PRESENT,
+    SD_MON_LOST,
+    SD_MON_SETTLING
+} sd_monitor_state_t;
+
+typedef struct {
+    sd_monitor_state_t state;
+    absolute_time_t next_check;
+    absolute_time_t lost_at;
+    volatile bool cd_event;            // IRQ do card detect
+    uint32_t losses;
+    uint32_t remounts;
+    uint32_t remount_failures;
+    uint32_t down_max_ms;              // Maior tempo até a remontagem
+} sd_monitor_card_t;
+
+// Protótipos das funções
+// Liga a IRQ dos pinos de card detect (depois do sd_init_driver e do
+// callback de GPIO)
+void sd_monitor_init(void);
+// Chamada pelo callback de GPIO; true se o pino é de card detect
+bool sd_monitor_irq(uint gpio);
+// Montagem e desmontagem pelo usuário
+void sd_monitor_start(sd_card_t *sd);
+void sd_monitor_stop(sd_card_t *sd);
+// Erro de escrita: o cartão vai para LOST e é testado na próxima chamada
+void sd_monitor_fault(sd_card_t *sd);
+// Testa os cartões que estão na hora; true se algum mudou de estado
+bool sd_monitor_poll(void);
+sd_monitor_state_t sd_monitor_state(sd_card_t *sd);
+const sd_monitor_card_t *sd_monitor_get(sd_card_t *sd);
+const char *sd_monitor_state_str(sd_monitor_state_t state);
+
+#endif // SD_MONITOR_H
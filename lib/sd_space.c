@@ -0,0 +1,35 @@
+#include "sd_space.h"
+#include "hw_config.h"
+
+bool sd_space_get(sd_card_t *sd, sd_space_t *out) {
+    DWORD nclst;
+    FATFS *fs;
+    if (!sd->mounted || FR_OK != f_getfree_step(sd->pcName, 0, &nclst, &fs))
+        return false;
+    uint32_t cluster_bytes = (uint32_t)fs->csize * FF_MIN_SS;
+    out->total_bytes = (uint64_t)(fs->n_fatent - 2) * cluster_bytes;
+    out->known = nclst != 0xFFFFFFFF;
+    out->free_bytes = out->known ? (uint64_t)nclst * cluster_bytes : 0;
+    out->scan_pct = fs->scan_clst ? (uint8_t)((uint64_t)fs->scan_clst * 100 / fs->n_fatent) : 0;
+    return true;
+}
+
+bool sd_space_poll(void) {
+    for (size_t i = 0; i < sd_get_num(); i++) {
+        sd_card_t *sd = sd_get_by_num(i);
+        if (!sd->mounted || sd->fatfs.free_clst <= sd->fatfs.n_fatent - 2)
+            continue;
+        // Um cartão por chamada, para o laço ocioso não atrasar
+        DWORD nclst;
+        FATFS *fs;
+        return FR_OK == f_getfree_step(sd->pcName, SD_SPACE_SCAN_SECTORS, &nclst, &fs) && nclst != 0xFFFFFFFF;
+    }
+    return false;
+}
+
+uint32_t sd_space_remaining_s(const sd_space_t *space, uint32_t bytes_per_s) {
+    if (!space->known || !bytes_per_s)
+        return 0;
+    uint64_t s = space->free_bytes / bytes_per_s;
+    return s > UINT32_MAX ? UINT32_MAX : (uint32_t)s;
+}
@@ -0,0 +1,36 @@
+#ifndef SD_SPACE_H
+#define SD_SPACE_H
+
+#include "pico/stdlib.h"
+#include "ff.h"
+#include "sd_card.h"
+
+// Espaço livre dos cartões sem parar a interface numa varredura da FAT.
+// O FatFs mantém a contagem de clusters livres a cada alocação depois que
+// ela é conhecida: no FAT32 vem do FSINFO ao montar; no FAT16, no exFAT ou
+// com o FSINFO inválido, sd_space_poll conta alguns setores da FAT (ou do
+// bitmap do exFAT) por chamada, no laço ocioso (f_getfree_step em ff.c).
+// sd_space_get só lê o que já se sabe e nunca varre.
+
+// Setores da FAT lidos por chamada de sd_space_poll
+#ifndef SD_SPACE_SCAN_SECTORS
+#define SD_SPACE_SCAN_SECTORS 32
+#endif
+
+typedef struct {
+    bool known;            // free_bytes vale (senão a contagem está em andamento)
+    uint8_t scan_pct;      // Progresso da contagem enquanto !known
+    uint64_t free_bytes;
+    uint64_t total_bytes;
+} sd_space_t;
+
+// Protótipos das funções
+// false se o cartão não está montado
+bool sd_space_get(sd_card_t *sd, sd_space_t *out);
+// Avança a contagem de um cartão montado que ainda não a tem; true quando
+// alguma contagem terminou nesta chamada
+bool sd_space_poll(void);
+// Segundos de gravação que cabem em free_bytes a bytes_per_s (0 se desconhecido)
+uint32_t sd_space_remaining_s(const sd_space_t *space, uint32_t bytes_per_s);
+
+#endif // SD_SPACE_H
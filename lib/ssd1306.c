@@ -1,5 +1,7 @@
 #include "ssd1306.h"
 #include "font.h"
+#include "trace.h"
+#include "cpu_load.h"
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -53,6 +55,8 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
+  TRACE_BEGIN(TRACE_DISPLAY, 0);
+  CPU_TASK_BEGIN(CPU_TASK_DISPLAY);
   ssd1306_command(ssd, SET_COL_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->width - 1);
@@ -66,6 +70,8 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     ssd->bufsize,
     false
   );
+  CPU_TASK_END(CPU_TASK_DISPLAY);
+  TRACE_END(TRACE_DISPLAY, 0);
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
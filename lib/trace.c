@@ -0,0 +1,152 @@
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+
+typedef struct {
+    trace_event_t ev[TRACE_EVENTS];
+    uint32_t head;  // Total gravado; a posição é head % TRACE_EVENTS
+} trace_ring_t;
+
+static trace_ring_t rings[2];
+static volatile bool trace_on = true;
+
+static const char *const trace_names[TRACE_ID_COUNT] = {
+    [TRACE_IMU_READ] = "imu_read",
+    [TRACE_BUF_SWAP] = "buf_swap",
+    [TRACE_F_WRITE] = "f_write",
+    [TRACE_F_SYNC] = "f_sync",
+    [TRACE_DISK_READ] = "disk_read",
+    [TRACE_DISK_WRITE] = "disk_write",
+    [TRACE_DMA] = "spi_dma",
+    [TRACE_DISPLAY] = "display",
+    [TRACE_BUZZER] = "buzzer",
+    [TRACE_ISR_GPIO] = "isr_gpio",
+    [TRACE_ISR_DMA] = "isr_dma",
+    [TRACE_CORE1_JOB] = "core1_job",
+};
+
+// Chamado de interrupções e do caminho do DMA: fica na RAM
+void __not_in_flash_func(trace_record)(uint8_t id, uint16_t arg) {
+    if (!trace_on) return;
+    uint core = get_core_num();
+    trace_ring_t *r = &rings[core];
+    uint32_t irq = save_and_disable_interrupts();
+    trace_event_t *e = &r->ev[r->head++ % TRACE_EVENTS];
+    e->t_us = time_us_32();
+    e->arg = arg;
+    e->id = id;
+    e->core = (uint8_t)core;
+    restore_interrupts(irq);
+}
+
+void trace_enable(bool on) {
+    trace_on = on;
+}
+
+bool trace_is_enabled(void) {
+    return trace_on;
+}
+
+void trace_clear(void) {
+    bool was_on = trace_on;
+    trace_on = false;
+    for (uint i = 0; i < count_of(rings); i++) rings[i].head = 0;
+    trace_on = was_on;
+}
+
+static uint32_t ring_count(const trace_ring_t *r) {
+    return r->head < TRACE_EVENTS ? r->head : TRACE_EVENTS;
+}
+
+uint32_t trace_count(void) {
+    return ring_count(&rings[0]) + ring_count(&rings[1]);
+}
+
+uint32_t trace_overwritten(void) {
+    return rings[0].head + rings[1].head - trace_count();
+}
+
+// Entrega o rastro serializado (ver trace.h) em pedaços para "put"
+static bool trace_serialize(bool (*put)(const void *data, UINT len, void *ctx), void *ctx) {
+    trace_file_header_t h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, TRACE_MAGIC, sizeof h.magic);
+    h.version = TRACE_VERSION;
+    h.event_size = sizeof(trace_event_t);
+    h.n_names = TRACE_ID_COUNT;
+    h.name_len = TRACE_NAME_LEN;
+    h.n_events = trace_count();
+    h.overwritten = trace_overwritten();
+    h.now_us = time_us_64();
+    if (!put(&h, sizeof h, ctx)) return false;
+
+    for (uint i = 0; i < TRACE_ID_COUNT; i++) {
+        char name[TRACE_NAME_LEN] = {0};
+        if (trace_names[i]) strncpy(name, trace_names[i], sizeof name - 1);
+        if (!put(name, sizeof name, ctx)) return false;
+    }
+    for (uint c = 0; c < count_of(rings); c++) {
+        const trace_ring_t *r = &rings[c];
+        uint32_t n = ring_count(r);
+        for (uint32_t k = r->head - n; k != r->head; k++)
+            if (!put(&r->ev[k % TRACE_EVENTS], sizeof(trace_event_t), ctx)) return false;
+    }
+    return true;
+}
+
+static bool put_file(const void *data, UINT len, void *ctx) {
+    UINT bw;
+    return FR_OK == f_write((FIL *)ctx, data, len, &bw) && bw == len;
+}
+
+// Grava o rastro num arquivo. O registro fica pausado durante a gravação
+// para os eventos do próprio f_write não se misturarem ao que é gravado.
+FRESULT trace_save(const char *path) {
+    bool was_on = trace_on;
+    trace_on = false;
+    FIL fil;
+    FRESULT fr = f_open(&fil, path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (FR_OK == fr) {
+        if (!trace_serialize(put_file, &fil)) fr = FR_DISK_ERR;
+        FRESULT fr_close = f_close(&fil);
+        if (FR_OK == fr) fr = fr_close;
+    }
+    trace_on = was_on;
+    return fr;
+}
+
+typedef struct {
+    uint8_t line[32];
+    uint len;
+} hex_out_t;
+
+static void flush_hex(hex_out_t *out) {
+    for (uint i = 0; i < out->len; i++) printf("%02x", out->line[i]);
+    printf("\n");
+    out->len = 0;
+}
+
+static bool put_hex(const void *data, UINT len, void *ctx) {
+    hex_out_t *out = ctx;
+    const uint8_t *p = data;
+    while (len--) {
+        out->line[out->len++] = *p++;
+        if (sizeof out->line == out->len) flush_hex(out);
+    }
+    return true;
+}
+
+// Imprime o rastro em hexadecimal, 32 bytes por linha, entre as linhas
+// "--- trace begin ---" e "--- trace end ---"
+void trace_dump_hex(void) {
+    bool was_on = trace_on;
+    trace_on = false;
+    hex_out_t out = {.len = 0};
+    printf("--- trace begin ---\n");
+    trace_serialize(put_hex, &out);
+    if (out.len) flush_hex(&out);
+    printf("--- trace end ---\n");
+    stdio_flush();
+    trace_on = was_on;
+}
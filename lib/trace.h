@@ -0,0 +1,94 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+#include "ff.h"
+
+// Rastro binário de eventos em RAM para achar a causa de perdas e travadas:
+// cada evento guarda time_us_32(), o núcleo, um ID e um argumento de 16 bits.
+// Há um anel por núcleo, então só é preciso desligar interrupções (e não
+// travar o outro core) para gravar. Quando o anel enche, os eventos mais
+// antigos são sobrescritos.
+//
+// "trace save" grava o rastro no SD e "trace dump" o imprime em hexadecimal
+// no console; o tools/imu_trace converte os dois para JSON do Chrome
+// (chrome://tracing ou ui.perfetto.dev).
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// Eventos por núcleo (potência de 2); 8 bytes cada
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS 1024
+#endif
+
+// Formato do arquivo (little-endian), lido pelo tools/imu_trace:
+//   cabeçalho trace_file_header_t
+//   n_names nomes de TRACE_NAME_LEN bytes (terminados em zero), índice = ID
+//   n_events trace_event_t, cada núcleo em ordem cronológica
+#define TRACE_MAGIC "IMUTRACE"
+#define TRACE_VERSION 1
+#define TRACE_NAME_LEN 16
+
+typedef enum {
+    TRACE_IMU_READ = 1,  // Leitura do MPU6050
+    TRACE_BUF_SWAP,      // Segmento entregue ao core1 (arg: bytes)
+    TRACE_F_WRITE,       // f_write de um cartão (arg: cartão)
+    TRACE_F_SYNC,
+    TRACE_DISK_READ,     // disk_read (arg: setores)
+    TRACE_DISK_WRITE,    // disk_write (arg: setores)
+    TRACE_DMA,           // Transferência DMA do SPI (arg: bytes)
+    TRACE_DISPLAY,       // Envio do framebuffer ao SSD1306
+    TRACE_BUZZER,
+    TRACE_ISR_GPIO,      // Interrupção dos botões (arg: GPIO)
+    TRACE_ISR_DMA,       // Interrupção de fim de DMA
+    TRACE_CORE1_JOB,     // Trabalho executado pelo core1
+    TRACE_ID_COUNT
+} trace_id_t;
+
+// Fase do evento nos 2 bits altos do ID
+#define TRACE_PH_INSTANT 0x00
+#define TRACE_PH_BEGIN 0x40
+#define TRACE_PH_END 0x80
+#define TRACE_ID_MASK 0x3F
+
+typedef struct {
+    uint32_t t_us;
+    uint16_t arg;
+    uint8_t id;    // trace_id_t | fase
+    uint8_t core;
+} trace_event_t;
+
+typedef struct {
+    char magic[8];
+    uint16_t version;
+    uint16_t event_size;
+    uint16_t n_names;
+    uint16_t name_len;
+    uint32_t n_events;
+    uint32_t overwritten;  // Eventos perdidos por anel cheio
+    uint64_t now_us;       // Momento da gravação: situa os tempos de 32 bits
+} trace_file_header_t;
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(id, arg) trace_record((id) | TRACE_PH_BEGIN, (arg))
+#define TRACE_END(id, arg) trace_record((id) | TRACE_PH_END, (arg))
+#define TRACE_MARK(id, arg) trace_record((id) | TRACE_PH_INSTANT, (arg))
+#else
+#define TRACE_BEGIN(id, arg) ((void)0)
+#define TRACE_END(id, arg) ((void)0)
+#define TRACE_MARK(id, arg) ((void)0)
+#endif
+
+// Protótipos das funções
+void trace_record(uint8_t id, uint16_t arg);
+void trace_enable(bool on);
+bool trace_is_enabled(void);
+void trace_clear(void);
+uint32_t trace_count(void);
+uint32_t trace_overwritten(void);
+FRESULT trace_save(const char *path);
+void trace_dump_hex(void);
+
+#endif // TRACE_H
@@ -0,0 +1,25 @@
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+// Configuração do TinyUSB: dispositivo composto CDC (stdio) + MSC (cartão SD)
+
+#ifndef CFG_TUSB_RHPORT0_MODE
+#define CFG_TUSB_RHPORT0_MODE OPT_MODE_DEVICE
+#endif
+
+#define CFG_TUD_ENABLED 1
+#define CFG_TUD_ENDPOINT0_SIZE 64
+
+#define CFG_TUD_CDC 1
+#define CFG_TUD_MSC 1
+#define CFG_TUD_HID 0
+#define CFG_TUD_MIDI 0
+#define CFG_TUD_VENDOR 0
+
+#define CFG_TUD_CDC_RX_BUFSIZE 256
+#define CFG_TUD_CDC_TX_BUFSIZE 256
+
+// Cada chamada de READ10/WRITE10 transfere até 8 setores de uma vez
+#define CFG_TUD_MSC_EP_BUFSIZE 4096
+
+#endif // TUSB_CONFIG_H
@@ -0,0 +1,117 @@
+#include "usb_msc.h"
+#include <string.h>
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#include "diskio.h"
+
+// Modo USB Mass Storage: o PC acessa o cartão SD diretamente, setor a setor.
+// READ10/WRITE10 vão direto para read_blocks/write_blocks do driver, sem FatFs
+// no firmware; o cartão deve estar desmontado enquanto o modo estiver ativo.
+//
+// Fora do modo, o tud_task roda na tarefa de fundo do stdio USB (IRQ de baixa
+// prioridade), onde os callbacks não podem esperar o cartão (até o timeout de
+// ocupado dele) sem travar as outras IRQs e o stdio. Durante o modo o stdio
+// sai da USB (stdio_usb_deinit, o TinyUSB continua de pé) e o tud_task roda
+// no laço do modo, em usb_msc_task: os callbacks leem e escrevem o cartão ali
+// mesmo. O console segue pela UART; da CDC só se lê o Enter de saída.
+
+static sd_card_t *msc_sd = NULL;
+static volatile bool msc_active = false;
+static bool stdio_released = false;
+
+void usb_msc_init(void) {
+    // Precisa vir antes de stdio_init_all(), que espera o TinyUSB iniciado
+    tusb_init();
+}
+
+bool usb_msc_start(sd_card_t *sd) {
+    if (!sd_init_driver()) return false;
+    if (sd->init(sd) & (STA_NOINIT | STA_NODISK)) return false;
+    stdio_flush();
+    stdio_released = stdio_usb_deinit();
+    if (!stdio_released) return false;
+    msc_sd = sd;
+    msc_active = true;
+    return true;
+}
+
+void usb_msc_stop(void) {
+    msc_active = false;
+}
+
+bool usb_msc_active(void) {
+    return msc_active;
+}
+
+int usb_msc_task(void) {
+    tud_task();
+    if (!tud_cdc_available()) return PICO_ERROR_TIMEOUT;
+    return (int)tud_cdc_read_char();
+}
+
+void usb_msc_end(void) {
+    msc_active = false;
+    if (stdio_released) {
+        stdio_usb_init();
+        stdio_released = false;
+    }
+}
+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4]) {
+    (void)lun;
+    memcpy(vendor_id, "RPi     ", 8);
+    memcpy(product_id, "IMU Datalogger  ", 16);
+    memcpy(product_rev, "0.1 ", 4);
+}
+
+// Fora do modo MSC o PC vê um leitor sem cartão
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+    if (!msc_active) {
+        tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);  // Medium not present
+        return false;
+    }
+    return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t *block_count, uint16_t *block_size) {
+    (void)lun;
+    *block_count = msc_active ? (uint32_t)msc_sd->sectors : 0;
+    *block_size = FF_MAX_SS;
+}
+
+// Ejetar a unidade no PC encerra o modo MSC
+bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool load_eject) {
+    (void)lun;
+    (void)power_condition;
+    if (load_eject && !start) msc_active = false;
+    return true;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize) {
+    (void)lun;
+    // Com CFG_TUD_MSC_EP_BUFSIZE múltiplo de 512 o offset é sempre 0
+    if (!msc_active || offset || bufsize % FF_MAX_SS) return -1;
+    int rc = msc_sd->read_blocks(msc_sd, buffer, lba, bufsize / FF_MAX_SS);
+    return SD_BLOCK_DEVICE_ERROR_NONE == rc ? (int32_t)bufsize : -1;
+}
+
+bool tud_msc_is_writable_cb(uint8_t lun) {
+    (void)lun;
+    return !(msc_sd && (msc_sd->m_Status & STA_PROTECT));
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize) {
+    (void)lun;
+    if (!msc_active || offset || bufsize % FF_MAX_SS) return -1;
+    int rc = msc_sd->write_blocks(msc_sd, buffer, lba, bufsize / FF_MAX_SS);
+    return SD_BLOCK_DEVICE_ERROR_NONE == rc ? (int32_t)bufsize : -1;
+}
+
+// Demais comandos SCSI não são suportados
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void *buffer, uint16_t bufsize) {
+    (void)scsi_cmd;
+    (void)buffer;
+    (void)bufsize;
+    tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
+    return -1;
+}
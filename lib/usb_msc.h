@@ -0,0 +1,21 @@
+#ifndef USB_MSC_H
+#define USB_MSC_H
+
+#include "pico/stdlib.h"
+#include "sd_card.h"
+
+// Protótipos das funções
+void usb_msc_init(void);
+// Inicia o cartão e tira o stdio da USB; o console fica só na UART até o
+// usb_msc_end
+bool usb_msc_start(sd_card_t *sd);
+void usb_msc_stop(void);
+bool usb_msc_active(void);
+// Roda o TinyUSB, com as leituras e escritas do PC; chamar em laço enquanto
+// usb_msc_active(). Retorna o caractere recebido pela CDC, ou
+// PICO_ERROR_TIMEOUT.
+int usb_msc_task(void);
+// Devolve a USB ao stdio, depois do laço
+void usb_msc_end(void);
+
+#endif // USB_MSC_H
@@ -0,0 +1,284 @@
+#include "vib_spectrum.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "cpu_load.h"
+
+// Número de bits em |v| (0 para v = 0)
+static int bit_length(uint32_t v) {
+    int b = 0;
+    while (v >> b) b++;
+    return b;
+}
+
+// Calcula o resumo de x[0..n-1] (executado no core1)
+static void vib_compute(vib_spectrum_t *v, const int16_t *x, vib_summary_t *s) {
+    const uint n = v->n;
+    uint64_t t0 = time_us_64();
+
+    // Média, pico e RMS no tempo, em inteiros
+    int32_t sum = 0;
+    for (uint i = 0; i < n; i++) sum += x[i];
+    const int32_t mean = sum / (int32_t)n;
+    uint32_t peak = 0;
+    uint64_t ss = 0;
+    for (uint i = 0; i < n; i++) {
+        int32_t d = x[i] - mean;
+        uint32_t a = (uint32_t)abs(d);
+        if (a > peak) peak = a;
+        ss += (uint64_t)((int64_t)d * d);
+    }
+    float rms = sqrtf((float)ss / n);
+    s->rms = rms / v->sensitivity;
+    s->crest = rms > 0 ? peak / rms : 0.0f;
+
+    // Janela e normalização: o maior valor fica logo abaixo de 2^14, o que
+    // aproveita os 16 bits da FFT mesmo para vibrações pequenas
+    const int lshift = 14 - bit_length(peak);  // Pode ser negativo
+    const int wshift = 15 - lshift;            // d * w (Q15) >> wshift
+    for (uint i = 0; i < n; i++) {
+        int32_t y = (x[i] - mean) * (int32_t)fft_hann(i, n);
+        v->work[i].re = (int16_t)((y + (1 << (wshift - 1))) >> wshift);
+        v->work[i].im = 0;
+    }
+    const int exp = peak ? fft_forward(v->work, n) - lshift : 0;
+
+    const uint half = n / 2;
+    for (uint k = 0; k <= half; k++) {
+        int32_t re = v->work[k].re, im = v->work[k].im;
+        v->power[k] = peak ? (uint32_t)(re * re) + (uint32_t)(im * im) : 0;
+    }
+    v->power[0] = 0;  // A média já foi tirada
+
+    // Potência de um bin -> média quadrática (unilateral): 2 |X|^2 / (n sum w^2)
+    const float unit2 = v->sensitivity * v->sensitivity;
+    const float ms_per_p = ldexpf(2.0f / (n * v->win_power), 2 * exp) / unit2;
+
+    for (int b = 0; b < VIB_BANDS; b++) {
+        uint k0 = b * half / VIB_BANDS, k1 = (b + 1) * half / VIB_BANDS;
+        if (b == VIB_BANDS - 1) k1 = half + 1;
+        uint64_t acc = 0;
+        for (uint k = k0; k < k1; k++) acc += v->power[k];
+        s->band_rms[b] = sqrtf((float)acc * ms_per_p);
+    }
+
+    // Picos: máximos locais de maior potência, em ordem decrescente
+    uint peaks[VIB_PEAKS] = {0};
+    for (uint k = 1; k < half; k++) {
+        uint32_t p = v->power[k];
+        if (!p || p <= v->power[k - 1] || p < v->power[k + 1]) continue;
+        for (int j = 0; j < VIB_PEAKS; j++) {
+            if (peaks[j] && p <= v->power[peaks[j]]) continue;
+            memmove(&peaks[j + 1], &peaks[j], (VIB_PEAKS - 1 - j) * sizeof peaks[0]);
+            peaks[j] = k;
+            break;
+        }
+    }
+    for (int j = 0; j < VIB_PEAKS; j++) {
+        uint k = peaks[j];
+        s->peak_hz[j] = s->peak_amp[j] = 0.0f;
+        if (!k) continue;
+        float a = (float)v->power[k - 1], b = (float)v->power[k], c = (float)v->power[k + 1];
+        float delta = 0.0f;
+        if (a > 0 && c > 0) {
+            float la = logf(a), lb = logf(b), lc = logf(c);
+            float den = la - 2 * lb + lc;
+            if (den < 0) delta = 0.5f * (la - lc) / den;
+        }
+        s->peak_hz[j] = (k + delta) * v->rate_hz / n;
+        s->peak_amp[j] = sqrtf(2.0f * (a + b + c) * ms_per_p);
+    }
+    s->compute_us = (uint32_t)(time_us_64() - t0);
+}
+
+// Trabalho do core1: calcula o bloco que não está sendo enchido
+static void vib_core1_job(void *arg) {
+    vib_spectrum_t *v = (vib_spectrum_t *)arg;
+    uint busy = v->fill ^ 1;
+    vib_compute(v, v->buf[busy], &v->out);
+    v->out.block = v->blocks;
+    v->out.t_us = v->t_first[busy];
+}
+
+bool vib_spectrum_init(vib_spectrum_t *v, uint n, float rate_hz, float sensitivity) {
+    if (!fft_size_supported(n) || n < VIB_MIN_POINTS) return false;
+    memset(v, 0, sizeof *v);
+    v->n = n;
+    v->rate_hz = rate_hz;
+    v->sensitivity = sensitivity;
+    uint64_t w2 = 0;
+    for (uint i = 0; i < n; i++) {
+        int32_t w = fft_hann(i, n);
+        w2 += (uint64_t)(w * w);
+    }
+    v->win_power = ldexpf((float)w2, -30);
+    v->job.fn = vib_core1_job;
+    v->job.arg = v;
+    v->job.done = true;
+    core1_worker_init();
+    return true;
+}
+
+void vib_spectrum_add(vib_spectrum_t *v, int16_t x, uint64_t t_us) {
+    if (0 == v->fill_len) v->t_first[v->fill] = t_us;
+    v->buf[v->fill][v->fill_len++] = x;
+    if (v->fill_len < v->n) return;
+
+    // O core1 leva poucos ms por bloco; esperar aqui só acontece se ele
+    // estiver ocupado com outro trabalho (gravação espelhada)
+    core1_worker_wait(&v->job);
+    if (v->pending) {
+        __dmb();
+        if (v->has_held) v->lost++;
+        v->held = v->out;
+        v->has_held = true;
+    }
+    v->fill ^= 1;
+    v->fill_len = 0;
+    v->blocks++;
+    v->pending = true;
+    core1_worker_post(&v->job);
+}
+
+bool vib_spectrum_poll(vib_spectrum_t *v, vib_summary_t *out) {
+    if (v->has_held) {
+        *out = v->held;
+        v->has_held = false;
+        return true;
+    }
+    if (!v->pending || !v->job.done) return false;
+    __dmb();
+    *out = v->out;
+    v->pending = false;
+    return true;
+}
+
+bool vib_spectrum_finish(vib_spectrum_t *v, vib_summary_t *out) {
+    core1_worker_wait(&v->job);
+    v->fill_len = 0;
+    return vib_spectrum_poll(v, out);
+}
+
+float vib_spectrum_band_hz(const vib_spectrum_t *v) {
+    return v->rate_hz / 2 / VIB_BANDS;
+}
+
+int vib_spectrum_format_header(const vib_spectrum_t *v, const char *prefix, char *buf, size_t size) {
+    int len = snprintf(buf, size, "%sBloco, Tempo (s), RMS, Fator de crista", prefix);
+    for (int j = 0; j < VIB_PEAKS && len >= 0 && (size_t)len < size; j++)
+        len += snprintf(buf + len, size - len, ", Pico %d (Hz), Amplitude %d", j + 1, j + 1);
+    const float bw = vib_spectrum_band_hz(v);
+    for (int b = 0; b < VIB_BANDS && len >= 0 && (size_t)len < size; b++)
+        len += snprintf(buf + len, size - len, ", RMS %.0f-%.0f Hz", b * bw, (b + 1) * bw);
+    if (len >= 0 && (size_t)len < size) len += snprintf(buf + len, size - len, "\n");
+    return len;
+}
+
+int vib_spectrum_format(const vib_summary_t *s, const char *prefix, char *buf, size_t size) {
+    int len = snprintf(buf, size, "%s%lu, %lu.%06lu, %f, %f", prefix, (unsigned long)s->block,
+                       (unsigned long)(s->t_us / 1000000), (unsigned long)(s->t_us % 1000000),
+                       s->rms, s->crest);
+    for (int j = 0; j < VIB_PEAKS && len >= 0 && (size_t)len < size; j++)
+        len += snprintf(buf + len, size - len, ", %.2f, %f", s->peak_hz[j], s->peak_amp[j]);
+    for (int b = 0; b < VIB_BANDS && len >= 0 && (size_t)len < size; b++)
+        len += snprintf(buf + len, size - len, ", %f", s->band_rms[b]);
+    if (len >= 0 && (size_t)len < size) len += snprintf(buf + len, size - len, "\n");
+    return len;
+}
+
+void vib_spectrum_print(const vib_summary_t *s, const char *unit) {
+    printf("Bloco %lu (t = %.3f s, %lu us no core1): RMS %.4f %s, fator de crista %.2f\n",
+           (unsigned long)s->block, s->t_us / 1e6, (unsigned long)s->compute_us, s->rms, unit,
+           s->crest);
+    for (int j = 0; j < VIB_PEAKS && s->peak_hz[j] > 0; j++)
+        printf("  pico %d: %8.2f Hz  %.4f %s\n", j + 1, s->peak_hz[j], s->peak_amp[j], unit);
+    printf("  bandas:");
+    for (int b = 0; b < VIB_BANDS; b++) printf(" %.4f", s->band_rms[b]);
+    printf(" %s RMS\n", unit);
+}
+
+// FFT de referência em float, radix-2 como a de ponto fixo
+static void fft_float(float *re, float *im, uint n) {
+    for (uint i = 1, j = 0; i < n; i++) {
+        uint bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (uint half = 1; half < n; half <<= 1) {
+        for (uint k = 0; k < half; k++) {
+            float wr = cosf((float)M_PI * k / half), wi = -sinf((float)M_PI * k / half);
+            for (uint i = k; i < n; i += 2 * half) {
+                uint m = i + half;
+                float tr = re[m] * wr - im[m] * wi, ti = re[m] * wi + im[m] * wr;
+                re[m] = re[i] - tr; im[m] = im[i] - ti;
+                re[i] += tr; im[i] += ti;
+            }
+        }
+    }
+}
+
+void vib_spectrum_bench(uint n) {
+    const int runs = 16;
+    if (!fft_size_supported(n)) {
+        printf("Tamanho não suportado: %u (potência de 2 de %d a %d)\n", n, FFT_MIN_POINTS,
+               FFT_MAX_POINTS);
+        return;
+    }
+    fft_cpx_t *in = malloc(n * sizeof *in), *x = malloc(n * sizeof *x);
+    float *re = malloc(n * sizeof *re), *im = malloc(n * sizeof *im);
+    if (!in || !x || !re || !im) {
+        printf("Sem memória para o benchmark\n");
+        free(in); free(x); free(re); free(im);
+        return;
+    }
+
+    // Dois tons fora dos bins e um ruído pseudoaleatório, já janelados e
+    // perto de 2^14 como em vib_compute
+    uint32_t lcg = 12345;
+    for (uint i = 0; i < n; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        float t = (float)i / n;
+        float s = 12000.0f * sinf(2 * (float)M_PI * 37.3f * n / 1024 * t) +
+                  1600.0f * sinf(2 * (float)M_PI * 151.6f * n / 1024 * t) +
+                  (float)((int32_t)(lcg >> 16) % 257 - 128);
+        in[i].re = (int16_t)lroundf(s * fft_hann(i, n) / 32768.0f);
+        in[i].im = 0;
+    }
+
+    uint64_t total_us = 0;
+    uint32_t min_cycles = UINT32_MAX;
+    int exp = 0;
+    for (int r = 0; r < runs; r++) {
+        memcpy(x, in, n * sizeof *x);
+        uint64_t t0 = time_us_64();
+        cpu_cycles_start();
+        exp = fft_forward(x, n);
+        uint32_t cycles = cpu_cycles_elapsed();
+        total_us += time_us_64() - t0;
+        if (cycles < min_cycles) min_cycles = cycles;
+    }
+
+    for (uint i = 0; i < n; i++) {
+        re[i] = in[i].re;
+        im[i] = 0.0f;
+    }
+    fft_float(re, im, n);
+    double sig = 0, err = 0;
+    for (uint k = 0; k < n; k++) {
+        double er = ldexp(x[k].re, exp) - re[k], ei = ldexp(x[k].im, exp) - im[k];
+        sig += (double)re[k] * re[k] + (double)im[k] * im[k];
+        err += er * er + ei * ei;
+    }
+    printf("FFT de %u pontos: %.1f us em média (%d execuções)", n, (double)total_us / runs, runs);
+    if (cpu_cycles_available())
+        printf(", %lu ciclos", (unsigned long)min_cycles);
+    printf("\n  expoente do bloco %d, SNR contra float: %.1f dB\n", exp,
+           err > 0 ? 10 * log10(sig / err) : 999.0);
+    free(in); free(x); free(re); free(im);
+}
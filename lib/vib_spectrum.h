@@ -0,0 +1,73 @@
+#ifndef VIB_SPECTRUM_H
+#define VIB_SPECTRUM_H
+
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "fft.h"
+#include "core1_worker.h"
+
+// Resumo espectral de vibração por bloco: a captura entrega as amostras de
+// um eixo e, a cada bloco de n pontos (256 a 1024), o core1 tira a média,
+// aplica a janela de Hann, roda a FFT em ponto fixo (lib/fft.h) e reduz o
+// espectro a poucos números: RMS e fator de crista no tempo, as frequências
+// e amplitudes dos picos principais e o RMS em VIB_BANDS bandas iguais até
+// a frequência de Nyquist. Enquanto o core1 calcula um bloco, o core0 enche
+// o outro buffer.
+//
+// As amplitudes de pico somam a energia dos três bins em volta do máximo
+// (o lóbulo da Hann), o que as deixa quase independentes da posição do tom
+// entre bins; a frequência é interpolada numa parábola sobre o log da
+// potência.
+
+#define VIB_MIN_POINTS 256
+#define VIB_PEAKS 3
+#define VIB_BANDS 4
+
+typedef struct {
+    uint32_t block;               // Número do bloco, desde 1
+    uint64_t t_us;                // Carimbo da primeira amostra do bloco
+    float rms;                    // RMS sem a média, na unidade do eixo
+    float crest;                  // Pico / RMS
+    float peak_hz[VIB_PEAKS];     // 0 = pico não encontrado
+    float peak_amp[VIB_PEAKS];    // Amplitude do seno equivalente
+    float band_rms[VIB_BANDS];
+    uint32_t compute_us;          // Tempo do core1 neste bloco
+} vib_summary_t;
+
+typedef struct {
+    uint n;
+    float rate_hz;
+    float sensitivity;            // Contagens por unidade do eixo
+    float win_power;              // Soma de w^2 da janela
+    int16_t buf[2][FFT_MAX_POINTS];
+    uint fill, fill_len;          // Buffer sendo enchido pelo core0
+    uint64_t t_first[2];
+    fft_cpx_t work[FFT_MAX_POINTS];
+    uint32_t power[FFT_MAX_POINTS / 2 + 1];
+    core1_job_t job;
+    bool pending;                 // Bloco postado e resumo ainda não entregue
+    uint32_t blocks;
+    uint32_t lost;                // Resumos sobrescritos antes do poll
+    vib_summary_t out;            // Escrito pelo core1
+    vib_summary_t held;           // Pronto mas não entregue quando o core1 recebeu outro bloco
+    bool has_held;
+} vib_spectrum_t;
+
+// Protótipos das funções
+bool vib_spectrum_init(vib_spectrum_t *v, uint n, float rate_hz, float sensitivity);
+// Acrescenta uma amostra (contagens brutas); bloco cheio vai para o core1
+void vib_spectrum_add(vib_spectrum_t *v, int16_t x, uint64_t t_us);
+// Entrega o resumo do último bloco calculado, uma vez; chamar a cada amostra
+bool vib_spectrum_poll(vib_spectrum_t *v, vib_summary_t *out);
+// Fim da captura: espera o bloco em cálculo e entrega os resumos que faltam,
+// um por chamada, até retornar false (o bloco incompleto é descartado)
+bool vib_spectrum_finish(vib_spectrum_t *v, vib_summary_t *out);
+float vib_spectrum_band_hz(const vib_spectrum_t *v);
+// Linhas CSV; prefix vai no começo de cada uma ("" ou "# Espectro, ")
+int vib_spectrum_format_header(const vib_spectrum_t *v, const char *prefix, char *buf, size_t size);
+int vib_spectrum_format(const vib_summary_t *s, const char *prefix, char *buf, size_t size);
+void vib_spectrum_print(const vib_summary_t *s, const char *unit);
+// Mede a FFT de n pontos (tempo e ciclos) e a compara a uma FFT em float
+void vib_spectrum_bench(uint n);
+
+#endif // VIB_SPECTRUM_H
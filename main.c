@@ -6,11 +6,32 @@
 #include <time.h>
 #include "pico/stdlib.h"
 #include "pico/bootrom.h"
+#include "pico/stdio_usb.h"
 #include "hardware/rtc.h"
 #include "lib/MPU6050.h"
 #include "lib/buzzer.h"
 #include "lib/ssd1306.h"
 #include "lib/font.h"
+#include "lib/sd_array.h"
+#include "lib/usb_msc.h"
+#include "lib/bulk_xfer.h"
+#include "lib/imu_stream.h"
+#include "lib/log_bench.h"
+#include "lib/trace.h"
+#include "lib/sample_clock.h"
+#include "lib/cpu_load.h"
+#include "lib/imu_stats.h"
+#include "lib/decim.h"
+#include "lib/vib_spectrum.h"
+#include "lib/ahrs.h"
+#include "lib/imz.h"
+#include "lib/binlog.h"
+#include "lib/event_rules.h"
+#include "lib/config.h"
+#include "lib/sd_space.h"
+#include "lib/sd_monitor.h"
+#include "lib/imu_array.h"
+#include "lib/core1_worker.h"
 #include "ff.h"
 #include "diskio.h"
 #include "f_util.h"
@@ -22,6 +43,7 @@
 #define MPU_PORT i2c0 
 #define MPU_SDA 0
 #define MPU_SCL 1
+#define MPU_INT 4  // Data-ready do MPU6050
 #define DISP_PORT i2c1
 #define DISP_SDA 14
 #define DISP_SCL 15
@@ -32,7 +54,6 @@
 #define BUTTON_A 5
 #define BUTTON_B 6
 #define DEBOUNCE_DELAY 200
-#define ALARM_ERROR_DURATION 500  // Duração do alarme de erro (ms)
 
 ssd1306_t ssd;
 
@@ -42,35 +63,75 @@ bool sd_mounted = false;
 
 mpu6050_t mpu;
 float accel[3], gyro[3];
+// Todos os sensores achados, com o mpu como sensor 0 (lib/imu_array.h)
+static imu_array_t imus = {.job = {.done = true}};
 
 static bool logger_enabled;
 static const uint32_t period = 1000;
 static absolute_time_t next_log_time;
 
-static char filename[20] = "data.csv";
-static char filename_base[20] = "medicoes_imu";
+static char filename[32] = "data.csv";
 static int med_count = 1;
+static config_t config;  // Lida de config.ini ao montar (lib/config.h)
 
 static bool capture_in_progress = false;
 static bool should_stop_capture = false;
+static imu_stats_t capture_stats;  // Média/desvio/RMS da captura atual ou da última
+static uint decim_ratio = 0;       // 0 = grava cada leitura do sensor
+static decim_t decim;
+static uint fft_points = 0;        // 0 = sem resumo espectral
+static int fft_axis = 2;           // Índice em fft_axis_names
+static bool fft_summary_only = false;  // Grava só os resumos, sem as amostras
+static vib_spectrum_t vib;
+static vib_summary_t vib_last;     // Último bloco (página do OLED e "fft")
+static int vib_last_axis;
+static const char *const fft_axis_names[] = {"ax", "ay", "az", "gx", "gy", "gz"};
+static bool ahrs_enabled = false;  // Colunas de orientação no CSV
+static float ahrs_kp = 1.0f, ahrs_ki = 0.02f;
+static ahrs_t ahrs;
+static float orient_q[4] = {1.0f, 0.0f, 0.0f, 0.0f};  // Última orientação
+static float orient_euler[3];      // Rolagem, arfagem, guinada (graus)
+static core1_job_t capture_display_job = {.done = true};  // Envio do OLED na captura
+// Sensores do i2c1 em uso (captura, "imus", boot): o botão não desenha no OLED
+static volatile bool display_bus_busy = false;
+// Formato das amostras no log
+typedef enum { LOG_CSV, LOG_IMZ, LOG_BIN } log_format_t;
+static const char *const log_format_names[] = {"csv", "imz", "bin"};
+static log_format_t log_format = LOG_CSV;
+_Static_assert(BINLOG_PAGE_SIZE == SD_ARRAY_SEGMENT_SIZE, "a página do .imb é um segmento do sd_array");
+static imz_encoder_t imz;
 
 static int current_menu_page = 0;
-static const int MAX_MENU_PAGES = 3;
-static bool alarm_enabled = false;
+static const int MAX_MENU_PAGES = 6;
+static bool alarm_enabled = false;  // Detecção de eventos (lib/event_rules.h)
+static event_rules_t event_rules;
+
+static sd_array_mode_t log_mode = SD_ARRAY_SINGLE;
+static bool jitter_report = false;  // Histograma do relógio ao fim da captura
+static sd_array_t log_array;
+// Taxa medida na última captura, por cartão, e com que ajustes foi medida
+static struct {
+    uint32_t bytes_per_s;
+    log_format_t format;
+    sd_array_mode_t mode;
+    uint32_t interval_ms;
+} log_rate;
 
 
 void play_error_alarm() {
+    TRACE_BEGIN(TRACE_BUZZER, 0);
     gpio_put(RED_LED, true);  // Acende LED vermelho
     set_buzzer_tone(BUZZER_A, A4);
-    sleep_ms(ALARM_ERROR_DURATION);
+    sleep_ms(config.alarm_ms);
     stop_buzzer(BUZZER_A);
     gpio_put(RED_LED, false);
-    sleep_ms(ALARM_ERROR_DURATION);
+    sleep_ms(config.alarm_ms);
     gpio_put(RED_LED, true);
     set_buzzer_tone(BUZZER_A, A4);
-    sleep_ms(ALARM_ERROR_DURATION);
+    sleep_ms(config.alarm_ms);
     stop_buzzer(BUZZER_A);
     gpio_put(RED_LED, false);
+    TRACE_END(TRACE_BUZZER, 0);
 }
 
 void disp_init(){
@@ -87,10 +148,126 @@ void disp_init(){
     ssd1306_send_data(&ssd);
 }
 
+// Página do espectro: RMS, crista, picos e barras das bandas (escala pela maior)
+static void draw_spectrum_page(void) {
+    char line[24];
+    sprintf(line, "Espectro (5/%d)", MAX_MENU_PAGES);
+    ssd1306_draw_string(&ssd, line, 1, 0);
+    if (!vib_last.block) {
+        ssd1306_draw_string(&ssd, "Sem espectro", 5, 28);
+        return;
+    }
+    snprintf(line, sizeof line, "%s R%.3f C%.1f", fft_axis_names[vib_last_axis], vib_last.rms, vib_last.crest);
+    ssd1306_draw_string(&ssd, line, 1, 10);
+    for (int j = 0; j < VIB_PEAKS; j++) {
+        if (vib_last.peak_hz[j] <= 0) break;
+        snprintf(line, sizeof line, "%6.1fHz %.3f", vib_last.peak_hz[j], vib_last.peak_amp[j]);
+        ssd1306_draw_string(&ssd, line, 1, 19 + 9 * j);
+    }
+    float top = 0;
+    for (int b = 0; b < VIB_BANDS; b++)
+        if (vib_last.band_rms[b] > top) top = vib_last.band_rms[b];
+    for (int b = 0; b < VIB_BANDS && top > 0; b++) {
+        uint8_t h = (uint8_t)(16 * vib_last.band_rms[b] / top);
+        if (h) ssd1306_rect(&ssd, 64 - h, 4 + 31 * b, 26, h, true, true);
+    }
+}
+
+// Página da orientação: ângulos de Euler e quaternion do AHRS
+static void draw_orientation_page(void) {
+    char line[24];
+    sprintf(line, "Orientacao (6/%d)", MAX_MENU_PAGES);
+    ssd1306_draw_string(&ssd, line, 1, 0);
+    static const char *const names[3] = {"Rol", "Arf", "Gui"};
+    for (int i = 0; i < 3; i++) {
+        snprintf(line, sizeof line, "%s %+7.1f graus", names[i], orient_euler[i]);
+        ssd1306_draw_string(&ssd, line, 1, 12 + 10 * i);
+    }
+    snprintf(line, sizeof line, "q %+.2f %+.2f", orient_q[0], orient_q[1]);
+    ssd1306_draw_string(&ssd, line, 1, 45);
+    snprintf(line, sizeof line, "  %+.2f %+.2f", orient_q[2], orient_q[3]);
+    ssd1306_draw_string(&ssd, line, 1, 55);
+}
+
+static void send_display_job(void *arg) {
+    ssd1306_send_data((ssd1306_t *)arg);
+}
+
+// Durante a captura, redesenha a página "page" se ela estiver na tela e a
+// envia pelo core1, que não mexe no i2c0 do sensor; se o envio anterior não
+// terminou, pula esta atualização
+static void update_capture_display(int page) {
+    if (current_menu_page != page || !capture_display_job.done || display_bus_busy) return;
+    ssd1306_fill(&ssd, false);
+    if (4 == page)
+        draw_spectrum_page();
+    else
+        draw_orientation_page();
+    capture_display_job.fn = send_display_job;
+    capture_display_job.arg = &ssd;
+    core1_worker_post(&capture_display_job);
+}
+
+// Espaço do cartão 0 para a página 1 do display (ver refresh_disp_space)
+static sd_space_t disp_space;
+static bool disp_space_valid;
+
+// Chamada do laço ocioso: avança a contagem do espaço livre e atualiza a
+// cópia que o display usa. true se a cópia mudou.
+static bool refresh_disp_space(void) {
+    sd_space_t space;
+    memset(&space, 0, sizeof space);
+    bool valid = false;
+    if (sd_mounted) {
+        sd_space_poll();
+        valid = sd_space_get(sd_get_by_num(0), &space);
+    }
+    bool changed = valid != disp_space_valid || (valid && memcmp(&space, &disp_space, sizeof space));
+    disp_space = space;
+    disp_space_valid = valid;
+    return changed;
+}
+
+// Canais por registro do .imb: vários sensores só no formato binário
+static unsigned log_channels(void) {
+    return LOG_BIN == log_format && imus.n > 1 ? imus.n : 1;
+}
+
+// Período de leitura do sensor na captura: com decimação ou espectro a
+// DECIM_INPUT_HZ, senão o intervalo configurado. Os dois são múltiplos de
+// 1 ms, que o MPU6050 faz exatos (mpu6050_enable_data_ready).
+static uint32_t capture_period_us(void) {
+    return decim_ratio || fft_points ? 1000000 / DECIM_INPUT_HZ : config.interval_ms * 1000;
+}
+
+// Bytes por segundo que a captura grava em cada cartão: o medido na última
+// captura com o mesmo formato, modo e intervalo, ou uma estimativa por linha
+static uint32_t log_bytes_per_s(void) {
+    if (log_rate.bytes_per_s && log_rate.format == log_format && log_rate.mode == log_mode &&
+        log_rate.interval_ms == config.interval_ms)
+        return log_rate.bytes_per_s;
+    const uint32_t period_us = capture_period_us();
+    uint32_t bps;
+    if (LOG_BIN == log_format)  // Um registro por leitura
+        bps = (uint32_t)(1000000ull * BINLOG_PAGE_SIZE / ((uint64_t)period_us * binlog_records_per_page(log_channels())));
+    else  // Uma linha por leitura, ou por decim_ratio leituras
+        bps = (uint32_t)(1000000ull * (LOG_IMZ == log_format ? 9 : ahrs_enabled ? 130 : 72) /
+                         ((uint64_t)period_us * (decim_ratio ? decim_ratio : 1)));
+    return SD_ARRAY_STRIPE == log_mode ? bps / 2 : bps;
+}
+
+// Duração em "12h34m" ou "5m20s"
+static void format_duration(char *buf, size_t size, uint32_t s) {
+    if (s >= 3600)
+        snprintf(buf, size, "%luh%02lum", (unsigned long)(s / 3600), (unsigned long)(s / 60 % 60));
+    else
+        snprintf(buf, size, "%lum%02lus", (unsigned long)(s / 60), (unsigned long)(s % 60));
+}
+
 // **FUNÇÃO DO MENU MODIFICADA**
 void display_menu_page(int page) {
     ssd1306_fill(&ssd, false);
-    char title[20];
+    char title[24];
 
     switch(page) {
         case 0: // Menu Principal
@@ -107,9 +284,22 @@ void display_menu_page(int page) {
             ssd1306_draw_string(&ssd, title, 1, 5);
             ssd1306_draw_string(&ssd, "---------------", 1, 15);
             char status_str[20];
-            sprintf(status_str, "Estado: %s", sd_mounted ? "Montado" : "N/A");
-            ssd1306_draw_string(&ssd, status_str, 5, 28);
-            ssd1306_draw_string(&ssd, "Arquivo Atual:", 5, 42);
+            sprintf(status_str, "Estado: %s", !sd_mounted ? "N/A" : sd_get_by_num(0)->mounted ? "Montado" : "Fora");
+            ssd1306_draw_string(&ssd, status_str, 5, 22);
+            // Espaço do cartão 0 guardado pelo laço ocioso: esta página também
+            // é desenhada na IRQ do botão, onde o FatFs não pode ser chamado
+            if (disp_space_valid) {
+                char dur[12];
+                if (disp_space.known) {
+                    snprintf(status_str, sizeof status_str, "Livre: %.2f GB", disp_space.free_bytes / 1e9);
+                    ssd1306_draw_string(&ssd, status_str, 5, 32);
+                    format_duration(dur, sizeof dur, sd_space_remaining_s(&disp_space, log_bytes_per_s()));
+                    snprintf(status_str, sizeof status_str, "Resta: %s", dur);
+                } else {
+                    snprintf(status_str, sizeof status_str, "Contando %u%%", disp_space.scan_pct);
+                }
+                ssd1306_draw_string(&ssd, status_str, 5, 42);
+            }
             ssd1306_draw_string(&ssd, filename, 5, 52);
             break;
             
@@ -127,6 +317,31 @@ void display_menu_page(int page) {
             ssd1306_draw_string(&ssd, gyro_str, 1, 42);
             break;
             
+        case 3: // Estatísticas da captura (média e desvio por eixo)
+            sprintf(title, "Estatistica (4/%d)", MAX_MENU_PAGES);
+            ssd1306_draw_string(&ssd, title, 1, 0);
+            if (!imu_stats_count(&capture_stats)) {
+                ssd1306_draw_string(&ssd, "Sem captura", 5, 28);
+                break;
+            }
+            static const char *const axis_labels[IMU_STATS_AXES] = {"Ax", "Ay", "Az", "Gx", "Gy", "Gz"};
+            for (int i = 0; i < IMU_STATS_AXES; i++) {
+                imu_axis_summary_t a;
+                char line[24];
+                imu_stats_summary(&capture_stats, i, &a);
+                snprintf(line, sizeof line, "%s%+7.2f %6.2f", axis_labels[i], a.mean, a.std);
+                ssd1306_draw_string(&ssd, line, 1, 10 + 9 * i);
+            }
+            break;
+
+        case 4: // Resumo espectral do último bloco
+            draw_spectrum_page();
+            break;
+
+        case 5: // Orientação estimada pelo AHRS
+            draw_orientation_page();
+            break;
+
         default:
             ssd1306_draw_string(&ssd, "Pagina Invalida", 1, 20);
             break;
@@ -137,27 +352,52 @@ void display_menu_page(int page) {
 
 
 void toggle_alarm() {
+    static const buzzer_note_t alarm_on[] = {{C5, 200}, {E5, 200}, {G5, 200}};
+    static const buzzer_note_t alarm_off[] = {{G5, 200}, {E5, 200}, {C5, 200}};
     alarm_enabled = !alarm_enabled;
-    
-    if (alarm_enabled) {
-        // Toca um som de alarme ativado
-        set_buzzer_tone(BUZZER_A, C5);
-        sleep_ms(200);
-        set_buzzer_tone(BUZZER_A, E5);
-        sleep_ms(200);
-        set_buzzer_tone(BUZZER_A, G5);
-        sleep_ms(200);
-        stop_buzzer(BUZZER_A);
-    } else {
-        // Toca um som de alarme desativado
-        set_buzzer_tone(BUZZER_A, G5);
-        sleep_ms(200);
-        set_buzzer_tone(BUZZER_A, E5);
-        sleep_ms(200);
-        set_buzzer_tone(BUZZER_A, C5);
-        sleep_ms(200);
-        stop_buzzer(BUZZER_A);
+    config.alarm = alarm_enabled;
+    event_rules_reset(&event_rules);
+    // Som de alarme ativado ou desativado, sem bloquear
+    buzzer_play(BUZZER_A, alarm_enabled ? alarm_on : alarm_off, 3);
+}
+
+// Passa a configuração para o sensor, o SPI dos cartões e o alarme; a
+// captura lê o resto dela a cada início
+static void apply_config(void) {
+    static const uint32_t accel_ranges[] = {2, 4, 8, 16};
+    static const uint32_t gyro_ranges[] = {250, 500, 1000, 2000};
+    int as = 0, gs = 0;
+    while (accel_ranges[as] != config.accel_range_g) as++;
+    while (gyro_ranges[gs] != config.gyro_range_dps) gs++;
+    if ((enum mpu6050_accel_scale)as != mpu.accel_scale || (enum mpu6050_gyro_scale)gs != mpu.gyro_scale) {
+        mpu6050_init(&mpu, MPU_PORT, MPU6050_ADDR, (enum mpu6050_accel_scale)as, (enum mpu6050_gyro_scale)gs);
+        event_rules_set_sensitivity(&event_rules, mpu.accel_sensitivity, mpu.gyro_sensitivity);
+        printf("Escalas do sensor: ±%lu g, ±%lu graus/s\n", (unsigned long)config.accel_range_g,
+               (unsigned long)config.gyro_range_dps);
     }
+    for (size_t i = 0; i < sd_get_num(); i++) {
+        spi_t *spi = sd_get_by_num(i)->spi;
+        if (spi->baud_rate == config.spi_hz)
+            continue;
+        spi->baud_rate = config.spi_hz;
+        // Cartão já inicializado: muda agora; senão vale na inicialização
+        if (spi->initialized) {
+            spi_lock(spi);
+            uint actual = spi_set_baudrate(spi->hw_inst, spi->baud_rate);
+            spi_unlock(spi);
+            printf("SPI de %s %u Hz\n", sd_get_by_num(i)->pcName, actual);
+        }
+    }
+    if (config.alarm != alarm_enabled)
+        toggle_alarm();
+}
+
+// Toca o som da regra que acabou de disparar um evento
+static void play_event_sound(int rule) {
+    const buzzer_note_t *notes;
+    uint n = event_rules_sound(&event_rules, rule, &notes);
+    if (n)
+        buzzer_play(BUZZER_A, notes, n);
 }
 
 static sd_card_t *sd_get_by_name(const char *const name)
@@ -277,7 +517,16 @@ static void run_mount() {
     myASSERT(pSD);
     pSD->mounted = true;
     sd_mounted = true; // Atualiza o estado global
+    sd_monitor_start(pSD);
     printf("Processo de montagem do SD ( %s ) concluído\n", pSD->pcName);
+    int n_keys = config_load(&config, CONFIG_FILE);
+    if (n_keys >= 0) {
+        printf("%d chaves lidas de %s\n", n_keys, CONFIG_FILE);
+        apply_config();
+    }
+    int n_rules = event_rules_load(&event_rules, EVENT_RULES_FILE);
+    if (n_rules >= 0)
+        printf("%d regras de eventos lidas de %s\n", n_rules, EVENT_RULES_FILE);
     gpio_put(RED_LED, false); gpio_put(GREEN_LED, true);
 }
 static void run_unmount()
@@ -299,6 +548,7 @@ static void run_unmount()
     }
     sd_card_t *pSD = sd_get_by_name(arg1);
     myASSERT(pSD);
+    sd_monitor_stop(pSD);
     pSD->mounted = false;
     sd_mounted = false; // Atualiza o estado global
     pSD->m_Status |= STA_NOINIT; // in case medium is removed
@@ -310,22 +560,32 @@ static void run_getfree()
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
-    DWORD fre_clust, fre_sect, tot_sect;
-    FATFS *p_fs = sd_get_fs_by_name(arg1);
-    if (!p_fs)
+    sd_card_t *pSD = sd_get_by_name(arg1);
+    if (!pSD)
     {
         printf("Unknown logical drive number: \"%s\"\n", arg1);
         return;
     }
-    FRESULT fr = f_getfree(arg1, &fre_clust, &p_fs);
-    if (FR_OK != fr)
+    // Sem varrer a FAT: o que o FatFs já sabe, ou o andamento da contagem
+    // que o laço ocioso faz aos poucos (ver lib/sd_space.h)
+    sd_space_t space;
+    if (!sd_space_get(pSD, &space))
     {
-        printf("f_getfree error: %s (%d)\n", FRESULT_str(fr), fr);
+        printf("Cartão %s não montado\n", arg1);
         return;
     }
-    tot_sect = (p_fs->n_fatent - 2) * p_fs->csize;
-    fre_sect = fre_clust * p_fs->csize;
-    printf("%10lu KiB total drive space.\n%10lu KiB available.\n", tot_sect / 2, fre_sect / 2);
+    printf("%10llu KiB total drive space.\n", (unsigned long long)(space.total_bytes / 1024));
+    if (!space.known)
+    {
+        printf("Contando o espaço livre: %u%% da FAT\n", space.scan_pct);
+        return;
+    }
+    printf("%10llu KiB available.\n", (unsigned long long)(space.free_bytes / 1024));
+    uint32_t bps = log_bytes_per_s();
+    char dur[12];
+    format_duration(dur, sizeof dur, sd_space_remaining_s(&space, bps));
+    printf("Gravação restante: %s a %lu B/s (%s)\n", dur, (unsigned long)bps,
+           bps == log_rate.bytes_per_s ? "medido na última captura" : "estimado");
 }
 static void run_ls()
 {
@@ -350,14 +610,20 @@ static void run_ls()
         p_dir = cwdbuf;
     }
     printf("Directory Listing: %s\n", p_dir);
-    DIR dj;
+    // Objetos do pool do FatFs (ffsystem.c): fora da pilha e do heap
+    DIR *dj = ff_dir_alloc();
+    if (!dj)
+    {
+        printf("Sem objetos DIR livres (FF_DIRPOOL_SIZE)\n");
+        return;
+    }
     FILINFO fno;
-    memset(&dj, 0, sizeof dj);
     memset(&fno, 0, sizeof fno);
-    fr = f_findfirst(&dj, &fno, p_dir, "*");
+    fr = f_findfirst(dj, &fno, p_dir, "*");
     if (FR_OK != fr)
     {
         printf("f_findfirst error: %s (%d)\n", FRESULT_str(fr), fr);
+        ff_dir_free(dj);
         return;
     }
     while (fr == FR_OK && fno.fname[0])
@@ -374,9 +640,10 @@ static void run_ls()
             pcAttrib = pcWritableFile;
         printf("%s [%s] [size=%llu]\n", fno.fname, pcAttrib, fno.fsize);
 
-        fr = f_findnext(&dj, &fno);
+        fr = f_findnext(dj, &fno);
     }
-    f_closedir(&dj);
+    f_closedir(dj);
+    ff_dir_free(dj);
 }
 static void run_cat()
 {
@@ -386,21 +653,28 @@ static void run_cat()
         printf("Missing argument\n");
         return;
     }
-    FIL fil;
-    FRESULT fr = f_open(&fil, arg1, FA_READ);
+    FIL *fil = ff_fil_alloc();
+    if (!fil)
+    {
+        printf("Sem objetos FIL livres (FF_FILPOOL_SIZE)\n");
+        return;
+    }
+    FRESULT fr = f_open(fil, arg1, FA_READ);
     if (FR_OK != fr)
     {
         printf("f_open error: %s (%d)\n", FRESULT_str(fr), fr);
+        ff_fil_free(fil);
         return;
     }
     char buf[256];
-    while (f_gets(buf, sizeof buf, &fil))
+    while (f_gets(buf, sizeof buf, fil))
     {
         printf("%s", buf);
     }
-    fr = f_close(&fil);
+    fr = f_close(fil);
     if (FR_OK != fr)
         printf("f_open error: %s (%d)\n", FRESULT_str(fr), fr);
+    ff_fil_free(fil);
 }
 
 
@@ -441,9 +715,681 @@ static void run_help()
     printf("Digite 'f' para capturar dados do ADC e salvar no arquivo\n");
     printf("Digite 'g' para formatar o cartão SD\n");
     printf("Digite 'h' para exibir os comandos disponíveis\n");
+    printf("Digite 'rbench [arquivo]' para medir a taxa de leitura do cartão SD\n");
+    printf("Digite 'sdstats [drive]' para ver as latências e erros do cartão SD\n");
+    printf("Digite 'trace [on|off|clear|dump|save [arquivo]]' para o rastro de eventos (tools/imu_trace)\n");
+    printf("Digite 'jitter [on|off]' para ver o jitter do relógio de amostragem\n");
+    printf("Digite 'decim [off|5|10|20]' para ler o sensor a 1 kHz e gravar decimado\n");
+    printf("Digite 'fft [off|256|512|1024] [ax..gz] [resumo]' para o resumo espectral da vibração\n");
+    printf("Digite 'fft bench [pontos]' para medir o tempo e a precisão da FFT\n");
+    printf("Digite 'ahrs [on [kp] [ki]|off|bench]' para gravar a orientação estimada no CSV\n");
+    printf("Digite 'logfmt [csv|imz|bin]' para gravar as amostras em CSV, comprimidas (tools/imu_imz) ou cruas (tools/imu_bin)\n");
+    printf("Digite 'imus [scan|cal]' para procurar e calibrar os sensores e ver a taxa de cada um\n");
+    printf("Digite 'events [on|off|load [arquivo]|default|save]' para detectar quedas, impactos e repouso\n");
+    printf("Digite 'config [get <chave>|set <chave> <valor>|save|load|default]' para ver e mudar a configuração\n");
+    printf("Digite 'top' para ver a carga de CPU, as pilhas e o heap\n");
+    printf("Digite 'logmode [single|stripe|mirror]' para escolher como gravar nos cartões\n");
+    printf("Digite 'get <arquivo> [offset] [tamanho]' para baixar um arquivo com o tools/imu_get\n");
+    printf("Digite 'stream [hz]' para transmitir as amostras ao vivo com o tools/imu_stream\n");
+    printf("Digite 'bench [quick|full] [csv|json] [segundos]' para medir a gravação no cartão SD\n");
+    printf("Digite 'usb' (ou segure o botão A) para acessar o cartão SD pelo PC\n");
+    printf("\n(Tecle Enter após o comando)\n");
     printf("\nEscolha o comando:  ");
 }
 
+static uint32_t kib_per_s(uint64_t bytes, int64_t us)
+{
+    return us > 0 ? (uint32_t)(bytes * 1000000 / 1024 / us) : 0;
+}
+
+// Mede a taxa de leitura sequencial: setores brutos lidos um por chamada
+// (o padrão de acesso do FatFs) e depois um arquivo inteiro via f_read
+static void run_rbench()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+        arg1 = filename;
+    sd_card_t *pSD = sd_get_by_num(0);
+    if (!pSD->mounted)
+    {
+        printf("Monte o cartão SD primeiro\n");
+        return;
+    }
+    static BYTE buf[8 * FF_MAX_SS];
+    const UINT n_sectors = 2048; // 1 MiB
+    absolute_time_t t0 = get_absolute_time();
+    for (UINT i = 0; i < n_sectors; ++i)
+    {
+        DRESULT dr = disk_read(0, buf, i, 1);
+        if (RES_OK != dr)
+        {
+            printf("disk_read error: %d\n", dr);
+            return;
+        }
+    }
+    int64_t us = absolute_time_diff_us(t0, get_absolute_time());
+    printf("Setores: %u em %lld us (%lu KiB/s)\n", n_sectors, us,
+           kib_per_s((uint64_t)n_sectors * FF_MAX_SS, us));
+
+    FIL fil;
+    FRESULT fr = f_open(&fil, arg1, FA_READ);
+    if (FR_OK != fr)
+    {
+        printf("f_open error: %s (%d)\n", FRESULT_str(fr), fr);
+        return;
+    }
+    uint64_t total = 0;
+    UINT br;
+    t0 = get_absolute_time();
+    while (FR_OK == (fr = f_read(&fil, buf, sizeof buf, &br)) && br)
+        total += br;
+    us = absolute_time_diff_us(t0, get_absolute_time());
+    f_close(&fil);
+    if (FR_OK != fr)
+        printf("f_read error: %s (%d)\n", FRESULT_str(fr), fr);
+    printf("%s: %llu bytes em %lld us (%lu KiB/s)\n", arg1, total, us,
+           kib_per_s(total, us));
+}
+
+// Disputa pela trava de um volume do FatFs entre os dois cores (ver
+// ff_mutex_take em ffsystem.c); zera os contadores
+static void print_lock_stats(const char *name, int vol)
+{
+    FF_MUTEXSTATS st;
+    ff_mutex_stats(vol, &st, true);
+    printf("  trava (%s) %lu acessos, %lu com espera (média %lu us, máx %lu us), %lu timeouts\n", name,
+           (unsigned long)st.takes, (unsigned long)st.contended,
+           st.contended ? (unsigned long)(st.wait_sum_us / st.contended) : 0UL, (unsigned long)st.wait_max_us,
+           (unsigned long)st.timeouts);
+    printf("  posse da trava: média %lu us, máx %lu us\n",
+           st.takes ? (unsigned long)(st.hold_sum_us / st.takes) : 0UL, (unsigned long)st.hold_max_us);
+}
+
+// Latências e erros do driver SD desde a última chamada (ver sd_stats.h):
+// histogramas log2 de comando, DMA, cartão ocupado após escrita e das
+// leituras/escritas inteiras. Os contadores são zerados depois de mostrados.
+static void run_sdstats()
+{
+    const char *arg1 = strtok(NULL, " ");
+    for (size_t i = 0; i < sd_get_num(); ++i)
+    {
+        sd_card_t *pSD = sd_get_by_num(i);
+        if (arg1 && 0 != strcmp(arg1, pSD->pcName))
+            continue;
+        sd_stats_t st;
+        sd_card_get_stats(pSD, &st, true);
+        sd_stats_print(pSD, &st);
+        print_lock_stats(pSD->pcName, (int)i);
+        const sd_monitor_card_t *mon = sd_monitor_get(pSD);
+        if (mon)
+            printf("  presença: %s, %lu quedas, %lu remontagens (%lu falhas), maior queda %lu ms\n",
+                   sd_monitor_state_str(mon->state), (unsigned long)mon->losses, (unsigned long)mon->remounts,
+                   (unsigned long)mon->remount_failures, (unsigned long)mon->down_max_ms);
+        arg1 = arg1 ? "" : NULL; // Achou o cartão pedido
+    }
+    if (arg1 && *arg1)
+        printf("Unknown logical drive number: \"%s\"\n", arg1);
+    else if (!arg1)
+        print_lock_stats("sistema", FF_VOLUMES);  // Tabela de arquivos abertos (FF_FS_LOCK)
+}
+
+// Rastro de eventos (ver lib/trace.h): "trace [on|off|clear|dump|save [arquivo]]".
+// Sem argumento mostra quantos eventos há no buffer.
+static void run_trace()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        printf("Rastro %s: %lu eventos, %lu sobrescritos\n", trace_is_enabled() ? "ligado" : "desligado",
+               (unsigned long)trace_count(), (unsigned long)trace_overwritten());
+    }
+    else if (0 == strcmp(arg1, "on") || 0 == strcmp(arg1, "off"))
+    {
+        trace_enable(0 == strcmp(arg1, "on"));
+    }
+    else if (0 == strcmp(arg1, "clear"))
+    {
+        trace_clear();
+    }
+    else if (0 == strcmp(arg1, "dump"))
+    {
+        trace_dump_hex();
+    }
+    else if (0 == strcmp(arg1, "save"))
+    {
+        const char *arg2 = strtok(NULL, " ");
+        if (!arg2)
+            arg2 = "trace.bin";
+        FRESULT fr = trace_save(arg2);
+        if (FR_OK != fr)
+            printf("trace_save error: %s (%d)\n", FRESULT_str(fr), fr);
+        else
+            printf("%lu eventos gravados em %s\n", (unsigned long)trace_count(), arg2);
+    }
+    else
+    {
+        printf("Argumento desconhecido: \"%s\"\n", arg1);
+    }
+}
+
+// Jitter do relógio de amostragem (ver lib/sample_clock.h): "jitter on" mostra
+// o histograma dos intervalos ao fim de cada captura; sem argumento mostra o
+// da última captura.
+static void run_jitter()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+        sample_clock_print(sample_clock_stats(), true);
+    else if (0 == strcmp(arg1, "on") || 0 == strcmp(arg1, "off"))
+        jitter_report = 0 == strcmp(arg1, "on");
+    else
+        printf("Argumento desconhecido: \"%s\"\n", arg1);
+}
+
+// Decimação entre o sensor e o cartão (ver lib/decim.h): "decim 10" lê o
+// sensor a 1 kHz e grava a 100 Hz; "decim off" grava cada leitura.
+static void run_decim()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1)
+    {
+        uint ratio = 0 == strcmp(arg1, "off") ? 0 : (uint)strtoul(arg1, NULL, 0);
+        if (ratio && !decim_ratio_supported(ratio))
+        {
+            printf("Razão não suportada: \"%s\" (use off, 5, 10 ou 20)\n", arg1);
+            return;
+        }
+        decim_ratio = ratio;
+    }
+    if (decim_ratio)
+        printf("Decimação: sensor a %d Hz, gravação a %d Hz\n", DECIM_INPUT_HZ,
+               DECIM_INPUT_HZ / (int)decim_ratio);
+    else
+        printf("Decimação desligada\n");
+}
+
+// Resumo espectral da captura (ver lib/vib_spectrum.h): "fft 1024 az" lê o
+// sensor a 1 kHz e, a cada 1024 amostras do eixo, grava no CSV uma linha de
+// comentário com RMS, crista, picos e bandas; com "resumo" o arquivo leva só
+// esses resumos. Sem argumento mostra a configuração e o último bloco.
+static void run_fft()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "bench"))
+    {
+        const char *arg2 = strtok(NULL, " ");
+        if (arg2)
+            vib_spectrum_bench((uint)strtoul(arg2, NULL, 0));
+        else
+            for (uint n = VIB_MIN_POINTS; n <= FFT_MAX_POINTS; n <<= 1)
+                vib_spectrum_bench(n);
+        return;
+    }
+    if (arg1)
+    {
+        uint n = 0 == strcmp(arg1, "off") ? 0 : (uint)strtoul(arg1, NULL, 0);
+        if (n && (!fft_size_supported(n) || n < VIB_MIN_POINTS))
+        {
+            printf("Tamanho não suportado: \"%s\" (use off, 256, 512 ou 1024)\n", arg1);
+            return;
+        }
+        int axis = fft_axis;
+        bool summary_only = false;
+        for (const char *arg = strtok(NULL, " "); arg; arg = strtok(NULL, " "))
+        {
+            if (0 == strcmp(arg, "resumo"))
+            {
+                summary_only = true;
+                continue;
+            }
+            for (axis = 0; axis < (int)count_of(fft_axis_names); axis++)
+                if (0 == strcmp(arg, fft_axis_names[axis]))
+                    break;
+            if (axis == (int)count_of(fft_axis_names))
+            {
+                printf("Argumento desconhecido: \"%s\"\n", arg);
+                return;
+            }
+        }
+        fft_points = n;
+        fft_axis = axis;
+        fft_summary_only = n && summary_only;
+    }
+    if (!fft_points)
+    {
+        printf("Resumo espectral desligado\n");
+        return;
+    }
+    printf("Espectro de %u pontos do eixo %s a %d Hz (um resumo a cada %.2f s)%s\n", fft_points,
+           fft_axis_names[fft_axis], DECIM_INPUT_HZ, (double)fft_points / DECIM_INPUT_HZ,
+           fft_summary_only ? ", só os resumos no arquivo" : "");
+    if (vib_last.block)
+        vib_spectrum_print(&vib_last, vib_last_axis < 3 ? "g" : "graus/s");
+}
+
+// Mede o custo de uma atualização do AHRS com leituras sintéticas (rotação
+// lenta, gravidade em Z)
+static void ahrs_bench()
+{
+    const int runs = 1000;
+    ahrs_t a;
+    ahrs_init(&a, DECIM_INPUT_HZ, mpu.gyro_sensitivity, ahrs_kp, ahrs_ki);
+    uint32_t min_cycles = UINT32_MAX;
+    uint64_t t0 = time_us_64();
+    for (int i = 0; i < runs; i++)
+    {
+        int16_t acc[3] = {(int16_t)(i % 200 - 100), (int16_t)(50 - i % 100), 16384};
+        int16_t gyr[3] = {131, (int16_t)(-66 + i % 7), 13};
+        cpu_cycles_start();
+        ahrs_update(&a, acc, gyr);
+        uint32_t c = cpu_cycles_elapsed();
+        if (c < min_cycles)
+            min_cycles = c;
+    }
+    uint64_t us = time_us_64() - t0;
+    printf("AHRS: %.2f us por atualização (%d atualizações)", (double)us / runs, runs);
+    if (cpu_cycles_available())
+        printf(", %lu ciclos", (unsigned long)min_cycles);
+    printf("\n");
+}
+
+// Orientação na captura (ver lib/ahrs.h): "ahrs on [kp] [ki]" acrescenta ao
+// CSV o quaternion e os ângulos de Euler, calculados no core1 a cada leitura
+// do sensor; "ahrs bench" mede o custo por atualização.
+static void run_ahrs()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "bench"))
+    {
+        ahrs_bench();
+        return;
+    }
+    if (arg1 && 0 == strcmp(arg1, "on"))
+    {
+        const char *arg2 = strtok(NULL, " ");
+        const char *arg3 = arg2 ? strtok(NULL, " ") : NULL;
+        if (arg2)
+            ahrs_kp = strtof(arg2, NULL);
+        if (arg3)
+            ahrs_ki = strtof(arg3, NULL);
+        ahrs_enabled = true;
+    }
+    else if (arg1 && 0 == strcmp(arg1, "off"))
+    {
+        ahrs_enabled = false;
+    }
+    else if (arg1)
+    {
+        printf("Argumento desconhecido: \"%s\"\n", arg1);
+        return;
+    }
+    printf("AHRS %s (kp %.3f, ki %.3f)\n", ahrs_enabled ? "ligado" : "desligado", ahrs_kp, ahrs_ki);
+    printf("Última orientação: rolagem %.2f, arfagem %.2f, guinada %.2f graus\n", orient_euler[0],
+           orient_euler[1], orient_euler[2]);
+}
+
+// Formato do log (ver lib/imz.h): "logfmt imz" grava as amostras em contagens
+// comprimidas sem perdas, em blocos de 4 KiB, num .imz; o tools/imu_imz
+// devolve o CSV. O resumo espectral, a orientação e as estatísticas ficam
+// de fora do .imz e só aparecem no console.
+//
+// "logfmt bin" (ver lib/binlog.h) grava cada leitura crua do sensor num .imb
+// pré-alocado: o I2C lê direto na página, que vai inteira para o DMA do SPI,
+// sem cópias nem formatação. Sem decimação no arquivo; o tools/imu_bin
+// devolve o CSV.
+static void run_logfmt()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1)
+    {
+        size_t i = 0;
+        while (i < count_of(log_format_names) && strcmp(arg1, log_format_names[i]))
+            i++;
+        if (i == count_of(log_format_names))
+        {
+            printf("Argumento desconhecido: \"%s\"\n", arg1);
+            return;
+        }
+        log_format = (log_format_t)i;
+    }
+    static const char *const desc[] = {"csv", "imz (comprimido)", "bin (leituras cruas, sem cópia)"};
+    printf("Formato do log: %s\n", desc[log_format]);
+}
+
+// Sensores (lib/imu_array.h): "imus" mede o tempo de leitura de cada um e a
+// taxa que o I2C permite; "imus scan" procura de novo nos dois barramentos e
+// "imus cal" recalibra todos, parados e com o Z para cima. Com mais de um
+// sensor, o "logfmt bin" grava todos.
+static void run_imus()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (capture_in_progress)
+    {
+        printf("[ERRO] Captura em andamento.\n");
+        return;
+    }
+    display_bus_busy = true;
+    if (arg1 && 0 == strcmp(arg1, "scan"))
+    {
+        imu_array_scan(&imus, &mpu);
+    }
+    else if (arg1 && 0 == strcmp(arg1, "cal"))
+    {
+        printf("Calibrando %u sensores...\n", imus.n);
+        imu_array_calibrate(&imus, 100);
+    }
+    else if (arg1)
+    {
+        printf("Argumento desconhecido: \"%s\"\n", arg1);
+        display_bus_busy = false;
+        return;
+    }
+    imu_array_measure(&imus, 100);
+    display_bus_busy = false;
+    imu_array_print(&imus);
+    if (imus.n > 1 && LOG_BIN != log_format)
+        printf("Use 'logfmt bin' para gravar todos os sensores\n");
+}
+
+// Detecção de eventos (ver lib/event_rules.h): "events on" avalia as regras
+// a cada leitura do sensor, também fora da captura (a 10 Hz), toca o som da
+// regra e registra os eventos em eventos.csv. As regras vêm de regras.txt,
+// lido ao montar o cartão ou com "events load".
+static void run_events()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && (0 == strcmp(arg1, "on") || 0 == strcmp(arg1, "off")))
+    {
+        if (alarm_enabled != (0 == strcmp(arg1, "on")))
+            toggle_alarm();
+    }
+    else if (arg1 && 0 == strcmp(arg1, "load"))
+    {
+        const char *arg2 = strtok(NULL, " ");
+        const char *path = arg2 ? arg2 : EVENT_RULES_FILE;
+        int n = event_rules_load(&event_rules, path);
+        if (n < 0)
+        {
+            printf("Não foi possível abrir %s\n", path);
+            return;
+        }
+    }
+    else if (arg1 && 0 == strcmp(arg1, "default"))
+    {
+        event_rules_init(&event_rules, mpu.accel_sensitivity, mpu.gyro_sensitivity);
+    }
+    else if (arg1 && 0 == strcmp(arg1, "save"))
+    {
+        FRESULT fr = event_rules_save(&event_rules, EVENT_LOG_FILE);
+        if (FR_OK != fr)
+            printf("Erro ao gravar %s: %s (%d)\n", EVENT_LOG_FILE, FRESULT_str(fr), fr);
+    }
+    else if (arg1)
+    {
+        printf("Argumento desconhecido: \"%s\"\n", arg1);
+        return;
+    }
+    printf("Detecção de eventos %s\n", alarm_enabled ? "ligada" : "desligada");
+    event_rules_print(&event_rules);
+}
+
+// Configuração (ver lib/config.h): "config set intervalo_ms 10" vale na
+// próxima captura sem reiniciar; "config save" grava o config.ini que é
+// lido ao montar o cartão.
+static void run_config()
+{
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = arg1 ? strtok(NULL, " ") : NULL;
+    char value[24];
+    if (!arg1)
+    {
+        config_print(&config);
+    }
+    else if (0 == strcmp(arg1, "get") && arg2)
+    {
+        if (config_get(&config, arg2, value, sizeof value) < 0)
+            printf("Chave desconhecida: \"%s\"\n", arg2);
+        else
+            printf("%s = %s\n", arg2, value);
+    }
+    else if (0 == strcmp(arg1, "set") && arg2)
+    {
+        const char *arg3 = strtok(NULL, " ");
+        int rc = arg3 ? config_set(&config, arg2, arg3) : CONFIG_ERR_VALUE;
+        if (CONFIG_ERR_KEY == rc)
+            printf("Chave desconhecida: \"%s\"\n", arg2);
+        else if (CONFIG_ERR_VALUE == rc)
+            printf("Valor inválido para %s: \"%s\"\n", arg2, arg3 ? arg3 : "");
+        else
+            apply_config();
+    }
+    else if (0 == strcmp(arg1, "save"))
+    {
+        FRESULT fr = config_save(&config, CONFIG_FILE);
+        if (FR_OK != fr)
+            printf("Erro ao gravar %s: %s (%d)\n", CONFIG_FILE, FRESULT_str(fr), fr);
+        else
+            printf("Configuração gravada em %s\n", CONFIG_FILE);
+    }
+    else if (0 == strcmp(arg1, "load"))
+    {
+        int n = config_load(&config, CONFIG_FILE);
+        if (n < 0)
+            printf("Não foi possível abrir %s\n", CONFIG_FILE);
+        else
+            apply_config();
+    }
+    else if (0 == strcmp(arg1, "default"))
+    {
+        config_defaults(&config);
+        apply_config();
+    }
+    else
+    {
+        printf("Argumento desconhecido: \"%s\"\n", arg1);
+    }
+}
+
+// Carga de CPU no estilo do top (ver lib/cpu_load.h): ocupação de cada core,
+// tempo por tarefa e em interrupções desde o "top" anterior, marca d'água
+// das pilhas e uso do heap.
+static void run_top()
+{
+    cpu_load_report_t r;
+    cpu_load_sample(&r);
+    cpu_load_print(&r);
+    printf("Framebuffer do SSD1306: %u B no heap\n", (unsigned)ssd.bufsize);
+}
+
+static void run_logmode()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1)
+    {
+        if (0 == strcmp(arg1, "single"))
+            log_mode = SD_ARRAY_SINGLE;
+        else if (0 == strcmp(arg1, "stripe"))
+            log_mode = SD_ARRAY_STRIPE;
+        else if (0 == strcmp(arg1, "mirror"))
+            log_mode = SD_ARRAY_MIRROR;
+        else
+        {
+            printf("Modo desconhecido: \"%s\"\n", arg1);
+            return;
+        }
+    }
+    printf("Modo de gravação: %s\n", sd_array_mode_str(log_mode));
+    if (SD_ARRAY_SINGLE != log_mode)
+        printf("Monte também o segundo cartão: mount %s\n", sd_get_by_num(1)->pcName);
+}
+
+// Expõe o cartão 0 ao PC como unidade USB (Mass Storage) até o PC ejetá-lo,
+// o usuário teclar Enter ou apertar o botão A
+static void run_usb()
+{
+    sd_card_t *pSD = sd_get_by_num(0);
+    if (pSD->mounted)
+    {
+        // O PC passa a ser o dono do sistema de arquivos
+        sd_monitor_stop(pSD);
+        f_unmount(pSD->pcName);
+        pSD->mounted = false;
+        sd_mounted = false;
+    }
+    while (gpio_get(BUTTON_A) == 0) // Solta o botão que iniciou o modo
+        sleep_ms(10);
+    // Avisos antes do usb_msc_start: daí até o fim do modo o console só
+    // sai pela UART e o USB só é atendido no laço abaixo
+    printf("\nExpondo o cartão SD ao PC como unidade USB.\n");
+    printf("Ejete a unidade no PC, tecle Enter ou aperte o botão A para sair.\n");
+    if (!usb_msc_start(pSD))
+    {
+        printf("[ERRO] Cartão SD não respondeu.\n");
+        play_error_alarm();
+        return;
+    }
+    gpio_put(GREEN_LED, false); gpio_put(RED_LED, false); gpio_put(BLUE_LED, true);
+    ssd1306_fill(&ssd, false);
+    ssd1306_draw_string(&ssd, "Modo USB", 1, 5);
+    ssd1306_draw_string(&ssd, "Ejete no PC ou", 1, 25);
+    ssd1306_draw_string(&ssd, "aperte A p/ sair", 1, 38);
+    ssd1306_send_data(&ssd);
+
+    CPU_TASK_BEGIN(CPU_TASK_USB);
+    while (usb_msc_active())
+    {
+        // Leituras e escritas do PC aqui, fora da IRQ; Enter pela CDC ou UART
+        if ('\r' == usb_msc_task() || '\r' == getchar_timeout_us(0) || !gpio_get(BUTTON_A))
+            usb_msc_stop();
+    }
+    CPU_TASK_END(CPU_TASK_USB);
+    usb_msc_end();
+    while (gpio_get(BUTTON_A) == 0)
+        sleep_ms(10);
+
+    gpio_put(BLUE_LED, false);
+    printf("Modo USB encerrado.\n");
+    run_mount();
+    display_menu_page(current_menu_page);
+}
+
+// Download binário: "get <arquivo> [offset] [tamanho]". Os quadros com CRC32
+// saem direto na CDC (ver lib/bulk_xfer.h); o PC retoma a partir do último
+// offset recebido se algum quadro chegar corrompido ou faltando.
+static void run_get()
+{
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    const char *arg3 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        printf("Missing argument\n");
+        return;
+    }
+    if (!stdio_usb_connected())
+    {
+        printf("[ERRO] O download binário só funciona pela USB.\n");
+        return;
+    }
+    uint64_t offset = arg2 ? strtoull(arg2, NULL, 0) : 0;
+    uint64_t len = arg3 ? strtoull(arg3, NULL, 0) : 0;
+    gpio_put(BLUE_LED, true); gpio_put(GREEN_LED, false); gpio_put(RED_LED, false);
+    bulk_xfer_send_file(arg1, offset, len);
+    gpio_put(BLUE_LED, false); gpio_put(GREEN_LED, true); gpio_put(RED_LED, false);
+}
+
+// Transmissão ao vivo: "stream [taxa_hz]". Envia as amostras em binário
+// (ver lib/imu_stream.h) até o PC mandar Enter; use com o tools/imu_stream.
+static void run_stream()
+{
+    const char *arg1 = strtok(NULL, " ");
+    uint32_t rate_hz = arg1 ? strtoul(arg1, NULL, 0) : IMU_STREAM_DEFAULT_HZ;
+    if (!rate_hz || rate_hz > IMU_STREAM_MAX_HZ)
+    {
+        printf("Taxa inválida (1..%d Hz)\n", IMU_STREAM_MAX_HZ);
+        return;
+    }
+    if (!stdio_usb_connected())
+    {
+        printf("[ERRO] A transmissão só funciona pela USB.\n");
+        return;
+    }
+    if (capture_in_progress)
+    {
+        printf("[ERRO] Captura em andamento.\n");
+        return;
+    }
+    gpio_put(BLUE_LED, true); gpio_put(GREEN_LED, false); gpio_put(RED_LED, false);
+    ssd1306_fill(&ssd, false);
+    ssd1306_draw_string(&ssd, "Transmitindo", 1, 5);
+    ssd1306_draw_string(&ssd, "pela USB...", 1, 25);
+    ssd1306_send_data(&ssd);
+
+    imu_stream_stats_t st = {0};
+    CPU_TASK_BEGIN(CPU_TASK_STREAM);
+    imu_stream_run(&mpu, rate_hz, &st);
+    CPU_TASK_END(CPU_TASK_STREAM);
+
+    gpio_put(BLUE_LED, false); gpio_put(GREEN_LED, true);
+    printf("\nTransmissão encerrada: %lu enviadas, %lu perdidas (USB), %lu atrasadas\n",
+           st.sent, st.dropped, st.late);
+    display_menu_page(current_menu_page);
+}
+
+// Mostra no display a rodada atual do benchmark
+static void bench_progress(int run, int total)
+{
+    char line[32];  // Cabe "Rodada " e dois int inteiros
+    snprintf(line, sizeof line, "Rodada %d/%d", run + 1, total);
+    ssd1306_fill(&ssd, false);
+    ssd1306_draw_string(&ssd, "Benchmark", 1, 5);
+    ssd1306_draw_string(&ssd, line, 1, 25);
+    ssd1306_draw_string(&ssd, "Enter p/ parar", 1, 45);
+    ssd1306_send_data(&ssd);
+}
+
+// Benchmark de gravação: "bench [quick|full] [csv|json] [segundos]". Varre taxa,
+// formato, buffer, política de sync e clock SPI (ver lib/log_bench.h) e
+// imprime uma linha por rodada entre "--- bench begin/end ---".
+static void run_bench()
+{
+    log_bench_sweep_t sweep = {.duration_ms = 5000, .mode = log_mode, .array = &log_array, .progress = bench_progress};
+    const char *arg;
+    while ((arg = strtok(NULL, " ")))
+    {
+        if (0 == strcmp(arg, "quick"))
+            sweep.full = false;
+        else if (0 == strcmp(arg, "full"))
+            sweep.full = true;
+        else if (0 == strcmp(arg, "csv"))
+            sweep.json = false;
+        else if (0 == strcmp(arg, "json"))
+            sweep.json = true;
+        else if (isdigit((unsigned char)arg[0]) && atoi(arg) > 0)
+            sweep.duration_ms = atoi(arg) * 1000;
+        else
+        {
+            printf("Argumento desconhecido: \"%s\"\n", arg);
+            return;
+        }
+    }
+    if (!sd_get_by_num(0)->mounted)
+    {
+        printf("Monte o cartão SD primeiro\n");
+        return;
+    }
+    if (capture_in_progress)
+    {
+        printf("[ERRO] Captura em andamento.\n");
+        return;
+    }
+    gpio_put(BLUE_LED, true); gpio_put(GREEN_LED, false); gpio_put(RED_LED, false);
+    int runs = log_bench_sweep(&mpu, &sweep);
+    gpio_put(BLUE_LED, false); gpio_put(GREEN_LED, true);
+    printf("Benchmark: %d rodadas\n", runs);
+    display_menu_page(current_menu_page);
+}
+
 typedef void (*p_fn_t)();
 typedef struct
 {
@@ -460,16 +1406,35 @@ static cmd_def_t cmds[] = {
     {"getfree", run_getfree, "getfree [<drive#:>]: Espaço livre"},
     {"ls", run_ls, "ls: Lista arquivos"},
     {"cat", run_cat, "cat <filename>: Mostra conteúdo do arquivo"},
+    {"rbench", run_rbench, "rbench [<filename>]: Mede a taxa de leitura do cartão SD"},
+    {"sdstats", run_sdstats, "sdstats [<drive#:>]: Latências e erros do cartão SD (zera depois)"},
+    {"trace", run_trace, "trace [on|off|clear|dump|save [arquivo]]: Rastro de eventos (tools/imu_trace)"},
+    {"jitter", run_jitter, "jitter [on|off]: Intervalos entre amostras da última captura"},
+    {"decim", run_decim, "decim [off|5|10|20]: Lê a 1 kHz e grava a 1/N (CIC + FIR)"},
+    {"fft", run_fft, "fft [off|256|512|1024] [ax|ay|az|gx|gy|gz] [resumo] | fft bench [n]: Espectro por bloco"},
+    {"ahrs", run_ahrs, "ahrs [on [kp] [ki]|off|bench]: Orientação (quaternion e Euler) no CSV"},
+    {"logfmt", run_logfmt, "logfmt [csv|imz|bin]: Amostras em CSV, comprimidas sem perdas (.imz) ou cruas (.imb)"},
+    {"imus", run_imus, "imus [scan|cal]: Sensores MPU6050, calibração e taxa máxima de cada um"},
+    {"events", run_events, "events [on|off|load [arquivo]|default|save]: Regras de eventos (queda, impacto, repouso)"},
+    {"config", run_config, "config [get <chave>|set <chave> <valor>|save|load|default]: Configuração (config.ini)"},
+    {"top", run_top, "top: Carga de CPU por core e tarefa, pilhas e heap"},
+    {"logmode", run_logmode, "logmode [single|stripe|mirror]: Modo de gravação nos cartões"},
+    {"get", run_get, "get <filename> [offset] [len]: Download binário (tools/imu_get)"},
+    {"stream", run_stream, "stream [hz]: Transmite as amostras ao vivo (tools/imu_stream)"},
+    {"bench", run_bench, "bench [quick|full] [csv|json] [segundos]: Benchmark de gravação"},
+    {"usb", run_usb, "usb: Acessa o cartão SD pelo PC (USB Mass Storage)"},
     {"help", run_help, "help: Mostra comandos disponíveis"}};
 
-static void process_stdio(int cRxedChar)
+// Executa a linha digitada ao receber '\r'. Uma linha de um só caractere que
+// não é comando é devolvida como atalho do menu ('a'..'h'); senão retorna 0.
+static int process_stdio(int cRxedChar)
 {
     static char cmd[256];
     static size_t ix;
 
     if (!isprint(cRxedChar) && !isspace(cRxedChar) && '\r' != cRxedChar &&
         '\b' != cRxedChar && cRxedChar != (char)127)
-        return;
+        return 0;
     printf("%c", cRxedChar); // echo
     stdio_flush();
     if (cRxedChar == '\r')
@@ -481,8 +1446,9 @@ static void process_stdio(int cRxedChar)
         {
             printf("> ");
             stdio_flush();
-            return;
+            return 0;
         }
+        int hotkey = 0;
         char *cmdn = strtok(cmd, " ");
         if (cmdn)
         {
@@ -491,15 +1457,24 @@ static void process_stdio(int cRxedChar)
             {
                 if (0 == strcmp(cmds[i].command, cmdn))
                 {
+                    CPU_TASK_BEGIN(CPU_TASK_CONSOLE);
                     (*cmds[i].function)();
+                    CPU_TASK_END(CPU_TASK_CONSOLE);
                     break;
                 }
             }
             if (count_of(cmds) == i)
-                printf("Command \"%s\" not found\n", cmdn);
+            {
+                if (1 == strlen(cmdn))
+                    hotkey = cmdn[0];
+                else
+                    printf("Command \"%s\" not found\n", cmdn);
+            }
         }
         ix = 0;
         memset(cmd, 0, sizeof cmd);
+        if (hotkey)
+            return hotkey;
         printf("\n> ");
         stdio_flush();
     }
@@ -522,7 +1497,58 @@ static void process_stdio(int cRxedChar)
             }
         }
     }
+    return 0;
 }
+// Grava uma linha do CSV com os valores de accel/gyro (g e graus/s) e, com o
+// AHRS ligado, a orientação
+static FRESULT write_sample_row(int n, uint64_t t_us) {
+    char buffer[200];
+    char buffer_disp[50];
+    sprintf(buffer_disp, "Amostra: %d,Tempo de medição: %1.2f", n, t_us / 1e6f);
+    if (current_menu_page < 4)  // As páginas do espectro e da orientação ocupam a tela
+        ssd1306_draw_string(&ssd, buffer_disp, 1, 35);
+    int len = sprintf(buffer, "%d,%f,%f,%f,%f,%f,%f,%lu.%06lu", n, accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2],
+                      (unsigned long)(t_us / 1000000), (unsigned long)(t_us % 1000000));
+    if (ahrs_enabled)
+        len += sprintf(buffer + len, ",%f,%f,%f,%f,%.3f,%.3f,%.3f", orient_q[0], orient_q[1], orient_q[2],
+                       orient_q[3], orient_euler[0], orient_euler[1], orient_euler[2]);
+    buffer[len++] = '\n';
+    return sd_array_write(&log_array, buffer, len);
+}
+
+// Fecha a página do .imb; com vários sensores, a tabela de canais leva o
+// atraso médio das leituras até aqui
+static void log_page_end(uint8_t *page, unsigned n_ch, unsigned n) {
+    if (n_ch > 1) {
+        binlog_channel_t ch[IMU_ARRAY_MAX];
+        imu_array_describe(&imus, ch);
+        binlog_page_channels(page, ch, n_ch);
+    }
+    binlog_page_end(page, n_ch, n);
+}
+
+// Espera pelo cartão no fim de uma captura com ele fora
+#define LOG_OUTAGE_WAIT_MS 5000
+
+// Cartão 0 fora durante a captura (modo single): o log segue em RAM no
+// sd_array enquanto o monitor tenta remontar o volume
+static FRESULT log_outage_poll(bool *reported) {
+    sd_card_t *pSD = sd_get_by_num(0);
+    if (!*reported) {
+        printf("[AVISO] Cartão sem resposta; guardando o log em RAM\n");
+        sd_monitor_fault(pSD);
+        *reported = true;
+    }
+    sd_monitor_poll();
+    if (SD_MON_PRESENT != sd_monitor_state(pSD))
+        return FR_OK;
+    *reported = false;
+    FRESULT fr = sd_array_resume(&log_array);
+    if (FR_OK == fr)
+        printf("Cartão remontado; log retomado\n");
+    return fr;
+}
+
 void capture_imu_data_and_save() {
     if (capture_in_progress) {
         should_stop_capture = true;
@@ -535,16 +1561,41 @@ void capture_imu_data_and_save() {
     gpio_put(RED_LED, true); gpio_put(GREEN_LED, false);
     printf("\nIniciando a captura de dados de aceleração e giroscópio.\n");
     
-    const int total_amostras = 1000;
-    const int intervalo_ms = 100;
-    int tempo_total_s = (total_amostras * intervalo_ms) / 1000;
+    const int total_amostras = (int)config.samples;
+    const int intervalo_ms = (int)config.interval_ms;
+    int tempo_total_s = (int)((uint64_t)total_amostras * intervalo_ms / 1000);
     printf("Tempo estimado: %d segundos\n", tempo_total_s);
+    // Com decimação o sensor é lido a DECIM_INPUT_HZ e cada decim_ratio
+    // leituras viram uma linha; o espectro também usa essa taxa. O período
+    // de verdade é o que o sample_clock_start devolve (igual a este).
+    uint32_t period_in_us = capture_period_us();
+    const int total_in = (int)((uint64_t)total_amostras * intervalo_ms * 1000 / period_in_us);
+    if (decim_ratio)
+        printf("Sensor a %lu Hz, gravando a %lu Hz (decimação por %u)\n", (unsigned long)(1000000 / period_in_us),
+               (unsigned long)(1000000 / (period_in_us * decim_ratio)), decim_ratio);
     
-    snprintf(filename, sizeof(filename), "%s%d.csv", filename_base, med_count);
+    // Resumo espectral: só os resumos no arquivo, ou como comentários no
+    // meio das amostras. Com o log comprimido o arquivo leva só as amostras.
+    const bool write_samples = !(fft_points && fft_summary_only);
+    // No binário o arquivo leva as leituras cruas e nada mais
+    const bool compressed = log_format == LOG_IMZ && write_samples;
+    const bool binary = log_format == LOG_BIN && write_samples;
+    // Os outros sensores vão junto só no .imb, um canal cada
+    const unsigned n_ch = binary ? log_channels() : 1;
+    const unsigned page_records = binlog_records_per_page(n_ch);
+    if (imus.n > 1 && n_ch == 1)
+        printf("%u sensores, mas só o formato bin grava todos; gravando o sensor 0\n", imus.n);
+    snprintf(filename, sizeof(filename), "%s%d.%s", config.filename_base, med_count,
+             binary ? "imb" : compressed ? "imz" : "csv");
     med_count++;
     
-    FIL file;
-    FRESULT res = f_open(&file, filename, FA_WRITE | FA_CREATE_ALWAYS);
+    FRESULT res;
+    if (binary) {
+        uint32_t pages = (total_in + page_records - 1) / page_records;
+        res = sd_array_open_pages(&log_array, log_mode, filename, pages * BINLOG_PAGE_SIZE);
+    } else {
+        res = sd_array_open(&log_array, log_mode, filename);
+    }
     if (res != FR_OK) {
         printf("\n[ERRO] Não foi possível abrir o arquivo para escrita. Monte o cartão.\n");
         play_error_alarm();
@@ -552,39 +1603,264 @@ void capture_imu_data_and_save() {
         return;
     }
     
-    UINT bw;
     absolute_time_t start_time = get_absolute_time();
-    char header[] = "Amostra, Aceleração X, Aceleração Y, Aceleração Z, Giroscópio X, Giroscópio Y, Giroscópio Z, Tempo (s)\n";
-    res = f_write(&file, header, strlen(header), &bw);
+    imu_stats_init(&capture_stats, mpu.accel_sensitivity, mpu.gyro_sensitivity);
+    event_rules_reset(&event_rules);
+    const uint32_t events_before = event_rules.total;
+    if (n_ch > 1) {
+        display_bus_busy = true;
+        imu_array_measure(&imus, 10);
+        printf("%u sensores; o I2C sozinho dá até %lu Hz juntos (a gravação das páginas baixa isso)\n", n_ch,
+               (unsigned long)imu_array_rate_hz(&imus));
+        imu_array_start(&imus, &mpu);
+        display_bus_busy = imus.n_bus[1] > 0;
+    }
+    period_in_us = sample_clock_start(&mpu, MPU_INT, period_in_us);
+    const float rate_in = 1e6f / period_in_us;
+    uint32_t decim_delay = 0;
+    if (decim_ratio) {
+        decim_init(&decim, decim_ratio);
+        decim_delay = decim_delay_us(&decim, period_in_us);
+    }
+    int16_t block[DECIM_MAX_RATIO][DECIM_AXES];
+    uint block_len = 0;
+    int rows = 0;
+    const char *vib_prefix = write_samples ? "# Espectro, " : "";
+    char vib_line[256];
+    if (fft_points) {
+        float sens = fft_axis < 3 ? mpu.accel_sensitivity : mpu.gyro_sensitivity;
+        vib_spectrum_init(&vib, fft_points, rate_in, sens);
+        vib_last_axis = fft_axis;
+        memset(&vib_last, 0, sizeof vib_last);
+        printf("Espectro do eixo %s a cada %u amostras\n", fft_axis_names[fft_axis], fft_points);
+    }
+    if (ahrs_enabled) {
+        ahrs_init(&ahrs, rate_in, mpu.gyro_sensitivity, ahrs_kp, ahrs_ki);
+        core1_worker_init();  // Envio da página da orientação
+    }
+    uint64_t last_orient_display_us = 0;
+    // Valores em contagens; com decimação, em Q8
+    const int frac_bits = decim_ratio ? DECIM_OUT_FRAC_BITS : 0;
+    uint64_t imz_us = 0;
+    if (compressed)
+        imz_encoder_init(&imz, period_in_us * (decim_ratio ? decim_ratio : 1), mpu.accel_sensitivity,
+                         mpu.gyro_sensitivity, frac_bits);
+    uint8_t *page = NULL;              // Página do .imb sendo preenchida
+    bool outage_reported = false;
+    uint32_t page_seq = 0;
+    unsigned page_n = 0;
+    if (write_samples && !compressed && !binary) {
+        char header[] = "Amostra, Aceleração X, Aceleração Y, Aceleração Z, Giroscópio X, Giroscópio Y, Giroscópio Z, Tempo (s)";
+        res = sd_array_write(&log_array, header, strlen(header));
+        const char *cols = ahrs_enabled ? ", q0, q1, q2, q3, Rolagem (graus), Arfagem (graus), Guinada (graus)\n" : "\n";
+        if (FR_OK == res)
+            res = sd_array_write(&log_array, cols, strlen(cols));
+    }
+    if (fft_points && !compressed && !binary && FR_OK == res) {
+        int len = vib_spectrum_format_header(&vib, vib_prefix, vib_line, sizeof vib_line);
+        if (len > 0 && (size_t)len < sizeof vib_line)
+            res = sd_array_write(&log_array, vib_line, (UINT)len);
+    }
     
-    for (int i = 0; i < total_amostras && !should_stop_capture; i++) {
-        mpu6050_read_calibrated(&mpu, accel, gyro);
-        char buffer[100];
-        uint32_t time = to_ms_since_boot(get_absolute_time());
-        char buffer_disp[50];
-        sprintf(buffer_disp, "Amostra: %d,Tempo de medição: %1.2f", i+1, time);
-        ssd1306_draw_string(&ssd, buffer_disp, 1, 35);
-        sprintf(buffer, "%d,%f,%f,%f,%f,%f,%f,%f\n", i + 1, accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], (float)time/1000);
-        res = f_write(&file, buffer, strlen(buffer), &bw);
+    for (int i = 0; i < total_in && !should_stop_capture; i++) {
+        // Carimbo do data-ready do sensor, em us
+        uint64_t t_us = sample_clock_wait();
+        TRACE_BEGIN(TRACE_IMU_READ, 0);
+        int16_t raw_accel[3], raw_gyro[3];
+        if (binary && FR_OK == res) {
+            // A leitura cai direto no registro da página
+            if (!page) {
+                page = sd_array_page(&log_array);
+                binlog_page_begin(page, page_seq++, t_us, mpu.accel_sensitivity, mpu.gyro_sensitivity, n_ch);
+            }
+            uint8_t *rec = binlog_record(page, n_ch, page_n++, t_us);
+            if (n_ch > 1) {
+                // Todos os sensores no mesmo tick; o sensor 0 segue para as
+                // estatísticas, eventos e espectro
+                imu_array_read(&imus, rec, t_us);
+                mpu6050_decode_burst(rec + 1, raw_accel, raw_gyro);
+            } else {
+                mpu6050_read_burst(&mpu, rec);
+                mpu6050_decode_burst(rec, raw_accel, raw_gyro);
+            }
+            rows++;
+        } else {
+            mpu6050_read_raw(&mpu, raw_accel, raw_gyro);
+        }
+        TRACE_END(TRACE_IMU_READ, 0);
+        if (page && page_n == page_records) {
+            log_page_end(page, n_ch, page_n);
+            res = sd_array_commit(&log_array);
+            page = NULL;
+            page_n = 0;
+        }
+        // Estatísticas nas contagens brutas; o CSV leva g e graus/s
+        imu_stats_add(&capture_stats, raw_accel, raw_gyro);
+        if (alarm_enabled) {
+            uint32_t seen = event_rules.total;
+            int fired = event_rules_eval(&event_rules, raw_accel, raw_gyro, t_us);
+            if (fired >= 0)
+                play_event_sound(fired);
+            // Evento encerrado: fica marcado no CSV, entre as amostras
+            if (event_rules.total != seen && write_samples && !compressed && !binary && FR_OK == res) {
+                char event_line[80];
+                const event_record_t *ev = &event_rules.log[(event_rules.head + EVENT_LOG_SIZE - 1) % EVENT_LOG_SIZE];
+                int len = event_rules_format(&event_rules, ev, "# Evento, ", event_line, sizeof event_line);
+                if (len > 0 && (size_t)len < sizeof event_line)
+                    res = sd_array_write(&log_array, event_line, (UINT)len);
+            }
+        }
+        buzzer_poll();
+        if (fft_points) {
+            vib_spectrum_add(&vib, fft_axis < 3 ? raw_accel[fft_axis] : raw_gyro[fft_axis - 3], t_us);
+            if (vib_spectrum_poll(&vib, &vib_last)) {
+                int len = vib_spectrum_format(&vib_last, vib_prefix, vib_line, sizeof vib_line);
+                if (!compressed && !binary && len > 0 && (size_t)len < sizeof vib_line)
+                    res = sd_array_write(&log_array, vib_line, (UINT)len);
+                update_capture_display(4);
+            }
+        }
+        // O bloco só alimenta as linhas (e o AHRS, que anda junto com elas)
+        if (write_samples && !binary && FR_OK == res) {
+            for (int j = 0; j < 3; j++) {
+                block[block_len][j] = raw_accel[j];
+                block[block_len][3 + j] = raw_gyro[j];
+            }
+            block_len++;
+        }
+        // Uma linha por leitura, ou por decim_ratio leituras com decimação
+        if (block_len && block_len == (decim_ratio ? decim_ratio : 1)) {
+            // O AHRS fica no core0 (~15 us por leitura): no core1 a linha
+            // esperaria pelos trabalhos dele, como a gravação no cartão 1
+            if (ahrs_enabled) {
+                ahrs_update_block(&ahrs, (const int16_t (*)[DECIM_AXES])block, block_len);
+                ahrs_quaternion(&ahrs, orient_q);
+                ahrs_euler(&ahrs, orient_euler);
+            }
+            int32_t out[2][DECIM_AXES];
+            size_t n_out = 1;
+            if (decim_ratio) {
+                n_out = decim_process(&decim, (const int16_t (*)[DECIM_AXES])block, block_len, out);
+            } else {
+                for (int j = 0; j < DECIM_AXES; j++)
+                    out[0][j] = block[0][j];
+            }
+            block_len = 0;
+            const float q = 1 << frac_bits;
+            for (size_t k = 0; k < n_out && FR_OK == res; k++) {
+                // O filtro atrasa o sinal; o carimbo volta para o centro dele
+                if (compressed) {
+                    uint64_t t0 = time_us_64();
+                    const uint8_t *full = imz_encoder_add(&imz, out[k], t_us - decim_delay);
+                    imz_us += time_us_64() - t0;
+                    rows++;
+                    if (full)
+                        res = sd_array_write(&log_array, full, IMZ_BLOCK_SIZE);
+                    continue;
+                }
+                for (int j = 0; j < 3; j++) {
+                    accel[j] = out[k][j] / q / mpu.accel_sensitivity;
+                    gyro[j] = out[k][3 + j] / q / mpu.gyro_sensitivity;
+                }
+                res = write_sample_row(++rows, t_us - decim_delay);
+            }
+            if (ahrs_enabled && t_us - last_orient_display_us >= 200000) {
+                update_capture_display(5);
+                last_orient_display_us = t_us;
+            }
+        }
         
+        if (log_array.offline && FR_OK == res)
+            res = log_outage_poll(&outage_reported);
         if (res != FR_OK) {
             printf("[ERRO] Não foi possível escrever no arquivo.\n");
             play_error_alarm();
             break;
         }
         
-        if ((i + 1) % 50 == 0 || i == 0) {
+        if ((i + 1) % (5000000 / period_in_us) == 0 || i == 0) {
             absolute_time_t now = get_absolute_time();
             int elapsed_ms = to_ms_since_boot(now) - to_ms_since_boot(start_time);
-            int remaining_ms = (total_amostras - (i + 1)) * intervalo_ms;
+            int remaining_ms = (int)((int64_t)(total_in - (i + 1)) * period_in_us / 1000);
             int remaining_s = remaining_ms / 1000;
-            printf("Amostra %d/%d - Tempo restante: %d segundos\n", i + 1, total_amostras, remaining_s);
+            printf("Amostra %d/%d - Tempo restante: %d segundos\n", i + 1, total_in, remaining_s);
         }
-        
-        sleep_ms(intervalo_ms);
+    }
+    sample_clock_stop();
+    if (n_ch > 1)
+        imu_array_stop(&imus);
+    while (fft_points && FR_OK == res && vib_spectrum_finish(&vib, &vib_last)) {
+        int len = vib_spectrum_format(&vib_last, vib_prefix, vib_line, sizeof vib_line);
+        if (!compressed && !binary && len > 0 && (size_t)len < sizeof vib_line)
+            res = sd_array_write(&log_array, vib_line, (UINT)len);
+    }
+    core1_worker_wait(&capture_display_job);
+    display_bus_busy = false;
+
+    // Última página do .imb, incompleta
+    if (page && FR_OK == res) {
+        log_page_end(page, n_ch, page_n);
+        res = sd_array_commit(&log_array);
+    }
+
+    if (compressed && FR_OK == res) {
+        const uint8_t *last = imz_encoder_flush(&imz);
+        if (last)
+            res = sd_array_write(&log_array, last, IMZ_BLOCK_SIZE);
+    }
+    // Rodapé com as estatísticas, em linhas de comentário do CSV
+    if (!compressed && !binary && FR_OK == res) {
+        char footer[512];
+        int len = imu_stats_format_footer(&capture_stats, footer, sizeof footer);
+        if (len > 0 && (size_t)len < sizeof footer)
+            res = sd_array_write(&log_array, footer, (UINT)len);
     }
     
-    f_close(&file);
+    absolute_time_t outage_deadline = make_timeout_time_ms(LOG_OUTAGE_WAIT_MS);
+    while (log_array.offline && FR_OK == res && !time_reached(outage_deadline)) {
+        res = log_outage_poll(&outage_reported);
+        sleep_ms(10);
+    }
+    if (sd_array_close(&log_array) != FR_OK) {
+        printf("[ERRO] Falha ao gravar nos cartões.\n");
+        play_error_alarm();
+    }
+    sd_array_print_stats(&log_array);
+    uint64_t log_us = absolute_time_diff_us(log_array.start, get_absolute_time());
+    if (log_us && FR_OK == res) {
+        log_rate.bytes_per_s = (uint32_t)(log_array.stats[0].bytes * 1000000ull / log_us);
+        log_rate.format = log_format;
+        log_rate.mode = log_mode;
+        log_rate.interval_ms = config.interval_ms;
+    }
+    if (alarm_enabled) {
+        printf("%lu eventos na captura\n", (unsigned long)(event_rules.total - events_before));
+        FRESULT fr = event_rules_save(&event_rules, EVENT_LOG_FILE);
+        if (FR_OK != fr)
+            printf("[ERRO] Não foi possível gravar %s: %s\n", EVENT_LOG_FILE, FRESULT_str(fr));
+    }
+    sample_clock_print(sample_clock_stats(), jitter_report);
+    imu_stats_print(&capture_stats);
+    if (n_ch > 1)
+        imu_array_print(&imus);
+    if (compressed && rows) {
+        // Comparado ao binário cru: 6 eixos (int16, ou int32 em Q8) e o tempo em 64 bits
+        uint32_t bytes = imz.seq * IMZ_BLOCK_SIZE;
+        uint32_t raw = rows * ((frac_bits ? 4 : 2) * IMZ_AXES + 8);
+        printf("imz: %d amostras em %lu blocos (%lu bytes), %.1f bits/amostra, %.2fx o binário, %.1f us/amostra\n",
+               rows, (unsigned long)imz.seq, (unsigned long)bytes, 8.0f * bytes / rows, (float)raw / bytes,
+               (float)imz_us / rows);
+    }
+    if (binary && rows)
+        printf("imb: %d leituras em %lu páginas (%lu bytes)\n", rows, (unsigned long)page_seq,
+               (unsigned long)page_seq * BINLOG_PAGE_SIZE);
+    if (fft_points && vib_last.block) {
+        printf("%lu blocos espectrais", (unsigned long)vib.blocks);
+        if (vib.lost)
+            printf(" (%lu resumos perdidos)", (unsigned long)vib.lost);
+        printf("; último:\n");
+        vib_spectrum_print(&vib_last, fft_axis < 3 ? "g" : "graus/s");
+    }
     
     if (should_stop_capture) {
         printf("\nCaptura interrompida pelo usuário. Dados parciais salvos em %s.\n", filename);
@@ -598,44 +1874,66 @@ void capture_imu_data_and_save() {
 }
 
 void check_system_errors() {
-    static bool last_sd_state = false;
-    static bool sd_error_shown = false;
+    static sd_monitor_state_t last_sd_state = SD_MON_OFF;
     
-    // Verifica estado do SD card
-    bool current_sd_state = sd_mounted;
-    if (last_sd_state != current_sd_state) {
-        last_sd_state = current_sd_state;
-        sd_error_shown = false;
-    }
-    
-    // Se SD deveria estar montado mas não está
-    if (sd_mounted && !sd_get_by_num(0)->mounted && !sd_error_shown) {
+    // Queda e volta do cartão 0, vistas pelo monitor (lib/sd_monitor.h)
+    sd_monitor_state_t current_sd_state = sd_monitor_state(sd_get_by_num(0));
+    if (current_sd_state == last_sd_state)
+        return;
+    if (SD_MON_LOST == current_sd_state && SD_MON_PRESENT == last_sd_state) {
+        printf("\n[ERRO] Cartão SD desconectado; será remontado quando voltar.\n");
         play_error_alarm();
         ssd1306_fill(&ssd, false);
         ssd1306_draw_string(&ssd, "ERRO: SD desconectado", 1, 20);
         ssd1306_send_data(&ssd);
-        sd_error_shown = true;
+    } else if (SD_MON_PRESENT == current_sd_state && SD_MON_OFF != last_sd_state) {
+        printf("\nCartão SD remontado.\n");
+        display_menu_page(current_menu_page);
     }
+    last_sd_state = current_sd_state;
 }
 
 
 void gpio_irq_handler(uint gpio, uint32_t events) {
+    CPU_ISR_ENTER();
+    TRACE_BEGIN(TRACE_ISR_GPIO, gpio);
+    if (gpio == MPU_INT) {
+        sample_clock_irq();
+        TRACE_END(TRACE_ISR_GPIO, gpio);
+        CPU_ISR_EXIT();
+        return;
+    }
+    if (sd_monitor_irq(gpio)) {
+        TRACE_END(TRACE_ISR_GPIO, gpio);
+        CPU_ISR_EXIT();
+        return;
+    }
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     
     if (gpio == BUTTON_A && (current_time - last_time_a >= DEBOUNCE_DELAY)) {
         // Alterna entre páginas do menu
         current_menu_page = (current_menu_page + 1) % MAX_MENU_PAGES;
-        display_menu_page(current_menu_page);
+        // Com o core1 enviando uma página da captura (ou lendo os sensores
+        // do i2c1), o barramento está ocupado; a página nova aparece na
+        // próxima atualização
+        if (capture_display_job.done && !display_bus_busy)
+            display_menu_page(current_menu_page);
         last_time_a = current_time;
     } 
     else if (gpio == BUTTON_B && (current_time - last_time_b >= DEBOUNCE_DELAY)) {
         reset_usb_boot(0, 0);
         last_time_b = current_time;
     }
+    TRACE_END(TRACE_ISR_GPIO, gpio);
+    CPU_ISR_EXIT();
 }
 
 int main()
 {
+    cpu_load_init_core();
+    fft_init();  // Tabela de senos, antes de o core1 começar
+    config_defaults(&config);
+    usb_msc_init();
     stdio_init_all();
 
     gpio_init(BUTTON_A);
@@ -663,12 +1961,17 @@ int main()
     // Inicializa MPU6050
     
     mpu6050_init(&mpu, MPU_PORT, MPU6050_ADDR, AFS_2G, GFS_250DPS);
+    event_rules_init(&event_rules, mpu.accel_sensitivity, mpu.gyro_sensitivity);
     
-    // Calibração (opcional)
-    int16_t accel_bias[3], gyro_bias[3];
-    mpu6050_calibrate(&mpu, accel_bias, gyro_bias, 100);
+    // Outros sensores nos dois barramentos e calibração de todos
+    display_bus_busy = true;
+    if (imu_array_scan(&imus, &mpu) > 1)
+        printf("%u sensores MPU6050 (comando 'imus')\n", imus.n);
+    imu_array_calibrate(&imus, 100);
+    display_bus_busy = false;
     gpio_put(RED_LED, true); gpio_put(GREEN_LED, true);
     sd_init_driver();
+    sd_monitor_init();
     gpio_put(RED_LED, false); gpio_put(GREEN_LED, false);
     stdio_flush(); 
     run_help();
@@ -676,30 +1979,49 @@ int main()
 
     while (true) {
         int cRxedChar = getchar_timeout_us(0);
+        int hotkey = 0;
         if (PICO_ERROR_TIMEOUT != cRxedChar)
-            process_stdio(cRxedChar);
+            hotkey = process_stdio(cRxedChar);
         
         static absolute_time_t last_imu_update = 0;
         if (absolute_time_diff_us(last_imu_update, get_absolute_time()) > 100000) { // 100ms
-            mpu6050_read_calibrated(&mpu, accel, gyro);
+            CPU_TASK_BEGIN(CPU_TASK_IMU);
+            int16_t raw_accel[3], raw_gyro[3];
+            mpu6050_read_raw(&mpu, raw_accel, raw_gyro);
+            for (int i = 0; i < 3; i++) {
+                accel[i] = (float)raw_accel[i] / mpu.accel_sensitivity;
+                gyro[i] = (float)raw_gyro[i] / mpu.gyro_sensitivity;
+            }
             last_imu_update = get_absolute_time();
+            if (alarm_enabled) {
+                int fired = event_rules_eval(&event_rules, raw_accel, raw_gyro, time_us_64());
+                if (fired >= 0)
+                    play_event_sound(fired);
+            }
             
             // Se estiver na página de dados IMU, atualiza o display
             if (current_menu_page == 2) {
                 display_menu_page(2);
             }
+            CPU_TASK_END(CPU_TASK_IMU);
+        }
+        buzzer_poll();
+        // Contagem do espaço livre aos poucos, sem travar o menu
+        static absolute_time_t last_space_poll = 0;
+        if (absolute_time_diff_us(last_space_poll, get_absolute_time()) > 100000) {
+            if (refresh_disp_space() && current_menu_page == 1)
+                display_menu_page(1);
+            last_space_poll = get_absolute_time();
         }
-        static absolute_time_t last_alarm_time = 0;
-        if (alarm_enabled && absolute_time_diff_us(last_alarm_time, get_absolute_time()) > 2000000) { // 2s
-            set_buzzer_tone(BUZZER_A, C5);
-            sleep_ms(100);
-            set_buzzer_tone(BUZZER_A, G5);
-            sleep_ms(100);
-            stop_buzzer(BUZZER_A);
-            last_alarm_time = get_absolute_time();
+        // Eventos detectados fora da captura vão para o cartão a cada 5 s
+        static absolute_time_t last_event_save = 0;
+        if (event_rules.unsaved && sd_get_by_num(0)->mounted && absolute_time_diff_us(last_event_save, get_absolute_time()) > 5000000) {
+            event_rules_save(&event_rules, EVENT_LOG_FILE);
+            last_event_save = get_absolute_time();
         }
         
-        switch (cRxedChar) {
+        if (hotkey) CPU_TASK_BEGIN(CPU_TASK_CONSOLE);
+        switch (hotkey) {
             case 'a': // Monta o SD card se pressionar 'a'
                 ssd1306_fill(&ssd, false);
                 ssd1306_draw_string(&ssd, "Montando SD...", 1, 25);
@@ -764,7 +2086,9 @@ int main()
                 sleep_ms(150);
                 stop_buzzer(BUZZER_A);
 
+                CPU_TASK_BEGIN(CPU_TASK_CAPTURE);
                 capture_imu_data_and_save();
+                CPU_TASK_END(CPU_TASK_CAPTURE);
                 
                 ssd1306_fill(&ssd, false);
                 ssd1306_draw_string(&ssd, "Dados Salvos!", 1, 25);
@@ -808,7 +2132,25 @@ int main()
                 // Nenhuma ação para outros caracteres
                 break;
         }
+        if (hotkey) CPU_TASK_END(CPU_TASK_CONSOLE);
+        // Segurar o botão A por 2 s entra no modo USB
+        static absolute_time_t button_a_down = 0;
+        if (gpio_get(BUTTON_A) == 0) {
+            if (!button_a_down) {
+                button_a_down = get_absolute_time();
+            } else if (absolute_time_diff_us(button_a_down, get_absolute_time()) > 2000000) {
+                run_usb();
+                button_a_down = 0;
+            }
+        } else {
+            button_a_down = 0;
+        }
+
+        sd_monitor_poll();
         check_system_errors();
+        sd_read_stream_poll(sd_get_by_num(0));
+        CPU_IDLE_BEGIN();
         sleep_ms(100); // Reduzido para maior responsividade do loop
+        CPU_IDLE_END();
     }
 }
@@ -0,0 +1,143 @@
+// gen_decim: gera lib/decim_coeffs.h, os coeficientes do estágio de
+// decimação (lib/decim.h) para cada razão suportada.
+//
+//   gen_decim > lib/decim_coeffs.h
+//
+// Cada razão R = Rc * M é um CIC de DECIM_CIC_STAGES estágios que decima por
+// Rc, seguido de um FIR de fase linear que compensa a queda do CIC na banda
+// passante e decima por M. O FIR é projetado por mínimos quadrados
+// ponderados numa grade densa de frequências; a normalização do ganho do CIC
+// (1 / Rc^N) já vai embutida nos coeficientes inteiros.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int kStages = 4;      // DECIM_CIC_STAGES
+constexpr int kOutFrac = 8;     // Bits fracionários da saída (DECIM_OUT_FRAC_BITS)
+constexpr int kShift = 24;      // Deslocamento final do acumulador (DECIM_ACC_SHIFT)
+constexpr int kGrid = 2048;
+
+struct Ratio {
+    int ratio, cic, fir, taps;
+    double pass, stop;  // Bordas em ciclos/amostra na entrada do FIR
+};
+
+// Razões a partir de 1 kHz: 200, 100 e 50 Hz
+const Ratio kRatios[] = {
+    {5, 5, 1, 15, 0.30, 0.45},
+    {10, 5, 2, 31, 0.20, 0.30},
+    {20, 10, 2, 31, 0.20, 0.30},
+};
+
+// |H| do CIC normalizado (ganho 1 em DC); f em ciclos/amostra na saída do CIC
+double cic_response(double f, int rc) {
+    if (f == 0) return 1.0;
+    double x = M_PI * f;
+    return std::pow(std::fabs(std::sin(x) / (rc * std::sin(x / rc))), kStages);
+}
+
+// Resolve A x = b (A simétrica positiva definida) por eliminação de Gauss
+std::vector<double> solve(std::vector<std::vector<double>> a, std::vector<double> b) {
+    const size_t n = b.size();
+    for (size_t i = 0; i < n; i++) {
+        size_t p = i;
+        for (size_t r = i + 1; r < n; r++)
+            if (std::fabs(a[r][i]) > std::fabs(a[p][i])) p = r;
+        std::swap(a[i], a[p]);
+        std::swap(b[i], b[p]);
+        for (size_t r = i + 1; r < n; r++) {
+            double k = a[r][i] / a[i][i];
+            for (size_t c = i; c < n; c++) a[r][c] -= k * a[i][c];
+            b[r] -= k * b[i];
+        }
+    }
+    std::vector<double> x(n);
+    for (size_t i = n; i-- > 0;) {
+        double s = b[i];
+        for (size_t c = i + 1; c < n; c++) s -= a[i][c] * x[c];
+        x[i] = s / a[i][i];
+    }
+    return x;
+}
+
+// FIR tipo I: H(f) = h[K] + 2 sum h[K-k] cos(2 pi f k). Ajusta 1/|CIC| até
+// "pass" e 0 a partir de "stop"; a transição fica livre.
+std::vector<double> design(const Ratio &r) {
+    const int half = r.taps / 2;
+    const int n = half + 1;
+    std::vector<std::vector<double>> a(n, std::vector<double>(n, 0.0));
+    std::vector<double> b(n, 0.0);
+    for (int g = 0; g <= kGrid; g++) {
+        double f = 0.5 * g / kGrid, want, weight;
+        if (f <= r.pass) {
+            want = 1.0 / cic_response(f, r.cic);
+            weight = 1.0;
+        } else if (f >= r.stop) {
+            want = 0.0;
+            weight = 20.0;
+        } else {
+            continue;
+        }
+        std::vector<double> basis(n);
+        for (int k = 0; k < n; k++) basis[k] = k ? 2 * std::cos(2 * M_PI * f * k) : 1.0;
+        for (int i = 0; i < n; i++) {
+            b[i] += weight * want * basis[i];
+            for (int j = 0; j < n; j++) a[i][j] += weight * basis[i] * basis[j];
+        }
+    }
+    std::vector<double> c = solve(a, b);
+    // Ganho exato 1 em DC
+    double dc = c[0];
+    for (int k = 1; k < n; k++) dc += 2 * c[k];
+    std::vector<double> h(r.taps);
+    for (int k = 0; k < n; k++) h[half - k] = h[half + k] = c[k] / dc;
+    return h;
+}
+
+}  // namespace
+
+int main() {
+    std::printf("// Gerado por tools/gen_decim.cpp; não edite à mão.\n");
+    std::printf("#ifndef DECIM_COEFFS_H\n#define DECIM_COEFFS_H\n\n");
+    std::printf("#include <stdint.h>\n\n");
+    std::printf("#define DECIM_CIC_STAGES %d\n", kStages);
+    std::printf("#define DECIM_OUT_FRAC_BITS %d\n", kOutFrac);
+    std::printf("#define DECIM_ACC_SHIFT %d\n", kShift);
+    int max_taps = 0;
+    for (const Ratio &r : kRatios) max_taps = std::max(max_taps, r.taps);
+    std::printf("#define DECIM_MAX_TAPS %d\n\n", max_taps);
+
+    // Coeficiente inteiro = h * 2^(OUT_FRAC + SHIFT) / Rc^N: a saída do CIC
+    // multiplicada por ele e deslocada de SHIFT sai em contagens Q8
+    for (const Ratio &r : kRatios) {
+        std::vector<double> h = design(r);
+        double gain = std::pow(r.cic, kStages);
+        double scale = std::ldexp(1.0, kOutFrac + kShift) / gain;
+        std::printf("// R = %d: CIC /%d, FIR /%d com %d taps (passa até %.2f, corta de %.2f\n"
+                    "// ciclos/amostra na entrada do FIR)\n",
+                    r.ratio, r.cic, r.fir, r.taps, r.pass, r.stop);
+        std::printf("static const int32_t decim_fir_%d[%d] = {", r.ratio, r.taps);
+        for (int i = 0; i < r.taps; i++)
+            std::printf("%s%ld,", i % 6 ? " " : "\n    ", std::lround(h[i] * scale));
+        std::printf("\n};\n\n");
+    }
+
+    std::printf("typedef struct {\n"
+                "    uint8_t ratio;      // Decimação total\n"
+                "    uint8_t cic_ratio;  // Decimação do CIC\n"
+                "    uint8_t fir_ratio;  // Decimação do FIR (polifásico)\n"
+                "    uint8_t taps;\n"
+                "    const int32_t *coef;\n"
+                "} decim_config_t;\n\n");
+    std::printf("static const decim_config_t decim_configs[] = {\n");
+    for (const Ratio &r : kRatios)
+        std::printf("    {%d, %d, %d, %d, decim_fir_%d},\n", r.ratio, r.cic, r.fir, r.taps,
+                    r.ratio);
+    std::printf("};\n\n#endif // DECIM_COEFFS_H\n");
+    return 0;
+}
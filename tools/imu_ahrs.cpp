@@ -0,0 +1,267 @@
+// imu_ahrs: reprocessa um CSV gravado pelo datalogger com o mesmo estimador
+// de orientação do firmware (lib/ahrs.c, em inteiros) e com uma versão em
+// double do mesmo filtro de Mahony, e mostra o quanto os dois divergem.
+//
+//   imu_ahrs [-r taxa_hz] [-a lsb_por_g] [-g lsb_por_dps] [-p kp] [-i ki]
+//            [-o saída.csv] <log.csv>
+//
+// As colunas de aceleração (g) e giroscópio (graus/s) voltam a contagens
+// com as sensibilidades dadas (padrão: ±2 g e ±250 graus/s, as da captura).
+// A taxa padrão é a mediana dos intervalos da coluna de tempo. Se o CSV já
+// tiver as colunas q0..q3 gravadas pelo dispositivo ("ahrs on" sem
+// decimação), a reprodução também é comparada a elas e deve coincidir até a
+// resolução do CSV. Com -o grava, por linha, os ângulos das duas versões.
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+extern "C" {
+#include "ahrs.h"
+}
+
+namespace {
+
+struct Row {
+    double t;
+    double accel[3], gyro[3];
+    double q[4];  // Do dispositivo, se houver
+};
+
+// Mahony em double, mesmo algoritmo e mesmas constantes de lib/ahrs.c
+struct Reference {
+    double q[4] = {1, 0, 0, 0};
+    double integ[3] = {0, 0, 0};
+    double dt, kp, ki;
+    bool started = false;
+
+    void update(const int16_t a[3], const int16_t g[3], double gyro_lsb) {
+        double n = std::sqrt((double)a[0] * a[0] + (double)a[1] * a[1] + (double)a[2] * a[2]);
+        if (!started && n > 0) {
+            double roll = std::atan2(a[1], a[2]);
+            double pitch = std::atan2(-a[0], std::sqrt((double)a[1] * a[1] + (double)a[2] * a[2]));
+            double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+            double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+            q[0] = cr * cp, q[1] = sr * cp, q[2] = cr * sp, q[3] = -sr * sp;
+            started = true;
+        }
+        double th[3];
+        for (int i = 0; i < 3; i++) th[i] = 0.5 * dt * g[i] / gyro_lsb * M_PI / 180.0;
+        if (n > 0) {
+            double u[3] = {a[0] / n, a[1] / n, a[2] / n};
+            double v[3] = {2 * (q[1] * q[3] - q[0] * q[2]), 2 * (q[0] * q[1] + q[2] * q[3]),
+                           q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]};
+            double e[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2],
+                           u[0] * v[1] - u[1] * v[0]};
+            const double lim = 0.5 * dt * 20.0 * M_PI / 180.0;
+            for (int i = 0; i < 3; i++) {
+                if (ki > 0) integ[i] = std::clamp(integ[i] + 0.5 * ki * dt * dt * e[i], -lim, lim);
+                th[i] += 0.5 * kp * dt * e[i] + integ[i];
+            }
+        }
+        double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+        q[0] -= q1 * th[0] + q2 * th[1] + q3 * th[2];
+        q[1] += q0 * th[0] + q2 * th[2] - q3 * th[1];
+        q[2] += q0 * th[1] - q1 * th[2] + q3 * th[0];
+        q[3] += q0 * th[2] + q1 * th[1] - q2 * th[0];
+        double norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (double &c : q) c /= norm;
+    }
+};
+
+// Ângulo da rotação entre dois quaternions, em graus: 2 atan2(|v|, |w|) do
+// quaternion diferença conj(a) * b, estável para ângulos pequenos
+double angle_between(const double a[4], const double b[4]) {
+    double w = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    double x = a[0] * b[1] - a[1] * b[0] - a[2] * b[3] + a[3] * b[2];
+    double y = a[0] * b[2] + a[1] * b[3] - a[2] * b[0] - a[3] * b[1];
+    double z = a[0] * b[3] - a[1] * b[2] + a[2] * b[1] - a[3] * b[0];
+    return 2 * std::atan2(std::sqrt(x * x + y * y + z * z), std::fabs(w)) * 180.0 / M_PI;
+}
+
+void euler(const double q[4], double out[3]) {
+    double sp = std::clamp(2 * (q[0] * q[2] - q[3] * q[1]), -1.0, 1.0);
+    out[0] = std::atan2(2 * (q[0] * q[1] + q[2] * q[3]), 1 - 2 * (q[1] * q[1] + q[2] * q[2]));
+    out[1] = std::asin(sp);
+    out[2] = std::atan2(2 * (q[0] * q[3] + q[1] * q[2]), 1 - 2 * (q[2] * q[2] + q[3] * q[3]));
+    for (int i = 0; i < 3; i++) out[i] *= 180.0 / M_PI;
+}
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n"), e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+std::vector<std::string> split(const std::string &line) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    for (;;) {
+        size_t comma = line.find(',', start);
+        out.push_back(trim(line.substr(start, comma - start)));
+        if (comma == std::string::npos) return out;
+        start = comma + 1;
+    }
+}
+
+// Lê as linhas de amostras; as colunas são achadas pelo nome no cabeçalho
+bool read_log(FILE *in, std::vector<Row> &rows, bool &has_q) {
+    static const char *const kCols[] = {"Tempo (s)", "Aceleração X", "Aceleração Y",
+                                        "Aceleração Z", "Giroscópio X", "Giroscópio Y",
+                                        "Giroscópio Z", "q0", "q1", "q2", "q3"};
+    int idx[11];
+    std::fill(idx, idx + 11, -1);
+    bool header = false;
+    char buf[1024];
+    while (fgets(buf, sizeof buf, in)) {
+        std::string line(buf);
+        if (trim(line).empty() || line[0] == '#') continue;
+        std::vector<std::string> f = split(line);
+        if (!header) {
+            for (size_t c = 0; c < f.size(); c++)
+                for (int k = 0; k < 11; k++)
+                    if (f[c] == kCols[k]) idx[k] = (int)c;
+            for (int k = 0; k < 7; k++) {
+                if (idx[k] < 0) {
+                    fprintf(stderr, "imu_ahrs: coluna \"%s\" não encontrada\n", kCols[k]);
+                    return false;
+                }
+            }
+            has_q = idx[7] >= 0 && idx[8] >= 0 && idx[9] >= 0 && idx[10] >= 0;
+            header = true;
+            continue;
+        }
+        Row r{};
+        auto get = [&](int k) { return idx[k] < (int)f.size() ? atof(f[idx[k]].c_str()) : 0.0; };
+        r.t = get(0);
+        for (int i = 0; i < 3; i++) {
+            r.accel[i] = get(1 + i);
+            r.gyro[i] = get(4 + i);
+        }
+        if (has_q)
+            for (int i = 0; i < 4; i++) r.q[i] = get(7 + i);
+        rows.push_back(r);
+    }
+    return header;
+}
+
+int16_t to_counts(double v, double lsb) {
+    return (int16_t)std::clamp(std::lround(v * lsb), -32768L, 32767L);
+}
+
+void usage() {
+    fprintf(stderr, "uso: imu_ahrs [-r taxa_hz] [-a lsb_por_g] [-g lsb_por_dps] [-p kp] [-i ki]\n"
+                    "                [-o saída.csv] <log.csv | ->\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    double rate = 0, accel_lsb = 16384.0, gyro_lsb = 131.0, kp = 1.0, ki = 0.02;
+    const char *out_path = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:a:g:p:i:o:")) != -1) {
+        switch (opt) {
+            case 'r': rate = atof(optarg); break;
+            case 'a': accel_lsb = atof(optarg); break;
+            case 'g': gyro_lsb = atof(optarg); break;
+            case 'p': kp = atof(optarg); break;
+            case 'i': ki = atof(optarg); break;
+            case 'o': out_path = optarg; break;
+            default: usage(); return 2;
+        }
+    }
+    if (argc - optind != 1) {
+        usage();
+        return 2;
+    }
+    const char *in_path = argv[optind];
+    FILE *in = strcmp(in_path, "-") ? fopen(in_path, "r") : stdin;
+    if (!in) {
+        fprintf(stderr, "imu_ahrs: %s: %s\n", in_path, strerror(errno));
+        return 1;
+    }
+    std::vector<Row> rows;
+    bool has_q = false;
+    bool ok = read_log(in, rows, has_q);
+    if (in != stdin)
+        fclose(in);
+    if (!ok || rows.size() < 2) {
+        fprintf(stderr, "imu_ahrs: %s: sem amostras\n", in_path);
+        return 1;
+    }
+
+    if (rate <= 0) {
+        std::vector<double> dts;
+        for (size_t i = 1; i < rows.size(); i++) dts.push_back(rows[i].t - rows[i - 1].t);
+        std::nth_element(dts.begin(), dts.begin() + dts.size() / 2, dts.end());
+        double dt = dts[dts.size() / 2];
+        if (dt <= 0) {
+            fprintf(stderr, "imu_ahrs: coluna de tempo inválida; use -r\n");
+            return 1;
+        }
+        rate = 1.0 / dt;
+    }
+
+    FILE *out = nullptr;
+    if (out_path) {
+        out = fopen(out_path, "w");
+        if (!out) {
+            fprintf(stderr, "imu_ahrs: %s: %s\n", out_path, strerror(errno));
+            return 1;
+        }
+        fprintf(out, "Tempo (s), Rolagem, Arfagem, Guinada, Rolagem ref, Arfagem ref, "
+                     "Guinada ref, Erro (graus)\n");
+    }
+
+    ahrs_t fixed;
+    ahrs_init(&fixed, (float)rate, (float)gyro_lsb, (float)kp, (float)ki);
+    Reference ref;
+    ref.dt = 1.0 / rate, ref.kp = kp, ref.ki = ki;
+
+    double err_max = 0, err_sum2 = 0, dev_max = 0, euler_max[3] = {0, 0, 0};
+    for (const Row &r : rows) {
+        int16_t a[3], g[3];
+        for (int i = 0; i < 3; i++) {
+            a[i] = to_counts(r.accel[i], accel_lsb);
+            g[i] = to_counts(r.gyro[i], gyro_lsb);
+        }
+        ahrs_update(&fixed, a, g);
+        ref.update(a, g, gyro_lsb);
+
+        double qf[4], ef[3], er[3];
+        for (int i = 0; i < 4; i++) qf[i] = std::ldexp((double)fixed.q[i], -30);
+        double err = angle_between(qf, ref.q);
+        err_max = std::max(err_max, err);
+        err_sum2 += err * err;
+        euler(qf, ef);
+        euler(ref.q, er);
+        for (int i = 0; i < 3; i++) {
+            double d = std::fabs(ef[i] - er[i]);
+            euler_max[i] = std::max(euler_max[i], std::min(d, 360.0 - d));
+        }
+        if (has_q)
+            dev_max = std::max(dev_max, angle_between(qf, r.q));
+        if (out)
+            fprintf(out, "%.6f, %.4f, %.4f, %.4f, %.4f, %.4f, %.4f, %.6f\n", r.t, ef[0], ef[1],
+                    ef[2], er[0], er[1], er[2], err);
+    }
+    if (out)
+        fclose(out);
+
+    printf("%zu amostras a %.1f Hz, kp %.3f, ki %.3f\n", rows.size(), rate, kp, ki);
+    printf("Inteiros x double: erro de orientação máx %.5f, RMS %.5f graus\n", err_max,
+           std::sqrt(err_sum2 / rows.size()));
+    printf("  máx por ângulo: rolagem %.5f, arfagem %.5f, guinada %.5f graus\n", euler_max[0],
+           euler_max[1], euler_max[2]);
+    if (has_q)
+        printf("Reprodução x dispositivo (q0..q3 do CSV): máx %.5f graus\n", dev_max);
+    return 0;
+}
@@ -0,0 +1,191 @@
+// imu_bin: converte os logs binários do datalogger ("logfmt bin",
+// lib/binlog.h) para CSV.
+//
+//   imu_bin [-t] [-r] [-o saída.csv] <log.imb | ->
+//
+// Gera o CSV no formato da captura (g, graus/s e tempo em segundos), com as
+// sensibilidades gravadas em cada página. Com -t acrescenta a temperatura
+// do sensor, que também vem na leitura. Páginas com assinatura inválida
+// encerram o arquivo (sobra da pré-alocação); saltos na sequência são
+// avisados.
+//
+// Logs com vários sensores (lib/imu_array.h) viram uma linha por tick, com
+// o tempo logo depois da amostra e as colunas de cada sensor (S0, S1...)
+// já sem o bias da calibração, a menos que se use -r. A coluna "Nova" é 0
+// quando o sensor não tinha amostra nova no tick; leituras com erro saem
+// vazias.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+extern "C" {
+#include "binlog.h"
+}
+
+namespace {
+
+int16_t be16(const uint8_t *p) { return (int16_t)((p[0] << 8) | p[1]); }
+
+void usage() { fprintf(stderr, "uso: imu_bin [-t] [-r] [-o saída.csv] <log.imb | ->\n"); }
+
+struct ChannelTotals {
+    binlog_channel_t desc;
+    long stale = 0, errors = 0;
+};
+
+void print_multi_header(FILE *out, unsigned n_ch, bool temperature) {
+    static const char *const axes[] = {"Aceleração X", "Aceleração Y", "Aceleração Z",
+                                       "Giroscópio X", "Giroscópio Y", "Giroscópio Z"};
+    fprintf(out, "Amostra, Tempo (s)");
+    for (unsigned c = 0; c < n_ch; c++) {
+        for (const char *axis : axes)
+            fprintf(out, ", S%u %s", c, axis);
+        if (temperature)
+            fprintf(out, ", S%u Temperatura (C)", c);
+        fprintf(out, ", S%u Nova", c);
+    }
+    fprintf(out, "\n");
+}
+
+// Um canal do registro: INT_STATUS e os 14 bytes do sensor
+void print_channel(FILE *out, const uint8_t *ch, const binlog_channel_t &desc, const binlog_page_header_t &h,
+                   bool temperature, bool raw, ChannelTotals &tot) {
+    if (ch[0] & BINLOG_STATUS_ERROR) {
+        tot.errors++;
+        fprintf(out, ",,,,,,%s,", temperature ? "," : "");
+        return;
+    }
+    const uint8_t *b = ch + 1;
+    for (int i = 0; i < 3; i++)
+        fprintf(out, ",%f", (be16(b + 2 * i) - (raw ? 0 : desc.accel_bias[i])) / h.accel_lsb);
+    for (int i = 0; i < 3; i++)
+        fprintf(out, ",%f", (be16(b + 8 + 2 * i) - (raw ? 0 : desc.gyro_bias[i])) / h.gyro_lsb);
+    if (temperature)
+        fprintf(out, ",%.2f", be16(b + 6) / 340.0 + 36.53);
+    bool fresh = ch[0] & BINLOG_STATUS_DATA_RDY;
+    if (!fresh)
+        tot.stale++;
+    fprintf(out, ",%d", fresh ? 1 : 0);
+}
+
+int convert(const char *in_path, const char *out_path, bool temperature, bool raw) {
+    FILE *in = strcmp(in_path, "-") ? fopen(in_path, "rb") : stdin;
+    if (!in) {
+        fprintf(stderr, "imu_bin: %s: %s\n", in_path, strerror(errno));
+        return 1;
+    }
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "imu_bin: %s: %s\n", out_path, strerror(errno));
+        if (in != stdin) fclose(in);
+        return 1;
+    }
+    std::vector<uint8_t> page(BINLOG_PAGE_SIZE);
+    std::vector<ChannelTotals> totals;
+    uint32_t expected_seq = 0, pages = 0;
+    unsigned n_ch = 0;  // Do primeiro cabeçalho válido
+    long n = 0;
+    while (fread(page.data(), 1, page.size(), in) == page.size()) {
+        binlog_page_header_t h;
+        memcpy(&h, page.data(), sizeof h);
+        if (memcmp(h.magic, BINLOG_MAGIC, 4) != 0)
+            break;
+        unsigned page_ch = h.n_channels > 1 ? h.n_channels : 1;
+        if (page_ch > BINLOG_MAX_CHANNELS || h.record_size != binlog_record_size(page_ch) ||
+            h.n_records > binlog_records_per_page(page_ch) || (n_ch && page_ch != n_ch)) {
+            fprintf(stderr, "imu_bin: página %u: cabeçalho inválido, pulada\n", (unsigned)h.seq);
+            continue;
+        }
+        if (!n_ch) {
+            n_ch = page_ch;
+            totals.resize(n_ch);
+            if (n_ch > 1)
+                print_multi_header(out, n_ch, temperature);
+            else
+                fprintf(out, "Amostra, Aceleração X, Aceleração Y, Aceleração Z, Giroscópio X, "
+                             "Giroscópio Y, Giroscópio Z, Tempo (s)%s\n",
+                        temperature ? ", Temperatura (C)" : "");
+        }
+        if (n_ch > 1) {
+            for (unsigned c = 0; c < n_ch; c++)
+                memcpy(&totals[c].desc, page.data() + sizeof h + c * sizeof(binlog_channel_t),
+                       sizeof(binlog_channel_t));
+        }
+        if (h.seq != expected_seq)
+            fprintf(stderr, "imu_bin: páginas %u a %u ausentes\n", (unsigned)expected_seq,
+                    (unsigned)h.seq - 1);
+        expected_seq = h.seq + 1;
+        pages++;
+        for (unsigned r = 0; r < h.n_records; r++) {
+            const uint8_t *rec = page.data() + binlog_records_offset(n_ch) + r * h.record_size;
+            uint32_t lo = rec[0] | rec[1] << 8 | rec[2] << 16 | (uint32_t)rec[3] << 24;
+            // Os registros seguem o primeiro: a diferença de 32 bits basta
+            uint64_t t_us = h.t0_us + (uint32_t)(lo - (uint32_t)h.t0_us);
+            const uint8_t *b = rec + 4;
+            if (n_ch > 1) {
+                fprintf(out, "%ld,%llu.%06llu", ++n, (unsigned long long)(t_us / 1000000),
+                        (unsigned long long)(t_us % 1000000));
+                for (unsigned c = 0; c < n_ch; c++)
+                    print_channel(out, b + c * BINLOG_CHANNEL_LEN, totals[c].desc, h, temperature, raw,
+                                  totals[c]);
+                fprintf(out, "\n");
+                continue;
+            }
+            fprintf(out, "%ld", ++n);
+            for (int i = 0; i < 3; i++)
+                fprintf(out, ",%f", be16(b + 2 * i) / h.accel_lsb);
+            for (int i = 0; i < 3; i++)
+                fprintf(out, ",%f", be16(b + 8 + 2 * i) / h.gyro_lsb);
+            fprintf(out, ",%llu.%06llu", (unsigned long long)(t_us / 1000000),
+                    (unsigned long long)(t_us % 1000000));
+            if (temperature)
+                fprintf(out, ",%.2f", be16(b + 6) / 340.0 + 36.53);
+            fprintf(out, "\n");
+        }
+    }
+    if (in != stdin)
+        fclose(in);
+    if (out != stdout)
+        fclose(out);
+    if (!pages) {
+        fprintf(stderr, "imu_bin: %s: nenhuma página válida\n", in_path);
+        return 1;
+    }
+    fprintf(stderr, "imu_bin: %ld leituras em %u páginas\n", n, (unsigned)pages);
+    for (unsigned c = 0; n_ch > 1 && c < n_ch; c++) {
+        const ChannelTotals &t = totals[c];
+        char where[16] = "direto";
+        if (t.desc.mux_channel != BINLOG_NO_MUX)
+            snprintf(where, sizeof where, "canal %u", t.desc.mux_channel);
+        fprintf(stderr, "imu_bin: S%u i2c%u 0x%02x %s: atraso %u us, %ld sem amostra nova, %ld com erro\n", c,
+                t.desc.bus, t.desc.addr, where, t.desc.read_offset_us, t.stale, t.errors);
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    bool temperature = false, raw = false;
+    const char *out_path = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "tro:")) != -1) {
+        switch (opt) {
+            case 't': temperature = true; break;
+            case 'r': raw = true; break;
+            case 'o': out_path = optarg; break;
+            default: usage(); return 2;
+        }
+    }
+    if (argc - optind != 1) {
+        usage();
+        return 2;
+    }
+    return convert(argv[optind], out_path, temperature, raw);
+}
@@ -0,0 +1,254 @@
+// imu_get: baixa um arquivo do cartão SD pela porta serial USB do datalogger
+// usando o comando "get" (protocolo em lib/bulk_xfer.h).
+//
+//   imu_get [-o saída] [-c] [-t timeout_ms] <porta> <arquivo>
+//
+// Quadros com CRC errado ou fora de ordem são descartados; quando o envio
+// termina (ou trava) antes do fim, o download é retomado com
+// "get <arquivo> <offset>" a partir do último byte confirmado. Com -c, um
+// download interrompido continua do tamanho atual do arquivo de saída.
+// Funciona com qualquer tty, inclusive um pseudo-terminal de testes.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// Precisam ser iguais aos de lib/bulk_xfer.h
+constexpr uint32_t kMagic = 0x42554D49u;  // "IMUB"
+constexpr size_t kHdrSize = 20;
+constexpr uint32_t kMaxPayload = 4096;
+enum FrameType : uint8_t { kInfo = 1, kData = 2, kEnd = 3, kError = 4 };
+
+constexpr int kMaxRetries = 10;
+
+uint32_t crc32(uint32_t crc, const uint8_t *p, size_t len) {
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while (len--)
+        crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint64_t get_le(const uint8_t *p, int n) {
+    uint64_t v = 0;
+    for (int i = n - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+struct Frame {
+    uint8_t type;
+    uint64_t offset;
+    std::vector<uint8_t> data;
+};
+
+class Link {
+public:
+    explicit Link(int fd) : fd_(fd) {}
+
+    bool send(const std::string &s) {
+        size_t done = 0;
+        while (done < s.size()) {
+            ssize_t n = write(fd_, s.data() + done, s.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += n;
+        }
+        return true;
+    }
+
+    // Descarta o que já chegou (eco, prompt, restos de um envio anterior)
+    void flush_input() {
+        tcflush(fd_, TCIFLUSH);
+        buf_.clear();
+    }
+
+    // Lê o próximo quadro íntegro. Retorna false se nada chegar em timeout_ms.
+    // Bytes que não formam um quadro válido (texto do console, quadros
+    // corrompidos) são pulados procurando o próximo magic.
+    bool next_frame(Frame &f, int timeout_ms, unsigned &bad_frames) {
+        for (;;) {
+            size_t i = 0;
+            while (i + 4 <= buf_.size() && get_le(&buf_[i], 4) != kMagic)
+                i++;
+            buf_.erase(buf_.begin(), buf_.begin() + i);
+
+            if (buf_.size() >= kHdrSize) {
+                uint32_t len = (uint32_t)get_le(&buf_[16], 4);
+                if (len > kMaxPayload) {
+                    buf_.erase(buf_.begin());  // Falso magic
+                    continue;
+                }
+                size_t total = kHdrSize + len + 4;
+                if (buf_.size() >= total) {
+                    uint32_t crc = crc32(0, buf_.data(), kHdrSize + len);
+                    if (crc != get_le(&buf_[kHdrSize + len], 4)) {
+                        bad_frames++;
+                        buf_.erase(buf_.begin());
+                        continue;
+                    }
+                    f.type = buf_[4];
+                    f.offset = get_le(&buf_[8], 8);
+                    f.data.assign(buf_.begin() + kHdrSize, buf_.begin() + kHdrSize + len);
+                    buf_.erase(buf_.begin(), buf_.begin() + total);
+                    return true;
+                }
+            }
+            if (!fill(timeout_ms))
+                return false;
+        }
+    }
+
+private:
+    bool fill(int timeout_ms) {
+        pollfd p = {fd_, POLLIN, 0};
+        int r = poll(&p, 1, timeout_ms);
+        if (r <= 0)
+            return false;
+        uint8_t tmp[16384];
+        ssize_t n = read(fd_, tmp, sizeof tmp);
+        if (n <= 0)
+            return false;
+        buf_.insert(buf_.end(), tmp, tmp + n);
+        return true;
+    }
+
+    int fd_;
+    std::vector<uint8_t> buf_;
+};
+
+int open_port(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+        return -1;
+    termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+void usage() {
+    fprintf(stderr, "uso: imu_get [-o saída] [-c] [-t timeout_ms] <porta> <arquivo>\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::string out_path;
+    bool resume = false;
+    int timeout_ms = 2000;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:ct:")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            case 'c': resume = true; break;
+            case 't': timeout_ms = atoi(optarg); break;
+            default: usage(); return 2;
+        }
+    }
+    if (argc - optind != 2) {
+        usage();
+        return 2;
+    }
+    const char *port = argv[optind];
+    std::string file = argv[optind + 1];
+    if (out_path.empty()) {
+        size_t slash = file.find_last_of("/:");
+        out_path = slash == std::string::npos ? file : file.substr(slash + 1);
+    }
+
+    int fd = open_port(port);
+    if (fd < 0) {
+        fprintf(stderr, "imu_get: %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+    FILE *out = fopen(out_path.c_str(), resume ? "ab" : "wb");
+    if (!out) {
+        fprintf(stderr, "imu_get: %s: %s\n", out_path.c_str(), strerror(errno));
+        return 1;
+    }
+    fseek(out, 0, SEEK_END);
+    uint64_t next = resume ? (uint64_t)ftell(out) : 0;
+
+    Link link(fd);
+    uint64_t end = UINT64_MAX;
+    unsigned bad_frames = 0, restarts = 0;
+    int retries = 0;
+    bool done = false;
+    while (!done) {
+        if (retries > kMaxRetries) {
+            fprintf(stderr, "\nimu_get: desistindo em %llu após %d tentativas\n",
+                    (unsigned long long)next, kMaxRetries);
+            break;
+        }
+        uint64_t start = next;
+        link.flush_input();
+        link.send("get " + file + " " + std::to_string(next) + "\r");
+
+        Frame f;
+        bool ended = false;
+        while (!ended && link.next_frame(f, timeout_ms, bad_frames)) {
+            switch (f.type) {
+                case kInfo:
+                    if (f.data.size() >= 16)
+                        end = get_le(&f.data[0], 8);
+                    break;
+                case kData:
+                    // Quadros depois de um perdido ficam de fora; são pedidos de novo
+                    if (f.offset == next && next < end) {
+                        if (fwrite(f.data.data(), 1, f.data.size(), out) != f.data.size()) {
+                            fprintf(stderr, "\nimu_get: %s: %s\n", out_path.c_str(), strerror(errno));
+                            return 1;
+                        }
+                        next += f.data.size();
+                        fprintf(stderr, "\r%llu / %llu bytes", (unsigned long long)next,
+                                (unsigned long long)end);
+                    }
+                    break;
+                case kEnd:
+                    ended = true;
+                    break;
+                case kError:
+                    fprintf(stderr, "\nimu_get: erro no dispositivo: %.*s\n",
+                            (int)f.data.size(), (const char *)f.data.data());
+                    fclose(out);
+                    return 1;
+            }
+        }
+        if (next >= end) {
+            done = true;
+        } else {
+            restarts++;
+            retries = next > start ? 0 : retries + 1;
+        }
+    }
+    fclose(out);
+    fprintf(stderr, "\n%s: %llu bytes, %u quadro(s) com CRC inválido, %u retomada(s)\n",
+            out_path.c_str(), (unsigned long long)next, bad_frames, restarts);
+    return done ? 0 : 1;
+}
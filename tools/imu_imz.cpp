@@ -0,0 +1,322 @@
+// imu_imz: decodifica os logs comprimidos do datalogger ("logfmt imz",
+// lib/imz.h) e mede a compressão em logs gravados.
+//
+//   imu_imz [-o saída.csv] <log.imz>
+//   imu_imz -b [-a lsb_por_g] [-g lsb_por_dps] [-q bits_frac] <log.csv|log.imz>...
+//
+// No primeiro modo gera o CSV no formato da captura (g, graus/s e tempo em
+// segundos). Cada bloco de 4 KiB é independente: um bloco corrompido é
+// avisado e pulado, e o resto do arquivo continua sendo lido.
+//
+// Com -b, cada log é passado pelo mesmo codificador do firmware (compilado
+// de lib/imz.c), decodificado de volta e comparado amostra a amostra; o
+// relatório mostra o tamanho em CSV, em binário cru (6 eixos e o tempo em
+// 64 bits) e comprimido, os bits por amostra e a taxa do codificador. Os
+// CSVs voltam a contagens com as sensibilidades dadas (padrão: ±2 g e ±250
+// graus/s); para logs decimados use -q 8, como grava o firmware.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+extern "C" {
+#include "imz.h"
+}
+
+namespace {
+
+struct Dataset {
+    std::vector<imz_sample_t> samples;
+    uint32_t period_us = 0;
+    float accel_lsb = 16384.0f, gyro_lsb = 131.0f;
+    uint8_t frac_bits = 0;
+    long file_bytes = 0;
+};
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n"), e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+std::vector<std::string> split(const std::string &line) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    for (;;) {
+        size_t comma = line.find(',', start);
+        out.push_back(trim(line.substr(start, comma - start)));
+        if (comma == std::string::npos) return out;
+        start = comma + 1;
+    }
+}
+
+bool ends_with(const std::string &s, const char *suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Lê um .imz bloco a bloco; blocos inválidos são avisados e pulados
+bool read_imz(const char *path, Dataset &d, bool verbose) {
+    FILE *in = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+    if (!in) {
+        fprintf(stderr, "imu_imz: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    std::vector<uint8_t> block(IMZ_BLOCK_SIZE);
+    std::vector<imz_sample_t> out(IMZ_MAX_SAMPLES);
+    bool have_header = false;
+    uint32_t expected_seq = 0, bad = 0;
+    size_t got;
+    while ((got = fread(block.data(), 1, block.size(), in)) > 0) {
+        d.file_bytes += (long)got;
+        imz_block_header_t h;
+        int n = imz_decode_block(block.data(), got, &h, out.data(), out.size());
+        if (n < 0) {
+            static const char *const kErr[] = {"", "assinatura", "CRC", "formato"};
+            fprintf(stderr, "imu_imz: %s: bloco no byte %ld inválido (%s)\n", path,
+                    d.file_bytes - (long)got, kErr[-n]);
+            bad++;
+            expected_seq++;
+            continue;
+        }
+        if (verbose && h.seq != expected_seq)
+            fprintf(stderr, "imu_imz: %s: esperava o bloco %u, veio o %u\n", path, expected_seq,
+                    h.seq);
+        expected_seq = h.seq + 1;
+        if (!have_header) {
+            d.period_us = h.period_us;
+            d.accel_lsb = h.accel_lsb;
+            d.gyro_lsb = h.gyro_lsb;
+            d.frac_bits = h.frac_bits;
+            have_header = true;
+        }
+        d.samples.insert(d.samples.end(), out.begin(), out.begin() + n);
+    }
+    if (in != stdin)
+        fclose(in);
+    if (bad)
+        fprintf(stderr, "imu_imz: %s: %u blocos perdidos\n", path, bad);
+    return have_header;
+}
+
+// Lê as amostras de um CSV da captura; as colunas são achadas pelo nome
+bool read_csv(const char *path, Dataset &d) {
+    static const char *const kCols[] = {"Aceleração X", "Aceleração Y", "Aceleração Z",
+                                        "Giroscópio X", "Giroscópio Y", "Giroscópio Z",
+                                        "Tempo (s)"};
+    FILE *in = strcmp(path, "-") ? fopen(path, "r") : stdin;
+    if (!in) {
+        fprintf(stderr, "imu_imz: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    int idx[7];
+    std::fill(idx, idx + 7, -1);
+    bool header = false;
+    const double q = std::ldexp(1.0, d.frac_bits);
+    char buf[1024];
+    while (fgets(buf, sizeof buf, in)) {
+        d.file_bytes += (long)strlen(buf);
+        std::string line(buf);
+        if (trim(line).empty() || line[0] == '#') continue;
+        std::vector<std::string> f = split(line);
+        if (!header) {
+            for (size_t c = 0; c < f.size(); c++)
+                for (int k = 0; k < 7; k++)
+                    if (f[c] == kCols[k]) idx[k] = (int)c;
+            for (int k = 0; k < 7; k++) {
+                if (idx[k] < 0) {
+                    fprintf(stderr, "imu_imz: %s: coluna \"%s\" não encontrada\n", path,
+                            kCols[k]);
+                    if (in != stdin)
+                        fclose(in);
+                    return false;
+                }
+            }
+            header = true;
+            continue;
+        }
+        auto get = [&](int k) { return idx[k] < (int)f.size() ? atof(f[idx[k]].c_str()) : 0.0; };
+        imz_sample_t s;
+        for (int i = 0; i < IMZ_AXES; i++)
+            s.v[i] = (int32_t)std::lround(get(i) * (i < 3 ? d.accel_lsb : d.gyro_lsb) * q);
+        s.t_us = (uint64_t)std::llround(get(6) * 1e6);
+        d.samples.push_back(s);
+    }
+    if (in != stdin)
+        fclose(in);
+    if (d.samples.size() > 1) {
+        std::vector<int64_t> dts;
+        for (size_t i = 1; i < d.samples.size(); i++)
+            dts.push_back((int64_t)(d.samples[i].t_us - d.samples[i - 1].t_us));
+        std::nth_element(dts.begin(), dts.begin() + dts.size() / 2, dts.end());
+        d.period_us = (uint32_t)std::max<int64_t>(dts[dts.size() / 2], 0);
+    }
+    return header;
+}
+
+int decode(const char *in_path, const char *out_path) {
+    Dataset d;
+    if (!read_imz(in_path, d, true)) {
+        fprintf(stderr, "imu_imz: %s: nenhum bloco válido\n", in_path);
+        return 1;
+    }
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "imu_imz: %s: %s\n", out_path, strerror(errno));
+        return 1;
+    }
+    const double q = std::ldexp(1.0, d.frac_bits);
+    fprintf(out, "Amostra, Aceleração X, Aceleração Y, Aceleração Z, Giroscópio X, "
+                 "Giroscópio Y, Giroscópio Z, Tempo (s)\n");
+    int n = 0;
+    for (const imz_sample_t &s : d.samples) {
+        fprintf(out, "%d", ++n);
+        for (int i = 0; i < IMZ_AXES; i++)
+            fprintf(out, ",%f", s.v[i] / q / (i < 3 ? d.accel_lsb : d.gyro_lsb));
+        fprintf(out, ",%llu.%06llu\n", (unsigned long long)(s.t_us / 1000000),
+                (unsigned long long)(s.t_us % 1000000));
+    }
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
+
+struct BenchTotals {
+    size_t samples = 0;
+    long csv = 0, raw = 0, imz = 0;
+    long csv_imz = 0;  // Comprimido dos que vieram de CSV
+};
+
+// Codifica, decodifica de volta e confere; retorna false se não bater
+bool bench(const char *path, const Dataset &d, BenchTotals &tot) {
+    imz_encoder_t *e = new imz_encoder_t;
+    imz_encoder_init(e, d.period_us, d.accel_lsb, d.gyro_lsb, d.frac_bits);
+    std::vector<uint8_t> stream;
+    auto append = [&](const uint8_t *b) {
+        if (b) stream.insert(stream.end(), b, b + IMZ_BLOCK_SIZE);
+    };
+    auto t0 = std::chrono::steady_clock::now();
+    for (const imz_sample_t &s : d.samples) append(imz_encoder_add(e, s.v, s.t_us));
+    append(imz_encoder_flush(e));
+    double enc_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    delete e;
+
+    std::vector<imz_sample_t> out(IMZ_MAX_SAMPLES);
+    size_t k = 0;
+    bool ok = true;
+    for (size_t off = 0; off < stream.size() && ok; off += IMZ_BLOCK_SIZE) {
+        int n = imz_decode_block(stream.data() + off, IMZ_BLOCK_SIZE, nullptr, out.data(),
+                                 out.size());
+        if (n < 0) {
+            fprintf(stderr, "imu_imz: %s: bloco %zu não decodifica (%d)\n", path,
+                    off / IMZ_BLOCK_SIZE, n);
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < n && ok; i++, k++) {
+            if (k >= d.samples.size() || d.samples[k].t_us != out[i].t_us ||
+                memcmp(d.samples[k].v, out[i].v, sizeof out[i].v) != 0) {
+                fprintf(stderr, "imu_imz: %s: amostra %zu difere\n", path, k + 1);
+                ok = false;
+            }
+        }
+    }
+    if (ok && k != d.samples.size()) {
+        fprintf(stderr, "imu_imz: %s: %zu de %zu amostras decodificadas\n", path, k,
+                d.samples.size());
+        ok = false;
+    }
+
+    // Binário cru: int16 por eixo (int32 com bits fracionários) e tempo em 64 bits
+    const long per_sample = (d.frac_bits ? 4 : 2) * IMZ_AXES + 8;
+    const long raw = (long)d.samples.size() * per_sample;
+    const long imz = (long)stream.size();
+    const bool from_csv = !ends_with(path, ".imz");
+    printf("%s: %zu amostras, %zu blocos, %s\n", path, d.samples.size(),
+           stream.size() / IMZ_BLOCK_SIZE, ok ? "sem perdas" : "FALHOU");
+    if (from_csv)
+        printf("  CSV %ld bytes, binário %ld, imz %ld: %.2fx o binário, %.2fx o CSV\n",
+               d.file_bytes, raw, imz, (double)raw / imz, (double)d.file_bytes / imz);
+    else
+        printf("  binário %ld, imz %ld: %.2fx o binário\n", raw, imz, (double)raw / imz);
+    printf("  %.1f bits/amostra (%.2f por canal), codificador %.1f Msamples/s no host\n",
+           8.0 * imz / d.samples.size(), 8.0 * imz / d.samples.size() / IMZ_CHANNELS,
+           d.samples.size() / enc_s / 1e6);
+    tot.samples += d.samples.size();
+    tot.csv += from_csv ? d.file_bytes : 0;
+    tot.csv_imz += from_csv ? imz : 0;
+    tot.raw += raw;
+    tot.imz += imz;
+    return ok;
+}
+
+void usage() {
+    fprintf(stderr, "uso: imu_imz [-o saída.csv] <log.imz | ->\n"
+                    "     imu_imz -b [-a lsb_por_g] [-g lsb_por_dps] [-q bits_frac] "
+                    "<log.csv|log.imz>...\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    bool bench_mode = false;
+    double accel_lsb = 16384.0, gyro_lsb = 131.0;
+    int frac_bits = 0;
+    const char *out_path = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "ba:g:q:o:")) != -1) {
+        switch (opt) {
+            case 'b': bench_mode = true; break;
+            case 'a': accel_lsb = atof(optarg); break;
+            case 'g': gyro_lsb = atof(optarg); break;
+            case 'q': frac_bits = std::clamp(atoi(optarg), 0, 16); break;
+            case 'o': out_path = optarg; break;
+            default: usage(); return 2;
+        }
+    }
+    if (!bench_mode) {
+        if (argc - optind != 1) {
+            usage();
+            return 2;
+        }
+        return decode(argv[optind], out_path);
+    }
+    if (argc == optind) {
+        usage();
+        return 2;
+    }
+
+    BenchTotals tot;
+    int files = 0, failed = 0;
+    for (int i = optind; i < argc; i++) {
+        Dataset d;
+        d.accel_lsb = (float)accel_lsb;
+        d.gyro_lsb = (float)gyro_lsb;
+        d.frac_bits = (uint8_t)frac_bits;
+        bool ok = ends_with(argv[i], ".imz") ? read_imz(argv[i], d, false) : read_csv(argv[i], d);
+        if (!ok || d.samples.empty()) {
+            fprintf(stderr, "imu_imz: %s: sem amostras\n", argv[i]);
+            failed++;
+            continue;
+        }
+        if (!bench(argv[i], d, tot))
+            failed++;
+        files++;
+    }
+    if (files > 1 && tot.imz > 0) {
+        printf("Total: %zu amostras, binário %ld, imz %ld: %.2fx o binário", tot.samples, tot.raw,
+               tot.imz, (double)tot.raw / tot.imz);
+        if (tot.csv)
+            printf(" (CSVs: %.2fx)", (double)tot.csv / tot.csv_imz);
+        printf("\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+// imu_stream: recebe a transmissão ao vivo do datalogger (comando "stream",
+// protocolo em lib/imu_stream.h) e grava as amostras em CSV.
+//
+//   imu_stream [-o saída.csv] [-r taxa_hz] [-d segundos] [-R] <porta>
+//
+// Sem -o, o CSV vai para a saída padrão. -R grava os valores brutos do
+// sensor em vez de g e °/s. A cada segundo, as perdas informadas pelo
+// dispositivo e as lacunas de sequência vistas aqui são mostradas em stderr.
+// Funciona com qualquer tty, inclusive um pseudo-terminal de testes.
+
+#include <csignal>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// Precisam ser iguais aos de lib/imu_stream.h
+enum FrameType : uint8_t { kInfo = 1, kSample = 2, kStats = 3 };
+constexpr size_t kInfoSize = 7, kSampleSize = 21, kStatsSize = 17;
+
+volatile sig_atomic_t stop_requested = 0;
+
+void on_signal(int) { stop_requested = 1; }
+
+// Decodifica um quadro COBS (sem o 0x00 final). Retorna false se malformado.
+bool cobs_decode(const std::vector<uint8_t> &in, std::vector<uint8_t> &out) {
+    out.clear();
+    size_t i = 0;
+    while (i < in.size()) {
+        uint8_t code = in[i++];
+        if (!code || i + code - 1 > in.size())
+            return false;
+        out.insert(out.end(), in.begin() + i, in.begin() + i + code - 1);
+        i += code - 1;
+        if (code != 0xFF && i < in.size())
+            out.push_back(0);
+    }
+    return true;
+}
+
+uint32_t get_le(const uint8_t *p, int n) {
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+int open_port(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+        return -1;
+    termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+void usage() {
+    fprintf(stderr, "uso: imu_stream [-o saída.csv] [-r taxa_hz] [-d segundos] [-R] <porta>\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const char *out_path = nullptr;
+    unsigned rate_hz = 1000;
+    double duration_s = 0;
+    bool raw = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:r:d:R")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            case 'r': rate_hz = (unsigned)atoi(optarg); break;
+            case 'd': duration_s = atof(optarg); break;
+            case 'R': raw = true; break;
+            default: usage(); return 2;
+        }
+    }
+    if (argc - optind != 1) {
+        usage();
+        return 2;
+    }
+    const char *port = argv[optind];
+
+    int fd = open_port(port);
+    if (fd < 0) {
+        fprintf(stderr, "imu_stream: %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "imu_stream: %s: %s\n", out_path, strerror(errno));
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    tcflush(fd, TCIFLUSH);
+    std::string cmd = "stream " + std::to_string(rate_hz) + "\r";
+    if (write(fd, cmd.data(), cmd.size()) != (ssize_t)cmd.size()) {
+        fprintf(stderr, "imu_stream: %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+
+    double accel_lsb = 16384.0, gyro_lsb = 131.0;
+    bool synced = false;  // O texto antes do primeiro 0x00 é eco do console
+    bool have_seq = false;
+    uint32_t expected_seq = 0;
+    uint64_t received = 0, gaps = 0, bad_frames = 0;
+    uint64_t sec_gaps = 0;
+    std::vector<uint8_t> enc, frame;
+    timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    fprintf(out, raw ? "seq,t_us,ax_raw,ay_raw,az_raw,gx_raw,gy_raw,gz_raw\n"
+                     : "seq,t_us,ax_g,ay_g,az_g,gx_dps,gy_dps,gz_dps\n");
+    while (!stop_requested) {
+        if (duration_s > 0) {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (now.tv_sec - t0.tv_sec + (now.tv_nsec - t0.tv_nsec) / 1e9 >= duration_s)
+                break;
+        }
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, 200) <= 0)
+            continue;
+        uint8_t tmp[4096];
+        ssize_t n = read(fd, tmp, sizeof tmp);
+        if (n <= 0)
+            break;
+        for (ssize_t i = 0; i < n; i++) {
+            if (tmp[i]) {
+                enc.push_back(tmp[i]);
+                continue;
+            }
+            if (!synced) {
+                synced = true;
+                enc.clear();
+                continue;
+            }
+            bool ok = cobs_decode(enc, frame);
+            enc.clear();
+            if (!ok || frame.empty()) {
+                bad_frames++;
+                continue;
+            }
+            const uint8_t *f = frame.data();
+            if (f[0] == kInfo && frame.size() == kInfoSize) {
+                fprintf(stderr, "imu_stream: %u Hz\n", get_le(f + 1, 2));
+                accel_lsb = get_le(f + 3, 2);
+                gyro_lsb = get_le(f + 5, 2) / 10.0;
+            } else if (f[0] == kSample && frame.size() == kSampleSize) {
+                uint32_t seq = get_le(f + 1, 4);
+                if (have_seq && seq != expected_seq) {
+                    gaps += seq - expected_seq;
+                    sec_gaps += seq - expected_seq;
+                }
+                have_seq = true;
+                expected_seq = seq + 1;
+                received++;
+                int16_t v[6];
+                for (int k = 0; k < 6; k++)
+                    v[k] = (int16_t)get_le(f + 9 + 2 * k, 2);
+                if (raw)
+                    fprintf(out, "%u,%u,%d,%d,%d,%d,%d,%d\n", seq, get_le(f + 5, 4),
+                            v[0], v[1], v[2], v[3], v[4], v[5]);
+                else
+                    fprintf(out, "%u,%u,%.5f,%.5f,%.5f,%.3f,%.3f,%.3f\n", seq, get_le(f + 5, 4),
+                            v[0] / accel_lsb, v[1] / accel_lsb, v[2] / accel_lsb,
+                            v[3] / gyro_lsb, v[4] / gyro_lsb, v[5] / gyro_lsb);
+            } else if (f[0] == kStats && frame.size() == kStatsSize) {
+                fprintf(stderr, "seq %u: enviadas %u, perdidas USB %u, atrasadas %u, lacunas aqui %llu\n",
+                        get_le(f + 1, 4), get_le(f + 5, 4), get_le(f + 9, 4), get_le(f + 13, 4),
+                        (unsigned long long)sec_gaps);
+                sec_gaps = 0;
+            } else {
+                bad_frames++;
+            }
+        }
+    }
+
+    // Enter encerra a transmissão no dispositivo
+    if (write(fd, "\r", 1) != 1)
+        fprintf(stderr, "imu_stream: %s: %s\n", port, strerror(errno));
+    if (out != stdout)
+        fclose(out);
+    fprintf(stderr, "imu_stream: %llu amostras, %llu perdidas na sequência, %llu quadros inválidos\n",
+            (unsigned long long)received, (unsigned long long)gaps, (unsigned long long)bad_frames);
+    return 0;
+}
@@ -0,0 +1,202 @@
+// imu_trace: converte o rastro de eventos do datalogger (lib/trace.h) para o
+// formato JSON de trace do Chrome, aberto em chrome://tracing ou
+// ui.perfetto.dev.
+//
+//   imu_trace [-o saída.json] <trace.bin | log.txt | ->
+//
+// A entrada pode ser o arquivo gravado com "trace save" ou um log do console
+// com a saída de "trace dump" (as linhas em hexadecimal entre
+// "--- trace begin ---" e "--- trace end ---"); "-" lê da entrada padrão.
+// Cada núcleo vira uma thread; os tempos são em µs desde o boot.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// Precisam ser iguais aos de lib/trace.h
+constexpr char kMagic[8] = {'I', 'M', 'U', 'T', 'R', 'A', 'C', 'E'};
+constexpr size_t kHeaderSize = 32;
+constexpr uint8_t kPhaseBegin = 0x40, kPhaseEnd = 0x80, kIdMask = 0x3F;
+
+struct Event {
+    uint64_t ts;
+    uint16_t arg;
+    uint8_t id;
+    uint8_t core;
+    size_t order;  // Desempate para eventos no mesmo µs
+};
+
+uint64_t get_le(const uint8_t *p, int n) {
+    uint64_t v = 0;
+    for (int i = n - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+bool read_all(FILE *f, std::vector<uint8_t> &data) {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    return !ferror(f);
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Extrai os bytes de um "trace dump" capturado do console
+bool decode_dump(const std::vector<uint8_t> &text, std::vector<uint8_t> &out) {
+    std::string s(text.begin(), text.end());
+    size_t begin = s.find("--- trace begin ---");
+    if (begin == std::string::npos)
+        return false;
+    size_t end = s.find("--- trace end ---", begin);
+    if (end == std::string::npos)
+        return false;
+    size_t i = s.find('\n', begin);
+    out.clear();
+    while (i < end) {
+        int hi = hex_value(s[i]);
+        if (hi < 0) {
+            i++;  // Quebras de linha e \r
+            continue;
+        }
+        int lo = i + 1 < end ? hex_value(s[i + 1]) : -1;
+        if (lo < 0)
+            return false;
+        out.push_back((uint8_t)(hi << 4 | lo));
+        i += 2;
+    }
+    return true;
+}
+
+std::string json_escape(const std::string &in) {
+    std::string out;
+    for (char c : in) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if ((unsigned char)c >= 0x20)
+            out += c;
+    }
+    return out;
+}
+
+void usage() {
+    fprintf(stderr, "uso: imu_trace [-o saída.json] <trace.bin | log.txt | ->\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const char *out_path = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            default: usage(); return 2;
+        }
+    }
+    if (argc - optind != 1) {
+        usage();
+        return 2;
+    }
+    const char *in_path = argv[optind];
+    FILE *in = strcmp(in_path, "-") ? fopen(in_path, "rb") : stdin;
+    if (!in) {
+        fprintf(stderr, "imu_trace: %s: %s\n", in_path, strerror(errno));
+        return 1;
+    }
+    std::vector<uint8_t> raw, data;
+    if (!read_all(in, raw)) {
+        fprintf(stderr, "imu_trace: %s: erro de leitura\n", in_path);
+        return 1;
+    }
+    if (in != stdin)
+        fclose(in);
+
+    if (raw.size() >= sizeof kMagic && !memcmp(raw.data(), kMagic, sizeof kMagic)) {
+        data.swap(raw);
+    } else if (!decode_dump(raw, data)) {
+        fprintf(stderr, "imu_trace: %s: nem arquivo de rastro nem \"trace dump\"\n", in_path);
+        return 1;
+    }
+    if (data.size() < kHeaderSize || memcmp(data.data(), kMagic, sizeof kMagic)) {
+        fprintf(stderr, "imu_trace: cabeçalho inválido\n");
+        return 1;
+    }
+
+    const uint8_t *h = data.data();
+    unsigned version = get_le(h + 8, 2), event_size = get_le(h + 10, 2);
+    unsigned n_names = get_le(h + 12, 2), name_len = get_le(h + 14, 2);
+    uint32_t n_events = get_le(h + 16, 4), overwritten = get_le(h + 20, 4);
+    uint64_t now_us = get_le(h + 24, 8);
+    if (version != 1 || event_size < 8) {
+        fprintf(stderr, "imu_trace: versão %u não suportada\n", version);
+        return 1;
+    }
+    size_t names_at = kHeaderSize, events_at = names_at + (size_t)n_names * name_len;
+    if (data.size() < events_at + (size_t)n_events * event_size) {
+        fprintf(stderr, "imu_trace: arquivo truncado\n");
+        return 1;
+    }
+    std::vector<std::string> names;
+    for (unsigned i = 0; i < n_names; i++) {
+        const char *p = (const char *)&data[names_at + (size_t)i * name_len];
+        names.emplace_back(p, strnlen(p, name_len));
+    }
+
+    // Os tempos são de 32 bits (voltam a zero a cada ~71 min): cada um é
+    // situado pela distância até o momento da gravação
+    std::vector<Event> events;
+    for (uint32_t i = 0; i < n_events; i++) {
+        const uint8_t *e = &data[events_at + (size_t)i * event_size];
+        uint32_t t = get_le(e, 4);
+        uint32_t age = (uint32_t)now_us - t;
+        events.push_back({now_us - age, (uint16_t)get_le(e + 4, 2), e[6], e[7], i});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+        return a.ts < b.ts;
+    });
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "imu_trace: %s: %s\n", out_path, strerror(errno));
+        return 1;
+    }
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(out, "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                 "\"args\": {\"name\": \"IMU Datalogger\"}}");
+    for (int core = 0; core < 2; core++)
+        fprintf(out, ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                     "\"args\": {\"name\": \"core%d\"}}", core, core);
+    for (const Event &e : events) {
+        unsigned id = e.id & kIdMask;
+        std::string name = id < names.size() && !names[id].empty() ? names[id]
+                                                                    : "id" + std::to_string(id);
+        const char *ph = (e.id & kPhaseBegin) ? "B" : (e.id & kPhaseEnd) ? "E" : "i";
+        fprintf(out, ",\n  {\"name\": \"%s\", \"ph\": \"%s\", \"ts\": %llu, \"pid\": 1, "
+                     "\"tid\": %u, ",
+                json_escape(name).c_str(), ph, (unsigned long long)e.ts, e.core);
+        if (*ph == 'i')
+            fprintf(out, "\"s\": \"t\", ");
+        fprintf(out, "\"args\": {\"arg\": %u}}", e.arg);
+    }
+    fprintf(out, "\n]}\n");
+    if (out != stdout)
+        fclose(out);
+    fprintf(stderr, "imu_trace: %u eventos (%u sobrescritos no dispositivo)\n", n_events,
+            overwritten);
+    return 0;
+}